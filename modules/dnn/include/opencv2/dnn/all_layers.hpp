@@ -384,6 +384,12 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
     class CV_EXPORTS PaddingLayer : public Layer
     {
     public:
+        /** @brief Returns zero padding of the height and width of a 4D blob as it was set up
+         * by finalize(). The result is false if the layer pads the other dimensions or pads
+         * by a value which is not zero.
+         */
+        virtual bool getSpatialZeroPadding(int& top, int& bottom, int& left, int& right) const = 0;
+
         static Ptr<PaddingLayer> create(const LayerParams& params);
     };
 
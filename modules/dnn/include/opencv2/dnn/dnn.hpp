@@ -84,6 +84,19 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
         DNN_TARGET_OPENCL_FP16
     };
 
+    /**
+     * @brief Enum of layer fusion passes, see Net::setFusionPasses().
+     */
+    enum FusionPass
+    {
+        DNN_FUSION_ACTIVATION = 1,  //!< BatchNorm, Scale and activations computed by the preceding layer
+        DNN_FUSION_CONCAT = 2,      //!< inputs of Concat written into the slices of its output
+        DNN_FUSION_VIEW = 4,        //!< Flatten, Reshape and Permute which keep the data in place become views
+        DNN_FUSION_PADDING = 8,     //!< zero Padding folded into the borders of the following convolution
+        DNN_FUSION_POINTWISE = 16,  //!< 1x1 convolution merged into the preceding convolution
+        DNN_FUSION_ALL = 31
+    };
+
     /** @brief This class provides all data needed to initialize layer.
      *
      * It includes dictionary with scalar params (which can be readed by using Dict interface),
@@ -288,6 +301,31 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
          */
         virtual bool tryFuse(Ptr<Layer>& top);
 
+        /**
+         * @brief Switches the layer to 8-bit integer computations.
+         * @param[in] inputRanges Maximal absolute values of the layer inputs collected over calibration data.
+         *                        Empty vector switches the layer back to floating point computations.
+         * @returns True if the layer computes in int8 from now on.
+         *
+         * Weights are quantized with a scale per output channel and inputs with the scale
+         * derived from @p inputRanges. Outputs of the layer stay floating point.
+         */
+        virtual bool tryQuantize(const std::vector<float>& inputRanges);
+
+        /**
+         * @brief Switches the layer to the channel-blocked layout of the blobs.
+         * @param[in] inputs Input blobs. Empty vector switches the layer back to the NCHW layout.
+         * @param[in] outputs Output blobs.
+         * @returns True if the layer processes all its inputs and outputs in the blocked layout from now on.
+         *
+         * In the blocked layout (NCHW8c) the channels are split into groups of 8 and the values of a group
+         * are interleaved: the element (n, c, y, x) is stored at (((n*C + c - c%8)*H + y)*W + x)*8 + c%8.
+         * Blob headers keep their NCHW shapes. The network negotiates the layout after the layers fusion
+         * for the 4-dimensional blobs with a multiple of 8 channels and converts the blobs only between
+         * the layers which use different layouts.
+         */
+        virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs);
+
         /**
          * @brief Returns parameters of layers with channel-wise multiplication and addition.
          * @param[out] scale Channel-wise multipliers. Total number of values should
@@ -600,11 +638,70 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
                                           CV_OUT std::vector<size_t>& weights,
                                           CV_OUT std::vector<size_t>& blobs) const; // FIXIT: CV_WRAP
 
+        /** @brief Returns bytes number of intermediate blobs of the network as it was allocated
+         * by the last forward() call.
+         * @param allocated output parameter for the memory allocated for intermediate blobs.
+         * @param peak output parameter for the maximal memory of intermediate blobs which are in use at
+         * the same time. It is the lower bound of @p allocated.
+         *
+         * On CPU, blobs are placed by their lifetimes into a single memory arena so @p allocated
+         * is close to @p peak. Network inputs are not counted.
+         */
+        CV_WRAP void getActivationMemory(CV_OUT size_t& allocated, CV_OUT size_t& peak) const;
+
+        /** @brief Makes the network use the same memory arena for intermediate blobs as @p other.
+         *
+         * The arena is as large as required by the biggest of the networks so a few models used in
+         * turn take only the memory of one of them. Networks that share the arena must not be run
+         * concurrently. Blobs returned by forward() remain valid if they are outputs of the network or
+         * requested by names in forward(OutputArrayOfArrays, const std::vector<String>&); results of
+         * intermediate layers requested by forward(const String&) are overwritten by
+         * the next forward() of any network sharing the arena.
+         */
+        CV_WRAP void shareActivationArena(Net& other);
+
         /** @brief Enables or disables layer fusion in the network.
          * @param fusion true to enable the fusion, false to disable. The fusion is enabled by default.
          */
         CV_WRAP void enableFusion(bool fusion);
 
+        /** @brief Selects the layer fusion passes applied when the fusion is enabled.
+         * @param passes combination of #FusionPass flags, #DNN_FUSION_ALL by default.
+         *
+         * The passes other than #DNN_FUSION_ACTIVATION and #DNN_FUSION_CONCAT take effect for
+         * #DNN_BACKEND_DEFAULT on #DNN_TARGET_CPU only.
+         */
+        CV_WRAP void setFusionPasses(int passes);
+
+        /** @brief Returns the layers which are not computed separately after the last forward() call
+         * because they are fused into the other layers.
+         * @param layerNames output parameter for the names of the fused layers.
+         * @param passes output parameter for the #FusionPass which removed each of the layers.
+         */
+        CV_WRAP void getFusedLayers(CV_OUT std::vector<String>& layerNames, CV_OUT std::vector<int>& passes) const;
+
+        /** @brief Enables or disables the channel-blocked layout of intermediate blobs.
+         * @param blockedLayout true to let the layers negotiate the blocked layout (see
+         * Layer::tryUseBlockedLayout), false to keep all the blobs in NCHW. It is enabled by default
+         * and takes effect for #DNN_BACKEND_DEFAULT on #DNN_TARGET_CPU only.
+         *
+         * Outputs of the network and blobs requested by forward() are always returned in NCHW.
+         */
+        CV_WRAP void enableBlockedLayout(bool blockedLayout);
+
+        /** @brief Calibrates the network and switches Convolution and InnerProduct layers to 8-bit
+         * integer computations (post-training quantization).
+         * @param calibData representative input blobs. The network is run on each of them in floating
+         * point to collect the ranges of the layers inputs.
+         * @return the number of layers computing in int8.
+         *
+         * Weights are quantized symmetrically with a scale per output channel, inputs of the layers
+         * with a single scale each. The blobs between the layers remain floating point, so the other
+         * layers are not affected. Calling the method again recalibrates the network.
+         * Only #DNN_BACKEND_DEFAULT on #DNN_TARGET_CPU computes in int8, other targets ignore it.
+         */
+        CV_WRAP int quantize(InputArrayOfArrays calibData);
+
         /** @brief Returns overall time for inference and timings (in ticks) for layers.
          * Indexes in returned vector correspond to layers ids. Some layers can be fused with others,
          * in this case zero ticks count will be return for that skipped layers.
@@ -618,6 +715,51 @@ CV__DNN_EXPERIMENTAL_NS_BEGIN
         Ptr<Impl> impl;
     };
 
+    /** @brief Runs a network on inputs submitted by several threads in batches.
+     *
+     * Every forward() call blocks the calling thread. Inputs of the concurrent calls are collected
+     * until @p maxBatchSize samples are available or @p timeoutMs milliseconds have passed since
+     * the first of them, stacked along the batch dimension into a single blob and processed by one
+     * Net::forward() call on a worker thread. Then each caller gets its part of the output.
+     *
+     * Batches are padded with zero samples to the next power of two, at most @p maxBatchSize,
+     * so a lone request is not run at the full batch size and the network is reallocated only
+     * for a few batch sizes. The network must have a single input, and it must not be used
+     * directly while the executor is alive.
+     */
+    class CV_EXPORTS BatchingExecutor
+    {
+    public:
+        /** @brief Starts the worker thread.
+         * @param net network to run.
+         * @param maxBatchSize maximal number of samples in a batch.
+         * @param timeoutMs maximal time to wait for a batch to be filled up.
+         * @param outputName name of the layer whose output is returned, the last layer's output by default.
+         */
+        BatchingExecutor(const Net& net, int maxBatchSize, double timeoutMs = 1.,
+                         const String& outputName = String());
+
+        /** @brief Processes the remaining inputs and stops the worker thread. */
+        ~BatchingExecutor();
+
+        /** @brief Runs the network on @p blob and returns the output.
+         * @param blob 4-dimensional (or any other number of dimensions) CV_32F blob. Its first
+         * dimension is a number of samples and it can be more than one. Others must be the same
+         * for all the calls to be batched together.
+         * @return the output blob with the same number of samples as @p blob.
+         *
+         * An exception thrown by the network is thrown in all the calls of the batch.
+         */
+        Mat forward(InputArray blob);
+
+        /** @brief Returns the numbers of processed batches and samples. */
+        void getStatistics(int64& batches, int64& samples) const;
+
+    private:
+        struct Impl;
+        Ptr<Impl> impl;
+    };
+
     /** @brief Reads a network model stored in <a href="https://pjreddie.com/darknet/">Darknet</a> model files.
     *  @param cfgFile      path to the .cfg file with text description of the network architecture.
     *  @param darknetModel path to the .weights file with learned network.
@@ -0,0 +1,96 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+#include <thread>
+
+namespace opencv_test {
+
+// Every client thread sends single samples one after another, as a server would do for concurrent
+// connections. maxBatchSize == 1 corresponds to the requests processed one by one.
+typedef TestBaseWithParam<tuple<int, int> > BatchingExecutorPerfTest;
+
+PERF_TEST_P_(BatchingExecutorPerfTest, throughput)
+{
+    const int maxBatchSize = get<0>(GetParam());
+    const int numClients = get<1>(GetParam());
+    const int requestsPerClient = 8;
+
+    RNG rng(0);
+    Mat input(std::vector<int>{1, 3, 64, 64}, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    BatchingExecutor executor(createResidualNet(0), maxBatchSize, 2.);
+    executor.forward(input);  // warm up
+
+    std::vector<double> latencies(numClients * requestsPerClient);
+    PERF_SAMPLE_BEGIN()
+        std::vector<std::thread> clients;
+        for (int c = 0; c < numClients; c++)
+        {
+            clients.push_back(std::thread([&, c]() {
+                for (int i = 0; i < requestsPerClient; i++)
+                {
+                    int64 start = getTickCount();
+                    executor.forward(input);
+                    latencies[c * requestsPerClient + i] = (getTickCount() - start) * 1000. / getTickFrequency();
+                }
+            }));
+        }
+        for (size_t c = 0; c < clients.size(); c++)
+            clients[c].join();
+    PERF_SAMPLE_END()
+
+    std::sort(latencies.begin(), latencies.end());
+    RecordProperty("latency_median_ms", cv::format("%.3f", latencies[latencies.size() / 2]));
+    RecordProperty("latency_max_ms", cv::format("%.3f", latencies.back()));
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, BatchingExecutorPerfTest, Combine(
+    Values(1, 4, 8),
+    Values(1, 8)
+));
+
+// A single client under light load: the request should cost about as much as Net::forward()
+// on the sample (maxBatchSize == 0) whatever maxBatchSize is.
+typedef TestBaseWithParam<int> BatchingExecutorLatencyPerfTest;
+
+PERF_TEST_P_(BatchingExecutorLatencyPerfTest, single_request)
+{
+    const int maxBatchSize = GetParam();
+
+    RNG rng(0);
+    Mat input(std::vector<int>{1, 3, 64, 64}, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Net net = createResidualNet(0);
+    if (maxBatchSize == 0)
+    {
+        net.setInput(input);
+        net.forward();  // warm up
+        TEST_CYCLE()
+        {
+            net.setInput(input);
+            net.forward();
+        }
+    }
+    else
+    {
+        BatchingExecutor executor(net, maxBatchSize, 0.);
+        executor.forward(input);  // warm up
+        TEST_CYCLE()
+        {
+            executor.forward(input);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, BatchingExecutorLatencyPerfTest, Values(0, 1, 8, 32));
+
+} // namespace
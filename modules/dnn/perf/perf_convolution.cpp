@@ -1,5 +1,6 @@
 #include "perf_precomp.hpp"
 #include <opencv2/dnn/shape_utils.hpp>
+#include <opencv2/dnn/all_layers.hpp>
 
 namespace opencv_test {
 
@@ -89,4 +90,101 @@ PERF_TEST_P( ConvolutionPerfTest, perf, Combine(
     SANITY_CHECK_NOTHING();
 }
 
+// The specialized convolution kernels against the generic im2row one (CONV_IM2ROW, Winograd disabled).
+// CONV_BLOCKED runs the layer on the channel-blocked blobs without the conversions. The depthwise
+// convolutions (group 0 stands for group == channels) of MobileNet have a fused ReLU6.
+enum {CONV_IM2ROW, CONV_WINOGRAD, CONV_INT8, CONV_BLOCKED};
+CV_ENUM(ConvKernel, CONV_IM2ROW, CONV_WINOGRAD, CONV_INT8, CONV_BLOCKED);
+
+typedef TestBaseWithParam<tuple<InpShapeNumOut, int, int, int, ConvKernel> > ConvKernelPerfTest;
+
+PERF_TEST_P_(ConvKernelPerfTest, kernel)
+{
+    RNG rng(0);
+
+    MatShape inpShape = get<0>(GetParam()).first;
+    int outCn = get<0>(GetParam()).second;
+    int kernel = get<1>(GetParam());
+    int stride = get<2>(GetParam());
+    int group = get<3>(GetParam());
+    int mode = get<4>(GetParam());
+    if (group == 0)
+        group = inpShape[1];
+
+    LayerParams lp = convolutionParams("conv", inpShape[1], outCn, kernel, stride, kernel / 2, group, true, rng);
+    lp.set("use_winograd", mode == CONV_WINOGRAD);
+    Mat inpBlob(4, &inpShape[0], CV_32F);
+    rng.fill(inpBlob, RNG::UNIFORM, -1, +1);
+
+    std::vector<Mat*> inpBlobs(1, &inpBlob);
+    std::vector<Mat> outBlobs, internalBlobs;
+
+    Ptr<Layer> layer = cv::dnn::LayerFactory::createLayerInstance("Convolution", lp);
+    std::vector<MatShape> inputShapes(1, shape(inpBlob)), outShapes, internals;
+    layer->getMemoryShapes(inputShapes, 0, outShapes, internals);
+    outBlobs.push_back(Mat(outShapes[0], CV_32F));
+
+    if (group == inpShape[1] && group > 1)
+    {
+        LayerParams relu6;
+        relu6.set("min_value", 0.f);
+        relu6.set("max_value", 6.f);
+        Ptr<ActivationLayer> activ = LayerFactory::createLayerInstance("ReLU6", relu6).dynamicCast<ActivationLayer>();
+        ASSERT_TRUE(layer->setActivation(activ));
+    }
+    layer->finalize(inpBlobs, outBlobs);
+    if (mode == CONV_INT8)
+        ASSERT_TRUE(layer->tryQuantize(std::vector<float>(1, 1.f)));  // the range of the input values
+    if (mode == CONV_BLOCKED && !layer->tryUseBlockedLayout(inpBlobs, outBlobs))
+        throw SkipTestException("Blocked convolution is not available");
+    layer->forward(inpBlobs, outBlobs, internalBlobs); /// warmup
+
+    PERF_SAMPLE_BEGIN()
+        layer->forward(inpBlobs, outBlobs, internalBlobs);
+    PERF_SAMPLE_END()
+
+    SANITY_CHECK_NOTHING();
+}
+
+// 3x3 stride 1 convolutions of ResNet / VGG.
+INSTANTIATE_TEST_CASE_P(Winograd, ConvKernelPerfTest, Combine(
+    Values(make_pair(blobShape(1,  16, 112, 112),  16),
+           make_pair(blobShape(1,  64,  56,  56),  64),
+           make_pair(blobShape(1, 128,  28,  28), 128),
+           make_pair(blobShape(1, 256,  14,  14), 256),
+           make_pair(blobShape(1, 512,   7,   7), 512)),
+    Values(3), Values(1), Values(1),
+    Values((int)CONV_WINOGRAD, (int)CONV_IM2ROW)
+));
+
+// Convolutions of ResNet-50.
+INSTANTIATE_TEST_CASE_P(Int8, ConvKernelPerfTest, Combine(
+    Values(make_pair(blobShape(1,  64, 56, 56),  64),
+           make_pair(blobShape(1, 256, 14, 14), 256),
+           make_pair(blobShape(1, 512,  7,  7), 512)),
+    Values(1, 3), Values(1), Values(1),
+    Values((int)CONV_INT8, (int)CONV_IM2ROW)
+));
+
+INSTANTIATE_TEST_CASE_P(Blocked, ConvKernelPerfTest, Combine(
+    Values(make_pair(blobShape(1,  64, 56, 56),  64),
+           make_pair(blobShape(1, 256, 56, 56),  64),
+           make_pair(blobShape(1, 128, 28, 28), 512),
+           make_pair(blobShape(1, 256, 14, 14), 256),
+           make_pair(blobShape(1, 512,  7,  7), 512)),
+    Values(1, 3), Values(1, 2), Values(1),
+    Values((int)CONV_BLOCKED, (int)CONV_IM2ROW)
+));
+
+// Depthwise convolutions of MobileNet, computed by the direct depthwise kernel.
+INSTANTIATE_TEST_CASE_P(Depthwise, ConvKernelPerfTest, Combine(
+    Values(make_pair(blobShape(1,   32, 112, 112),   32),
+           make_pair(blobShape(1,  128,  56,  56),  128),
+           make_pair(blobShape(1,  256,  28,  28),  256),
+           make_pair(blobShape(1,  512,  14,  14),  512),
+           make_pair(blobShape(1, 1024,   7,   7), 1024)),
+    Values(3, 5), Values(1, 2), Values(0),
+    Values((int)CONV_IM2ROW)
+));
+
 } // namespace
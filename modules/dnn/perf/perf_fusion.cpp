@@ -0,0 +1,102 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test {
+
+// SSD-like detection head on a few feature maps: the explicitly padded convolutions with
+// a bottleneck of 1x1 convolution predict boxes, which are permuted to NHWC, flattened and
+// concatenated.
+static Net createDetectionHead(const std::vector<int>& sizes, int cn, RNG& rng)
+{
+    Net net;
+    std::vector<String> inputNames;
+    std::vector<int> flattenIds;
+    for (size_t i = 0; i < sizes.size(); i++)
+        inputNames.push_back(cv::format("input%d", (int)i));
+    net.setInputsNames(inputNames);
+
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        LayerParams lp;
+        int paddings[] = {0, 0, 0, 0, 1, 1, 1, 1};
+        lp.set("paddings", DictValue::arrayInt(&paddings[0], 8));
+        lp.type = "Padding";
+        lp.name = cv::format("padding%d", (int)i);
+        int id = net.addLayer(lp.name, lp.type, lp);
+        net.connect(0, (int)i, id, 0);
+
+        id = addConvolution(net, cv::format("conv%d", (int)i), id, cn, cn / 4, 3, 1, 0, 1, false, rng);
+        id = addConvolution(net, cv::format("pointwise%d", (int)i), id, cn / 4, 24, 1, 1, 0, 1, false, rng);
+
+        lp = LayerParams();
+        int order[] = {0, 2, 3, 1};
+        lp.set("order", DictValue::arrayInt(&order[0], 4));
+        lp.type = "Permute";
+        lp.name = cv::format("permute%d", (int)i);
+        int permuteId = net.addLayer(lp.name, lp.type, lp);
+        net.connect(id, 0, permuteId, 0);
+
+        lp = LayerParams();
+        lp.type = "Flatten";
+        lp.name = cv::format("flatten%d", (int)i);
+        flattenIds.push_back(net.addLayer(lp.name, lp.type, lp));
+        net.connect(permuteId, 0, flattenIds.back(), 0);
+    }
+
+    LayerParams lp;
+    lp.set("axis", 1);
+    lp.type = "Concat";
+    lp.name = "concat";
+    int concatId = net.addLayer(lp.name, lp.type, lp);
+    for (size_t i = 0; i < flattenIds.size(); i++)
+        net.connect(flattenIds[i], 0, concatId, (int)i);
+    return net;
+}
+
+// DNN_FUSION_ACTIVATION | DNN_FUSION_CONCAT corresponds to the fusion of the previous versions.
+typedef TestBaseWithParam<int> FusionPerfTest;
+
+PERF_TEST_P_(FusionPerfTest, detection_head)
+{
+    const int passes = GetParam();
+    const int sizesArr[] = {19, 10, 5, 3, 2, 1};
+    const int cn = 256;
+    std::vector<int> sizes(sizesArr, sizesArr + sizeof(sizesArr) / sizeof(sizesArr[0]));
+
+    RNG rng(0);
+    Net net = createDetectionHead(sizes, cn, rng);
+    net.setFusionPasses(passes);
+    std::vector<Mat> inputs(sizes.size());
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        inputs[i].create(std::vector<int>{1, cn, sizes[i], sizes[i]}, CV_32F);
+        rng.fill(inputs[i], RNG::UNIFORM, -1, 1);
+        net.setInput(inputs[i], cv::format("input%d", (int)i));
+    }
+    net.forward();  // warm up
+
+    TEST_CYCLE()
+    {
+        net.forward();
+    }
+
+    std::vector<String> fusedNames;
+    std::vector<int> fusedPasses;
+    net.getFusedLayers(fusedNames, fusedPasses);
+    RecordProperty("fused_layers", (int)fusedNames.size());
+
+    SANITY_CHECK_NOTHING();
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, FusionPerfTest, Values(
+    (int)(DNN_FUSION_ACTIVATION | DNN_FUSION_CONCAT),
+    (int)(DNN_FUSION_ACTIVATION | DNN_FUSION_CONCAT | DNN_FUSION_VIEW),
+    (int)(DNN_FUSION_ACTIVATION | DNN_FUSION_CONCAT | DNN_FUSION_PADDING),
+    (int)(DNN_FUSION_ACTIVATION | DNN_FUSION_CONCAT | DNN_FUSION_POINTWISE),
+    (int)DNN_FUSION_ALL
+));
+
+} // namespace
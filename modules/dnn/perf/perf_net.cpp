@@ -30,8 +30,10 @@ public:
     }
 
     void processNet(std::string weights, std::string proto, std::string halide_scheduler,
-                    const Mat& input, const std::string& outputLayer = "")
+                    const Mat& input, const std::string& outputLayer = "", bool int8 = false)
     {
+        if (int8 && (backend != DNN_BACKEND_DEFAULT || target != DNN_TARGET_CPU))
+            throw SkipTestException("int8 is computed on CPU only");
         if (backend == DNN_BACKEND_DEFAULT && target == DNN_TARGET_OPENCL)
         {
 #if defined(HAVE_OPENCL)
@@ -55,6 +57,14 @@ public:
                 halide_scheduler = findDataFile(std::string("dnn/halide_scheduler_") + (target == DNN_TARGET_OPENCL ? "opencl_" : "") + halide_scheduler, true);
         }
         net = readNet(proto, weights);
+        if (int8)
+        {
+            // the scales are calibrated on a real image in the range of the pixel values
+            // the models are trained on, as in Reproducibility_ResNet50_int8
+            Mat sample = imread(findDataFile("dnn/googlenet_0.png", false));
+            ASSERT_FALSE(sample.empty());
+            net.quantize(std::vector<Mat>(1, blobFromImage(sample, 1.0, input.size(), Scalar(), false)));
+        }
         net.setInput(blobFromImage(input, 1.0, Size(), Scalar(), false));
         net.setPreferableBackend(backend);
         net.setPreferableTarget(target);
@@ -111,6 +121,18 @@ PERF_TEST_P_(DNNTestNetwork, SqueezeNet_v1_1)
             "squeezenet_v1_1.yml", Mat(cv::Size(227, 227), CV_32FC3));
 }
 
+PERF_TEST_P_(DNNTestNetwork, ResNet_50_int8)
+{
+    processNet("dnn/ResNet-50-model.caffemodel", "dnn/ResNet-50-deploy.prototxt",
+            "", Mat(cv::Size(224, 224), CV_32FC3), "", true);
+}
+
+PERF_TEST_P_(DNNTestNetwork, SqueezeNet_v1_1_int8)
+{
+    processNet("dnn/squeezenet_v1.1.caffemodel", "dnn/squeezenet_v1.1.prototxt",
+            "", Mat(cv::Size(227, 227), CV_32FC3), "", true);
+}
+
 PERF_TEST_P_(DNNTestNetwork, Inception_5h)
 {
     if (backend == DNN_BACKEND_INFERENCE_ENGINE) throw SkipTestException("");
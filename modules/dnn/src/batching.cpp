@@ -0,0 +1,249 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include <opencv2/dnn/shape_utils.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <exception>
+
+namespace cv
+{
+namespace dnn
+{
+CV__DNN_EXPERIMENTAL_NS_BEGIN
+
+struct BatchingExecutor::Impl
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Lives on the stack of the thread waiting in forward().
+    struct Request
+    {
+        Request() : samples(0), done(false) {}
+
+        Mat input;
+        int samples;
+        Clock::time_point arrival;
+        Mat output;
+        std::exception_ptr error;
+        bool done;
+    };
+
+    Impl(const Net& net_, int maxBatchSize_, double timeoutMs, const String& outputName_)
+        : net(net_), maxBatchSize(maxBatchSize_), outputName(outputName_),
+          timeout(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(timeoutMs))),
+          stopping(false), batches(0), samples(0)
+    {
+        CV_Assert(!net.empty());
+        CV_Assert(maxBatchSize > 0);
+        CV_Assert(timeoutMs >= 0);
+        worker = std::thread(&Impl::run, this);
+    }
+
+    ~Impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            arrived.notify_all();
+        }
+        worker.join();
+    }
+
+    static bool sameSampleShape(const Mat& a, const Mat& b)
+    {
+        if (a.dims != b.dims)
+            return false;
+        for (int i = 1; i < a.dims; i++)
+        {
+            if (a.size[i] != b.size[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Number of the queued samples which can be batched with the first request.
+    int readySamples() const
+    {
+        int n = 0;
+        for (size_t i = 0; i < queue.size(); i++)
+        {
+            if (sameSampleShape(queue[i]->input, queue.front()->input))
+                n += queue[i]->samples;
+        }
+        return n;
+    }
+
+    // The batches are padded up to a power of two (or maxBatchSize) so the network
+    // is reshaped only for a few batch sizes, a request too big for a batch runs as is.
+    int paddedBatchSize(int batchSamples) const
+    {
+        if (batchSamples >= maxBatchSize)
+            return batchSamples;
+        int size = 1;
+        while (size < batchSamples)
+            size *= 2;
+        return std::min(size, maxBatchSize);
+    }
+
+    void run();
+    void process(const std::vector<Request*>& batch, int batchSamples);
+
+    Net net;
+    const int maxBatchSize;
+    const String outputName;
+    const Clock::duration timeout;
+    std::map<int, Mat> batchBlobs;  // by the padded batch size
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable arrived, finished;
+    std::deque<Request*> queue;
+    bool stopping;
+    int64 batches, samples;
+};
+
+void BatchingExecutor::Impl::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        while (!stopping && queue.empty())
+            arrived.wait(lock);
+        if (queue.empty())
+            break;
+
+        const Clock::time_point deadline = queue.front()->arrival + timeout;
+        while (!stopping && readySamples() < maxBatchSize)
+        {
+            if (arrived.wait_until(lock, deadline) == std::cv_status::timeout)
+                break;
+        }
+
+        // The first request is taken even if it does not fit into a batch alone.
+        std::vector<Request*> batch;
+        int batchSamples = 0;
+        const Mat first = queue.front()->input;
+        for (std::deque<Request*>::iterator it = queue.begin(); it != queue.end();)
+        {
+            Request* req = *it;
+            if (sameSampleShape(req->input, first) &&
+                (batch.empty() || batchSamples + req->samples <= maxBatchSize))
+            {
+                batch.push_back(req);
+                batchSamples += req->samples;
+                it = queue.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        lock.unlock();
+        process(batch, batchSamples);
+        lock.lock();
+
+        batches++;
+        samples += batchSamples;
+        for (size_t i = 0; i < batch.size(); i++)
+            batch[i]->done = true;
+        finished.notify_all();
+    }
+}
+
+void BatchingExecutor::Impl::process(const std::vector<Request*>& batch, int batchSamples)
+{
+    CV_TRACE_FUNCTION();
+
+    const int batchSize = paddedBatchSize(batchSamples);
+    try
+    {
+        MatShape inpShape = shape(batch[0]->input);
+        inpShape[0] = batchSize;
+        Mat& batchBlob = batchBlobs[batchSize];
+        batchBlob.create(inpShape, CV_32F);
+
+        Mat rows = batchBlob.reshape(1, batchSize);
+        int r = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i]->input.reshape(1, batch[i]->samples).copyTo(rows.rowRange(r, r + batch[i]->samples));
+            r += batch[i]->samples;
+        }
+        if (r < batchSize)
+            rows.rowRange(r, batchSize).setTo(0);
+
+        net.setInput(batchBlob);
+        Mat out = net.forward(outputName);
+        CV_Assert(out.dims >= 2 && out.size[0] == batchSize && out.isContinuous());
+
+        MatShape outShape = shape(out);
+        rows = out.reshape(1, batchSize);
+        r = 0;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            // The network reuses its output memory in the next batch.
+            outShape[0] = batch[i]->samples;
+            batch[i]->output = rows.rowRange(r, r + batch[i]->samples).clone().reshape(1, outShape);
+            r += batch[i]->samples;
+        }
+    }
+    catch (...)
+    {
+        std::exception_ptr error = std::current_exception();
+        for (size_t i = 0; i < batch.size(); i++)
+            batch[i]->error = error;
+    }
+}
+
+BatchingExecutor::BatchingExecutor(const Net& net, int maxBatchSize, double timeoutMs,
+                                   const String& outputName)
+    : impl(makePtr<Impl>(net, maxBatchSize, timeoutMs, outputName))
+{
+}
+
+BatchingExecutor::~BatchingExecutor()
+{
+}
+
+Mat BatchingExecutor::forward(InputArray blob)
+{
+    CV_TRACE_FUNCTION();
+
+    Impl::Request req;
+    req.input = blob.getMat();
+    CV_Assert(req.input.type() == CV_32F && req.input.size[0] > 0);
+    if (!req.input.isContinuous())
+        req.input = req.input.clone();
+    req.samples = req.input.size[0];
+
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    CV_Assert(!impl->stopping);
+    req.arrival = Impl::Clock::now();
+    impl->queue.push_back(&req);
+    impl->arrived.notify_all();
+    while (!req.done)
+        impl->finished.wait(lock);
+    lock.unlock();
+
+    if (req.error)
+        std::rethrow_exception(req.error);
+    return req.output;
+}
+
+void BatchingExecutor::getStatistics(int64& batches, int64& samples) const
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    batches = impl->batches;
+    samples = impl->samples;
+}
+
+CV__DNN_EXPERIMENTAL_NS_END
+}
+}
@@ -43,6 +43,7 @@
 #include "op_halide.hpp"
 #include "op_inf_engine.hpp"
 #include "halide_scheduler.hpp"
+#include "layers/layers_common.hpp"
 #include <set>
 #include <algorithm>
 #include <iostream>
@@ -339,9 +340,9 @@ struct LayerPin
 
 struct LayerData
 {
-    LayerData() : id(-1), skip(false), flag(0) {}
+    LayerData() : id(-1), skip(false), blocked(false), flag(0) {}
     LayerData(int _id, const String &_name, const String &_type, LayerParams &_params)
-        : id(_id), name(_name), type(_type), params(_params), skip(false), flag(0)
+        : id(_id), name(_name), type(_type), params(_params), skip(false), blocked(false), flag(0)
     {
         CV_TRACE_FUNCTION();
 
@@ -371,6 +372,15 @@ struct LayerData
     std::map<int, Ptr<BackendNode> > backendNodes;
     // Flag for skip layer computation for specific backend.
     bool skip;
+    // Maximal absolute values of the inputs seen while calibrating (see Net::quantize).
+    std::vector<float> inputRanges;
+    // The layer processes its blobs in the channel-blocked layout (see Net::Impl::negotiateLayouts).
+    bool blocked;
+    // Blocked copies of the inputs and outputs which are converted at the boundaries of the blocked
+    // parts of the network. Empty for the blobs passed to the layer as is.
+    std::vector<Mat> blockedInputs, blockedOutputs;
+    // Output blobs which hold the blocked data after the forward pass.
+    std::vector<bool> outputBlocked;
 
     int flag;
 
@@ -423,9 +433,27 @@ struct DataLayer : public Layer
     std::vector<String> outNames;
 };
 
+// Memory of the intermediate blobs packed by the liveness planner. Can be shared by several
+// networks which are not run concurrently; it only grows.
+struct ActivationArena
+{
+    // The arena is a single row, the blobs are bound to its column ranges.
+    Mat reserve(size_t total)
+    {
+        CV_Assert(total <= (size_t)INT_MAX);
+        if (buffer.total() < total)
+            buffer.create(1, (int)total, CV_32F);
+        return buffer;
+    }
+
+    Mat buffer;
+};
+
 struct BlobManager
 {
 public:
+    BlobManager() : arenaTotal(0), persistentTotal(0), peakTotal(0), planningStep(0) {}
+
     // Increase references counter to layer output.
     void addReference(const LayerPin& lp)
     {
@@ -615,6 +643,8 @@ public:
                         ld.outputBlobs[index] = ld.inputBlobs[0]->reshape(1, shapes[index]);
                         reuse(ld.inputBlobsId[0], blobPin);
                     }
+                    else if (!arenaBuffer.empty() && !forceCreate)
+                        bindPlanned(shapes[index], blobPin, *blobs[index]);
                     else
                         reuseOrCreate(shapes[index], blobPin, *blobs[index], forceCreate);
                 }
@@ -630,9 +660,232 @@ public:
         refCounter.clear();
         reuseMap.clear();
         memHosts.clear();
+        plannedHosts.clear();
+        arenaBuffer.release();
+        arenaTotal = persistentTotal = peakTotal = 0;
+    }
+
+    // The liveness planner replays the allocation order on a copy of the reference counters
+    // (the same in-place decisions as allocateBlobsForLayer) to find out at which step every
+    // memory host is created and at which step its last reader has been allocated. Hosts
+    // with intersecting lifetimes get disjoint ranges of a single arena, the others overlap.
+    void beginPlanning()
+    {
+        plannedHosts.clear();
+        plannedReuse.clear();
+        plannedRefs = refCounter;
+        planningStep = 0;
+    }
+
+    void planBlobsForLayer(const LayerData& ld, const LayerShapes& layerShapes)
+    {
+        const int step = planningStep++;
+        const ShapesVec& outShapes = layerShapes.out,
+                internalShapes = layerShapes.internal;
+
+        bool inPlace = false;
+        if (layerShapes.supportInPlace && ld.inputBlobsId.size() == 1)
+            inPlace = plannedRefs[plannedHost(ld.inputBlobsId[0])] == 1;
+
+        std::vector<LayerPin> pinsForInternalBlobs;
+        for (int i = 0; i < (int)outShapes.size(); i++)
+        {
+            if (!total(outShapes[i]))
+                continue;
+            LayerPin blobPin(ld.id, i);
+            if (inPlace)
+            {
+                // see reuse()
+                LayerPin host = plannedHost(ld.inputBlobsId[0]);
+                plannedReuse[blobPin] = host;
+                std::map<LayerPin, int>::iterator userRefIt = plannedRefs.find(blobPin);
+                if (userRefIt != plannedRefs.end())
+                {
+                    plannedRefs[host] += userRefIt->second;
+                    plannedRefs.erase(userRefIt);
+                }
+                else
+                    plannedRefs[host] += 1;
+            }
+            else
+                addPlannedHost(blobPin, total(outShapes[i]), step);
+        }
+        for (int i = 0; i < (int)internalShapes.size(); i++)
+        {
+            if (!total(internalShapes[i]))
+                continue;
+            LayerPin blobPin(ld.id, (int)outShapes.size() + i);
+            addPlannedHost(blobPin, total(internalShapes[i]), step);
+            plannedRefs[blobPin] += 1;
+            pinsForInternalBlobs.push_back(blobPin);
+        }
+
+        releasePlanned(ld.inputBlobsId, step);
+        releasePlanned(pinsForInternalBlobs, step);
+    }
+
+    // Assigns the arena offsets (if <arena> is not empty) and computes the memory statistics.
+    void endPlanning(const Ptr<ActivationArena>& arena)
+    {
+        const size_t alignment = 16;  // elements
+
+        // Network inputs are owned by the user and are not counted.
+        std::map<int, int64> liveDelta;
+        std::vector<std::pair<size_t, LayerPin> > arenaHosts;
+        persistentTotal = 0;
+        std::map<LayerPin, MemoryHost>::iterator it;
+        for (it = plannedHosts.begin(); it != plannedHosts.end(); ++it)
+        {
+            const MemoryHost& host = it->second;
+            if (it->first.lid == 0)
+                continue;
+            liveDelta[host.firstUse] += host.total;
+            if (host.lastUse != INT_MAX)
+            {
+                liveDelta[host.lastUse + 1] -= host.total;
+                arenaHosts.push_back(std::make_pair(host.total, it->first));
+            }
+            else
+                persistentTotal += host.total;
+        }
+        int64 live = 0;
+        peakTotal = 0;
+        for (std::map<int, int64>::iterator d = liveDelta.begin(); d != liveDelta.end(); ++d)
+        {
+            live += d->second;
+            peakTotal = std::max(peakTotal, (size_t)live);
+        }
+
+        arenaTotal = 0;
+        arenaBuffer.release();
+        if (arena.empty())
+            return;
+
+        // Largest blobs first, each one into the smallest gap between the already placed
+        // blobs that are alive at the same time.
+        std::sort(arenaHosts.begin(), arenaHosts.end(), ComparePlannedHosts(plannedHosts));
+        std::vector<LayerPin> placed;
+        for (size_t i = 0; i < arenaHosts.size(); i++)
+        {
+            MemoryHost& host = plannedHosts[arenaHosts[i].second];
+            const size_t size = alignSize(host.total, alignment);
+
+            std::vector<std::pair<size_t, size_t> > busy;
+            for (size_t j = 0; j < placed.size(); j++)
+            {
+                const MemoryHost& other = plannedHosts[placed[j]];
+                if (other.firstUse <= host.lastUse && host.firstUse <= other.lastUse)
+                    busy.push_back(std::make_pair(other.offset, other.offset + alignSize(other.total, alignment)));
+            }
+            std::sort(busy.begin(), busy.end());
+
+            size_t bestOffset = 0, bestGap = SIZE_MAX, end = 0;
+            for (size_t j = 0; j < busy.size(); j++)
+            {
+                if (busy[j].first > end && busy[j].first - end >= size && busy[j].first - end < bestGap)
+                {
+                    bestGap = busy[j].first - end;
+                    bestOffset = end;
+                }
+                end = std::max(end, busy[j].second);
+            }
+            host.offset = bestGap != SIZE_MAX ? bestOffset : end;
+            arenaTotal = std::max(arenaTotal, host.offset + size);
+            placed.push_back(arenaHosts[i].second);
+        }
+        if (arenaTotal)
+            arenaBuffer = arena->reserve(arenaTotal);
+    }
+
+    // Returns true if the blobs are bound to the arena memory which has been reallocated since.
+    bool arenaOutdated(const Ptr<ActivationArena>& arena) const
+    {
+        return !arenaBuffer.empty() && !arena.empty() && arena->buffer.data != arenaBuffer.data;
+    }
+
+    // Bytes of the intermediate blobs: allocated ones and the maximum alive at the same time.
+    void getActivationMemory(size_t& allocated, size_t& peak) const
+    {
+        allocated = 0;
+        if (!arenaBuffer.empty())
+            allocated = arenaTotal + persistentTotal;
+        else
+        {
+            std::map<LayerPin, Mat>::const_iterator it;
+            for (it = memHosts.begin(); it != memHosts.end(); ++it)
+            {
+                if (it->first.lid != 0)
+                    allocated += it->second.total();
+            }
+        }
+        allocated *= sizeof(float);
+        peak = peakTotal * sizeof(float);
     }
 
 private:
+    struct MemoryHost
+    {
+        MemoryHost() : total(0), firstUse(0), lastUse(INT_MAX), offset(0) {}
+
+        size_t total;
+        // Allocation steps of the first writer and the last reader. Hosts which
+        // are never released (network inputs and outputs, kept blobs) are not in the arena.
+        int firstUse, lastUse;
+        size_t offset;
+    };
+
+    struct ComparePlannedHosts
+    {
+        ComparePlannedHosts(const std::map<LayerPin, MemoryHost>& hosts_) : hosts(hosts_) {}
+        bool operator()(const std::pair<size_t, LayerPin>& a, const std::pair<size_t, LayerPin>& b) const
+        {
+            if (a.first != b.first)
+                return a.first > b.first;
+            return hosts.find(a.second)->second.firstUse < hosts.find(b.second)->second.firstUse;
+        }
+        const std::map<LayerPin, MemoryHost>& hosts;
+    };
+
+    LayerPin plannedHost(const LayerPin& lp) const
+    {
+        std::map<LayerPin, LayerPin>::const_iterator it = plannedReuse.find(lp);
+        CV_Assert(it != plannedReuse.end());
+        return it->second;
+    }
+
+    void addPlannedHost(const LayerPin& lp, size_t totalElems, int step)
+    {
+        CV_Assert(plannedHosts.find(lp) == plannedHosts.end());
+        MemoryHost& host = plannedHosts[lp];
+        host.total = totalElems;
+        host.firstUse = step;
+        plannedReuse[lp] = lp;
+    }
+
+    void releasePlanned(const std::vector<LayerPin>& pins, int step)
+    {
+        for (size_t i = 0; i < pins.size(); i++)
+        {
+            LayerPin host = plannedHost(pins[i]);
+            int& refs = plannedRefs[host];
+            CV_Assert(refs > 0);
+            if (--refs == 0)
+                plannedHosts[host].lastUse = step;
+        }
+    }
+
+    void bindPlanned(const MatShape& shape, const LayerPin& lp, Mat& dst)
+    {
+        std::map<LayerPin, MemoryHost>::const_iterator it = plannedHosts.find(lp);
+        CV_Assert(it != plannedHosts.end() && it->second.total == (size_t)total(shape));
+        const MemoryHost& host = it->second;
+        if (host.lastUse == INT_MAX)
+            dst.create(shape, CV_32F);
+        else
+            dst = arenaBuffer.colRange((int)host.offset, (int)(host.offset + host.total)).reshape(1, shape);
+        addHost(lp, dst);
+    }
+
     // Register allocated memory.
     void addHost(const LayerPin& lp, const Mat& mat)
     {
@@ -646,6 +899,13 @@ private:
     // For origin blobs key == value.
     std::map<LayerPin, LayerPin> reuseMap;
     std::map<LayerPin, Mat> memHosts;
+
+    std::map<LayerPin, MemoryHost> plannedHosts;
+    std::map<LayerPin, LayerPin> plannedReuse;
+    std::map<LayerPin, int> plannedRefs;
+    Mat arenaBuffer;
+    size_t arenaTotal, persistentTotal, peakTotal;  // elements
+    int planningStep;
 };
 
 static Ptr<BackendWrapper> wrapMat(int backendId, int targetId, cv::Mat& m)
@@ -697,9 +957,13 @@ struct Net::Impl
         lastLayerId = 0;
         netWasAllocated = false;
         fusion = true;
+        fusionPasses = DNN_FUSION_ALL;
+        blockedLayout = true;
         preferableBackend = DNN_BACKEND_DEFAULT;
         preferableTarget = DNN_TARGET_CPU;
         skipInfEngineInit = false;
+        calibrating = false;
+        arena = makePtr<ActivationArena>();
     }
 
     Ptr<DataLayer> netInputLayer;
@@ -707,6 +971,7 @@ struct Net::Impl
     MapIdToLayerData layers;
     std::map<String, int> layerNameToId;
     BlobManager blobManager;
+    Ptr<ActivationArena> arena;
     int preferableBackend;
     int preferableTarget;
     String halideConfigFile;
@@ -718,6 +983,11 @@ struct Net::Impl
 
     bool netWasAllocated;
     bool fusion;
+    int fusionPasses;
+    std::vector<std::pair<int, int> > fusedLayers;  // layer id, FusionPass
+    std::map<int, Size> foldedPaddings;  // convolution id, its padding before the fusion
+    bool blockedLayout;
+    bool calibrating;
     std::vector<int64> layersTimings;
 
     Ptr<BackendWrapper> wrap(Mat& host)
@@ -820,6 +1090,8 @@ struct Net::Impl
                 it->second.internals.clear();
             }
             it->second.skip = false;
+            it->second.blocked = false;
+            it->second.outputBlocked.clear();
             //it->second.consumers.clear();
             Ptr<Layer> currLayer = it->second.layerInstance;
 
@@ -833,7 +1105,15 @@ struct Net::Impl
             {
                 poolingLayer->computeMaxIdx = true;
             }
+
+            std::map<int, Size>::iterator folded = foldedPaddings.find(it->first);
+            if( folded != foldedPaddings.end() )
+            {
+                currLayer.dynamicCast<ConvolutionLayer>()->pad = folded->second;
+            }
         }
+        foldedPaddings.clear();
+        fusedLayers.clear();
         it = layers.find(0);
         CV_Assert(it != layers.end());
         it->second.skip = true;
@@ -845,7 +1125,8 @@ struct Net::Impl
     {
         CV_TRACE_FUNCTION();
 
-        if (!netWasAllocated || this->blobsToKeep != blobsToKeep_)
+        if (!netWasAllocated || this->blobsToKeep != blobsToKeep_ ||
+            blobManager.arenaOutdated(arena))
         {
 #ifndef HAVE_OPENCL
             if (preferableBackend == DNN_BACKEND_DEFAULT && preferableTarget == DNN_TARGET_OPENCL)
@@ -1391,6 +1672,25 @@ struct Net::Impl
         ld.flag = 1;
     }
 
+    // Visits the layers in the same order as allocateLayer().
+    void planLayer(int lid, const LayersShapesMap& layersShapes)
+    {
+        LayerData &ld = layers[lid];
+        if (ld.flag)
+            return;
+        ld.flag = 1;
+
+        std::set<int> inputLayersId;
+        for (size_t i = 0; i < ld.inputBlobsId.size(); i++)
+            inputLayersId.insert(ld.inputBlobsId[i].lid);
+        for (set<int>::iterator i = inputLayersId.begin(); i != inputLayersId.end(); i++)
+            planLayer(*i, layersShapes);
+
+        LayersShapesMap::const_iterator layerShapesIt = layersShapes.find(lid);
+        CV_Assert(layerShapesIt != layersShapes.end());
+        blobManager.planBlobsForLayer(ld, layerShapesIt->second);
+    }
+
 #if 0
 #define printf_(args) printf args
 #else
@@ -1405,6 +1705,9 @@ struct Net::Impl
 
         CV_TRACE_FUNCTION();
 
+        // the passes which change the blobs binding are implemented for CPU only
+        const bool cpu = preferableBackend == DNN_BACKEND_DEFAULT && preferableTarget == DNN_TARGET_CPU;
+
         // scan through all the layers. If there is convolution layer followed by the activation layer,
         // we try to embed this activation into the convolution and disable separate execution of the activation
         std::set<LayerPin> pinsToKeep(blobsToKeep_.begin(),
@@ -1433,6 +1736,9 @@ struct Net::Impl
                 continue;
 
             Ptr<Layer>& currLayer = ld.layerInstance;
+            // the layer whose output blobs are written by the current one
+            LayerPin lpLast(lid, 0);
+            bool merged = false;
             if( ld.consumers.size() == 1 && pinsToKeep.count(LayerPin(lid, 0)) == 0 )
             {
                 LayerData* nextData = &layers[ld.consumers[0].lid];
@@ -1440,10 +1746,19 @@ struct Net::Impl
                 while (nextData)
                 {
                     Ptr<Layer> nextLayer = nextData->layerInstance;
-                    if (currLayer->tryFuse(nextLayer))
+                    // A merged convolution writes the output of the next one in its place,
+                    // so no other layer may be computed in between.
+                    const int pass = nextData->type == "Convolution" ? DNN_FUSION_POINTWISE : DNN_FUSION_ACTIVATION;
+                    if (pass == DNN_FUSION_POINTWISE &&
+                        (!cpu || lpNext.lid != lpLast.lid + 1 || pinsToKeep.count(lpLast) != 0))
+                        break;
+                    if ((fusionPasses & pass) && currLayer->tryFuse(nextLayer))
                     {
                         printf_(("\tfused with %s\n", nextLayer->name.c_str()));
                         nextData->skip = true;
+                        fusedLayers.push_back(std::make_pair(lpNext.lid, pass));
+                        merged = merged || pass == DNN_FUSION_POINTWISE;
+                        lpLast = lpNext;
                         ld.outputBlobs = layers[lpNext.lid].outputBlobs;
                         ld.outputBlobsWrappers = layers[lpNext.lid].outputBlobsWrappers;
                         if (nextData->consumers.size() == 1)
@@ -1482,11 +1797,14 @@ struct Net::Impl
                         nextActivLayer = nextData->layerInstance.dynamicCast<ActivationLayer>();
 
                     if( !nextActivLayer.empty() && pinsToKeep.count(lpNext) == 0
+                            && (fusionPasses & DNN_FUSION_ACTIVATION)
                             && currLayer->setActivation(nextActivLayer) )
                     {
                         LayerData *activData = nextData;
                         printf_(("\tfused with %s\n", nextActivLayer->name.c_str()));
                         activData->skip = true;
+                        fusedLayers.push_back(std::make_pair(lpNext.lid, (int)DNN_FUSION_ACTIVATION));
+                        lpLast = lpNext;
                         ld.outputBlobs = layers[lpNext.lid].outputBlobs;
                         ld.outputBlobsWrappers = layers[lpNext.lid].outputBlobsWrappers;
 
@@ -1508,7 +1826,8 @@ struct Net::Impl
                     if( nextData )
                         nextEltwiseLayer = nextData->layerInstance.dynamicCast<EltwiseLayer>();
 
-                    if( !nextEltwiseLayer.empty() && pinsToKeep.count(lpNext) == 0 )
+                    if( !nextEltwiseLayer.empty() && pinsToKeep.count(lpNext) == 0 &&
+                        (fusionPasses & DNN_FUSION_ACTIVATION) )
                     {
                         LayerData *eltwiseData = nextData;
                         // go down from the second input and find the first non-skipped layer.
@@ -1559,6 +1878,8 @@ struct Net::Impl
                                         printf_(("\tfused with %s\n", nextActivLayer->name.c_str()));
                                         eltwiseData->skip = true;
                                         nextData->skip = true;
+                                        fusedLayers.push_back(std::make_pair(eltwiseData->id, (int)DNN_FUSION_ACTIVATION));
+                                        fusedLayers.push_back(std::make_pair(nextData->id, (int)DNN_FUSION_ACTIVATION));
                                         // This optimization for cases like
                                         // some_layer   conv
                                         //   |             |
@@ -1605,6 +1926,17 @@ struct Net::Impl
                 }
             }
 
+            // A merged convolution or the one which reads the input of a folded padding layer
+            // may write over its input, which the memory was planned to outlive.
+            if( (merged || foldedPaddings.count(lid)) && ld.outputBlobs.size() == 1 &&
+                blobsOverlap(ld.outputBlobs[0], *ld.inputBlobs[0]) )
+            {
+                Mat& output = layers[lpLast.lid].outputBlobs[lpLast.oid];
+                output = Mat(shape(output), output.type());
+                ld.outputBlobs[0] = output;
+                printf_(("\treallocated output of %s\n", ld.name.c_str()));
+            }
+
             if (preferableBackend != DNN_BACKEND_DEFAULT)
                 continue;  // Go to the next layer.
 
@@ -1634,18 +1966,22 @@ struct Net::Impl
             // (and so we eliminate the concatenation layer, because the channels
             // are concatenated implicitly).
             Ptr<ConcatLayer> concatLayer = ld.layerInstance.dynamicCast<ConcatLayer>();
-            if( !concatLayer.empty() && concatLayer->axis == 1 && !concatLayer->padding &&
-                ld.outputBlobs.size() == 1 )
+            if( !concatLayer.empty() && !concatLayer->padding && ld.outputBlobs.size() == 1 &&
+                (fusionPasses & DNN_FUSION_CONCAT) )
             {
                 Mat& output = ld.outputBlobs[0];
+                const int axis = clamp(concatLayer->axis, output.dims);
 
                 // TODO: in general, this optimization can always be done, but
                 // many layers currently check that the input/output blobs are
                 // continuous arrays. Unfortunately, this is not true when
                 // the concatenation optimization is applied with batch_size > 1.
-                // so, for now, we only apply this optimization in the most popular
-                // case batch_size == 1.
-                if( output.dims == 4 && output.size[0] == 1 )
+                // so, for now, we only apply this optimization if all the dimensions
+                // before the axis are 1, as in the most popular case batch_size == 1.
+                // On CPU, it covers the flattened outputs concatenated by SSD and YOLO
+                // detection heads.
+                if( cpu ? total(shape(output), 0, axis) == 1 :
+                          output.dims == 4 && output.size[0] == 1 && axis == 1 )
                 {
                     size_t i, ninputs = ld.inputBlobsId.size();
                     std::vector<LayerPin> realinputs(ninputs);
@@ -1674,20 +2010,22 @@ struct Net::Impl
                         // Allocate new memory to prevent collisions during memory
                         // reusing (see https://github.com/opencv/opencv/pull/10456).
                         output = output.clone();
-                        Range chrange[] = { Range::all(), Range::all(), Range::all(), Range::all() };
+                        std::vector<Range> chrange(output.dims, Range::all());
                         int ofs = 0;
                         for( i = 0; i < ninputs; i++ )
                         {
                             LayerPin pin = realinputs[i];
                             LayerData* inp_i_data = &layers[pin.lid];
-                            int channels_i = ld.inputBlobs[i]->size[1];
-                            chrange[1] = Range(ofs, ofs + channels_i);
+                            int channels_i = ld.inputBlobs[i]->size[axis];
+                            chrange[axis] = Range(ofs, ofs + channels_i);
                             printf_(("\toutput %s(%d) to channels (%d, %d)\n", inp_i_data->layerInstance->name.c_str(),
                                    pin.oid, ofs, ofs + channels_i));
                             ofs += channels_i;
-                            Mat output_slice = output(chrange);
+                            Mat output_slice = output(&chrange[0]);
                             Mat& curr_output = inp_i_data->outputBlobs[pin.oid];
-                            CV_Assert(output_slice.isContinuous() && output_slice.size == curr_output.size);
+                            // the input may be a view of the real input's output with another shape
+                            CV_Assert(output_slice.isContinuous() && output_slice.total() == curr_output.total());
+                            output_slice = output_slice.reshape(1, shape(curr_output));
                             Mat* oldPtr = &curr_output;
                             curr_output = output_slice;
                             // Layers that refer old input Mat will refer to the
@@ -1695,13 +2033,62 @@ struct Net::Impl
                             CV_Assert(curr_output.data == output_slice.data, oldPtr == &curr_output);
                         }
                         ld.skip = true;
+                        fusedLayers.push_back(std::make_pair(lid, (int)DNN_FUSION_CONCAT));
                         printf_(("\toptimized out Concat layer %s\n", concatLayer->name.c_str()));
                     }
                 }
             }
+
+            if( !cpu )
+                continue;
+
+            // the optimization #4. the layers which only reinterpret the shape of their input
+            // computed in-place (Flatten, Reshape and Permute of the axes of size 1) are replaced
+            // by views of the input, so that they are not called and the concat layers
+            // following them are optimized out.
+            if( (fusionPasses & DNN_FUSION_VIEW) &&
+                (ld.type == "Flatten" || ld.type == "Reshape" || ld.type == "Permute") &&
+                ld.inputBlobs.size() == 1 && ld.outputBlobs.size() == 1 &&
+                ld.outputBlobs[0].data == ld.inputBlobs[0]->data )
+            {
+                Mat& output = ld.outputBlobs[0];
+                output = ld.inputBlobs[0]->reshape(1, shape(output));
+                ld.skip = true;
+                fusedLayers.push_back(std::make_pair(lid, (int)DNN_FUSION_VIEW));
+                printf_(("\treplaced %s by a view\n", ld.name.c_str()));
+                continue;
+            }
+
+            // the optimization #5. zero padding of the height and width is folded into
+            // the padding of the convolution which follows it. The convolution reads the input
+            // of the padding layer, so it has to be computed next.
+            Ptr<PaddingLayer> paddingLayer = ld.layerInstance.dynamicCast<PaddingLayer>();
+            int padTop, padBottom, padLeft, padRight;
+            if( !paddingLayer.empty() && (fusionPasses & DNN_FUSION_PADDING) &&
+                ld.consumers.size() == 1 && ld.consumers[0].lid == lid + 1 &&
+                pinsToKeep.count(LayerPin(lid, 0)) == 0 &&
+                layers[lid + 1].type == "Convolution" && !layers[lid + 1].skip &&
+                paddingLayer->getSpatialZeroPadding(padTop, padBottom, padLeft, padRight) )
+            {
+                LayerData& convData = layers[lid + 1];
+                Ptr<ConvolutionLayer> convLayer = convData.layerInstance.dynamicCast<ConvolutionLayer>();
+                CV_Assert(!convLayer.empty() && convData.inputBlobs.size() == 1);
+                // the bottom and right padding is implicit, as for asymmetric "SAME" padding
+                foldedPaddings[convData.id] = convLayer->pad;
+                convLayer->pad += Size(padLeft, padTop);
+                convData.inputBlobs[0] = ld.inputBlobs[0];
+                ld.skip = true;
+                fusedLayers.push_back(std::make_pair(lid, (int)DNN_FUSION_PADDING));
+                printf_(("\tfolded into %s\n", convData.name.c_str()));
+            }
         }
     }
 
+    static bool blobsOverlap(const Mat& a, const Mat& b)
+    {
+        return a.data < b.data + b.total()*b.elemSize() && b.data < a.data + a.total()*a.elemSize();
+    }
+
     void allocateLayers(const std::vector<LayerPin>& blobsToKeep_)
     {
         CV_TRACE_FUNCTION();
@@ -1736,6 +2123,17 @@ struct Net::Impl
             blobManager.addReference(blobsToKeep_[i]);
         }
 
+        // The plan is used for the blobs placement on CPU only, other targets
+        // wrap the allocated memory and keep reusing the blobs greedily.
+        bool useArena = !DNN_DISABLE_MEMORY_OPTIMIZATIONS &&
+                        preferableBackend == DNN_BACKEND_DEFAULT && preferableTarget == DNN_TARGET_CPU;
+        blobManager.beginPlanning();
+        for (it = layers.begin(); it != layers.end(); it++)
+            planLayer(it->first, layersShapes);
+        blobManager.endPlanning(useArena ? arena : Ptr<ActivationArena>());
+        for (it = layers.begin(); it != layers.end(); it++)
+            it->second.flag = 0;
+
         for (it = layers.begin(); it != layers.end(); it++)
         {
             int lid = it->first;
@@ -1744,6 +2142,271 @@ struct Net::Impl
 
         layersTimings.resize(lastLayerId + 1, 0);
         fuseLayers(blobsToKeep_);
+        negotiateLayouts(blobsToKeep_);
+    }
+
+    // A memory range written by a layer and the layers which read exactly this range
+    // with the same shape, the views of another shape read it partially.
+    struct LayoutRegion
+    {
+        LayoutRegion(const Mat& m, const LayerPin& writer_)
+            : data(m.data), size(m.total()*m.elemSize()), blobShape(shape(m)), writer(writer_), plain(false) {}
+
+        bool overlaps(const Mat& m) const
+        {
+            return m.data < data + size && data < m.data + m.total()*m.elemSize();
+        }
+
+        bool matches(const Mat& m) const
+        {
+            return m.data == data && m.total()*m.elemSize() == size && shape(m) == blobShape;
+        }
+
+        const uchar* data;
+        size_t size;
+        MatShape blobShape;
+        LayerPin writer;
+        std::vector<int> readers;
+        bool plain;  // read partially or by the user
+    };
+
+    static bool isBlockable(const Mat& m)
+    {
+        return m.dims == 4 && m.type() == CV_32F && m.isContinuous() && !m.empty() &&
+               m.size[1] % BLOCKED_CN == 0;
+    }
+
+    // A layer which does many operations per element of its blobs makes up for their
+    // conversions to and from the blocked layout on its own.
+    static bool isComputeBound(LayerData& ld)
+    {
+        enum { MIN_FLOPS_PER_ELEMENT = 128 };
+        std::vector<MatShape> inpShapes, outShapes;
+        int64 elements = 0;
+        for (size_t i = 0; i < ld.inputBlobs.size(); i++)
+        {
+            inpShapes.push_back(shape(*ld.inputBlobs[i]));
+            elements += ld.inputBlobs[i]->total();
+        }
+        for (size_t i = 0; i < ld.outputBlobs.size(); i++)
+        {
+            outShapes.push_back(shape(ld.outputBlobs[i]));
+            elements += ld.outputBlobs[i].total();
+        }
+        return ld.layerInstance->getFLOPS(inpShapes, outShapes) >= MIN_FLOPS_PER_ELEMENT * elements;
+    }
+
+    // Decides which layers process their blobs in the channel-blocked layout. Blobs are followed
+    // through the memory they occupy in the order of the forward pass, so the layers fused into
+    // their producers, in-place layers and concatenations written by their inputs directly need
+    // no special treatment. A blob stays blocked in memory if it is written and read only by
+    // the blocked layers and none of them accesses it partially. The other inputs and outputs of
+    // the blocked layers are converted; a blocked layer without blocked neighbours uses NCHW
+    // unless it is compute bound, like the convolutions left alone by the fusion.
+    void negotiateLayouts(const std::vector<LayerPin>& blobsToKeep_)
+    {
+        CV_TRACE_FUNCTION();
+
+        MapIdToLayerData::iterator it;
+        for (it = layers.begin(); it != layers.end(); it++)
+        {
+            LayerData& ld = it->second;
+            ld.blocked = false;
+            ld.blockedInputs.clear();
+            ld.blockedOutputs.clear();
+            ld.outputBlocked.assign(ld.outputBlobs.size(), false);
+            if (ld.id != 0 && !ld.layerInstance.empty())
+                ld.layerInstance->tryUseBlockedLayout(std::vector<Mat*>(), std::vector<Mat>());
+        }
+        if (!blockedLayout || preferableBackend != DNN_BACKEND_DEFAULT || preferableTarget != DNN_TARGET_CPU)
+            return;
+
+        for (it = layers.begin(); it != layers.end(); it++)
+        {
+            LayerData& ld = it->second;
+            if (ld.id == 0 || ld.skip || ld.outputBlobs.empty())
+                continue;
+            bool blockable = true;
+            for (size_t i = 0; i < ld.inputBlobs.size() && blockable; i++)
+                blockable = isBlockable(*ld.inputBlobs[i]);
+            for (size_t i = 0; i < ld.outputBlobs.size() && blockable; i++)
+                blockable = isBlockable(ld.outputBlobs[i]);
+            ld.blocked = blockable && ld.layerInstance->tryUseBlockedLayout(ld.inputBlobs, ld.outputBlobs);
+        }
+
+        std::vector<LayoutRegion> regions;
+        std::vector<int> live;
+        std::map<LayerPin, int> pinRegion;    // outputs of all the layers
+        std::map<LayerPin, int> inputRegion;  // (layer, input) of the computed layers, -1 for partial reads
+        for (it = layers.begin(); it != layers.end(); it++)
+        {
+            LayerData& ld = it->second;
+            const bool computed = ld.id == 0 || !ld.skip;
+            if (ld.id != 0 && computed)
+            {
+                for (size_t i = 0; i < ld.inputBlobs.size(); i++)
+                {
+                    int r = findRegion(regions, live, *ld.inputBlobs[i]);
+                    if (r >= 0)
+                        regions[r].readers.push_back(ld.id);
+                    inputRegion[LayerPin(ld.id, (int)i)] = r;
+                }
+            }
+            for (size_t i = 0; i < ld.outputBlobs.size(); i++)
+            {
+                const Mat& m = ld.outputBlobs[i];
+                LayerPin pin(ld.id, (int)i);
+                if (!computed)
+                {
+                    // computed by the layer this one is fused into
+                    pinRegion[pin] = findRegion(regions, live, m);
+                    continue;
+                }
+                for (size_t j = 0; j < live.size(); )
+                {
+                    if (regions[live[j]].overlaps(m))
+                        live.erase(live.begin() + j);
+                    else
+                        j++;
+                }
+                pinRegion[pin] = (int)regions.size();
+                live.push_back((int)regions.size());
+                regions.push_back(LayoutRegion(m, pin));
+            }
+        }
+
+        // Outputs of the network and the kept blobs are read by the user.
+        std::set<LayerPin> userPins(blobsToKeep_.begin(), blobsToKeep_.end());
+        for (it = layers.begin(); it != layers.end(); it++)
+        {
+            if (it->second.consumers.empty())
+                for (size_t i = 0; i < it->second.outputBlobs.size(); i++)
+                    userPins.insert(LayerPin(it->first, (int)i));
+        }
+        for (std::set<LayerPin>::iterator pin = userPins.begin(); pin != userPins.end(); ++pin)
+        {
+            std::map<LayerPin, int>::iterator r = pinRegion.find(*pin);
+            if (r != pinRegion.end() && r->second >= 0)
+                regions[r->second].plain = true;
+        }
+
+        std::vector<bool> regionBlocked(regions.size());
+        for (bool changed = true; changed; )
+        {
+            for (size_t r = 0; r < regions.size(); r++)
+            {
+                const LayoutRegion& region = regions[r];
+                bool blocked = !region.plain && layers[region.writer.lid].blocked;
+                for (size_t i = 0; i < region.readers.size() && blocked; i++)
+                    blocked = layers[region.readers[i]].blocked;
+                regionBlocked[r] = blocked;
+            }
+
+            changed = false;
+            for (it = layers.begin(); it != layers.end(); it++)
+            {
+                LayerData& ld = it->second;
+                if (!ld.blocked)
+                    continue;
+                bool neighbours = false;
+                for (size_t i = 0; i < ld.inputBlobs.size() && !neighbours; i++)
+                {
+                    int r = inputRegion[LayerPin(ld.id, (int)i)];
+                    neighbours = r >= 0 && regionBlocked[r];
+                }
+                for (size_t i = 0; i < ld.outputBlobs.size() && !neighbours; i++)
+                {
+                    int r = pinRegion[LayerPin(ld.id, (int)i)];
+                    neighbours = regionBlocked[r] && !regions[r].readers.empty();
+                }
+                if (!neighbours && !isComputeBound(ld))
+                {
+                    ld.blocked = false;
+                    ld.layerInstance->tryUseBlockedLayout(std::vector<Mat*>(), std::vector<Mat>());
+                    changed = true;
+                }
+            }
+        }
+
+        for (it = layers.begin(); it != layers.end(); it++)
+        {
+            LayerData& ld = it->second;
+            for (size_t i = 0; i < ld.outputBlobs.size(); i++)
+            {
+                int r = pinRegion[LayerPin(ld.id, (int)i)];
+                ld.outputBlocked[i] = r >= 0 && regionBlocked[r];
+            }
+            if (!ld.blocked)
+                continue;
+            ld.blockedInputs.resize(ld.inputBlobs.size());
+            for (size_t i = 0; i < ld.inputBlobs.size(); i++)
+            {
+                int r = inputRegion[LayerPin(ld.id, (int)i)];
+                if (r < 0 || !regionBlocked[r])
+                    ld.blockedInputs[i].create(shape(*ld.inputBlobs[i]), CV_32F);
+            }
+            ld.blockedOutputs.resize(ld.outputBlobs.size());
+            for (size_t i = 0; i < ld.outputBlobs.size(); i++)
+            {
+                if (!ld.outputBlocked[i])
+                    ld.blockedOutputs[i].create(shape(ld.outputBlobs[i]), CV_32F);
+            }
+        }
+    }
+
+    // Returns the live region which is exactly the memory of m, or -1 and marks all
+    // the overlapping regions as plain ones.
+    static int findRegion(std::vector<LayoutRegion>& regions, const std::vector<int>& live, const Mat& m)
+    {
+        std::vector<int> overlapping;
+        for (size_t j = 0; j < live.size(); j++)
+        {
+            if (regions[live[j]].overlaps(m))
+                overlapping.push_back(live[j]);
+        }
+        if (overlapping.size() == 1 && regions[overlapping[0]].matches(m))
+            return overlapping[0];
+        for (size_t j = 0; j < overlapping.size(); j++)
+            regions[overlapping[j]].plain = true;
+        return -1;
+    }
+
+    void forwardBlocked(LayerData &ld)
+    {
+        std::vector<Mat*> inputs(ld.inputBlobs);
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            if (!ld.blockedInputs[i].empty())
+            {
+                toBlockedLayout(*inputs[i], ld.blockedInputs[i]);
+                inputs[i] = &ld.blockedInputs[i];
+            }
+        }
+        std::vector<Mat> outputs(ld.outputBlobs);
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            if (!ld.blockedOutputs[i].empty())
+                outputs[i] = ld.blockedOutputs[i];
+        }
+
+        ld.layerInstance->forward(inputs, outputs, ld.internals);
+
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            if (!ld.blockedOutputs[i].empty())
+                fromBlockedLayout(ld.blockedOutputs[i], ld.outputBlobs[i]);
+        }
+    }
+
+    void updateInputRanges(LayerData &ld)
+    {
+        ld.inputRanges.resize(ld.inputBlobs.size(), 0.f);
+        for (size_t i = 0; i < ld.inputBlobs.size(); i++)
+        {
+            const Mat& inp = *ld.inputBlobs[i];
+            if (inp.type() == CV_32F)
+                ld.inputRanges[i] = std::max(ld.inputRanges[i], (float)norm(inp, NORM_INF));
+        }
     }
 
     void forwardLayer(LayerData &ld)
@@ -1776,7 +2439,13 @@ struct Net::Impl
                             ld.inputBlobsWrappers[i]->copyToHost();
                     }
 
-                    layer->forward(ld.inputBlobs, ld.outputBlobs, ld.internals);
+                    if (calibrating)
+                        updateInputRanges(ld);
+
+                    if (ld.blocked)
+                        forwardBlocked(ld);
+                    else
+                        layer->forward(ld.inputBlobs, ld.outputBlobs, ld.internals);
 
                     for (int i = 0, n = ld.outputBlobsWrappers.size(); i < n; ++i)
                     {
@@ -1925,6 +2594,12 @@ struct Net::Impl
             // Transfer data to CPU if it's require.
             ld.outputBlobsWrappers[pin.oid]->copyToHost();
         }
+        if ((size_t)pin.oid < ld.outputBlocked.size() && ld.outputBlocked[pin.oid])
+        {
+            Mat blob;
+            fromBlockedLayout(ld.outputBlobs[pin.oid], blob);
+            return blob;
+        }
         return ld.outputBlobs[pin.oid];
     }
 
@@ -2068,7 +2743,7 @@ void Net::forward(OutputArrayOfArrays outputBlobs, const String& outputName)
 
     if (outputBlobs.isUMat())
     {
-        outputBlobs.assign(ld.outputBlobs[pin.oid].getUMat(ACCESS_RW));
+        outputBlobs.assign(impl->getBlob(pin).getUMat(ACCESS_RW));
     }
     else if (outputBlobs.isMat())
     {
@@ -2076,16 +2751,10 @@ void Net::forward(OutputArrayOfArrays outputBlobs, const String& outputName)
     }
     else if (outputBlobs.isMatVector())
     {
-        if (impl->preferableTarget != DNN_TARGET_CPU)
-        {
-            for (int i = 0; i < ld.outputBlobsWrappers.size(); ++i)
-            {
-                CV_Assert(!ld.outputBlobsWrappers[i].empty());
-                ld.outputBlobsWrappers[i]->copyToHost();
-            }
-        }
         std::vector<Mat> & outputvec = *(std::vector<Mat> *)outputBlobs.getObj();
-        outputvec = ld.outputBlobs;
+        outputvec.resize(ld.outputBlobs.size());
+        for (int i = 0; i < outputvec.size(); ++i)
+            outputvec[i] = impl->getBlob(LayerPin(pin.lid, i));
     }
     else if (outputBlobs.isUMatVector())
     {
@@ -2100,7 +2769,7 @@ void Net::forward(OutputArrayOfArrays outputBlobs, const String& outputName)
         {
             outputvec.resize(ld.outputBlobs.size());
             for (int i = 0; i < outputvec.size(); ++i)
-                outputvec[i] = ld.outputBlobs[i].getUMat(ACCESS_RW);
+                outputvec[i] = impl->getBlob(LayerPin(pin.lid, i)).getUMat(ACCESS_RW);
         }
     }
 }
@@ -2551,6 +3220,102 @@ void Net::enableFusion(bool fusion)
     }
 }
 
+void Net::setFusionPasses(int passes)
+{
+    CV_Assert((passes & ~DNN_FUSION_ALL) == 0);
+    if( impl->fusionPasses != passes )
+    {
+        impl->fusionPasses = passes;
+        impl->netWasAllocated = false;
+        impl->clear();
+    }
+}
+
+void Net::getFusedLayers(std::vector<String>& layerNames, std::vector<int>& passes) const
+{
+    layerNames.clear();
+    passes.clear();
+    for (size_t i = 0; i < impl->fusedLayers.size(); i++)
+    {
+        layerNames.push_back(impl->getLayerData(impl->fusedLayers[i].first).name);
+        passes.push_back(impl->fusedLayers[i].second);
+    }
+}
+
+void Net::enableBlockedLayout(bool blockedLayout)
+{
+    if( impl->blockedLayout != blockedLayout )
+    {
+        impl->blockedLayout = blockedLayout;
+        impl->netWasAllocated = false;
+        impl->clear();
+    }
+}
+
+int Net::quantize(InputArrayOfArrays calibData)
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> samples;
+    calibData.getMatVector(samples);
+    CV_Assert(!samples.empty());
+
+    // the ranges are collected in floating point
+    Impl::MapIdToLayerData::iterator it;
+    for (it = impl->layers.begin(); it != impl->layers.end(); it++)
+    {
+        it->second.inputRanges.clear();
+        if (!it->second.layerInstance.empty())
+            it->second.layerInstance->tryQuantize(std::vector<float>());
+    }
+    impl->netWasAllocated = false;
+    impl->clear();
+
+    impl->calibrating = true;
+    try
+    {
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            setInput(samples[i]);
+            forward();
+        }
+    }
+    catch (...)
+    {
+        impl->calibrating = false;
+        throw;
+    }
+    impl->calibrating = false;
+
+    int quantized = 0;
+    for (it = impl->layers.begin(); it != impl->layers.end(); it++)
+    {
+        LayerData& ld = it->second;
+        if (!ld.inputRanges.empty() && ld.layerInstance->tryQuantize(ld.inputRanges))
+            quantized++;
+    }
+    impl->netWasAllocated = false;
+    impl->clear();
+    return quantized;
+}
+
+void Net::getActivationMemory(size_t& allocated, size_t& peak) const
+{
+    CV_TRACE_FUNCTION();
+    impl->blobManager.getActivationMemory(allocated, peak);
+}
+
+void Net::shareActivationArena(Net& other)
+{
+    CV_TRACE_FUNCTION();
+    if (impl->arena != other.impl->arena)
+    {
+        impl->arena = other.impl->arena;
+        impl->netWasAllocated = false;
+        impl->clear();
+    }
+}
+
 void Net::setHalideScheduler(const String& scheduler)
 {
     CV_TRACE_FUNCTION();
@@ -2688,6 +3453,8 @@ Ptr<BackendNode> Layer::tryAttach(const Ptr<BackendNode>& node)
 
 bool Layer::setActivation(const Ptr<ActivationLayer>&) { return false; }
 bool Layer::tryFuse(Ptr<Layer>&) { return false; }
+bool Layer::tryQuantize(const std::vector<float>&) { return false; }
+bool Layer::tryUseBlockedLayout(const std::vector<Mat*>&, const std::vector<Mat>&) { return false; }
 void Layer::getScaleShift(Mat& scale, Mat& shift) const
 {
     scale = Mat();
@@ -12,6 +12,8 @@ Implementation of Batch Normalization layer.
 #include "../precomp.hpp"
 #include "../op_halide.hpp"
 #include "../op_inf_engine.hpp"
+#include "layers_common.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <opencv2/dnn/shape_utils.hpp>
 
 #ifdef HAVE_OPENCL
@@ -29,7 +31,9 @@ public:
     Mat weights_, bias_;
     UMat umat_weight, umat_bias;
 
-    BatchNormLayerImpl(const LayerParams& params)
+    bool blockedLayout;
+
+    BatchNormLayerImpl(const LayerParams& params) : blockedLayout(false)
     {
         setParamsFrom(params);
         CV_Assert(blobs.size() >= 2);
@@ -107,6 +111,12 @@ public:
         return true;
     }
 
+    virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs) CV_OVERRIDE
+    {
+        blockedLayout = !inputs.empty();
+        return blockedLayout;
+    }
+
     virtual bool supportBackend(int backendId) CV_OVERRIDE
     {
         return backendId == DNN_BACKEND_DEFAULT ||
@@ -201,6 +211,13 @@ public:
         int rows = inpBlob.dims > 2 ? inpBlob.size[2] : 1;
         int cols = inpBlob.dims > 2 ? inpBlob.size[3] : 1;
 
+        if (blockedLayout)
+        {
+            for (size_t ii = 0; ii < outputs.size(); ii++)
+                forwardBlocked(inpBlob, outputs[ii]);
+            return;
+        }
+
         for (size_t ii = 0; ii < outputs.size(); ii++)
         {
             Mat &outBlob = outputs[ii];
@@ -219,6 +236,39 @@ public:
         }
     }
 
+    // Every pixel of a channel block is a vector of BLOCKED_CN channels, scaled and shifted at once.
+    void forwardBlocked(const Mat& inpBlob, Mat& outBlob) const
+    {
+        CV_Assert(inpBlob.dims == 4, inpBlob.size[1] % BLOCKED_CN == 0,
+                  inpBlob.isContinuous(), outBlob.isContinuous(), inpBlob.total() == outBlob.total());
+        const int channels = inpBlob.size[1], planeSize = inpBlob.size[2]*inpBlob.size[3];
+        const int nblocks = inpBlob.size[0]*channels/BLOCKED_CN;
+        const float* wdata = weights_.ptr<float>();
+        const float* bdata = bias_.ptr<float>();
+
+        for (int b = 0; b < nblocks; b++)
+        {
+            const int c0 = (b*BLOCKED_CN) % channels;
+            const float* w = wdata + c0;
+            const float* bias = bdata + c0;
+            const float* inptr = inpBlob.ptr<float>() + (size_t)b*planeSize*BLOCKED_CN;
+            float* outptr = outBlob.ptr<float>() + (size_t)b*planeSize*BLOCKED_CN;
+#if CV_SIMD128
+            v_float32x4 w0 = v_load(w), w1 = v_load(w + 4);
+            v_float32x4 b0 = v_load(bias), b1 = v_load(bias + 4);
+            for (int i = 0; i < planeSize; i++, inptr += BLOCKED_CN, outptr += BLOCKED_CN)
+            {
+                v_store(outptr, v_muladd(v_load(inptr), w0, b0));
+                v_store(outptr + 4, v_muladd(v_load(inptr + 4), w1, b1));
+            }
+#else
+            for (int i = 0; i < planeSize; i++, inptr += BLOCKED_CN, outptr += BLOCKED_CN)
+                for (int l = 0; l < BLOCKED_CN; l++)
+                    outptr[l] = inptr[l]*w[l] + bias[l];
+#endif
+        }
+    }
+
     virtual Ptr<BackendNode> tryAttach(const Ptr<BackendNode>& node) CV_OVERRIDE
     {
         switch (node->backendId)
@@ -168,8 +168,17 @@ public:
 class ConvolutionLayerImpl CV_FINAL : public BaseConvolutionLayerImpl
 {
 public:
-    enum { VEC_ALIGN = 8, DFT_TYPE = CV_32F };
+    enum { VEC_ALIGN = 8, DFT_TYPE = CV_32F, WINOGRAD_MIN_CN = 8, WINOGRAD_MIN_TILES = 32 };
     Mat weightsMat, weightsMat_doubles;
+    Mat winogradWeights;
+    bool useWinograd;
+    int numGroups;
+    // int8 computations, see tryQuantize()
+    float inputRange;
+    Mat int8Weights, int8Input;
+    std::vector<float> int8Scales;
+    // channel-blocked layout, see tryUseBlockedLayout()
+    Mat blockedWeights, blockedInput;
     std::vector<float> biasvec;
     std::vector<float> reluslope;
     Ptr<ActivationLayer> activ;
@@ -187,6 +196,9 @@ public:
     {
         newWeightAndBias = false;
         fusedBias = false;
+        useWinograd = params.get<bool>("use_winograd", true);
+        numGroups = 1;
+        inputRange = 0.f;
 #ifdef HAVE_OPENCL
         newActiv = false;
         activType = OCL4DNN_CONV_FUSED_ACTIV_NONE;
@@ -261,6 +273,14 @@ public:
         weightsMat = wm;
         weightsMat.convertTo(weightsMat_doubles, CV_64F);
 
+        const int inpCn = inputs[0]->size[1];
+        numGroups = inpCn / blobs[0].size[1];
+        winogradWeights.release();
+        if (inputRange == 0.f &&
+            canUseWinograd(inpCn, outCn, inpCn / blobs[0].size[1], outputs[0].size[2], outputs[0].size[3]))
+            WinogradConv::transformWeights(weightsMat, inpCn, winogradWeights);
+        quantizeWeights();
+
         Mat biasMat = hasBias() ? blobs[1].reshape(1, outCn) : Mat();
         biasvec.resize(outCn+2);
         if( biasMat.empty() )
@@ -278,6 +298,56 @@ public:
 #endif
     }
 
+    // 3x3 convolutions are computed by the Winograd algorithm unless there are
+    // too few channels to make up for the transforms or too few output tiles
+    // to make up for the transformed weights, which are 4 times larger.
+    bool canUseWinograd(int inpCn, int outCn, int ngroups, int outH, int outW) const
+    {
+        const int ntiles = ((outH + 3) / 4) * ((outW + 3) / 4);
+        return useWinograd && ngroups == 1 &&
+               kernel == Size(3, 3) && stride == Size(1, 1) && dilation == Size(1, 1) &&
+               inpCn >= WINOGRAD_MIN_CN && outCn >= WINOGRAD_MIN_CN && ntiles >= WINOGRAD_MIN_TILES;
+    }
+
+    virtual bool tryQuantize(const std::vector<float>& inputRanges) CV_OVERRIDE
+    {
+        inputRange = inputRanges.size() == 1 ? inputRanges[0] : 0.f;
+        int8Weights.release();
+        int8Input.release();
+        return inputRange > 0.f;
+    }
+
+    // The blocked convolution covers the regular single-group convolutions on AVX2; the Winograd
+    // and int8 paths are faster where they apply, so such layers keep NCHW.
+    virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs) CV_OVERRIDE
+    {
+        blockedWeights.release();
+        blockedInput.release();
+        if (inputs.empty() || inputs[0]->size[1] != blobs[0].size[1] ||
+            !winogradWeights.empty() || !int8Weights.empty())
+            return false;
+#if CV_TRY_AVX2
+        if (!checkHardwareSupport(CPU_AVX2))
+            return false;
+        BlockedConv::packWeights(weightsMat, inputs[0]->size[1], kernel, blockedWeights);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // int8Scales are products of the input and weights scales per output channel.
+    void quantizeWeights()
+    {
+        int8Weights.release();
+        if (inputRange > 0.f)
+        {
+            quantizeWeightsInt8(weightsMat, int8Weights, int8Scales, QuantizedConv::K_ALIGN);
+            for (size_t i = 0; i < int8Scales.size(); i++)
+                int8Scales[i] *= inputRange / 127;
+        }
+    }
+
     bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE
     {
         activ = layer;
@@ -314,6 +384,10 @@ public:
 
     virtual bool tryFuse(Ptr<Layer>& top) CV_OVERRIDE
     {
+        Ptr<ConvolutionLayerImpl> conv = top.dynamicCast<ConvolutionLayerImpl>();
+        if (!conv.empty())
+            return tryMerge(*conv);
+
         Mat w, b;
         top->getScaleShift(w, b);
         if (!w.empty() || !b.empty())
@@ -324,6 +398,46 @@ public:
         return false;
     }
 
+    // A single-group 1x1 convolution which follows this one is merged into it as
+    // conv2(conv1(I)) = (W2*W1)(I) + (W2*b1 + b2) if it takes no more operations.
+    // The layer blobs keep the original weights, so finalize() resets the merge.
+    bool tryMerge(const ConvolutionLayerImpl& top)
+    {
+        const int inpCn = blobs[0].size[1], midCn = weightsMat.rows, outCn = top.weightsMat.rows;
+        if (preferableTarget != DNN_TARGET_CPU || !activ.empty() || numGroups != 1 ||
+            !top.is1x1() || top.pad != Size(0, 0) || !top.activ.empty() || top.numGroups != 1 ||
+            (int64)kernel.area()*inpCn*outCn > (int64)kernel.area()*inpCn*midCn + (int64)midCn*outCn)
+            return false;
+
+        const int ksize = inpCn * kernel.area();
+        Mat b1(midCn, 1, CV_64F), b2(outCn, 1, CV_64F);
+        for (int i = 0; i < midCn; i++)
+            b1.at<double>(i) = biasvec[i];
+        for (int i = 0; i < outCn; i++)
+            b2.at<double>(i) = top.biasvec[i];
+        Mat w2 = top.weightsMat_doubles.colRange(0, midCn);
+
+        Mat wm(outCn, (int)alignSize(ksize, VEC_ALIGN), CV_32F, Scalar::all(0));
+        weightsMat_doubles = w2 * weightsMat_doubles.colRange(0, ksize);
+        weightsMat = wm.colRange(0, ksize);
+        weightsMat_doubles.convertTo(weightsMat, CV_32F);
+        b2 += w2 * b1;
+
+        biasvec.resize(outCn + 2);
+        for (int i = 0; i < outCn; i++)
+            biasvec[i] = (float)b2.at<double>(i);
+        biasvec[outCn] = biasvec[outCn+1] = biasvec[outCn-1];
+        fusedBias = true;
+        newWeightAndBias = true;
+
+        if (!winogradWeights.empty())
+            WinogradConv::transformWeights(weightsMat, inpCn, winogradWeights);
+        if (!int8Weights.empty())
+            quantizeWeights();
+        blockedWeights.release();
+        return true;
+    }
+
     void fuseWeights(const Mat& w, const Mat& b)
     {
         // Convolution weights have OIHW data layout. Parameters fusion in case of
@@ -342,6 +456,12 @@ public:
                 biasvec[i] *= wi;
             }
             weightsMat_doubles.convertTo(weightsMat, weightsMat.type());
+            if (!winogradWeights.empty())
+                WinogradConv::transformWeights(weightsMat, weightsMat.cols / 9, winogradWeights);
+            if (!int8Weights.empty())
+                quantizeWeights();
+            if (!blockedWeights.empty())
+                BlockedConv::packWeights(weightsMat, weightsMat.cols / kernel.area(), kernel, blockedWeights);
         }
 
         if (!b.empty())
@@ -834,6 +954,951 @@ public:
         }
     };
 
+    // Depthwise convolution (a group per channel) computed directly on the input: an output row is
+    // the weighted sum of kernel.area() shifted input rows. The pixels whose receptive field lies
+    // inside the input are vectorized for the strides 1 and 2; the others are computed one by one
+    // skipping the padding. Bias, ReLU and ReLU6 are applied before the row is stored.
+    class DepthwiseConv : public cv::ParallelLoopBody
+    {
+    public:
+        const Mat* input_;
+        const Mat* weights_;
+        Mat* output_;
+        const std::vector<float>* biasvec_;
+        const std::vector<float>* reluslope_;
+        const ActivationLayer* activ_;
+        Size kernel_, pad_, stride_, dilation_;
+        float minval_, maxval_;
+
+        DepthwiseConv()
+            : input_(0), weights_(0), output_(0), biasvec_(0), reluslope_(0), activ_(0),
+              minval_(-FLT_MAX), maxval_(FLT_MAX)
+        {}
+
+        static void run( const Mat& input, Mat& output, const Mat& weights,
+                         const std::vector<float>& biasvec,
+                         const std::vector<float>& reluslope,
+                         Size kernel, Size pad, Size stride, Size dilation,
+                         const ActivationLayer* activ, int nstripes )
+        {
+            CV_Assert( input.dims == 4 && output.dims == 4,
+                       input.size[0] == output.size[0],
+                       input.size[1] == output.size[1] && weights.rows == output.size[1],
+                       weights.cols == kernel.area(),
+                       input.type() == CV_32F && output.type() == CV_32F && weights.type() == CV_32F,
+                       input.isContinuous(), output.isContinuous(),
+                       biasvec.size() == (size_t)output.size[1]+2 );
+            DepthwiseConv p;
+
+            p.input_ = &input;
+            p.weights_ = &weights;
+            p.output_ = &output;
+            p.biasvec_ = &biasvec;
+            p.reluslope_ = &reluslope;
+            p.kernel_ = kernel; p.pad_ = pad; p.stride_ = stride; p.dilation_ = dilation;
+            const ReLU6Layer* relu6 = dynamic_cast<const ReLU6Layer*>(activ);
+            if( relu6 )
+            {
+                p.minval_ = relu6->minValue;
+                p.maxval_ = relu6->maxValue;
+            }
+            else
+                p.activ_ = reluslope.empty() ? activ : 0;
+
+            parallel_for_(Range(0, (int)output.total(0, 3)), p, nstripes);
+        }
+
+        virtual void operator ()(const Range &r) const CV_OVERRIDE
+        {
+            const int channels = input_->size[1], height = input_->size[2], width = input_->size[3];
+            const int outH = output_->size[2], outW = output_->size[3];
+            const int kernel_w = kernel_.width, kernel_h = kernel_.height;
+            const int pad_w = pad_.width, pad_h = pad_.height;
+            const int stride_w = stride_.width, stride_h = stride_.height;
+            const int dilation_w = dilation_.width, dilation_h = dilation_.height;
+            const size_t outPlaneSize = (size_t)outH*outW;
+            const float minval = minval_, maxval = maxval_;
+
+            // the output pixels [x0, x1) read no padding
+            const int x0 = std::min(outW, (pad_w + stride_w - 1)/stride_w);
+            const int xlast = width - 1 - (kernel_w - 1)*dilation_w + pad_w;
+            const int x1 = xlast < 0 ? x0 : std::max(x0, std::min(outW, xlast/stride_w + 1));
+
+            // the padding rows are read from a row of zeros
+            AutoBuffer<const float*> rowptr_(kernel_h);
+            AutoBuffer<float> zeros_(width);
+            const float** rowptr = rowptr_;
+            float* zeros = zeros_;
+            memset(zeros, 0, width*sizeof(zeros[0]));
+
+            for( int row = r.start; row < r.end; row++ )
+            {
+                const int y = row % outH, plane = row / outH, c = plane % channels;
+                const float* inptr = input_->ptr<float>() + (size_t)plane*height*width;
+                float* outptr = output_->ptr<float>() + (size_t)row*outW;
+                const float* wptr = weights_->ptr<float>(c);
+                const float bias = biasvec_->at(c);
+                const bool relu = !reluslope_->empty();
+                const float slope = relu ? reluslope_->at(c) : 1.f;
+
+                for( int ky = 0; ky < kernel_h; ky++ )
+                {
+                    const int iy = y*stride_h - pad_h + ky*dilation_h;
+                    rowptr[ky] = 0 <= iy && iy < height ? inptr + (size_t)iy*width : zeros;
+                }
+
+                int x = 0;
+                for( ; x < outW; x++ )
+                {
+                    if( x == x0 )
+                    {
+                        x = x1;
+                        if( x >= outW )
+                            break;
+                    }
+                    const int ix0 = x*stride_w - pad_w;
+                    int kx0 = 0, kx1 = kernel_w;
+                    while( kx0 < kx1 && ix0 + kx0*dilation_w < 0 )
+                        kx0++;
+                    while( kx1 > kx0 && ix0 + (kx1 - 1)*dilation_w >= width )
+                        kx1--;
+                    float s = bias;
+                    for( int ky = 0; ky < kernel_h; ky++ )
+                        for( int kx = kx0; kx < kx1; kx++ )
+                            s += rowptr[ky][ix0 + kx*dilation_w]*wptr[ky*kernel_w + kx];
+                    if( relu && s < 0.f )
+                        s *= slope;
+                    outptr[x] = std::min(std::max(s, minval), maxval);
+                }
+
+                x = x0;
+#if CV_SIMD128
+                if( stride_w == 1 || stride_w == 2 )
+                {
+                    const v_float32x4 vbias = v_setall_f32(bias), vslope = v_setall_f32(slope);
+                    const v_float32x4 vmin = v_setall_f32(minval), vmax = v_setall_f32(maxval);
+                    const v_float32x4 z = v_setzero_f32();
+                    // with the stride 2 the last vector reads one value beyond the last pixel
+                    const int x1v = x1 - (stride_w - 1);
+                    if( kernel_w == 3 && kernel_h == 3 )
+                    {
+                        const v_float32x4 w00 = v_setall_f32(wptr[0]), w01 = v_setall_f32(wptr[1]), w02 = v_setall_f32(wptr[2]);
+                        const v_float32x4 w10 = v_setall_f32(wptr[3]), w11 = v_setall_f32(wptr[4]), w12 = v_setall_f32(wptr[5]);
+                        const v_float32x4 w20 = v_setall_f32(wptr[6]), w21 = v_setall_f32(wptr[7]), w22 = v_setall_f32(wptr[8]);
+                        const int dw = dilation_w;
+                        for( ; x + 8 <= x1v; x += 8 )
+                        {
+                            const float* r0 = rowptr[0] + x*stride_w - pad_w;
+                            const float* r1 = rowptr[1] + x*stride_w - pad_w;
+                            const float* r2 = rowptr[2] + x*stride_w - pad_w;
+                            v_float32x4 s0 = vbias, s1 = vbias, t0, t1, t2, u0, u1, u2, d;
+                            if( stride_w == 1 )
+                            {
+                                s0 = v_muladd(v_load(r0), w00, s0); s1 = v_muladd(v_load(r0 + 4), w00, s1);
+                                s0 = v_muladd(v_load(r0 + dw), w01, s0); s1 = v_muladd(v_load(r0 + dw + 4), w01, s1);
+                                s0 = v_muladd(v_load(r0 + dw*2), w02, s0); s1 = v_muladd(v_load(r0 + dw*2 + 4), w02, s1);
+                                s0 = v_muladd(v_load(r1), w10, s0); s1 = v_muladd(v_load(r1 + 4), w10, s1);
+                                s0 = v_muladd(v_load(r1 + dw), w11, s0); s1 = v_muladd(v_load(r1 + dw + 4), w11, s1);
+                                s0 = v_muladd(v_load(r1 + dw*2), w12, s0); s1 = v_muladd(v_load(r1 + dw*2 + 4), w12, s1);
+                                s0 = v_muladd(v_load(r2), w20, s0); s1 = v_muladd(v_load(r2 + 4), w20, s1);
+                                s0 = v_muladd(v_load(r2 + dw), w21, s0); s1 = v_muladd(v_load(r2 + dw + 4), w21, s1);
+                                s0 = v_muladd(v_load(r2 + dw*2), w22, s0); s1 = v_muladd(v_load(r2 + dw*2 + 4), w22, s1);
+                            }
+                            else
+                            {
+                                v_load_deinterleave(r0, t0, d); v_load_deinterleave(r0 + 8, u0, d);
+                                v_load_deinterleave(r0 + dw, t1, d); v_load_deinterleave(r0 + dw + 8, u1, d);
+                                v_load_deinterleave(r0 + dw*2, t2, d); v_load_deinterleave(r0 + dw*2 + 8, u2, d);
+                                s0 = v_muladd(t0, w00, s0); s1 = v_muladd(u0, w00, s1);
+                                s0 = v_muladd(t1, w01, s0); s1 = v_muladd(u1, w01, s1);
+                                s0 = v_muladd(t2, w02, s0); s1 = v_muladd(u2, w02, s1);
+                                v_load_deinterleave(r1, t0, d); v_load_deinterleave(r1 + 8, u0, d);
+                                v_load_deinterleave(r1 + dw, t1, d); v_load_deinterleave(r1 + dw + 8, u1, d);
+                                v_load_deinterleave(r1 + dw*2, t2, d); v_load_deinterleave(r1 + dw*2 + 8, u2, d);
+                                s0 = v_muladd(t0, w10, s0); s1 = v_muladd(u0, w10, s1);
+                                s0 = v_muladd(t1, w11, s0); s1 = v_muladd(u1, w11, s1);
+                                s0 = v_muladd(t2, w12, s0); s1 = v_muladd(u2, w12, s1);
+                                v_load_deinterleave(r2, t0, d); v_load_deinterleave(r2 + 8, u0, d);
+                                v_load_deinterleave(r2 + dw, t1, d); v_load_deinterleave(r2 + dw + 8, u1, d);
+                                v_load_deinterleave(r2 + dw*2, t2, d); v_load_deinterleave(r2 + dw*2 + 8, u2, d);
+                                s0 = v_muladd(t0, w20, s0); s1 = v_muladd(u0, w20, s1);
+                                s0 = v_muladd(t1, w21, s0); s1 = v_muladd(u1, w21, s1);
+                                s0 = v_muladd(t2, w22, s0); s1 = v_muladd(u2, w22, s1);
+                            }
+                            if( relu )
+                            {
+                                s0 = v_select(s0 > z, s0, s0*vslope);
+                                s1 = v_select(s1 > z, s1, s1*vslope);
+                            }
+                            v_store(outptr + x, v_min(v_max(s0, vmin), vmax));
+                            v_store(outptr + x + 4, v_min(v_max(s1, vmin), vmax));
+                        }
+                    }
+                    for( ; x + 8 <= x1v; x += 8 )
+                    {
+                        v_float32x4 s0 = vbias, s1 = vbias;
+                        for( int ky = 0; ky < kernel_h; ky++ )
+                        {
+                            const float* inp = rowptr[ky] + x*stride_w - pad_w;
+                            const float* w = wptr + ky*kernel_w;
+                            for( int kx = 0; kx < kernel_w; kx++ )
+                            {
+                                const v_float32x4 wv = v_setall_f32(w[kx]);
+                                v_float32x4 v0, v1, d;
+                                if( stride_w == 1 )
+                                {
+                                    v0 = v_load(inp + kx*dilation_w);
+                                    v1 = v_load(inp + kx*dilation_w + 4);
+                                }
+                                else
+                                {
+                                    v_load_deinterleave(inp + kx*dilation_w, v0, d);
+                                    v_load_deinterleave(inp + kx*dilation_w + 8, v1, d);
+                                }
+                                s0 = v_muladd(v0, wv, s0);
+                                s1 = v_muladd(v1, wv, s1);
+                            }
+                        }
+                        if( relu )
+                        {
+                            s0 = v_select(s0 > z, s0, s0*vslope);
+                            s1 = v_select(s1 > z, s1, s1*vslope);
+                        }
+                        v_store(outptr + x, v_min(v_max(s0, vmin), vmax));
+                        v_store(outptr + x + 4, v_min(v_max(s1, vmin), vmax));
+                    }
+                    for( ; x + 4 <= x1v; x += 4 )
+                    {
+                        v_float32x4 s0 = vbias;
+                        for( int ky = 0; ky < kernel_h; ky++ )
+                        {
+                            const float* inp = rowptr[ky] + x*stride_w - pad_w;
+                            const float* w = wptr + ky*kernel_w;
+                            if( stride_w == 1 )
+                            {
+                                for( int kx = 0; kx < kernel_w; kx++ )
+                                    s0 = v_muladd(v_load(inp + kx*dilation_w), v_setall_f32(w[kx]), s0);
+                            }
+                            else
+                            {
+                                for( int kx = 0; kx < kernel_w; kx++ )
+                                {
+                                    v_float32x4 v0, v1;
+                                    v_load_deinterleave(inp + kx*dilation_w, v0, v1);
+                                    s0 = v_muladd(v0, v_setall_f32(w[kx]), s0);
+                                }
+                            }
+                        }
+                        if( relu )
+                            s0 = v_select(s0 > z, s0, s0*vslope);
+                        v_store(outptr + x, v_min(v_max(s0, vmin), vmax));
+                    }
+                }
+#endif
+                for( ; x < x1; x++ )
+                {
+                    const int ix0 = x*stride_w - pad_w;
+                    float s = bias;
+                    for( int ky = 0; ky < kernel_h; ky++ )
+                        for( int kx = 0; kx < kernel_w; kx++ )
+                            s += rowptr[ky][ix0 + kx*dilation_w]*wptr[ky*kernel_w + kx];
+                    if( relu && s < 0.f )
+                        s *= slope;
+                    outptr[x] = std::min(std::max(s, minval), maxval);
+                }
+
+                if( activ_ )
+                    activ_->forwardSlice(outptr, outptr, outW, outPlaneSize, c, c + 1);
+            }
+        }
+    };
+
+    // Winograd F(4x4, 3x3) convolution. Every 4x4 tile of the output is computed from the 6x6 tile
+    // of the input: the tiles are transformed as V = B^T*d*B, multiplied by the transformed weights
+    // U = G*g*G^T element-wise (summing over the input channels) and transformed back by A^T*M*A.
+    // That is 36 multiplications per tile and a pair of channels instead of 144.
+    //
+    // The tiles are processed in blocks of BLK_TILES, so the transformed input and output of a block
+    // stay in cache between the three steps.
+    class WinogradConv : public cv::ParallelLoopBody
+    {
+    public:
+        enum { TILE = 4, WIN = 6, NPOS = WIN*WIN, BLK_TILES = 16, CN_ALIGN = 4 };
+
+        const Mat* input_;
+        const Mat* weights_;
+        Mat* output_;
+        int inpCnAligned_, tilesW_, ntiles_, blocksPerSample_;
+        Size pad_;
+        const std::vector<float>* biasvec_;
+        const std::vector<float>* reluslope_;
+        const ActivationLayer* activ_;
+
+        WinogradConv()
+            : input_(0), weights_(0), output_(0),
+              inpCnAligned_(0), tilesW_(0), ntiles_(0), blocksPerSample_(0),
+              biasvec_(0), reluslope_(0), activ_(0)
+        {}
+
+        // weights: outCn x (inpCn*9) matrix; the result is NPOS x (outCn*inpCn_aligned) matrix of U
+        // where the input channels are padded with zeros to CN_ALIGN.
+        static void transformWeights(const Mat& weights, int inpCn, Mat& wino)
+        {
+            static const double G[WIN][3] = {
+                { 1./4,      0,     0 },
+                { -1./6, -1./6, -1./6 },
+                { -1./6,  1./6, -1./6 },
+                { 1./24, 1./12,  1./6 },
+                { 1./24, -1./12, 1./6 },
+                { 0,         0,     1 }
+            };
+            const int outCn = weights.rows, inpCnAligned = (int)alignSize(inpCn, CN_ALIGN);
+            CV_Assert(weights.type() == CV_32F && weights.cols == inpCn*9);
+            wino.create(NPOS, outCn*inpCnAligned, CV_32F);
+            wino.setTo(Scalar::all(0));
+            for( int oc = 0; oc < outCn; oc++ )
+            {
+                const float* wptr = weights.ptr<float>(oc);
+                for( int ic = 0; ic < inpCn; ic++, wptr += 9 )
+                {
+                    double t[WIN][3];
+                    for( int i = 0; i < WIN; i++ )
+                        for( int j = 0; j < 3; j++ )
+                            t[i][j] = G[i][0]*wptr[j] + G[i][1]*wptr[3 + j] + G[i][2]*wptr[6 + j];
+                    for( int i = 0; i < WIN; i++ )
+                        for( int j = 0; j < WIN; j++ )
+                            wino.at<float>(i*WIN + j, oc*inpCnAligned + ic) =
+                                (float)(t[i][0]*G[j][0] + t[i][1]*G[j][1] + t[i][2]*G[j][2]);
+                }
+            }
+        }
+
+        static void run( const Mat& input, Mat& output, const Mat& wino,
+                         const std::vector<float>& biasvec,
+                         const std::vector<float>& reluslope,
+                         Size pad, const ActivationLayer* activ, int nstripes )
+        {
+            CV_Assert( input.dims == 4 && output.dims == 4,
+                       input.size[0] == output.size[0],
+                       input.type() == CV_32F && output.type() == CV_32F,
+                       input.isContinuous(), output.isContinuous(),
+                       wino.rows == NPOS && wino.cols == (int)alignSize(input.size[1], CN_ALIGN)*output.size[1],
+                       biasvec.size() == (size_t)output.size[1]+2);
+            WinogradConv p;
+
+            p.input_ = &input;
+            p.weights_ = &wino;
+            p.output_ = &output;
+            p.inpCnAligned_ = (int)alignSize(input.size[1], CN_ALIGN);
+            p.tilesW_ = (output.size[3] + TILE - 1)/TILE;
+            p.ntiles_ = p.tilesW_*((output.size[2] + TILE - 1)/TILE);
+            p.blocksPerSample_ = (p.ntiles_ + BLK_TILES - 1)/BLK_TILES;
+            p.pad_ = pad;
+            p.biasvec_ = &biasvec;
+            p.reluslope_ = &reluslope;
+            p.activ_ = reluslope.empty() ? activ : 0;
+
+            parallel_for_(Range(0, input.size[0]*p.blocksPerSample_), p, nstripes);
+        }
+
+        virtual void operator ()(const Range &r) const CV_OVERRIDE
+        {
+            const int inpCn = input_->size[1], outCn = output_->size[1];
+            const size_t inpSampleSize = input_->total()/input_->size[0];
+            const size_t outSampleSize = output_->total()/output_->size[0];
+
+            // V: NPOS x BLK_TILES x inpCnAligned, M: outCn x NPOS x BLK_TILES
+            const size_t vsize = (size_t)NPOS*BLK_TILES*inpCnAligned_;
+            AutoBuffer<float> buf_(vsize + (size_t)outCn*NPOS*BLK_TILES + CN_ALIGN);
+            float* vbuf = alignPtr((float*)buf_, (int)(CN_ALIGN*sizeof(float)));
+            float* mbuf = vbuf + vsize;
+            // the padding channels and tiles are never written
+            memset(vbuf, 0, vsize*sizeof(vbuf[0]));
+
+            for( int blk = r.start; blk < r.end; blk++ )
+            {
+                const int n = blk / blocksPerSample_;
+                const int t0 = (blk - n*blocksPerSample_)*BLK_TILES;
+                const int t1 = std::min(t0 + BLK_TILES, ntiles_);
+                if( t1 - t0 < BLK_TILES && inpCn < inpCnAligned_ )
+                    memset(vbuf, 0, vsize*sizeof(vbuf[0]));
+
+                transformInput(input_->ptr<float>() + n*inpSampleSize, t0, t1, vbuf);
+                for( int pos = 0; pos < NPOS; pos++ )
+                    multiply(pos, t1 - t0, vbuf, mbuf);
+                transformOutput(mbuf, t0, t1, output_->ptr<float>() + n*outSampleSize);
+            }
+        }
+
+        void transformInput(const float* inp, int t0, int t1, float* vbuf) const
+        {
+            const int inpCn = input_->size[1], height = input_->size[2], width = input_->size[3];
+            const int inpCnAligned = inpCnAligned_;
+            const size_t inpPlaneSize = (size_t)width*height;
+            const size_t vstep = (size_t)BLK_TILES*inpCnAligned;
+
+            for( int t = t0; t < t1; t++ )
+            {
+                const int ty = t / tilesW_, tx = t - ty*tilesW_;
+                const int y0 = ty*TILE - pad_.height, x0 = tx*TILE - pad_.width;
+                float* v = vbuf + (t - t0)*inpCnAligned;
+            #if CV_SIMD128
+                // four horizontally adjacent tiles inside the image; the rows of their windows
+                // are gathered by transposing the 4x4 blocks of the image rows
+                if( t + 4 <= t1 && tx + 4 <= tilesW_ &&
+                    0 <= y0 && y0 + WIN <= height && 0 <= x0 && x0 + TILE*5 <= width )
+                {
+                    const v_float32x4 c2 = v_setall_f32(2.f), c4 = v_setall_f32(4.f), c5 = v_setall_f32(5.f);
+                    for( int ic = 0; ic < inpCn; ic++ )
+                    {
+                        const float* src = inp + ic*inpPlaneSize + y0*width + x0;
+                        v_float32x4 s[WIN][WIN];
+                        for( int i = 0; i < WIN; i++, src += width )
+                        {
+                            v_float32x4 a0 = v_load(src), a1 = v_load(src + 4), a2 = v_load(src + 8),
+                                        a3 = v_load(src + 12), a4 = v_load(src + 16);
+                            v_float32x4 d0, d1, d2, d3, d4, d5, u2, u3;
+                            v_transpose4x4(a0, a1, a2, a3, d0, d1, d2, d3);
+                            v_transpose4x4(a1, a2, a3, a4, d4, d5, u2, u3);
+                            // d*B
+                            s[0][i] = c4*d0 - c5*d2 + d4;
+                            s[1][i] = d3 + d4 - c4*(d1 + d2);
+                            s[2][i] = c4*(d1 - d2) - d3 + d4;
+                            s[3][i] = c2*(d3 - d1) - d2 + d4;
+                            s[4][i] = c2*(d1 - d3) - d2 + d4;
+                            s[5][i] = c4*d1 - c5*d3 + d5;
+                        }
+                        // B^T*(d*B)
+                        float* vc = v + ic;
+                        for( int j = 0; j < WIN; j++ )
+                        {
+                            v_float32x4 x0_ = s[j][0], x1 = s[j][1], x2 = s[j][2], x3 = s[j][3], x4 = s[j][4], x5 = s[j][5];
+                            v_float32x4 r[WIN];
+                            r[0] = c4*x0_ - c5*x2 + x4;
+                            r[1] = x3 + x4 - c4*(x1 + x2);
+                            r[2] = c4*(x1 - x2) - x3 + x4;
+                            r[3] = c2*(x3 - x1) - x2 + x4;
+                            r[4] = c2*(x1 - x3) - x2 + x4;
+                            r[5] = c4*x1 - c5*x3 + x5;
+                            for( int i = 0; i < WIN; i++ )
+                            {
+                                float CV_DECL_ALIGNED(16) buf[4];
+                                v_store_aligned(buf, r[i]);
+                                float* dst = vc + (i*WIN + j)*vstep;
+                                dst[0] = buf[0];
+                                dst[inpCnAligned] = buf[1];
+                                dst[inpCnAligned*2] = buf[2];
+                                dst[inpCnAligned*3] = buf[3];
+                            }
+                        }
+                    }
+                    t += 3;
+                    continue;
+                }
+            #endif
+                const bool inside = 0 <= y0 && y0 + WIN <= height && 0 <= x0 && x0 + WIN <= width;
+                for( int ic = 0; ic < inpCn; ic++ )
+                {
+                    const float* src = inp + ic*inpPlaneSize;
+                    float d[WIN][WIN], s[WIN][WIN];
+                    for( int i = 0; i < WIN; i++ )
+                        for( int j = 0; j < WIN; j++ )
+                        {
+                            int y = y0 + i, x = x0 + j;
+                            d[i][j] = inside || (0 <= y && y < height && 0 <= x && x < width) ? src[y*width + x] : 0.f;
+                        }
+                    // B^T*d
+                    for( int j = 0; j < WIN; j++ )
+                    {
+                        float x0_ = d[0][j], x1 = d[1][j], x2 = d[2][j], x3 = d[3][j], x4 = d[4][j], x5 = d[5][j];
+                        s[0][j] = 4*x0_ - 5*x2 + x4;
+                        s[1][j] = -4*(x1 + x2) + x3 + x4;
+                        s[2][j] = 4*(x1 - x2) - x3 + x4;
+                        s[3][j] = 2*(x3 - x1) - x2 + x4;
+                        s[4][j] = 2*(x1 - x3) - x2 + x4;
+                        s[5][j] = 4*x1 - 5*x3 + x5;
+                    }
+                    // (B^T*d)*B
+                    float* vc = v + ic;
+                    for( int i = 0; i < WIN; i++, vc += vstep*WIN )
+                    {
+                        float x0_ = s[i][0], x1 = s[i][1], x2 = s[i][2], x3 = s[i][3], x4 = s[i][4], x5 = s[i][5];
+                        vc[0] = 4*x0_ - 5*x2 + x4;
+                        vc[vstep] = -4*(x1 + x2) + x3 + x4;
+                        vc[vstep*2] = 4*(x1 - x2) - x3 + x4;
+                        vc[vstep*3] = 2*(x3 - x1) - x2 + x4;
+                        vc[vstep*4] = 2*(x1 - x3) - x2 + x4;
+                        vc[vstep*5] = 4*x1 - 5*x3 + x5;
+                    }
+                }
+            }
+        }
+
+        // M[pos] = U[pos]*V[pos]^T, i.e. dot products over the input channels
+        void multiply(int pos, int ntiles, const float* vbuf, float* mbuf) const
+        {
+            const int inpCn = input_->size[1], outCn = output_->size[1];
+            const int inpCnAligned = inpCnAligned_;
+            const float* wptr = weights_->ptr<float>(pos);
+            const float* vptr = vbuf + (size_t)pos*BLK_TILES*inpCnAligned;
+            const size_t mstep = (size_t)NPOS*BLK_TILES;
+            float* mptr = mbuf + pos*BLK_TILES;
+
+            for( int oc = 0; oc < outCn; oc += 2 )
+            {
+                const float* w0 = wptr + oc*inpCnAligned;
+                const float* w1 = oc + 1 < outCn ? w0 + inpCnAligned : w0;
+                float* m0 = mptr + oc*mstep;
+                float* m1 = oc + 1 < outCn ? m0 + mstep : m0;
+                int t = 0;
+            #if CV_SIMD128
+                for( ; t < ntiles; t += 4 )
+                {
+                    const float* v0 = vptr + t*inpCnAligned;
+                    v_float32x4 s00 = v_setzero_f32(), s01 = v_setzero_f32(),
+                                s02 = v_setzero_f32(), s03 = v_setzero_f32(),
+                                s10 = v_setzero_f32(), s11 = v_setzero_f32(),
+                                s12 = v_setzero_f32(), s13 = v_setzero_f32();
+                    for( int k = 0; k < inpCnAligned; k += 4 )
+                    {
+                        v_float32x4 a = v_load(w0 + k), b = v_load(w1 + k);
+                        v_float32x4 r0 = v_load(v0 + k), r1 = v_load(v0 + inpCnAligned + k),
+                                    r2 = v_load(v0 + inpCnAligned*2 + k), r3 = v_load(v0 + inpCnAligned*3 + k);
+                        s00 += a*r0; s01 += a*r1; s02 += a*r2; s03 += a*r3;
+                        s10 += b*r0; s11 += b*r1; s12 += b*r2; s13 += b*r3;
+                    }
+                    v_store(m0 + t, v_reduce_sum4(s00, s01, s02, s03));
+                    v_store(m1 + t, v_reduce_sum4(s10, s11, s12, s13));
+                }
+            #endif
+                for( ; t < ntiles; t++ )
+                {
+                    const float* v0 = vptr + t*inpCnAligned;
+                    float s0 = 0.f, s1 = 0.f;
+                    for( int k = 0; k < inpCn; k++ )
+                    {
+                        s0 += w0[k]*v0[k];
+                        s1 += w1[k]*v0[k];
+                    }
+                    m0[t] = s0;
+                    m1[t] = s1;
+                }
+            }
+        }
+
+        void transformOutput(const float* mbuf, int t0, int t1, float* out) const
+        {
+            const int outCn = output_->size[1], outH = output_->size[2], outW = output_->size[3];
+            const size_t outPlaneSize = (size_t)outW*outH;
+            const float* biasptr = &biasvec_->at(0);
+            const float* relu = reluslope_->empty() ? 0 : &reluslope_->at(0);
+
+            for( int oc = 0; oc < outCn; oc++ )
+            {
+                const float* m = mbuf + (size_t)oc*NPOS*BLK_TILES;
+                const float bias = biasptr[oc], slope = relu ? relu[oc] : 1.f;
+                float* outptr = out + oc*outPlaneSize;
+                for( int t = t0; t < t1; t += 4 )
+                {
+                    // four tiles at once; the padding tiles of the block are not stored
+                    float CV_DECL_ALIGNED(16) y[TILE][TILE][4];
+                    const float* mt = m + (t - t0);
+                #if CV_SIMD128
+                    const v_float32x4 c2 = v_setall_f32(2.f), c4 = v_setall_f32(4.f), c8 = v_setall_f32(8.f);
+                    const v_float32x4 vbias = v_setall_f32(bias), vslope = v_setall_f32(slope), z = v_setzero_f32();
+                    v_float32x4 s[TILE][WIN];
+                    for( int j = 0; j < WIN; j++ )
+                    {
+                        v_float32x4 m0 = v_load(mt + j*BLK_TILES), m1 = v_load(mt + (WIN + j)*BLK_TILES),
+                                    m2 = v_load(mt + (2*WIN + j)*BLK_TILES), m3 = v_load(mt + (3*WIN + j)*BLK_TILES),
+                                    m4 = v_load(mt + (4*WIN + j)*BLK_TILES), m5 = v_load(mt + (5*WIN + j)*BLK_TILES);
+                        s[0][j] = m0 + m1 + m2 + m3 + m4;
+                        s[1][j] = m1 - m2 + c2*(m3 - m4);
+                        s[2][j] = m1 + m2 + c4*(m3 + m4);
+                        s[3][j] = m1 - m2 + c8*(m3 - m4) + m5;
+                    }
+                    for( int i = 0; i < TILE; i++ )
+                    {
+                        v_float32x4 m0 = s[i][0], m1 = s[i][1], m2 = s[i][2], m3 = s[i][3], m4 = s[i][4], m5 = s[i][5];
+                        v_float32x4 r[TILE] = { m0 + m1 + m2 + m3 + m4 + vbias,
+                                                m1 - m2 + c2*(m3 - m4) + vbias,
+                                                m1 + m2 + c4*(m3 + m4) + vbias,
+                                                m1 - m2 + c8*(m3 - m4) + m5 + vbias };
+                        for( int j = 0; j < TILE; j++ )
+                        {
+                            if( relu )
+                                r[j] = v_select(r[j] > z, r[j], r[j]*vslope);
+                            v_store_aligned(y[i][j], r[j]);
+                        }
+                    }
+                #else
+                    for( int k = 0; k < 4; k++ )
+                    {
+                        float s[TILE][WIN];
+                        for( int j = 0; j < WIN; j++ )
+                        {
+                            float m0 = mt[j*BLK_TILES + k], m1 = mt[(WIN + j)*BLK_TILES + k],
+                                  m2 = mt[(2*WIN + j)*BLK_TILES + k], m3 = mt[(3*WIN + j)*BLK_TILES + k],
+                                  m4 = mt[(4*WIN + j)*BLK_TILES + k], m5 = mt[(5*WIN + j)*BLK_TILES + k];
+                            s[0][j] = m0 + m1 + m2 + m3 + m4;
+                            s[1][j] = m1 - m2 + 2*(m3 - m4);
+                            s[2][j] = m1 + m2 + 4*(m3 + m4);
+                            s[3][j] = m1 - m2 + 8*(m3 - m4) + m5;
+                        }
+                        for( int i = 0; i < TILE; i++ )
+                        {
+                            float m0 = s[i][0], m1 = s[i][1], m2 = s[i][2], m3 = s[i][3], m4 = s[i][4], m5 = s[i][5];
+                            float r[TILE] = { m0 + m1 + m2 + m3 + m4, m1 - m2 + 2*(m3 - m4),
+                                              m1 + m2 + 4*(m3 + m4), m1 - m2 + 8*(m3 - m4) + m5 };
+                            for( int j = 0; j < TILE; j++ )
+                            {
+                                float v = r[j] + bias;
+                                y[i][j][k] = relu && v < 0.f ? v*slope : v;
+                            }
+                        }
+                    }
+                #endif
+
+                    for( int k = 0; k < 4 && t + k < t1; k++ )
+                    {
+                        const int ty = (t + k) / tilesW_, tx = t + k - ty*tilesW_;
+                        const int y0 = ty*TILE, x0 = tx*TILE;
+                        const int h = std::min((int)TILE, outH - y0), w = std::min((int)TILE, outW - x0);
+                        float* dst = outptr + y0*outW + x0;
+                        for( int i = 0; i < h; i++, dst += outW )
+                            for( int j = 0; j < w; j++ )
+                                dst[j] = y[i][j][k];
+                    }
+                }
+            }
+
+            if( activ_ )
+            {
+                for( int t = t0; t < t1; t++ )
+                {
+                    const int ty = t / tilesW_, tx = t - ty*tilesW_;
+                    const int y0 = ty*TILE, x0 = tx*TILE;
+                    const int h = std::min((int)TILE, outH - y0), w = std::min((int)TILE, outW - x0);
+                    float* dst = out + y0*outW + x0;
+                    for( int i = 0; i < h; i++, dst += outW )
+                        activ_->forwardSlice(dst, dst, w, outPlaneSize, 0, outCn);
+                }
+            }
+        }
+    };
+
+    // Convolution with int8 weights and input. The quantized input is unrolled (im2row) by blocks
+    // of BLK_SIZE output pixels into 16-bit rows, multiplied by the weights with 32-bit accumulation
+    // and the sums are scaled back to float per output channel.
+    class QuantizedConv : public cv::ParallelLoopBody
+    {
+    public:
+        enum { BLK_SIZE = 32, K_ALIGN = 8 };
+
+        const Mat* input_;
+        const Mat* weights_;
+        Mat* output_;
+        const std::vector<float>* scales_;
+        const std::vector<float>* biasvec_;
+        const std::vector<float>* reluslope_;
+        const ActivationLayer* activ_;
+        Size kernel_, pad_, stride_, dilation_;
+        int ngroups_, blocksPerPlane_;
+        std::vector<int> ofstab_;
+
+        QuantizedConv()
+            : input_(0), weights_(0), output_(0), scales_(0), biasvec_(0), reluslope_(0), activ_(0),
+              ngroups_(0), blocksPerPlane_(0)
+        {}
+
+        static void run( const Mat& input, Mat& output, const Mat& weights,
+                         const std::vector<float>& scales,
+                         const std::vector<float>& biasvec,
+                         const std::vector<float>& reluslope,
+                         Size kernel, Size pad, Size stride, Size dilation,
+                         const ActivationLayer* activ, int ngroups, int nstripes )
+        {
+            const int outCn = output.size[1];
+            CV_Assert( input.dims == 4 && output.dims == 4,
+                       input.size[0] == output.size[0],
+                       input.type() == CV_8S && output.type() == CV_32F && weights.type() == CV_8S,
+                       input.isContinuous(), output.isContinuous(),
+                       weights.rows == outCn && weights.cols % K_ALIGN == 0 &&
+                       weights.cols >= input.size[1]/ngroups*kernel.area(),
+                       scales.size() == (size_t)outCn,
+                       biasvec.size() == (size_t)outCn+2);
+            QuantizedConv p;
+
+            p.input_ = &input;
+            p.weights_ = &weights;
+            p.output_ = &output;
+            p.scales_ = &scales;
+            p.biasvec_ = &biasvec;
+            p.reluslope_ = &reluslope;
+            p.activ_ = reluslope.empty() ? activ : 0;
+            p.kernel_ = kernel; p.pad_ = pad; p.stride_ = stride; p.dilation_ = dilation;
+            p.ngroups_ = ngroups;
+            p.blocksPerPlane_ = (output.size[2]*output.size[3] + BLK_SIZE - 1)/BLK_SIZE;
+
+            // offsets of the kernel aperture elements in the input of a group
+            const int height = input.size[2], width = input.size[3];
+            p.ofstab_.resize(input.size[1]/ngroups*kernel.area());
+            for( int c = 0, k = 0; c < input.size[1]/ngroups; c++ )
+                for( int ky = 0; ky < kernel.height; ky++ )
+                    for( int kx = 0; kx < kernel.width; kx++, k++ )
+                        p.ofstab_[k] = (c*height + ky*dilation.height)*width + kx*dilation.width;
+
+            parallel_for_(Range(0, input.size[0]*ngroups*p.blocksPerPlane_), p, nstripes);
+        }
+
+        virtual void operator ()(const Range &r) const CV_OVERRIDE
+        {
+            const int inpCn = input_->size[1], height = input_->size[2], width = input_->size[3];
+            const int outCn = output_->size[1], outH = output_->size[2], outW = output_->size[3];
+            const int inpCnG = inpCn/ngroups_, outCnG = outCn/ngroups_;
+            const int outPlaneSize = outH*outW;
+            const int ksize = inpCnG*kernel_.area(), ksizeAligned = weights_->cols;
+            const float* biasptr = &biasvec_->at(0);
+            const float* relu = reluslope_->empty() ? 0 : &reluslope_->at(0);
+
+            AutoBuffer<short> rowbuf_((size_t)BLK_SIZE*ksizeAligned);
+            AutoBuffer<int> accbuf_((size_t)outCnG*BLK_SIZE);
+            short* rowbuf = rowbuf_;
+            int* accbuf = accbuf_;
+            for( int i = 0; i < BLK_SIZE; i++ )
+                for( int k = ksize; k < ksizeAligned; k++ )
+                    rowbuf[i*ksizeAligned + k] = 0;
+
+            for( int blk = r.start; blk < r.end; blk++ )
+            {
+                const int n = blk / (ngroups_*blocksPerPlane_);
+                const int g = blk / blocksPerPlane_ - n*ngroups_;
+                const int ofs0 = (blk - (n*ngroups_ + g)*blocksPerPlane_)*BLK_SIZE;
+                const int ofs1 = std::min(ofs0 + BLK_SIZE, outPlaneSize);
+                const schar* inp = input_->ptr<schar>(n, g*inpCnG);
+
+                for( int ofs = ofs0; ofs < ofs1; ofs++ )
+                {
+                    const int oy = ofs / outW, ox = ofs - oy*outW;
+                    const int y0 = oy*stride_.height - pad_.height, x0 = ox*stride_.width - pad_.width;
+                    short* row = rowbuf + (ofs - ofs0)*ksizeAligned;
+                    if( 0 <= y0 && y0 + (kernel_.height - 1)*dilation_.height < height &&
+                        0 <= x0 && x0 + (kernel_.width - 1)*dilation_.width < width )
+                    {
+                        // most of the apertures are inside the image
+                        const schar* src = inp + y0*width + x0;
+                        const int* ofstab = &ofstab_[0];
+                        for( int k = 0; k < ksize; k++ )
+                            row[k] = src[ofstab[k]];
+                        continue;
+                    }
+                    for( int c = 0; c < inpCnG; c++ )
+                    {
+                        const schar* src = inp + c*height*width;
+                        for( int ky = 0; ky < kernel_.height; ky++ )
+                        {
+                            const int y = y0 + ky*dilation_.height;
+                            for( int kx = 0; kx < kernel_.width; kx++ )
+                            {
+                                const int x = x0 + kx*dilation_.width;
+                                *row++ = (unsigned)y < (unsigned)height && (unsigned)x < (unsigned)width ?
+                                         src[y*width + x] : 0;
+                            }
+                        }
+                    }
+                }
+
+                gemmInt8(weights_->ptr<schar>(g*outCnG), weights_->step1(), rowbuf, ksizeAligned,
+                         accbuf, BLK_SIZE, outCnG, ofs1 - ofs0, ksizeAligned);
+
+                float* outptr = output_->ptr<float>(n, g*outCnG) + ofs0;
+                for( int oc = 0; oc < outCnG; oc++ )
+                {
+                    const int k = g*outCnG + oc;
+                    const float scale = scales_->at(k), bias = biasptr[k], slope = relu ? relu[k] : 1.f;
+                    const int* acc = accbuf + oc*BLK_SIZE;
+                    float* dst = outptr + oc*outPlaneSize;
+                    int j = 0;
+                #if CV_SIMD128
+                    const v_float32x4 vscale = v_setall_f32(scale), vbias = v_setall_f32(bias);
+                    const v_float32x4 vslope = v_setall_f32(slope), z = v_setzero_f32();
+                    for( ; j <= ofs1 - ofs0 - 4; j += 4 )
+                    {
+                        v_float32x4 v = v_muladd(v_cvt_f32(v_load(acc + j)), vscale, vbias);
+                        if( relu )
+                            v = v_select(v > z, v, v*vslope);
+                        v_store(dst + j, v);
+                    }
+                #endif
+                    for( ; j < ofs1 - ofs0; j++ )
+                    {
+                        float v = acc[j]*scale + bias;
+                        dst[j] = relu && v < 0.f ? v*slope : v;
+                    }
+                }
+                if( activ_ )
+                    activ_->forwardSlice(outptr, outptr, ofs1 - ofs0, outPlaneSize, g*outCnG, (g + 1)*outCnG);
+            }
+        }
+    };
+
+    // Convolution of the channel-blocked blobs (see Layer::tryUseBlockedLayout). The input is padded
+    // once, so the receptive field of every output pixel is a dense window of 8-channel vectors.
+    // The kernel computes a group of outCnBlockSize() output channels for PIX_BLOCK output pixels at a time
+    // with the weights packed by packWeights(): [outCn/outCnBlockSize()][inpCn/8][kernel.height][kernel.width]
+    // [8][outCnBlockSize()], the last group is padded with zeros.
+    class BlockedConv : public cv::ParallelLoopBody
+    {
+    public:
+        enum { PIX_BLOCK = 96 };
+
+        const float* input_;
+        const float* weights_;
+        float* output_;
+        const std::vector<float>* biasvec_;
+        const std::vector<float>* reluslope_;
+        const ActivationLayer* activ_;
+        int inpCn_, outCn_, outCnBlock_, outPlaneSize_, pixBlocks_;
+        size_t inpBlockStep_;
+        std::vector<int> ofstab_, kofs_;
+        bool useAVX512;
+
+        BlockedConv()
+            : input_(0), weights_(0), output_(0), biasvec_(0), reluslope_(0), activ_(0),
+              inpCn_(0), outCn_(0), outCnBlock_(0), outPlaneSize_(0), pixBlocks_(0), inpBlockStep_(0),
+              useAVX512(false)
+        {}
+
+        // 2 vectors of the output channels
+        static int outCnBlockSize()
+        {
+            return CV_CPU_HAS_SUPPORT_AVX512_SKX ? 32 : 16;
+        }
+
+        static void packWeights(const Mat& weightsMat, int inpCn, Size kernel, Mat& packed)
+        {
+            const int outCn = weightsMat.rows, karea = kernel.area(), outCnBlock = outCnBlockSize();
+            const int ngroups = (outCn + outCnBlock - 1)/outCnBlock;
+            CV_Assert(outCn % BLOCKED_CN == 0 && inpCn % BLOCKED_CN == 0 && weightsMat.cols >= inpCn*karea);
+            packed.create(1, ngroups*outCnBlock*inpCn*karea, CV_32F);
+            float* dst = packed.ptr<float>();
+            for( int oc0 = 0; oc0 < outCn; oc0 += outCnBlock )
+                for( int ic0 = 0; ic0 < inpCn; ic0 += BLOCKED_CN )
+                    for( int k = 0; k < karea; k++ )
+                        for( int l = 0; l < BLOCKED_CN; l++ )
+                            for( int c = 0; c < outCnBlock; c++ )
+                                *dst++ = oc0 + c < outCn ? weightsMat.at<float>(oc0 + c, (ic0 + l)*karea + k) : 0.f;
+        }
+
+        static void run( const Mat& input, Mat& output, Mat& padded, const Mat& weights,
+                         const std::vector<float>& biasvec,
+                         const std::vector<float>& reluslope,
+                         Size kernel, Size pad, Size stride, Size dilation,
+                         const ActivationLayer* activ, int nstripes )
+        {
+            const int N = input.size[0], inpCn = input.size[1], height = input.size[2], width = input.size[3];
+            const int outCn = output.size[1], outH = output.size[2], outW = output.size[3];
+            const int outCnBlock = outCnBlockSize();
+            CV_Assert( input.dims == 4 && output.dims == 4, input.size[0] == output.size[0],
+                       input.type() == CV_32F && output.type() == CV_32F,
+                       input.isContinuous(), output.isContinuous(),
+                       inpCn % BLOCKED_CN == 0 && outCn % BLOCKED_CN == 0,
+                       weights.total() == (size_t)alignSize(outCn, outCnBlock)*inpCn*kernel.area(),
+                       biasvec.size() == (size_t)outCn+2,
+                       reluslope.empty() || reluslope.size() == (size_t)outCn+2 );
+
+            // the window of the input read by the convolution, including the padding
+            const int padH = (outH - 1)*stride.height + (kernel.height - 1)*dilation.height + 1;
+            const int padW = (outW - 1)*stride.width + (kernel.width - 1)*dilation.width + 1;
+            const float* src = input.ptr<float>();
+            int srcH = height, srcW = width;
+            if( pad != Size(0, 0) || padH > height || padW > width )
+            {
+                const int inpBlocks = N*inpCn/BLOCKED_CN;
+                const int rows = std::min(height, padH - pad.height), cols = std::min(width, padW - pad.width);
+                padded.create(1, inpBlocks*padH*padW*BLOCKED_CN, CV_32F);
+                padded.setTo(Scalar::all(0));
+                for( int b = 0; b < inpBlocks; b++ )
+                    for( int y = 0; y < rows; y++ )
+                        memcpy(padded.ptr<float>() + ((b*padH + y + pad.height)*padW + pad.width)*BLOCKED_CN,
+                               src + (b*height + y)*width*BLOCKED_CN, cols*BLOCKED_CN*sizeof(float));
+                src = padded.ptr<float>();
+                srcH = padH;
+                srcW = padW;
+            }
+
+            BlockedConv p;
+            p.input_ = src;
+            p.weights_ = weights.ptr<float>();
+            p.output_ = output.ptr<float>();
+            p.biasvec_ = &biasvec;
+            p.reluslope_ = &reluslope;
+            p.activ_ = reluslope.empty() ? activ : 0;
+            p.inpCn_ = inpCn;
+            p.outCn_ = outCn;
+            p.outCnBlock_ = outCnBlock;
+            p.outPlaneSize_ = outH*outW;
+            p.pixBlocks_ = (p.outPlaneSize_ + PIX_BLOCK - 1)/PIX_BLOCK;
+            p.inpBlockStep_ = (size_t)srcH*srcW*BLOCKED_CN;
+            p.useAVX512 = CV_CPU_HAS_SUPPORT_AVX512_SKX;
+
+            p.ofstab_.resize(p.outPlaneSize_);
+            for( int y = 0, k = 0; y < outH; y++ )
+                for( int x = 0; x < outW; x++, k++ )
+                    p.ofstab_[k] = (y*stride.height*srcW + x*stride.width)*BLOCKED_CN;
+            p.kofs_.resize(kernel.area());
+            for( int ky = 0, k = 0; ky < kernel.height; ky++ )
+                for( int kx = 0; kx < kernel.width; kx++, k++ )
+                    p.kofs_[k] = (ky*dilation.height*srcW + kx*dilation.width)*BLOCKED_CN;
+
+            const int ntasks = N*((outCn + outCnBlock - 1)/outCnBlock)*p.pixBlocks_;
+            parallel_for_(Range(0, ntasks), p, std::min(nstripes, ntasks));
+        }
+
+        virtual void operator ()(const Range &r) const CV_OVERRIDE
+        {
+            const int inpBlocks = inpCn_/BLOCKED_CN, outCnBlock = outCnBlock_;
+            const int outGroups = (outCn_ + outCnBlock - 1)/outCnBlock;
+            const int karea = (int)kofs_.size();
+            const size_t outBlockStep = (size_t)outPlaneSize_*BLOCKED_CN;
+            float biasbuf[32], relubuf[32];
+
+            for( int task = r.start; task < r.end; task++ )
+            {
+                const int pb = task % pixBlocks_, g = (task / pixBlocks_) % outGroups;
+                const int n = task / (pixBlocks_*outGroups);
+                const int p0 = pb*PIX_BLOCK, npix = std::min(outPlaneSize_ - p0, (int)PIX_BLOCK);
+                const int oc0 = g*outCnBlock, ocn = std::min(outCn_ - oc0, outCnBlock);
+                const float* inp = input_ + n*inpBlocks*inpBlockStep_;
+                const float* wptr = weights_ + (size_t)oc0*inpCn_*karea;
+                float* out = output_ + ((size_t)(n*outCn_ + oc0)/BLOCKED_CN)*outBlockStep + p0*BLOCKED_CN;
+
+                // the kernel reads the values for all outCnBlock channels
+                for( int c = 0; c < outCnBlock; c++ )
+                {
+                    biasbuf[c] = c < ocn ? biasvec_->at(oc0 + c) : 0.f;
+                    relubuf[c] = c < ocn && !reluslope_->empty() ? reluslope_->at(oc0 + c) : 0.f;
+                }
+                const float* relu = reluslope_->empty() ? 0 : relubuf;
+
+            #if CV_TRY_AVX512_SKX
+                if( useAVX512 )
+                    opt_AVX512_SKX::fastConvBlocked(wptr, ocn, inp, &ofstab_[p0], npix, inpBlocks, inpBlockStep_,
+                                                    &kofs_[0], karea, out, outBlockStep, biasbuf, relu);
+                else
+            #endif
+            #if CV_TRY_AVX2
+                    opt_AVX2::fastConvBlocked(wptr, ocn, inp, &ofstab_[p0], npix, inpBlocks, inpBlockStep_,
+                                              &kofs_[0], karea, out, outBlockStep, biasbuf, relu);
+            #else
+                    CV_Error(Error::StsNotImplemented, "Blocked convolution requires AVX2");
+            #endif
+                if( activ_ )
+                    activ_->forwardSlice(out, out, npix*BLOCKED_CN, outBlockStep, 0, ocn/BLOCKED_CN);
+            }
+        }
+    };
+
 #ifdef HAVE_OPENCL
     bool forward_ocl(InputArrayOfArrays inps, OutputArrayOfArrays outs, OutputArrayOfArrays internals)
     {
@@ -983,7 +2048,7 @@ public:
 
         int ngroups = inputs[0]->size[1]/blobs[0].size[1];
         CV_Assert(outputs[0].size[1] % ngroups == 0);
-        int outCn = blobs[0].size[0];
+        int outCn = outputs[0].size[1];
 
         reluslope.clear();
         if( activ )
@@ -1008,8 +2073,25 @@ public:
 
         int nstripes = std::max(getNumThreads(), 1);
 
-        ParallelConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
-                          kernel, pad, stride, dilation, activ.get(), ngroups, nstripes);
+        if (!blockedWeights.empty())
+            BlockedConv::run(*inputs[0], outputs[0], blockedInput, blockedWeights, biasvec, reluslope,
+                             kernel, pad, stride, dilation, activ.get(), nstripes);
+        else if (!int8Weights.empty() && inputs[0]->type() == CV_32F)
+        {
+            inputs[0]->convertTo(int8Input, CV_8S, 127. / inputRange);
+            QuantizedConv::run(int8Input, outputs[0], int8Weights, int8Scales, biasvec, reluslope,
+                               kernel, pad, stride, dilation, activ.get(), ngroups, nstripes);
+        }
+        else if (!winogradWeights.empty() && inputs[0]->type() == CV_32F &&
+                 canUseWinograd(inputs[0]->size[1], outCn, ngroups, outputs[0].size[2], outputs[0].size[3]))
+            WinogradConv::run(*inputs[0], outputs[0], winogradWeights, biasvec, reluslope,
+                              pad, activ.get(), nstripes);
+        else if (ngroups == outCn && blobs[0].size[1] == 1 && inputs[0]->type() == CV_32F)
+            DepthwiseConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
+                               kernel, pad, stride, dilation, activ.get(), nstripes);
+        else
+            ParallelConv::run(*inputs[0], outputs[0], weightsMat, biasvec, reluslope,
+                              kernel, pad, stride, dilation, activ.get(), ngroups, nstripes);
     }
 
     virtual int64 getFLOPS(const std::vector<MatShape> &inputs,
@@ -1600,3 +2682,4 @@ Ptr<BaseConvolutionLayer> DeconvolutionLayer::create(const LayerParams &params)
 
 }
 }
+
@@ -47,6 +47,7 @@
 #include "opencv2/imgproc.hpp"
 #include <opencv2/dnn/shape_utils.hpp>
 #include <iostream>
+#include <type_traits>
 
 #ifdef HAVE_OPENCL
 #include "opencl_kernels_dnn.hpp"
@@ -205,6 +206,12 @@ public:
         func.apply(src, dst, len, planeSize, cn0, cn1);
     }
 
+    // All the functions except the per-channel PReLU do not depend on the position of the element.
+    virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs) CV_OVERRIDE
+    {
+        return !inputs.empty() && !std::is_same<typename Func::Layer, ChannelsPReLULayer>::value;
+    }
+
     virtual int64 getFLOPS(const std::vector<MatShape> &inputs,
                            const std::vector<MatShape> &outputs) const CV_OVERRIDE
     {
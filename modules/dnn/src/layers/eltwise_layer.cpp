@@ -445,6 +445,12 @@ public:
         return !activ.empty();
     }
 
+    // The inputs are combined element by element, so any layout shared by all the blobs works.
+    virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs) CV_OVERRIDE
+    {
+        return !inputs.empty() && activ.dynamicCast<ChannelsPReLULayer>().empty();
+    }
+
     Ptr<ActivationLayer> activ;
 };
 
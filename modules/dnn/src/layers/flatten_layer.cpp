@@ -156,7 +156,8 @@ public:
         for (size_t i = 0; i < inputs.size(); i++)
         {
             MatShape outShape = shape(outputs[i]);
-            outputs[i] = inputs[i]->reshape(1, (int)outShape.size(), &outShape[0]);
+            if (outputs[i].data != inputs[i]->data)
+                inputs[i]->reshape(1, (int)outShape.size(), &outShape[0]).copyTo(outputs[i]);
         }
     }
 
@@ -75,6 +75,7 @@ public:
         int innerSize = (int)blobs[0].total() / numOutput;
         bias = params.get<bool>("bias_term", true);
         axis = params.get<int>("axis", 1);
+        inputRange = 0.f;
 
         CV_Assert(blobs[0].dims >= 2 && (size_t)(innerSize * numOutput) == blobs[0].total());
         CV_Assert(!bias || (blobs.size() == 2 && (size_t)numOutput == blobs[1].total()));
@@ -138,6 +139,21 @@ public:
         return !activ.empty();
     }
 
+    virtual bool tryQuantize(const std::vector<float>& inputRanges) CV_OVERRIDE
+    {
+        inputRange = inputRanges.size() == 1 ? inputRanges[0] : 0.f;
+        int8Weights.release();
+        int8Input.release();
+        if (inputRange > 0.f)
+        {
+            // int8Scales are products of the input and weights scales per output
+            quantizeWeightsInt8(weightsMat, int8Weights, int8Scales, VEC_ALIGN);
+            for (size_t i = 0; i < int8Scales.size(); i++)
+                int8Scales[i] *= inputRange / 127;
+        }
+        return inputRange > 0.f;
+    }
+
     class FullyConnected : public ParallelLoopBody
     {
     public:
@@ -266,6 +282,72 @@ public:
         bool useAVX512;
     };
 
+    // The same with int8 weights and input. Every stripe multiplies a range of the weights rows
+    // by all the samples and scales the sums back to float.
+    class QuantizedFullyConnected : public ParallelLoopBody
+    {
+    public:
+        QuantizedFullyConnected() : srcMat(0), weights(0), scales(0), biasMat(0), activ(0), dstMat(0), nstripes(0) {}
+
+        static void run(const Mat& srcMat, const Mat& weights, const std::vector<float>& scales,
+                        const Mat& biasMat, Mat& dstMat, const ActivationLayer* activ, int nstripes)
+        {
+            CV_Assert( srcMat.dims == 2 && srcMat.cols == weights.cols &&
+                       dstMat.rows == srcMat.rows && dstMat.cols == weights.rows &&
+                       srcMat.type() == CV_16S && weights.type() == CV_8S && dstMat.type() == CV_32F &&
+                       scales.size() == (size_t)weights.rows &&
+                       biasMat.type() == CV_32F && biasMat.isContinuous() && (int)biasMat.total() == dstMat.cols );
+
+            QuantizedFullyConnected p;
+
+            p.srcMat = &srcMat;
+            p.weights = &weights;
+            p.scales = &scales;
+            p.biasMat = &biasMat;
+            p.dstMat = &dstMat;
+            p.activ = activ;
+            p.nstripes = nstripes;
+
+            parallel_for_(Range(0, nstripes), p, nstripes);
+        }
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            int nsamples = srcMat->rows;
+            int nw0 = weights->rows;
+            int stripeSize = (int)alignSize((nw0 + nstripes - 1)/nstripes, 2);
+            int stripeStart = std::min(r.start*stripeSize, nw0);
+            int stripeEnd = std::min(r.end*stripeSize, nw0);
+            int nw = stripeEnd - stripeStart;
+            if( nw <= 0 )
+                return;
+
+            AutoBuffer<int> accbuf((size_t)nw*nsamples);
+            int* acc = accbuf;
+            gemmInt8(weights->ptr<schar>(stripeStart), weights->step1(), srcMat->ptr<short>(), srcMat->step1(),
+                     acc, nsamples, nw, nsamples, srcMat->cols);
+
+            const float* scaleptr = &scales->at(stripeStart);
+            const float* biasptr = biasMat->ptr<float>() + stripeStart;
+            for( int sampleIdx = 0; sampleIdx < nsamples; sampleIdx++ )
+            {
+                float* dptr = dstMat->ptr<float>(sampleIdx) + stripeStart;
+                for( int i = 0; i < nw; i++ )
+                    dptr[i] = acc[i*nsamples + sampleIdx]*scaleptr[i] + biasptr[i];
+
+                if(activ)
+                    activ->forwardSlice(dptr, dptr, 1, 1, stripeStart, stripeEnd);
+            }
+        }
+
+        const Mat *srcMat, *weights;
+        const std::vector<float>* scales;
+        const Mat* biasMat;
+        const ActivationLayer* activ;
+        Mat* dstMat;
+        int nstripes;
+    };
+
 #ifdef HAVE_OPENCL
     void finalize(const std::vector<Mat*> &inputs, std::vector<Mat> &outputs) CV_OVERRIDE
     {
@@ -374,7 +456,19 @@ public:
             Mat dstMat = output[i].reshape(1, outerSize);
 
             const int nstripes = getNumThreads();
-            FullyConnected::run(srcMat, weightsMat, biasMat, dstMat, activ.get(), nstripes);
+            if (!int8Weights.empty() && srcMat.type() == CV_32F)
+            {
+                // the quantized rows are padded with zeros like the weights
+                int8Input.create(outerSize, int8Weights.cols, CV_16S);
+                int8Input.colRange(srcMat.cols, int8Input.cols).setTo(Scalar::all(0));
+                Mat q;
+                srcMat.convertTo(q, CV_8S, 127. / inputRange);
+                q.convertTo(int8Input.colRange(0, srcMat.cols), CV_16S);
+                QuantizedFullyConnected::run(int8Input, int8Weights, int8Scales, biasMat, dstMat,
+                                             activ.get(), nstripes);
+            }
+            else
+                FullyConnected::run(srcMat, weightsMat, biasMat, dstMat, activ.get(), nstripes);
         }
     }
 
@@ -439,6 +533,10 @@ public:
     bool bias;
     Mat weightsMat, biasMat;
     Ptr<ActivationLayer> activ;
+    // int8 computations, see tryQuantize()
+    float inputRange;
+    Mat int8Weights, int8Input;
+    std::vector<float> int8Scales;
 };
 
 Ptr<InnerProductLayer> InnerProductLayer::create(const LayerParams& params)
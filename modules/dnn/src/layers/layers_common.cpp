@@ -42,6 +42,7 @@
 
 #include "../precomp.hpp"
 #include "layers_common.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -217,5 +218,183 @@ void getConvPoolPaddings(const Size& inp, const Size& out,
     }
 }
 
+void quantizeWeightsInt8(const Mat& src, Mat& dst, std::vector<float>& scales, int align)
+{
+    CV_Assert(src.dims == 2 && src.type() == CV_32F && align > 0);
+    const int rows = src.rows, cols = src.cols;
+    dst.create(rows, (int)alignSize(cols, align), CV_8S);
+    dst.setTo(Scalar::all(0));
+    scales.resize(rows);
+    for (int i = 0; i < rows; i++)
+    {
+        double maxVal = norm(src.row(i), NORM_INF);
+        scales[i] = (float)(maxVal / 127);
+        if (maxVal > 0)
+            src.row(i).convertTo(dst.row(i).colRange(0, cols), CV_8S, 127 / maxVal);
+    }
+}
+
+void gemmInt8(const schar* a, size_t astep, const short* b, size_t bstep,
+              int* c, size_t cstep, int m, int n, int vecsize)
+{
+    CV_Assert(vecsize % 8 == 0);
+#if CV_TRY_AVX2
+    if (checkHardwareSupport(CPU_AVX2))
+    {
+        opt_AVX2::fastGEMMInt8(a, astep, b, bstep, c, cstep, m, n, vecsize);
+        return;
+    }
+#endif
+    for (int i = 0; i < m; i += 2)
+    {
+        // an odd row is computed twice
+        const schar* a0 = a + i*astep;
+        const schar* a1 = i + 1 < m ? a0 + astep : a0;
+        int* c0 = c + i*cstep;
+        int* c1 = i + 1 < m ? c0 + cstep : c0;
+        int j = 0;
+#if CV_SIMD128
+        for (; j <= n - 4; j += 4)
+        {
+            const short* b0 = b + j*bstep;
+            const short* b1 = b0 + bstep;
+            const short* b2 = b1 + bstep;
+            const short* b3 = b2 + bstep;
+            v_int32x4 s00 = v_setzero_s32(), s01 = v_setzero_s32(), s02 = v_setzero_s32(), s03 = v_setzero_s32();
+            v_int32x4 s10 = v_setzero_s32(), s11 = v_setzero_s32(), s12 = v_setzero_s32(), s13 = v_setzero_s32();
+            for (int k = 0; k < vecsize; k += 8)
+            {
+                v_int16x8 w0 = v_load_expand(a0 + k), w1 = v_load_expand(a1 + k);
+                v_int16x8 r0 = v_load(b0 + k), r1 = v_load(b1 + k), r2 = v_load(b2 + k), r3 = v_load(b3 + k);
+                s00 = v_dotprod(w0, r0, s00); s01 = v_dotprod(w0, r1, s01);
+                s02 = v_dotprod(w0, r2, s02); s03 = v_dotprod(w0, r3, s03);
+                s10 = v_dotprod(w1, r0, s10); s11 = v_dotprod(w1, r1, s11);
+                s12 = v_dotprod(w1, r2, s12); s13 = v_dotprod(w1, r3, s13);
+            }
+            v_int32x4 t0, t1, t2, t3;
+            v_transpose4x4(s00, s01, s02, s03, t0, t1, t2, t3);
+            v_store(c0 + j, t0 + t1 + t2 + t3);
+            v_transpose4x4(s10, s11, s12, s13, t0, t1, t2, t3);
+            v_store(c1 + j, t0 + t1 + t2 + t3);
+        }
+        for (; j < n; j++)
+        {
+            const short* b0 = b + j*bstep;
+            v_int32x4 s0 = v_setzero_s32(), s1 = v_setzero_s32();
+            for (int k = 0; k < vecsize; k += 8)
+            {
+                v_int16x8 r0 = v_load(b0 + k);
+                s0 = v_dotprod(v_load_expand(a0 + k), r0, s0);
+                s1 = v_dotprod(v_load_expand(a1 + k), r0, s1);
+            }
+            c0[j] = v_reduce_sum(s0);
+            c1[j] = v_reduce_sum(s1);
+        }
+#endif
+        for (; j < n; j++)
+        {
+            const short* b0 = b + j*bstep;
+            int s0 = 0, s1 = 0;
+            for (int k = 0; k < vecsize; k++)
+            {
+                s0 += a0[k]*b0[k];
+                s1 += a1[k]*b0[k];
+            }
+            c0[j] = s0;
+            c1[j] = s1;
+        }
+    }
+}
+
+
+class BlockedLayoutInvoker : public ParallelLoopBody
+{
+public:
+    BlockedLayoutInvoker(const Mat& src_, Mat& dst_, bool toBlocked_)
+        : src(src_), dst(dst_), toBlocked(toBlocked_) {}
+
+    void operator()(const Range& r) const CV_OVERRIDE
+    {
+        const int B = BLOCKED_CN;
+        const int planeSize = src.size[2]*src.size[3];
+        for (int blk = r.start; blk < r.end; blk++)
+        {
+            // B planes of NCHW <-> one plane of B-channel pixels
+            const float* inp = src.ptr<float>() + (size_t)blk*B*planeSize;
+            float* out = dst.ptr<float>() + (size_t)blk*B*planeSize;
+            int i = 0;
+            if (toBlocked)
+            {
+#if CV_SIMD128
+                for (; i <= planeSize - 4; i += 4)
+                {
+                    for (int c = 0; c < B; c += 4)
+                    {
+                        const float* p = inp + c*planeSize + i;
+                        v_float32x4 t0, t1, t2, t3;
+                        v_transpose4x4(v_load(p), v_load(p + planeSize), v_load(p + planeSize*2),
+                                       v_load(p + planeSize*3), t0, t1, t2, t3);
+                        v_store(out + i*B + c, t0);
+                        v_store(out + (i + 1)*B + c, t1);
+                        v_store(out + (i + 2)*B + c, t2);
+                        v_store(out + (i + 3)*B + c, t3);
+                    }
+                }
+#endif
+                for (; i < planeSize; i++)
+                    for (int c = 0; c < B; c++)
+                        out[i*B + c] = inp[c*planeSize + i];
+            }
+            else
+            {
+#if CV_SIMD128
+                for (; i <= planeSize - 4; i += 4)
+                {
+                    for (int c = 0; c < B; c += 4)
+                    {
+                        const float* p = inp + i*B + c;
+                        v_float32x4 t0, t1, t2, t3;
+                        v_transpose4x4(v_load(p), v_load(p + B), v_load(p + B*2), v_load(p + B*3),
+                                       t0, t1, t2, t3);
+                        v_store(out + c*planeSize + i, t0);
+                        v_store(out + (c + 1)*planeSize + i, t1);
+                        v_store(out + (c + 2)*planeSize + i, t2);
+                        v_store(out + (c + 3)*planeSize + i, t3);
+                    }
+                }
+#endif
+                for (; i < planeSize; i++)
+                    for (int c = 0; c < B; c++)
+                        out[c*planeSize + i] = inp[i*B + c];
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    bool toBlocked;
+};
+
+static void convertBlockedLayout(const Mat& src, Mat& dst, bool toBlocked)
+{
+    CV_Assert(src.dims == 4 && src.type() == CV_32F && src.isContinuous() &&
+              src.size[1] % BLOCKED_CN == 0);
+    dst.create(src.dims, src.size.p, CV_32F);
+    CV_Assert(dst.isContinuous() && dst.data != src.data);
+    const int nblocks = src.size[0]*src.size[1]/BLOCKED_CN;
+    parallel_for_(Range(0, nblocks), BlockedLayoutInvoker(src, dst, toBlocked),
+                  std::min(nblocks, getNumThreads()));
+}
+
+void toBlockedLayout(const Mat& src, Mat& dst)
+{
+    convertBlockedLayout(src, dst, true);
+}
+
+void fromBlockedLayout(const Mat& src, Mat& dst)
+{
+    convertBlockedLayout(src, dst, false);
+}
 }
 }
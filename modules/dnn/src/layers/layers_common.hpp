@@ -74,6 +74,25 @@ void getConvPoolPaddings(const Size& inp, const Size& out,
                          const Size &kernel, const Size &stride,
                          const String &padMode, const Size &dilation, Size &pad);
 
+// Symmetric 8-bit quantization: x ~ q*scale, q in [-127, 127].
+
+// Quantizes every row of the CV_32F matrix src with its own scale. The rows of the CV_8S
+// matrix dst are padded with zeros up to a multiple of align.
+void quantizeWeightsInt8(const Mat& src, Mat& dst, std::vector<float>& scales, int align);
+
+// c[i*cstep + j] = sum_k a[i*astep + k]*b[j*bstep + k], 0 <= i < m, 0 <= j < n, 0 <= k < vecsize.
+// The values of b are int8 ones widened to 16 bits; vecsize is a multiple of 8.
+void gemmInt8(const schar* a, size_t astep, const short* b, size_t bstep,
+              int* c, size_t cstep, int m, int n, int vecsize);
+
+// Channel-blocked layout NCHW8c, see Layer::tryUseBlockedLayout().
+enum { BLOCKED_CN = 8 };
+
+// Conversions of 4-dimensional CV_32F blobs between NCHW and NCHW8c. The number of channels
+// is a multiple of BLOCKED_CN; dst is (re)allocated with the shape of src and must not share its data.
+void toBlockedLayout(const Mat& src, Mat& dst);
+void fromBlockedLayout(const Mat& src, Mat& dst);
+
 }
 }
 
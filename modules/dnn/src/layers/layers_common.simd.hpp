@@ -56,6 +56,13 @@ void fastGEMM1T( const float* vec, const float* weights,
 void fastGEMM( const float* aptr, size_t astep, const float* bptr,
                size_t bstep, float* cptr, size_t cstep,
                int ma, int na, int nb );
+void fastGEMMInt8( const schar* aptr, size_t astep, const short* bptr,
+                   size_t bstep, int* cptr, size_t cstep,
+                   int ma, int nb, int vecsize );
+void fastConvBlocked( const float* weights, int ocn, const float* input,
+                      const int* ofstab, int npix, int inpBlocks, size_t inpBlockStep,
+                      const int* kofs, int ntaps, float* output, size_t outBlockStep,
+                      const float* bias, const float* relu );
 
 #if !defined(CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY) && CV_AVX
 
@@ -475,6 +482,188 @@ void fastGEMM( const float* aptr, size_t astep, const float* bptr,
     _mm256_zeroupper();
 }
 
+#if CV_AVX2
+// int8 weights are widened to 16 bits and multiplied by the 16-bit input with vpmaddwd;
+// vecsize is a multiple of 8, the last 8 values are taken with the upper half of the weights zeroed.
+void fastGEMMInt8( const schar* aptr, size_t astep, const short* bptr,
+                   size_t bstep, int* cptr, size_t cstep,
+                   int ma, int nb, int vecsize )
+{
+    for( int m = 0; m < ma; m += 2 )
+    {
+        const schar* aptr0 = aptr + astep*m;
+        const schar* aptr1 = m + 1 < ma ? aptr0 + astep : aptr0;
+        int* cptr0 = cptr + cstep*m;
+        int* cptr1 = m + 1 < ma ? cptr0 + cstep : cptr0;
+
+        int n = 0;
+        for( ; n <= nb - 4; n += 4 )
+        {
+            const short* bptr0 = bptr + bstep*n;
+            const short* bptr1 = bptr0 + bstep;
+            const short* bptr2 = bptr1 + bstep;
+            const short* bptr3 = bptr2 + bstep;
+            __m256i d00 = _mm256_setzero_si256(), d01 = _mm256_setzero_si256(),
+                    d02 = _mm256_setzero_si256(), d03 = _mm256_setzero_si256(),
+                    d10 = _mm256_setzero_si256(), d11 = _mm256_setzero_si256(),
+                    d12 = _mm256_setzero_si256(), d13 = _mm256_setzero_si256();
+
+            for( int k = 0; k < vecsize; k += 16 )
+            {
+                __m256i a0, a1, b0, b1, b2, b3;
+                if( k + 16 <= vecsize )
+                {
+                    a0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(aptr0 + k)));
+                    a1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(aptr1 + k)));
+                    b0 = _mm256_loadu_si256((const __m256i*)(bptr0 + k));
+                    b1 = _mm256_loadu_si256((const __m256i*)(bptr1 + k));
+                    b2 = _mm256_loadu_si256((const __m256i*)(bptr2 + k));
+                    b3 = _mm256_loadu_si256((const __m256i*)(bptr3 + k));
+                }
+                else
+                {
+                    a0 = _mm256_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)(aptr0 + k)));
+                    a1 = _mm256_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)(aptr1 + k)));
+                    b0 = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bptr0 + k)));
+                    b1 = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bptr1 + k)));
+                    b2 = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bptr2 + k)));
+                    b3 = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(bptr3 + k)));
+                }
+                d00 = _mm256_add_epi32(d00, _mm256_madd_epi16(a0, b0));
+                d01 = _mm256_add_epi32(d01, _mm256_madd_epi16(a0, b1));
+                d02 = _mm256_add_epi32(d02, _mm256_madd_epi16(a0, b2));
+                d03 = _mm256_add_epi32(d03, _mm256_madd_epi16(a0, b3));
+                d10 = _mm256_add_epi32(d10, _mm256_madd_epi16(a1, b0));
+                d11 = _mm256_add_epi32(d11, _mm256_madd_epi16(a1, b1));
+                d12 = _mm256_add_epi32(d12, _mm256_madd_epi16(a1, b2));
+                d13 = _mm256_add_epi32(d13, _mm256_madd_epi16(a1, b3));
+            }
+
+            __m256i t0 = _mm256_hadd_epi32(_mm256_hadd_epi32(d00, d01), _mm256_hadd_epi32(d02, d03));
+            __m256i t1 = _mm256_hadd_epi32(_mm256_hadd_epi32(d10, d11), _mm256_hadd_epi32(d12, d13));
+            _mm_storeu_si128((__m128i*)(cptr0 + n), _mm_add_epi32(_mm256_castsi256_si128(t0),
+                                                                  _mm256_extracti128_si256(t0, 1)));
+            _mm_storeu_si128((__m128i*)(cptr1 + n), _mm_add_epi32(_mm256_castsi256_si128(t1),
+                                                                  _mm256_extracti128_si256(t1, 1)));
+        }
+
+        for( ; n < nb; n++ )
+        {
+            const short* bptr0 = bptr + bstep*n;
+            __m128i d0 = _mm_setzero_si128(), d1 = _mm_setzero_si128();
+            for( int k = 0; k < vecsize; k += 8 )
+            {
+                __m128i b0 = _mm_loadu_si128((const __m128i*)(bptr0 + k));
+                d0 = _mm_add_epi32(d0, _mm_madd_epi16(_mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)(aptr0 + k))), b0));
+                d1 = _mm_add_epi32(d1, _mm_madd_epi16(_mm_cvtepi8_epi16(_mm_loadl_epi64((const __m128i*)(aptr1 + k))), b0));
+            }
+            d0 = _mm_hadd_epi32(d0, d1);
+            d0 = _mm_hadd_epi32(d0, d0);
+            cptr0[n] = _mm_cvtsi128_si32(d0);
+            cptr1[n] = _mm_extract_epi32(d0, 1);
+        }
+    }
+    _mm256_zeroupper();
+}
+
+// Convolution of the channel-blocked blobs, see ConvolutionLayerImpl::BlockedConv. A tile of T output
+// pixels is computed for 2 vectors of output channels, 32 with AVX-512 and 16 with AVX2: every input
+// value is broadcasted and multiplied by both weights vectors. The weights are packed as
+// [inpBlocks][ntaps][8][2*vector size], zero-padded if the number of output channels ocn is less.
+#if CV_AVX512_SKX
+enum { CONV_BLK_VECSZ = 16, CONV_BLK_TILE = 12 };
+typedef __m512 v_conv_blk;
+static inline v_conv_blk convBlkLoad(const float* p) { return _mm512_loadu_ps(p); }
+static inline v_conv_blk convBlkSet1(float v) { return _mm512_set1_ps(v); }
+static inline v_conv_blk convBlkFMA(v_conv_blk a, v_conv_blk b, v_conv_blk c) { return _mm512_fmadd_ps(a, b, c); }
+static inline void convBlkStore(v_conv_blk v, v_conv_blk slope, bool relu, float* out, size_t outBlockStep, int nblocks)
+{
+    if( relu )
+        v = _mm512_mask_mul_ps(v, _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_LT_OQ), v, slope);
+    if( nblocks > 0 )
+        _mm256_storeu_ps(out, _mm512_castps512_ps256(v));
+    if( nblocks > 1 )
+        _mm256_storeu_ps(out + outBlockStep, _mm512_extractf32x8_ps(v, 1));
+}
+#else
+enum { CONV_BLK_VECSZ = 8, CONV_BLK_TILE = 6 };
+typedef __m256 v_conv_blk;
+static inline v_conv_blk convBlkLoad(const float* p) { return _mm256_loadu_ps(p); }
+static inline v_conv_blk convBlkSet1(float v) { return _mm256_set1_ps(v); }
+static inline v_conv_blk convBlkFMA(v_conv_blk a, v_conv_blk b, v_conv_blk c) { return _mm256_fmadd_ps(a, b, c); }
+static inline void convBlkStore(v_conv_blk v, v_conv_blk slope, bool relu, float* out, size_t, int nblocks)
+{
+    if( relu )
+        v = _mm256_blendv_ps(_mm256_mul_ps(v, slope), v, _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ));
+    if( nblocks > 0 )
+        _mm256_storeu_ps(out, v);
+}
+#endif
+
+#define CONV_BLK_INIT(t) v_conv_blk s##t##_0 = b0, s##t##_1 = b1; \
+    const float* inp##t = input + (T > t ? ofstab[t] : 0)
+#define CONV_BLK_FMA(t) if( T > t ) { v_conv_blk x = convBlkSet1(inp##t[ofs + l]); \
+    s##t##_0 = convBlkFMA(x, w0, s##t##_0); s##t##_1 = convBlkFMA(x, w1, s##t##_1); }
+#define CONV_BLK_STORE(t) if( T > t ) { \
+    convBlkStore(s##t##_0, r0, relu != 0, output + t*8, outBlockStep, nblocks); \
+    convBlkStore(s##t##_1, r1, relu != 0, output + t*8 + bpv*outBlockStep, outBlockStep, nblocks - bpv); }
+
+template<int T>
+static inline void convBlockedTile( const float* wptr, const float* input, const int* ofstab,
+                                    int inpBlocks, size_t inpBlockStep, const int* kofs, int ntaps,
+                                    float* output, size_t outBlockStep, int nblocks,
+                                    const float* bias, const float* relu )
+{
+    const int bpv = CONV_BLK_VECSZ/8;
+    const v_conv_blk b0 = convBlkLoad(bias), b1 = convBlkLoad(bias + CONV_BLK_VECSZ);
+    CONV_BLK_INIT(0); CONV_BLK_INIT(1); CONV_BLK_INIT(2); CONV_BLK_INIT(3);
+    CONV_BLK_INIT(4); CONV_BLK_INIT(5); CONV_BLK_INIT(6); CONV_BLK_INIT(7);
+    CONV_BLK_INIT(8); CONV_BLK_INIT(9); CONV_BLK_INIT(10); CONV_BLK_INIT(11);
+
+    for( int i = 0; i < inpBlocks; i++ )
+        for( int k = 0; k < ntaps; k++ )
+        {
+            const size_t ofs = i*inpBlockStep + kofs[k];
+            for( int l = 0; l < 8; l++, wptr += CONV_BLK_VECSZ*2 )
+            {
+                v_conv_blk w0 = convBlkLoad(wptr), w1 = convBlkLoad(wptr + CONV_BLK_VECSZ);
+                CONV_BLK_FMA(0); CONV_BLK_FMA(1); CONV_BLK_FMA(2); CONV_BLK_FMA(3);
+                CONV_BLK_FMA(4); CONV_BLK_FMA(5); CONV_BLK_FMA(6); CONV_BLK_FMA(7);
+                CONV_BLK_FMA(8); CONV_BLK_FMA(9); CONV_BLK_FMA(10); CONV_BLK_FMA(11);
+            }
+        }
+
+    const v_conv_blk r0 = relu ? convBlkLoad(relu) : b0;
+    const v_conv_blk r1 = relu ? convBlkLoad(relu + CONV_BLK_VECSZ) : b1;
+    CONV_BLK_STORE(0); CONV_BLK_STORE(1); CONV_BLK_STORE(2); CONV_BLK_STORE(3);
+    CONV_BLK_STORE(4); CONV_BLK_STORE(5); CONV_BLK_STORE(6); CONV_BLK_STORE(7);
+    CONV_BLK_STORE(8); CONV_BLK_STORE(9); CONV_BLK_STORE(10); CONV_BLK_STORE(11);
+}
+
+#undef CONV_BLK_INIT
+#undef CONV_BLK_FMA
+#undef CONV_BLK_STORE
+
+// The output pixels are taken in a row-major order, ofstab[] are the offsets of their receptive fields
+// in the input block and kofs[] are the offsets of the kernel taps within the receptive field.
+// bias and relu (optional) hold 2*vector size values.
+void fastConvBlocked( const float* weights, int ocn, const float* input,
+                      const int* ofstab, int npix, int inpBlocks, size_t inpBlockStep,
+                      const int* kofs, int ntaps, float* output, size_t outBlockStep,
+                      const float* bias, const float* relu )
+{
+    const int nblocks = ocn/8;
+    int p = 0;
+    for( ; p <= npix - CONV_BLK_TILE; p += CONV_BLK_TILE )
+        convBlockedTile<CONV_BLK_TILE>(weights, input, ofstab + p, inpBlocks, inpBlockStep, kofs, ntaps,
+                                       output + p*8, outBlockStep, nblocks, bias, relu);
+    for( ; p < npix; p++ )
+        convBlockedTile<1>(weights, input, ofstab + p, inpBlocks, inpBlockStep, kofs, ntaps,
+                           output + p*8, outBlockStep, nblocks, bias, relu);
+    _mm256_zeroupper();
+}
+#endif // CV_AVX2
+
 #endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 
 CV_CPU_OPTIMIZATION_NAMESPACE_END
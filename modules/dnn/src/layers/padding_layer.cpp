@@ -83,6 +83,8 @@ public:
         // Add the rest of dimensions.
         for (int i = dstRanges.size(); i < inputs[0]->dims; ++i)
             dstRanges.push_back(Range::all());
+        inputShape = shape(*inputs[0]);
+        outputShape = shape(outputs[0]);
     }
 
     virtual bool supportBackend(int backendId) CV_OVERRIDE
@@ -91,6 +93,18 @@ public:
                backendId == DNN_BACKEND_HALIDE && haveHalide() && dstRanges.size() == 4;
     }
 
+    bool getSpatialZeroPadding(int& top, int& bottom, int& left, int& right) const CV_OVERRIDE
+    {
+        if (paddingType != "constant" || paddingValue != 0.f || outputShape.size() != 4 ||
+            outputShape[0] != inputShape[0] || outputShape[1] != inputShape[1])
+            return false;
+        top = dstRanges[2].start;
+        bottom = outputShape[2] - dstRanges[2].end;
+        left = dstRanges[3].start;
+        right = outputShape[3] - dstRanges[3].end;
+        return true;
+    }
+
     void forward(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr, OutputArrayOfArrays internals_arr) CV_OVERRIDE
     {
         CV_TRACE_FUNCTION();
@@ -169,6 +183,7 @@ public:
 private:
     std::vector<std::pair<int, int> > paddings;  // Pairs pad before, pad after.
     std::vector<Range> dstRanges;
+    MatShape inputShape, outputShape;
     int inputDims;
     float paddingValue;
     std::string paddingType;
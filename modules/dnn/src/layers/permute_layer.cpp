@@ -87,8 +87,24 @@ public:
         }
     }
 
+    // The permutation does not move the data if the axes of size greater than 1 keep their order.
+    bool keepsDataOrder(const MatShape& shapeBefore) const
+    {
+        int prev = -1;
+        for (size_t i = 0; i < _numAxes; i++)
+        {
+            int axis = (int)_order[i];
+            if (shapeBefore[axis] == 1)
+                continue;
+            if (axis < prev)
+                return false;
+            prev = axis;
+        }
+        return true;
+    }
+
     PermuteLayerImpl(const LayerParams &params)
-        : _count(0), _needsPermute(false), _numAxes(0)
+        : _count(0), _needsPermute(false), _keepsDataOrder(true), _numAxes(0)
     {
         if (!params.has("order"))
         {
@@ -152,7 +168,7 @@ public:
             outputs.push_back(shapeAfter);
         }
 
-        return false;
+        return keepsDataOrder(shapeBefore);
     }
 
     void computeStrides(const MatShape &shapeBefore, const MatShape &shapeAfter)
@@ -174,7 +190,8 @@ public:
 
     void finalize(const std::vector<Mat*> &inputs, std::vector<Mat> &outputs) CV_OVERRIDE
     {
-        if(!_needsPermute)
+        _keepsDataOrder = !_needsPermute || keepsDataOrder(shape(*inputs[0]));
+        if(_keepsDataOrder)
         {
             return;
         }
@@ -285,7 +302,7 @@ public:
         inps.getUMatVector(inputs);
         outs.getUMatVector(outputs);
 
-        if (!_needsPermute)
+        if (_keepsDataOrder)
             return false;
 
         for (size_t i = 0; i < inputs.size(); i++)
@@ -326,13 +343,13 @@ public:
         CV_TRACE_ARG_VALUE(name, "name", name.c_str());
 
         size_t k, ninputs = inputs.size();
-        if(!_needsPermute)
+        if(_keepsDataOrder)
         {
             for (k = 0; k < ninputs; k++)
             {
                 CV_Assert(outputs[k].total() == inputs[k]->total());
                 if (outputs[k].data != inputs[k]->data)
-                    inputs[k]->copyTo(outputs[k]);
+                    inputs[k]->reshape(1, shape(outputs[k])).copyTo(outputs[k]);
             }
         }
         else
@@ -408,6 +425,7 @@ public:
     std::vector<size_t> _oldStride;
     std::vector<size_t> _newStride;
     bool _needsPermute;
+    bool _keepsDataOrder;  // for the input shape given to finalize()
 
 #ifdef HAVE_OPENCL
     UMat uorder, uold_stride, unew_stride;
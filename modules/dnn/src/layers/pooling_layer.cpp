@@ -105,11 +105,15 @@ public:
         else
             CV_Error(Error::StsBadArg, "Cannot determine pooling type");
         setParamsFrom(params);
+        blockedLayout = false;
         ceilMode = params.get<bool>("ceil_mode", true);
         spatialScale = params.get<float>("spatial_scale", 1);
         avePoolPaddedArea = params.get<bool>("ave_pool_padded_area", true);
     }
 
+    // the blobs are channel-blocked, see tryUseBlockedLayout()
+    bool blockedLayout;
+
 #ifdef HAVE_OPENCL
     Ptr<OCL4DNNPool<float> > poolOp;
 #endif
@@ -133,6 +137,13 @@ public:
 #endif
     }
 
+    // The indices of the maximal elements refer to NCHW, so only the pooling without them is blocked.
+    virtual bool tryUseBlockedLayout(const std::vector<Mat*> &inputs, const std::vector<Mat> &outputs) CV_OVERRIDE
+    {
+        blockedLayout = !inputs.empty() && (type == MAX && !computeMaxIdx || type == AVE);
+        return blockedLayout;
+    }
+
     virtual bool supportBackend(int backendId) CV_OVERRIDE
     {
         return backendId == DNN_BACKEND_DEFAULT ||
@@ -201,6 +212,14 @@ public:
         CV_TRACE_FUNCTION();
         CV_TRACE_ARG_VALUE(name, "name", name.c_str());
 
+        if (blockedLayout)
+        {
+            CV_Assert(inputs.size() == 1, !outputs.empty());
+            BlockedPoolingInvoker::run(*inputs[0], outputs[0], kernel, stride, pad,
+                                       avePoolPaddedArea, type, getNumThreads());
+            return;
+        }
+
         switch (type)
         {
             case MAX:
@@ -657,6 +676,130 @@ public:
         }
     };
 
+    // Pooling of the channel-blocked blobs: every input pixel is a vector of BLOCKED_CN channels,
+    // so the window is processed for all the channels of a block at once. The borders are handled
+    // in the same way as in PoolingInvoker.
+    class BlockedPoolingInvoker : public ParallelLoopBody
+    {
+    public:
+        const Mat* src;
+        Mat* dst;
+        Size kernel, stride, pad;
+        bool avePoolPaddedArea;
+        int poolingType;
+
+        BlockedPoolingInvoker() : src(0), dst(0), avePoolPaddedArea(false), poolingType(MAX) {}
+
+        static void run(const Mat& src, Mat& dst, Size kernel, Size stride, Size pad,
+                        bool avePoolPaddedArea, int poolingType, int nstripes)
+        {
+            CV_Assert(src.dims == 4 && dst.dims == 4, src.isContinuous() && dst.isContinuous(),
+                      src.type() == CV_32F && dst.type() == CV_32F,
+                      src.size[0] == dst.size[0] && src.size[1] == dst.size[1],
+                      src.size[1] % BLOCKED_CN == 0,
+                      poolingType == MAX || poolingType == AVE);
+
+            BlockedPoolingInvoker p;
+            p.src = &src;
+            p.dst = &dst;
+            p.kernel = kernel;
+            p.stride = stride;
+            p.pad = pad;
+            p.avePoolPaddedArea = avePoolPaddedArea;
+            p.poolingType = poolingType;
+
+            const int nrows = dst.size[0]*dst.size[1]/BLOCKED_CN*dst.size[2];
+            parallel_for_(Range(0, nrows), p, nstripes);
+        }
+
+        void operator()(const Range& r) const CV_OVERRIDE
+        {
+            const int inp_height = src->size[2], inp_width = src->size[3];
+            const int height = dst->size[2], width = dst->size[3];
+            const int kernel_w = kernel.width, kernel_h = kernel.height;
+            const int pad_w = pad.width, pad_h = pad.height;
+            const int stride_w = stride.width, stride_h = stride.height;
+
+            for( int row = r.start; row < r.end; row++ )
+            {
+                const int y0 = row % height, b = row / height;
+                const float* srcData = src->ptr<float>() + (size_t)b*inp_height*inp_width*BLOCKED_CN;
+                float* dstData = dst->ptr<float>() + ((size_t)b*height + y0)*width*BLOCKED_CN;
+
+                int ystart = y0 * stride_h - pad_h;
+                int yend = min(ystart + kernel_h, inp_height + pad_h);
+                const int ydelta = yend - ystart;
+                ystart = max(ystart, 0);
+                yend = min(yend, inp_height);
+
+                for( int x0 = 0; x0 < width; x0++, dstData += BLOCKED_CN )
+                {
+                    int xstart = x0 * stride_w - pad_w;
+                    int xend = min(xstart + kernel_w, inp_width + pad_w);
+                    const int xdelta = xend - xstart;
+                    xstart = max(xstart, 0);
+                    xend = min(xend, inp_width);
+
+                    if( poolingType == MAX && (xstart >= xend || ystart >= yend) )
+                    {
+                        for( int l = 0; l < BLOCKED_CN; l++ )
+                            dstData[l] = 0.f;
+                        continue;
+                    }
+#if CV_SIMD128
+                    v_float32x4 s0, s1;
+                    if( poolingType == MAX )
+                        s0 = s1 = v_setall_f32(-FLT_MAX);
+                    else
+                        s0 = s1 = v_setzero_f32();
+                    for( int y = ystart; y < yend; y++ )
+                    {
+                        const float* srcptr = srcData + ((size_t)y*inp_width + xstart)*BLOCKED_CN;
+                        for( int x = xstart; x < xend; x++, srcptr += BLOCKED_CN )
+                        {
+                            if( poolingType == MAX )
+                            {
+                                s0 = v_max(s0, v_load(srcptr));
+                                s1 = v_max(s1, v_load(srcptr + 4));
+                            }
+                            else
+                            {
+                                s0 += v_load(srcptr);
+                                s1 += v_load(srcptr + 4);
+                            }
+                        }
+                    }
+                    if( poolingType == AVE )
+                    {
+                        float kernel_area = avePoolPaddedArea ? xdelta * ydelta : ((yend - ystart) * (xend - xstart));
+                        v_float32x4 ikarea = v_setall_f32(1.f / kernel_area);
+                        s0 *= ikarea;
+                        s1 *= ikarea;
+                    }
+                    v_store(dstData, s0);
+                    v_store(dstData + 4, s1);
+#else
+                    float s[BLOCKED_CN];
+                    for( int l = 0; l < BLOCKED_CN; l++ )
+                        s[l] = poolingType == MAX ? -FLT_MAX : 0.f;
+                    for( int y = ystart; y < yend; y++ )
+                    {
+                        const float* srcptr = srcData + ((size_t)y*inp_width + xstart)*BLOCKED_CN;
+                        for( int x = xstart; x < xend; x++, srcptr += BLOCKED_CN )
+                            for( int l = 0; l < BLOCKED_CN; l++ )
+                                s[l] = poolingType == MAX ? std::max(s[l], srcptr[l]) : s[l] + srcptr[l];
+                    }
+                    float scale = 1.f;
+                    if( poolingType == AVE )
+                        scale = 1.f / (avePoolPaddedArea ? xdelta * ydelta : ((yend - ystart) * (xend - xstart)));
+                    for( int l = 0; l < BLOCKED_CN; l++ )
+                        dstData[l] = s[l]*scale;
+#endif
+                }
+            }
+        }
+    };
+
     void maxPooling(Mat &src, Mat &dst, Mat &mask)
     {
         const int nstripes = getNumThreads();
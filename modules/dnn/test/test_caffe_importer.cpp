@@ -248,6 +248,28 @@ TEST_P(Reproducibility_ResNet50, Accuracy)
 }
 INSTANTIATE_TEST_CASE_P(/**/, Reproducibility_ResNet50, availableDnnTargets());
 
+TEST(Reproducibility_ResNet50_int8, Accuracy)
+{
+    Net net = readNetFromCaffe(findDataFile("dnn/ResNet-50-deploy.prototxt", false),
+                               findDataFile("dnn/ResNet-50-model.caffemodel", false));
+
+    std::vector<Mat> calibData;
+    calibData.push_back(blobFromImage(imread(_tf("googlenet_0.png")), 1.0f, Size(224,224), Scalar(), false));
+    calibData.push_back(blobFromImage(imread(_tf("googlenet_1.png")), 1.0f, Size(224,224), Scalar(), false));
+    // all the convolutions and the fully connected layer
+    ASSERT_EQ(54, net.quantize(calibData));
+
+    net.setInput(calibData[0]);
+    Mat out = net.forward();
+
+    Mat ref = blobFromNPY(_tf("resnet50_prob.npy"));
+    Point refClass, outClass;
+    minMaxLoc(ref.reshape(1, 1), 0, 0, 0, &refClass);
+    minMaxLoc(out.reshape(1, 1), 0, 0, 0, &outClass);
+    EXPECT_EQ(refClass, outClass);
+    normAssert(ref, out, "", 2e-3, 0.1);
+}
+
 typedef testing::TestWithParam<DNNTarget> Reproducibility_SqueezeNet_v1_1;
 TEST_P(Reproducibility_SqueezeNet_v1_1, Accuracy)
 {
@@ -147,6 +147,66 @@ inline void normAssertDetections(cv::Mat ref, cv::Mat out, const char *comment =
                          testBoxes, comment, confThreshold, scores_diff, boxes_iou_diff);
 }
 
+// Parameters of a Convolution layer with the weights and the bias drawn uniformly from [-0.5, 0.5).
+inline cv::dnn::LayerParams convolutionParams(const std::string& name, int inpCn, int outCn, int kernel,
+                                              int stride, int pad, int group, bool bias, cv::RNG& rng)
+{
+    cv::dnn::LayerParams lp;
+    lp.set("kernel_size", kernel);
+    lp.set("stride", stride);
+    lp.set("pad", pad);
+    lp.set("group", group);
+    lp.set("num_output", outCn);
+    lp.set("bias_term", bias);
+    lp.type = "Convolution";
+    lp.name = name;
+
+    int wgtShape[] = {outCn, inpCn / group, kernel, kernel};
+    cv::Mat weights(4, wgtShape, CV_32F);
+    rng.fill(weights, cv::RNG::UNIFORM, -0.5, 0.5);
+    lp.blobs.push_back(weights);
+    if (bias)
+    {
+        cv::Mat b(1, outCn, CV_32F);
+        rng.fill(b, cv::RNG::UNIFORM, -0.5, 0.5);
+        lp.blobs.push_back(b);
+    }
+    return lp;
+}
+
+// Adds the convolution after the layer inputId, or after the last added layer if inputId < 0.
+inline int addConvolution(cv::dnn::Net& net, const std::string& name, int inputId, int inpCn, int outCn,
+                          int kernel, int stride, int pad, int group, bool bias, cv::RNG& rng)
+{
+    cv::dnn::LayerParams lp = convolutionParams(name, inpCn, outCn, kernel, stride, pad, group, bias, rng);
+    if (inputId < 0)
+        return net.addLayerToPrev(lp.name, lp.type, lp);
+    int id = net.addLayer(lp.name, lp.type, lp);
+    net.connect(inputId, 0, id, 0);
+    return id;
+}
+
+// Small network of 3x3 convolutions with a residual connection, 3 input and 4 output channels.
+inline cv::dnn::Net createResidualNet(int seed)
+{
+    cv::RNG rng(seed);
+    cv::dnn::Net net;
+    int conv1 = addConvolution(net, "conv1", -1, 3, 8, 3, 1, 1, 1, false, rng);
+    addConvolution(net, "conv2", -1, 8, 16, 3, 1, 1, 1, false, rng);
+    cv::dnn::LayerParams lp;
+    lp.type = "ReLU";
+    lp.name = "relu2";
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    addConvolution(net, "conv3", -1, 16, 8, 3, 1, 1, 1, false, rng);
+    lp.type = "Eltwise";
+    lp.name = "sum";
+    int sumId = net.addLayerToPrev(lp.name, lp.type, lp);
+    net.connect(conv1, 0, sumId, 1);
+    addConvolution(net, "conv4", -1, 8, 16, 3, 1, 1, 1, false, rng);
+    addConvolution(net, "conv5", -1, 16, 4, 3, 1, 1, 1, false, rng);
+    return net;
+}
+
 inline bool readFileInMemory(const std::string& filename, std::string& content)
 {
     std::ios::openmode mode = std::ios::in | std::ios::binary;
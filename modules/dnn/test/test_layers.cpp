@@ -748,6 +748,435 @@ TEST(Layer_Test_Average_pooling_kernel_area, Accuracy)
     normAssert(out, blobFromImage(target));
 }
 
+// Compare Winograd transforms with im2row for 3x3 convolutions.
+typedef testing::TestWithParam<tuple<Vec4i, int, int, bool, bool> > Convolution_Winograd;
+TEST_P(Convolution_Winograd, Accuracy)
+{
+    Vec4i inpShapeVec = get<0>(GetParam());  // NCHW
+    int outCn = get<1>(GetParam());
+    int pad = get<2>(GetParam());
+    bool hasBias = get<3>(GetParam());
+    bool hasReLU = get<4>(GetParam());
+
+    RNG rng(0);
+    const LayerParams convParams = convolutionParams("testConv", inpShapeVec[1], outCn, 3, 1, pad, 1, hasBias, rng);
+    Mat input(4, &inpShapeVec[0], CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Mat outs[2];
+    for (int i = 0; i < 2; i++)
+    {
+        LayerParams lp = convParams;
+        lp.set("use_winograd", i == 0);
+
+        Net net;
+        net.addLayerToPrev(lp.name, lp.type, lp);
+        if (hasReLU)
+        {
+            LayerParams reluParams;
+            reluParams.set("negative_slope", 0.1);
+            reluParams.type = "ReLU";
+            reluParams.name = "testReLU";
+            net.addLayerToPrev(reluParams.name, reluParams.type, reluParams);
+        }
+        net.setInput(input);
+        outs[i] = net.forward().clone();
+    }
+    normAssert(outs[1], outs[0], "", 1e-5, 2e-4);
+}
+
+INSTANTIATE_TEST_CASE_P(Layer_Test, Convolution_Winograd, Combine(
+/*input shape*/ Values(Vec4i(1, 8, 24, 24), Vec4i(2, 16, 29, 22), Vec4i(1, 10, 22, 37)),
+/*num_output*/  Values(8, 13),
+/*pad*/         Values(0, 1),
+/*bias*/        testing::Bool(),
+/*ReLU*/        testing::Bool()
+));
+
+// Compare int8 convolution with the floating point one.
+typedef testing::TestWithParam<tuple<int, int, int, int> > Convolution_Int8;
+TEST_P(Convolution_Int8, Accuracy)
+{
+    int kernel = get<0>(GetParam());
+    int stride = get<1>(GetParam());
+    int dilation = get<2>(GetParam());
+    int group = get<3>(GetParam());
+    const int inpCn = 8, outCn = 6;
+
+    RNG rng(0);
+    LayerParams lp = convolutionParams("testConv", inpCn, outCn, kernel, stride, 1, group, true, rng);
+    lp.set("dilation", dilation);
+    int inpShape[] = {2, inpCn, 11, 13};
+    Mat input(4, inpShape, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setInput(input);
+    Mat ref = net.forward().clone();
+
+    ASSERT_EQ(1, net.quantize(std::vector<Mat>(1, input)));
+    net.setInput(input);
+    Mat out = net.forward();
+    EXPECT_LE(cvtest::norm(ref, out, NORM_L2), 0.02 * cvtest::norm(ref, NORM_L2));
+}
+
+INSTANTIATE_TEST_CASE_P(Layer_Test, Convolution_Int8, Combine(
+/*kernel*/      Values(1, 3, 5),
+/*stride*/      Values(1, 2),
+/*dilation*/    Values(1, 2),
+/*group*/       Values(1, 2)
+));
+
+// Compare depthwise convolution with the dense one which has zero weights between different channels.
+typedef testing::TestWithParam<tuple<int, int, int, bool, int> > Convolution_Depthwise;
+TEST_P(Convolution_Depthwise, Accuracy)
+{
+    int kernel = get<0>(GetParam());
+    int stride = get<1>(GetParam());
+    int dilation = get<2>(GetParam());
+    int pad = get<3>(GetParam()) ? kernel / 2 * dilation : 0;
+    int activ = get<4>(GetParam());  // 0 - none, 1 - leaky ReLU, 2 - ReLU6
+    const int cn = 8;
+
+    RNG rng(0);
+    LayerParams depthwiseParams = convolutionParams("testConv", cn, cn, kernel, stride, pad, cn, true, rng);
+    depthwiseParams.set("dilation", dilation);
+    Mat weights = depthwiseParams.blobs[0];
+    int denseShape[] = {cn, cn, kernel, kernel};
+    Mat denseWeights(4, denseShape, CV_32F, Scalar(0));
+    for (int c = 0; c < cn; c++)
+        Mat(kernel, kernel, CV_32F, weights.ptr<float>(c)).copyTo(
+            Mat(kernel, kernel, CV_32F, denseWeights.ptr<float>(c, c)));
+    int inpShape[] = {2, cn, 17, 23};
+    Mat input(4, inpShape, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Mat outs[2];
+    for (int i = 0; i < 2; i++)
+    {
+        LayerParams lp = depthwiseParams;
+        if (i == 1)
+        {
+            lp.set("group", 1);
+            lp.blobs[0] = denseWeights;
+        }
+
+        Net net;
+        net.addLayerToPrev(lp.name, lp.type, lp);
+        if (activ == 1)
+        {
+            LayerParams reluParams;
+            reluParams.set("negative_slope", 0.1);
+            reluParams.type = "ReLU";
+            reluParams.name = "testReLU";
+            net.addLayerToPrev(reluParams.name, reluParams.type, reluParams);
+        }
+        else if (activ == 2)
+        {
+            LayerParams relu6Params;
+            relu6Params.set("min_value", 0.f);
+            relu6Params.set("max_value", 1.f);
+            relu6Params.type = "ReLU6";
+            relu6Params.name = "testReLU6";
+            net.addLayerToPrev(relu6Params.name, relu6Params.type, relu6Params);
+        }
+        net.setInput(input);
+        outs[i] = net.forward().clone();
+    }
+    normAssert(outs[1], outs[0], "", 1e-5, 1e-4);
+}
+
+INSTANTIATE_TEST_CASE_P(Layer_Test, Convolution_Depthwise, Combine(
+/*kernel*/      Values(3, 5),
+/*stride*/      Values(1, 2),
+/*dilation*/    Values(1, 2),
+/*pad*/         testing::Bool(),
+/*activation*/  Values(0, 1, 2)
+));
+
+// Compare the channel-blocked layout with NCHW on a residual block where the blocked layers
+// read and write converted, blocked and user-visible blobs.
+typedef testing::TestWithParam<tuple<int, int, std::string> > Layer_Test_BlockedLayout;
+TEST_P(Layer_Test_BlockedLayout, Accuracy)
+{
+    int kernel = get<0>(GetParam());
+    int stride = get<1>(GetParam());
+    std::string pool = get<2>(GetParam());
+    const int cn = 16;
+
+    RNG rng(0);
+    int inpShape[] = {2, 3, 19, 21};
+    Mat input(4, inpShape, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Net net;
+    int inpCn = inpShape[1];
+    const int kernels[] = {3, kernel, 1};
+    const int strides[] = {1, stride, 1};
+    int convIds[3];
+    for (int i = 0; i < 3; i++)
+    {
+        LayerParams lp = convolutionParams(cv::format("conv%d", i), inpCn, cn, kernels[i], strides[i],
+                                           kernels[i] / 2, 1, true, rng);
+        lp.set("use_winograd", false);
+        convIds[i] = net.addLayerToPrev(lp.name, lp.type, lp);
+        inpCn = cn;
+
+        if (i == 1)
+        {
+            LayerParams relu;
+            relu.set("negative_slope", 0.1);
+            relu.type = "ReLU";
+            relu.name = "relu";
+            net.addLayerToPrev(relu.name, relu.type, relu);
+
+            LayerParams poolParams;
+            poolParams.set("pool", pool);
+            poolParams.set("kernel_size", 3);
+            poolParams.set("stride", 2);
+            poolParams.set("pad", 1);
+            poolParams.type = "Pooling";
+            poolParams.name = "pool";
+            net.addLayerToPrev(poolParams.name, poolParams.type, poolParams);
+
+            LayerParams bn;
+            bn.set("has_weight", true);
+            bn.set("has_bias", true);
+            for (int j = 0; j < 4; j++)
+            {
+                Mat blob(1, cn, CV_32F);
+                rng.fill(blob, RNG::UNIFORM, j == 1 ? 0.5 : -1, 1);
+                bn.blobs.push_back(blob);
+            }
+            bn.type = "BatchNorm";
+            bn.name = "bn";
+            net.addLayerToPrev(bn.name, bn.type, bn);
+
+            LayerParams sigmoid;
+            sigmoid.type = "Sigmoid";
+            sigmoid.name = "sigmoid";
+            net.addLayerToPrev(sigmoid.name, sigmoid.type, sigmoid);
+        }
+    }
+    LayerParams eltwise;
+    eltwise.type = "Eltwise";
+    eltwise.name = "eltwise";
+    int eltwiseId = net.addLayer(eltwise.name, eltwise.type, eltwise);
+    net.connect(convIds[2] - 1, 0, eltwiseId, 0);
+    net.connect(convIds[2], 0, eltwiseId, 1);
+
+    std::vector<String> outNames;
+    outNames.push_back("eltwise");
+    outNames.push_back("pool");
+    std::vector<Mat> refs, outs;
+    net.enableBlockedLayout(false);
+    net.setInput(input);
+    net.forward(refs, outNames);
+    refs[0] = refs[0].clone();
+    refs[1] = refs[1].clone();
+
+    net.enableBlockedLayout(true);
+    net.setInput(input);
+    net.forward(outs, outNames);
+    normAssert(refs[0], outs[0], "eltwise", 1e-5, 1e-4);
+    normAssert(refs[1], outs[1], "pool", 1e-5, 1e-4);
+
+    // an intermediate blob requested alone
+    net.setInput(input);
+    Mat bnOut = net.forward("bn").clone();
+    net.enableBlockedLayout(false);
+    net.setInput(input);
+    normAssert(net.forward("bn"), bnOut, "bn", 1e-5, 1e-4);
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_BlockedLayout, Combine(
+/*kernel*/      Values(1, 3, 5),
+/*stride*/      Values(1, 2),
+/*pooling*/     Values("max", "ave")
+));
+
+// Runs the network with all the fusion passes but the given ones and returns the fused layers.
+static Mat forwardFused(Net& net, const Mat& input, int disabledPasses,
+                        std::vector<String>& fusedNames, std::vector<int>& fusedPasses)
+{
+    net.setFusionPasses(DNN_FUSION_ALL & ~disabledPasses);
+    net.setInput(input);
+    Mat out = net.forward().clone();
+    net.getFusedLayers(fusedNames, fusedPasses);
+    return out;
+}
+
+static int fusedPass(const std::vector<String>& fusedNames, const std::vector<int>& fusedPasses,
+                     const std::string& name)
+{
+    for (size_t i = 0; i < fusedNames.size(); i++)
+    {
+        if (fusedNames[i] == name)
+            return fusedPasses[i];
+    }
+    return 0;
+}
+
+// SSD-like detection head: the outputs of the convolutions are permuted to NHWC, flattened and
+// concatenated. The permutation of the 1x1 map keeps the data in place.
+TEST(Layer_Test_Fusion, concat_of_views)
+{
+    RNG rng(0);
+    int inpShape[] = {1, 8, 6, 7};
+    Mat input(4, inpShape, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    Net net;
+    LayerParams lp;
+    int flattenIds[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int id = 0;
+        if (i < 2)
+        {
+            id = addConvolution(net, cv::format("conv%d", i), 0, 8, 4 + 8 * i, 3, 1, 1, 1, true, rng);
+        }
+        else
+        {
+            lp = LayerParams();
+            lp.set("pool", "ave");
+            lp.set("global_pooling", true);
+            lp.type = "Pooling";
+            lp.name = "pool";
+            id = net.addLayer(lp.name, lp.type, lp);
+            net.connect(0, 0, id, 0);
+        }
+
+        lp = LayerParams();
+        int order[] = {0, 2, 3, 1};
+        lp.set("order", DictValue::arrayInt(&order[0], 4));
+        lp.type = "Permute";
+        lp.name = cv::format("permute%d", i);
+        int permuteId = net.addLayer(lp.name, lp.type, lp);
+        net.connect(id, 0, permuteId, 0);
+
+        lp = LayerParams();
+        lp.type = "Flatten";
+        lp.name = cv::format("flatten%d", i);
+        flattenIds[i] = net.addLayer(lp.name, lp.type, lp);
+        net.connect(permuteId, 0, flattenIds[i], 0);
+    }
+    lp = LayerParams();
+    lp.set("axis", 1);
+    lp.type = "Concat";
+    lp.name = "concat";
+    int concatId = net.addLayer(lp.name, lp.type, lp);
+    for (int i = 0; i < 3; i++)
+        net.connect(flattenIds[i], 0, concatId, i);
+
+    std::vector<String> names;
+    std::vector<int> passes;
+    Mat ref = forwardFused(net, input, DNN_FUSION_ALL, names, passes);
+    EXPECT_TRUE(names.empty());
+    ASSERT_EQ(2, ref.dims);
+    ASSERT_EQ((6 * 7) * (4 + 12) + 8, ref.size[1]);
+
+    Mat out = forwardFused(net, input, 0, names, passes);
+    normAssert(ref, out);
+    EXPECT_EQ(DNN_FUSION_CONCAT, fusedPass(names, passes, "concat"));
+    EXPECT_EQ(DNN_FUSION_VIEW, fusedPass(names, passes, "flatten0"));
+    EXPECT_EQ(DNN_FUSION_VIEW, fusedPass(names, passes, "flatten1"));
+    EXPECT_EQ(DNN_FUSION_VIEW, fusedPass(names, passes, "permute2"));
+    EXPECT_EQ(0, fusedPass(names, passes, "permute0"));
+
+    // Flatten layers computed separately write to the concatenated blob.
+    out = forwardFused(net, input, DNN_FUSION_VIEW, names, passes);
+    normAssert(ref, out);
+    EXPECT_EQ(DNN_FUSION_CONCAT, fusedPass(names, passes, "concat"));
+    EXPECT_EQ(0, fusedPass(names, passes, "flatten0"));
+
+    out = forwardFused(net, input, DNN_FUSION_CONCAT, names, passes);
+    normAssert(ref, out);
+    EXPECT_EQ(0, fusedPass(names, passes, "concat"));
+}
+
+// Zero padding before a convolution computed by the generic, Winograd and depthwise kernels.
+typedef testing::TestWithParam<tuple<int, int, int> > Layer_Test_Fusion_Padding;
+TEST_P(Layer_Test_Fusion_Padding, Accuracy)
+{
+    int kernel = get<0>(GetParam());
+    int stride = get<1>(GetParam());
+    int group = get<2>(GetParam());
+    const int cn = 8;
+
+    RNG rng(0);
+    Net net;
+    LayerParams lp;
+    int paddings[] = {0, 0, 0, 0, 2, 1, 0, 3};
+    lp.set("paddings", DictValue::arrayInt(&paddings[0], 8));
+    lp.type = "Padding";
+    lp.name = "padding";
+    int paddingId = net.addLayerToPrev(lp.name, lp.type, lp);
+    addConvolution(net, "conv", paddingId, cn, cn, kernel, stride, 1, group, true, rng);
+
+    for (int size = 0; size < 2; size++)
+    {
+        int inpShape[] = {1, cn, 19 + size * 6, 23 - size * 4};
+        Mat input(4, inpShape, CV_32F);
+        rng.fill(input, RNG::UNIFORM, -1, 1);
+
+        std::vector<String> names;
+        std::vector<int> passes;
+        Mat ref = forwardFused(net, input, DNN_FUSION_PADDING, names, passes);
+        Mat out = forwardFused(net, input, 0, names, passes);
+        normAssert(ref, out, "", 1e-5, 1e-4);
+        EXPECT_EQ(DNN_FUSION_PADDING, fusedPass(names, passes, "padding"));
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Test_Fusion_Padding, Combine(
+/*kernel*/      Values(3, 5),
+/*stride*/      Values(1, 2),
+/*group*/       Values(1, 8)
+));
+
+// A 1x1 convolution is merged into the preceding one unless it takes more operations.
+TEST(Layer_Test_Fusion, pointwise)
+{
+    RNG rng(0);
+    int inpShape[] = {2, 4, 9, 11};
+    Mat input(4, inpShape, CV_32F);
+    rng.fill(input, RNG::UNIFORM, -1, 1);
+
+    for (int outCn = 3; outCn <= 32; outCn += 29)
+    {
+        Net net;
+        addConvolution(net, "conv", 0, 4, 6, 3, 2, 1, 1, true, rng);
+        LayerParams lp;
+        lp.set("bias_term", true);
+        Mat scale(1, 6, CV_32F), shift(1, 6, CV_32F);
+        rng.fill(scale, RNG::UNIFORM, 0.5, 2);
+        rng.fill(shift, RNG::UNIFORM, -1, 1);
+        lp.blobs.push_back(scale);
+        lp.blobs.push_back(shift);
+        lp.type = "Scale";
+        lp.name = "scale";
+        int scaleId = net.addLayerToPrev(lp.name, lp.type, lp);
+        addConvolution(net, "pointwise", scaleId, 6, outCn, 1, 1, 0, 1, true, rng);
+        lp = LayerParams();
+        lp.set("negative_slope", 0.1);
+        lp.type = "ReLU";
+        lp.name = "relu";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+
+        std::vector<String> names;
+        std::vector<int> passes;
+        Mat ref = forwardFused(net, input, DNN_FUSION_POINTWISE, names, passes);
+        EXPECT_EQ(0, fusedPass(names, passes, "pointwise"));
+        EXPECT_EQ(DNN_FUSION_ACTIVATION, fusedPass(names, passes, "scale"));
+        Mat out = forwardFused(net, input, 0, names, passes);
+        normAssert(ref, out, "", 1e-5, 1e-4);
+        EXPECT_EQ(outCn == 3 ? DNN_FUSION_POINTWISE : 0, fusedPass(names, passes, "pointwise"));
+        EXPECT_EQ(DNN_FUSION_ACTIVATION, fusedPass(names, passes, "relu"));
+    }
+}
+
 // Test PriorBoxLayer in case of no aspect ratios (just squared proposals).
 TEST(Layer_PriorBox, squares)
 {
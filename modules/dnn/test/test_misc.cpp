@@ -9,6 +9,8 @@
 
 #include <opencv2/dnn/layer.details.hpp>  // CV_DNN_REGISTER_LAYER_CLASS
 
+#include <thread>
+
 namespace opencv_test { namespace {
 
 TEST(blobFromImage_4ch, Regression)
@@ -137,4 +139,205 @@ TEST(LayerFactory, custom_layers)
     LayerFactory::unregisterLayer("CustomType");
 }
 
+TEST(Net, activation_memory)
+{
+    Mat inp(std::vector<int>{1, 3, 20, 24}, CV_32F);
+    randu(inp, -1, 1);
+
+    Net net = createResidualNet(0);
+    net.setInput(inp);
+    Mat out = net.forward().clone();
+
+    size_t allocated = 0, peak = 0;
+    net.getActivationMemory(allocated, peak);
+    const size_t plane = 20 * 24 * sizeof(float);
+    // conv4 and conv5 outputs are alive at the same time, and conv5 output is not shared
+    EXPECT_GE(peak, (16 + 4) * plane);
+    EXPECT_GE(allocated, peak);
+    // the greedy reuse of the blobs without planning allocates 48 planes for this net
+    EXPECT_LT(allocated, 48 * plane);
+
+    // Keep outputs of all the layers so no memory is reused.
+    std::vector<String> names = net.getLayerNames();
+    std::vector<Mat> outs;
+    net.setInput(inp);
+    net.forward(outs, names);
+    ASSERT_EQ(names.size(), outs.size());
+    normAssert(out, outs.back());
+
+    size_t allocatedAll = 0, peakAll = 0;
+    net.getActivationMemory(allocatedAll, peakAll);
+    EXPECT_GE(allocatedAll, peakAll);
+    EXPECT_LT(allocated, allocatedAll);
+    EXPECT_LE(peak, peakAll);
+}
+
+TEST(Net, shareActivationArena)
+{
+    Mat inp1(std::vector<int>{1, 3, 16, 16}, CV_32F), inp2(std::vector<int>{1, 3, 24, 20}, CV_32F);
+    randu(inp1, -1, 1);
+    randu(inp2, -1, 1);
+
+    Net net1 = createResidualNet(1), net2 = createResidualNet(2);
+    net1.setInput(inp1);
+    Mat ref1 = net1.forward().clone();
+    net2.setInput(inp2);
+    Mat ref2 = net2.forward().clone();
+
+    net1 = createResidualNet(1);
+    net2 = createResidualNet(2);
+    net2.shareActivationArena(net1);
+    for (int i = 0; i < 2; i++)
+    {
+        net1.setInput(inp1);
+        Mat out1 = net1.forward();
+        net2.setInput(inp2);
+        Mat out2 = net2.forward();
+        // the outputs are not in the arena
+        normAssert(ref1, out1);
+        normAssert(ref2, out2);
+    }
+}
+
+TEST(Net, quantize)
+{
+    Net net = createResidualNet(4);
+    LayerParams lp;
+    lp.set("num_output", 10);
+    lp.type = "InnerProduct";
+    lp.name = "fc";
+    RNG rng(5);
+    Mat weights(10, 4 * 12 * 10, CV_32F), bias(1, 10, CV_32F);
+    rng.fill(weights, RNG::UNIFORM, -0.5, 0.5);
+    rng.fill(bias, RNG::UNIFORM, -0.5, 0.5);
+    lp.blobs.push_back(weights);
+    lp.blobs.push_back(bias);
+    net.addLayerToPrev(lp.name, lp.type, lp);
+
+    std::vector<Mat> calibData(4);
+    for (size_t i = 0; i < calibData.size(); i++)
+    {
+        calibData[i].create(std::vector<int>{2, 3, 12, 10}, CV_32F);
+        randu(calibData[i], -1, 1);
+    }
+    Mat inp(std::vector<int>{3, 3, 12, 10}, CV_32F);
+    randu(inp, -1, 1);
+    net.setInput(inp);
+    Mat ref = net.forward().clone();
+
+    // 5 convolutions and the fully connected layer
+    EXPECT_EQ(6, net.quantize(calibData));
+    net.setInput(inp);
+    Mat out = net.forward().clone();
+    EXPECT_GT(cvtest::norm(ref, out, NORM_INF), 0);
+    EXPECT_LE(cvtest::norm(ref, out, NORM_L2), 0.03 * cvtest::norm(ref, NORM_L2));
+
+    // recalibration gives the same result
+    EXPECT_EQ(6, net.quantize(calibData));
+    net.setInput(inp);
+    normAssert(out, net.forward(), "", 0, 0);
+}
+
+TEST(BatchingExecutor, concurrent_requests)
+{
+    const int numThreads = 6, numRequests = 3;
+    std::vector<Mat> inputs(numThreads * numRequests), refs(inputs.size());
+    Net ref = createResidualNet(3);
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        // requests of two samples are batched together with single ones
+        inputs[i].create(std::vector<int>{1 + (int)i % 2, 3, 12, 10}, CV_32F);
+        randu(inputs[i], -1, 1);
+        ref.setInput(inputs[i]);
+        refs[i] = ref.forward().clone();
+    }
+
+    std::vector<Mat> outputs(inputs.size());
+    {
+        BatchingExecutor executor(createResidualNet(3), 4, 10.);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++)
+        {
+            threads.push_back(std::thread([&, t]() {
+                for (int i = 0; i < numRequests; i++)
+                    outputs[t * numRequests + i] = executor.forward(inputs[t * numRequests + i]);
+            }));
+        }
+        for (size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
+
+        int64 batches = 0, samples = 0;
+        executor.getStatistics(batches, samples);
+        EXPECT_EQ(27, samples);
+        EXPECT_LE(batches, (int64)inputs.size());
+        EXPECT_GE(batches, 7);
+
+        // a request which does not fit into a batch is processed alone
+        Mat big(std::vector<int>{5, 3, 12, 10}, CV_32F);
+        randu(big, -1, 1);
+        ref.setInput(big);
+        normAssert(ref.forward(), executor.forward(big));
+
+        // errors are reported to the caller and don't stop the executor
+        Mat wrongChannels(std::vector<int>{1, 2, 12, 10}, CV_32F, Scalar(0));
+        EXPECT_ANY_THROW(executor.forward(wrongChannels));
+        normAssert(refs[0], executor.forward(inputs[0]));
+    }
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        SCOPED_TRACE(cv::format("request %d", (int)i));
+        normAssert(refs[i], outputs[i]);
+    }
+}
+
+// Passes the input through and records its batch size.
+class BatchSizeLayer CV_FINAL : public Layer
+{
+public:
+    BatchSizeLayer(const LayerParams &params) : Layer(params) {}
+
+    static Ptr<Layer> create(LayerParams& params)
+    {
+        return Ptr<Layer>(new BatchSizeLayer(params));
+    }
+
+    virtual void forward(InputArrayOfArrays, OutputArrayOfArrays, OutputArrayOfArrays) CV_OVERRIDE {}
+    virtual void forward(std::vector<Mat*> &inputs, std::vector<Mat> &outputs, std::vector<Mat>& internals) CV_OVERRIDE
+    {
+        inputs[0]->copyTo(outputs[0]);
+        batchSizes.push_back(inputs[0]->size[0]);
+    }
+
+    static std::vector<int> batchSizes;
+};
+std::vector<int> BatchSizeLayer::batchSizes;
+
+TEST(BatchingExecutor, padded_batch_size)
+{
+    CV_DNN_REGISTER_LAYER_CLASS(BatchSize, BatchSizeLayer);
+    Net net = createResidualNet(3);
+    LayerParams lp;
+    lp.type = "BatchSize";
+    lp.name = "batch_size";
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    BatchSizeLayer::batchSizes.clear();
+
+    Net ref = createResidualNet(3);
+    {
+        // a lone request is not padded up to maxBatchSize, bigger ones up to a power of two
+        BatchingExecutor executor(net, 8, 0.);
+        const int samples[] = {1, 3, 5, 8, 11};
+        for (int i = 0; i < 5; i++)
+        {
+            Mat inp(std::vector<int>{samples[i], 3, 12, 10}, CV_32F);
+            randu(inp, -1, 1);
+            ref.setInput(inp);
+            normAssert(ref.forward(), executor.forward(inp));
+        }
+    }
+    LayerFactory::unregisterLayer("BatchSize");
+    const int expected[] = {1, 4, 8, 8, 11};
+    EXPECT_EQ(std::vector<int>(expected, expected + 5), BatchSizeLayer::batchSizes);
+}
+
 }} // namespace
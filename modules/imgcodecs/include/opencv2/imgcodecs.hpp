@@ -74,7 +74,19 @@ enum ImreadModes {
        IMREAD_REDUCED_COLOR_4      = 33, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/4.
        IMREAD_REDUCED_GRAYSCALE_8  = 64, //!< If set, always convert image to the single channel grayscale image and the image size reduced 1/8.
        IMREAD_REDUCED_COLOR_8      = 65, //!< If set, always convert image to the 3 channel BGR color image and the image size reduced 1/8.
-       IMREAD_IGNORE_ORIENTATION   = 128 //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_IGNORE_ORIENTATION   = 128, //!< If set, do not rotate the image according to EXIF's orientation flag.
+       IMREAD_YUV_I420             = 256, //!< If set, return the 4:2:0 YCbCr planes (Y, Cb, Cr) in the single channel image of cv::COLOR_YUV2BGR_I420 layout, see cv::imread.
+       IMREAD_YUV_NV12             = 512  //!< If set, return the Y plane and the interleaved CbCr plane in the single channel image of cv::COLOR_YUV2BGR_NV12 layout, see cv::imread.
+     };
+
+//! Imread parameters, passed to cv::imread and cv::imdecode as pairs (paramId, paramValue)
+enum ImreadParams {
+       IMREAD_PARAM_ROI_X          = 1, //!< Left coordinate of the region to decode. Default value is 0.
+       IMREAD_PARAM_ROI_Y          = 2, //!< Top coordinate of the region to decode. Default value is 0.
+       IMREAD_PARAM_ROI_WIDTH      = 3, //!< Width of the region to decode. Default value is 0 - up to the right border.
+       IMREAD_PARAM_ROI_HEIGHT     = 4, //!< Height of the region to decode. Default value is 0 - up to the bottom border.
+       IMREAD_PARAM_MIN_WIDTH      = 5, //!< For JPEG, the region is decoded at the smallest DCT scale (1/2, 1/4, 1/8) keeping at least this width. Default value is 0.
+       IMREAD_PARAM_MIN_HEIGHT     = 6  //!< For JPEG, the region is decoded at the smallest DCT scale (1/2, 1/4, 1/8) keeping at least this height. Default value is 0.
      };
 
 //! Imwrite flags
@@ -88,6 +100,7 @@ enum ImwriteFlags {
        IMWRITE_PNG_COMPRESSION     = 16, //!< For PNG, it can be the compression level from 0 to 9. A higher value means a smaller size and longer compression time. If specified, strategy is changed to IMWRITE_PNG_STRATEGY_DEFAULT (Z_DEFAULT_STRATEGY). Default value is 1 (best speed setting).
        IMWRITE_PNG_STRATEGY        = 17, //!< One of cv::ImwritePNGFlags, default is IMWRITE_PNG_STRATEGY_RLE.
        IMWRITE_PNG_BILEVEL         = 18, //!< Binary level PNG, 0 or 1, default is 0.
+       IMWRITE_PNG_FILTER          = 19, //!< One or a combination of cv::ImwritePNGFilterFlags. Default is IMWRITE_PNG_FILTER_SUB, or IMWRITE_PNG_FILTER_ALL if IMWRITE_PNG_COMPRESSION is specified.
        IMWRITE_PXM_BINARY          = 32, //!< For PPM, PGM, or PBM, it can be a binary format flag, 0 or 1. Default value is 1.
        IMWRITE_EXR_TYPE            = (3 << 4) + 0, /* 48 */ //!< override EXR storage type (FLOAT (FP32) is default)
        IMWRITE_WEBP_QUALITY        = 64, //!< For WEBP, it can be a quality from 1 to 100 (the higher is the better). By default (without any parameter) and for quality above 100 the lossless compression is used.
@@ -119,6 +132,23 @@ enum ImwritePNGFlags {
        IMWRITE_PNG_STRATEGY_FIXED        = 4  //!< Using this value prevents the use of dynamic Huffman codes, allowing for a simpler decoder for special applications.
      };
 
+/** Row filters of PNG images. If several filters are combined, the filter is chosen for every row separately.
+
+IMWRITE_PNG_FILTER_SUB (the default) or IMWRITE_PNG_FILTER_NONE with IMWRITE_PNG_COMPRESSION 1 and
+IMWRITE_PNG_STRATEGY_RLE gives the fastest compression, IMWRITE_PNG_FILTER_ALL with higher compression levels
+gives the smallest files. Large images are compressed in parallel when several threads are available
+(see cv::setNumThreads): the rows are split into independent blocks which are joined into one valid stream.
+*/
+enum ImwritePNGFilterFlags {
+       IMWRITE_PNG_FILTER_NONE  = 8,   //!< Store the rows as they are.
+       IMWRITE_PNG_FILTER_SUB   = 16,  //!< Difference with the left pixel.
+       IMWRITE_PNG_FILTER_UP    = 32,  //!< Difference with the pixel above.
+       IMWRITE_PNG_FILTER_AVG   = 64,  //!< Difference with the average of the left and the above pixels.
+       IMWRITE_PNG_FILTER_PAETH = 128, //!< Difference with the Paeth predictor.
+       IMWRITE_PNG_FILTER_FAST  = (IMWRITE_PNG_FILTER_NONE | IMWRITE_PNG_FILTER_SUB | IMWRITE_PNG_FILTER_UP), //!< Cheap filters only.
+       IMWRITE_PNG_FILTER_ALL   = (IMWRITE_PNG_FILTER_FAST | IMWRITE_PNG_FILTER_AVG | IMWRITE_PNG_FILTER_PAETH) //!< All filters.
+     };
+
 //! Imwrite PAM specific tupletype flags used to define the 'TUPETYPE' field of a PAM file.
 enum ImwritePAMFlags {
        IMWRITE_PAM_FORMAT_NULL = 0,
@@ -170,11 +200,37 @@ Currently, the following file formats are supported:
     [Vector](http://www.gdal.org/ogr_formats.html).
 -   If EXIF information are embedded in the image file, the EXIF orientation will be taken into account
     and thus the image will be rotated accordingly except if the flag @ref IMREAD_IGNORE_ORIENTATION is passed.
+-   On Unix-like systems the file can be memory-mapped and decoded in place by the decoders which support
+    memory buffers, by setting the OPENCV_IMGCODECS_USE_MMAP environment variable to 1. The file must not
+    be truncated or replaced while it is read then, e.g. on a network file system, otherwise the process
+    gets SIGBUS. By default the file is read with stdio.
+-   With @ref IMREAD_YUV_I420 or @ref IMREAD_YUV_NV12 the image is returned as the full range (JFIF)
+    YCbCr planes with the chroma subsampled 2x2, in a CV_8UC1 matrix of (height*3/2) x width. The width
+    and the height are rounded up to even numbers by replicating the last column and row. JPEG images
+    with the YCbCr or grayscale color space are decoded directly to the planes, without the color
+    conversion (and usually without the chroma upsampling), other images are converted from BGR.
+    The EXIF orientation is not applied to such images, the other flags except the reduction ones are ignored.
 @param filename Name of file to be loaded.
 @param flags Flag that can take values of cv::ImreadModes
 */
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+/** @brief Loads a region of an image from a file.
+
+The function decodes only the requested region of the image, which is specified in the coordinates
+of the image imread would return with the same flags, before the EXIF orientation is applied.
+JPEG, PNG (not interlaced) and TIFF decoders stop reading after the bottom of the region, and TIFF
+decoder reads only the tiles intersecting it. Other formats are decoded completely and cropped.
+If IMREAD_PARAM_MIN_WIDTH or IMREAD_PARAM_MIN_HEIGHT is given, the JPEG decoder additionally
+reduces the region with the strongest DCT scaling that keeps it not smaller than requested;
+other decoders return the region in full resolution.
+
+@param filename Name of file to be loaded.
+@param flags Flag that can take values of cv::ImreadModes
+@param params Parameters encoded as pairs (paramId_1, paramValue_1, paramId_2, paramValue_2, ... .) see cv::ImreadParams
+*/
+CV_EXPORTS_W Mat imread( const String& filename, int flags, const std::vector<int>& params );
+
 /** @brief Loads a multi-page image from a file.
 
 The function imreadmulti loads a multi-page image from the specified file into a vector of Mat objects.
@@ -213,10 +269,14 @@ CV_EXPORTS_W bool imwrite( const String& filename, InputArray img,
 The function imdecode reads an image from the specified buffer in the memory. If the buffer is too short or
 contains invalid data, the function returns an empty matrix ( Mat::data==NULL ).
 
+The buffer may also be given as a list of chunks (a vector of Mat or a vector of vectors of bytes) which
+are concatenated logically, e.g. the buffers of a network receive chain. JPEG, PNG and TIFF decoders
+read such a list in place, for other formats the chunks are gathered into a temporary buffer.
+
 See cv::imread for the list of supported formats and flags description.
 
 @note In the case of color images, the decoded images will have the channels stored in **B G R** order.
-@param buf Input array or vector of bytes.
+@param buf Input array or vector of bytes, or a list of chunks.
 @param flags The same flags as in cv::imread, see cv::ImreadModes.
 */
 CV_EXPORTS_W Mat imdecode( InputArray buf, int flags );
@@ -226,9 +286,86 @@ CV_EXPORTS_W Mat imdecode( InputArray buf, int flags );
 @param flags
 @param dst The optional output placeholder for the decoded matrix. It can save the image
 reallocations when the function is called repeatedly for images of the same size.
+It is released if the image can't be decoded.
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @brief Reads a region of an image from a buffer in memory.
+
+See cv::imread for the description of the region parameters.
+
+@param buf Input array or vector of bytes.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@param params Parameters encoded as pairs (paramId_1, paramValue_1, paramId_2, paramValue_2, ... .) see cv::ImreadParams
+*/
+CV_EXPORTS_W Mat imdecode( InputArray buf, int flags, const std::vector<int>& params );
+
+/** @brief Source of encoded image data for cv::imdecode.
+
+Implement the interface to decode an image from non-contiguous memory or from a custom input stream
+without gathering the data into one contiguous buffer first. JPEG, PNG and TIFF decoders read the
+data piece by piece, for other formats the data is copied into a temporary buffer.
+*/
+class CV_EXPORTS ImageDecodeSource
+{
+public:
+    virtual ~ImageDecodeSource();
+
+    /** @brief Returns the next piece of data starting at the current position and moves the position past it.
+    @param size Size of the returned piece, 0 at the end of data.
+    The returned memory must stay valid until the next call of any method of the source.
+    */
+    virtual const uchar* next( size_t& size ) = 0;
+
+    /** @brief Moves the current position to pos bytes from the beginning of data.
+    Returns false if the position is out of data or can't be reached.
+    */
+    virtual bool seek( size_t pos ) = 0;
+
+    /** @brief Returns the total size of data in bytes. */
+    virtual size_t size() const = 0;
+};
+
+/** @brief Reads an image from a custom data source.
+
+See cv::imread for the list of supported formats and flags description.
+
+@param source Source of the encoded data.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@sa cv::ImageDecodeSource
+*/
+CV_EXPORTS Mat imdecode( const Ptr<ImageDecodeSource>& source, int flags );
+
+/** @brief Loads a batch of images from files using several threads.
+
+The function reads every file of the list the same way as cv::imread does, distributing the files
+over the threads of the OpenCV parallel framework (see cv::setNumThreads). Elements of mats that
+already have the size and type of the decoded image are reused, so passing the same vector for
+consecutive batches of similar images saves the reallocations. If an image cannot be read, the
+corresponding element of mats is left empty.
+
+@param filenames Names of files to be loaded.
+@param mats Output vector of images, resized to the number of files.
+@param flags Flag that can take values of cv::ImreadModes.
+@return true if all the images have been read successfully.
+@sa cv::imread
+*/
+CV_EXPORTS_W bool imreadBatch( const std::vector<String>& filenames, CV_IN_OUT std::vector<Mat>& mats,
+                               int flags = IMREAD_COLOR );
+
+/** @brief Reads a batch of images from buffers in memory using several threads.
+
+The function is the cv::imdecode counterpart of cv::imreadBatch.
+
+@param bufs Input vector of encoded buffers (vector of Mat or vector of vector of bytes).
+@param mats Output vector of images, resized to the number of buffers.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@return true if all the images have been decoded successfully.
+@sa cv::imdecode, cv::imreadBatch
+*/
+CV_EXPORTS_W bool imdecodeBatch( InputArrayOfArrays bufs, CV_IN_OUT std::vector<Mat>& mats,
+                                 int flags = IMREAD_COLOR );
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -243,8 +380,111 @@ CV_EXPORTS_W bool imencode( const String& ext, InputArray img,
                             CV_OUT std::vector<uchar>& buf,
                             const std::vector<int>& params = std::vector<int>());
 
+/** @brief Random access to the tiles of a large TIFF image.
+
+The reader decodes only the tiles (or strips, for images which are not tiled) which are requested,
+so the memory usage doesn't depend on the image size. Decoded tiles are kept in a cache of limited
+size, the least recently used tiles are dropped first. Several tiles are decoded in parallel
+(readRegion, processTiles), every thread uses its own handle of the file.
+
+Level 0 is the full resolution image, the other levels are the reduced resolution images stored
+either as SubIFDs of the first image or as the following directories marked as reduced images.
+
+8-bit, 16-bit and 32-bit floating-point grayscale, RGB and RGBA images are returned with the
+channels in **B G R (A)** order. Other images (palette, YCbCr, bilevel etc.) are converted to 8-bit
+BGR or BGRA images.
+*/
+class CV_EXPORTS TiledImageReader
+{
+public:
+    virtual ~TiledImageReader();
+
+    /** @brief Opens a TIFF file.
+    @param filename Name of the file.
+    @param cacheSize Maximum size of the decoded tiles kept in the cache, in bytes.
+    Throws an exception if the file can't be opened.
+    */
+    static Ptr<TiledImageReader> create( const String& filename, size_t cacheSize = (size_t)256 << 20 );
+
+    //! Number of the resolution levels.
+    virtual int levels() const = 0;
+    //! Size of the image at the level.
+    virtual Size size( int level = 0 ) const = 0;
+    //! Size of a tile at the level, for images which are not tiled a strip is a tile.
+    virtual Size tileSize( int level = 0 ) const = 0;
+    //! Type of the decoded tiles.
+    virtual int type() const = 0;
+
+    /** @brief Returns the tile with the given index.
+    Tiles at the right and bottom borders are cropped to the image size. The tile data is shared
+    with the cache, clone it before modification.
+    @param x Column index of the tile.
+    @param y Row index of the tile.
+    @param level Resolution level.
+    */
+    virtual Mat getTile( int x, int y, int level = 0 ) = 0;
+
+    //! Decodes the region of the image at the level, the tiles are decoded in parallel.
+    virtual Mat readRegion( const Rect& roi, int level = 0 ) = 0;
+
+    /** @brief Decodes the tiles intersecting the region in parallel and passes them to the callback.
+    The callback gets the tile and its position at the level, it may be called concurrently from
+    several threads. The tiles are not cached, so the whole image can be streamed with bounded memory.
+    */
+    virtual void processTiles( const Rect& roi, int level,
+                               const std::function<void(const Mat& tile, const Rect& rect)>& callback ) = 0;
+
+    //! Changes the maximum size of the tile cache, in bytes.
+    virtual void setCacheSize( size_t cacheSize ) = 0;
+};
+
+/** @brief Writes a large tiled TIFF image tile by tile.
+
+The image is never stored in memory as a whole. The tiles of a level can be written in any order,
+the levels must be written in increasing order: writing a tile of the next level finishes the current
+one. Tiles which were not written are filled with zeros. The reduced resolution levels are stored as
+SubIFDs of the full resolution image, the size of the level l is the size of the image divided by 2^l
+(rounded up). BigTIFF is written when the image doesn't fit into the classic TIFF format.
+*/
+class CV_EXPORTS TiledImageWriter
+{
+public:
+    virtual ~TiledImageWriter();
+
+    /** @brief Creates a TIFF file.
+    @param filename Name of the file.
+    @param size Size of the full resolution image.
+    @param type Type of the image: 8-bit, 16-bit or 32-bit floating-point with 1, 3 (BGR) or 4 (BGRA) channels.
+    @param tileSize Size of the tiles, must be a multiple of 16.
+    @param levels Number of the resolution levels.
+    @param params TIFFTAG_COMPRESSION and TIFFTAG_PREDICTOR as pairs (paramId, paramValue), LZW is used by default.
+    */
+    static Ptr<TiledImageWriter> create( const String& filename, Size size, int type, Size tileSize = Size(256, 256),
+                                         int levels = 1, const std::vector<int>& params = std::vector<int>() );
+
+    //! Size of the image at the level.
+    virtual Size size( int level = 0 ) const = 0;
+
+    /** @brief Writes the tile with the given index.
+    The tile must have the size of tileSize, tiles at the right and bottom borders may be cropped to the image size.
+    */
+    virtual void writeTile( int x, int y, InputArray tile, int level = 0 ) = 0;
+
+    //! Finishes the file, called by the destructor if not called explicitly.
+    virtual void close() = 0;
+};
+
 //! @} imgcodecs
 
+//! @cond IGNORED
+namespace details {
+/** Overrides OPENCV_IMGCODECS_USE_MMAP for the subsequent imread calls, for the tests.
+Returns the previous setting, the files are never mapped on the systems without mmap.
+*/
+CV_EXPORTS bool setUseMappedFiles( bool flag );
+}
+//! @endcond
+
 } // cv
 
 #endif //OPENCV_IMGCODECS_HPP
@@ -0,0 +1,136 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef tuple<string, int> Ext_Threads_t;
+typedef perf::TestBaseWithParam<Ext_Threads_t> Ext_Threads;
+
+static const string batch_exts[] = {
+#ifdef HAVE_PNG
+    ".png",
+#endif
+#ifdef HAVE_JPEG
+    ".jpg",
+#endif
+    ".bmp"
+};
+
+#define BATCH_EXTS testing::ValuesIn(batch_exts)
+#define BATCH_THREADS testing::Values(1, 2, 4, 8)
+
+static void generateBatch(const string& ext, size_t count, vector<vector<uchar> >& bufs)
+{
+    Mat image(480, 640, CV_8UC3);
+    RNG rng(0xC0DEC);
+    bufs.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        // smooth random image, so the codecs have something to compress
+        Mat small(15, 20, CV_8UC3);
+        rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        resize(small, image, image.size(), 0, 0, INTER_LINEAR);
+        ASSERT_TRUE(imencode(ext, image, bufs[i]));
+    }
+}
+
+PERF_TEST_P(Ext_Threads, imdecodeBatch, testing::Combine(BATCH_EXTS, BATCH_THREADS))
+{
+    const string ext = get<0>(GetParam());
+    const int threads = get<1>(GetParam());
+    const size_t count = 64; // images/s = count / mean time
+
+    vector<vector<uchar> > bufs;
+    generateBatch(ext, count, bufs);
+    vector<Mat> images;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() ASSERT_TRUE(imdecodeBatch(bufs, images));
+    setNumThreads(prevThreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Ext_Threads, imreadBatch, testing::Combine(BATCH_EXTS, BATCH_THREADS))
+{
+    const string ext = get<0>(GetParam());
+    const int threads = get<1>(GetParam());
+    const size_t count = 64;
+
+    vector<vector<uchar> > bufs;
+    generateBatch(ext, count, bufs);
+    vector<String> filenames(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        filenames[i] = cv::tempfile(ext.c_str());
+        FILE* f = fopen(filenames[i].c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        ASSERT_EQ(bufs[i].size(), fwrite(&bufs[i][0], 1, bufs[i].size(), f));
+        fclose(f);
+    }
+    vector<Mat> images;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() ASSERT_TRUE(imreadBatch(filenames, images));
+    setNumThreads(prevThreads);
+
+    for (size_t i = 0; i < count; i++)
+        remove(filenames[i].c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<string> Ext;
+
+// thumbnails: the per-image codec setup dominates the decoding time
+PERF_TEST_P(Ext, imdecode_small, BATCH_EXTS)
+{
+    const string ext = GetParam();
+    const int count = 256; // images/s = count / mean time
+
+    Mat image(32, 32, CV_8UC3);
+    randu(image, Scalar::all(0), Scalar::all(256));
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(ext, image, buf));
+    Mat dst;
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < count; i++)
+            dst = imdecode(buf, IMREAD_COLOR);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+#ifdef HAVE_JPEG
+
+typedef perf::TestBaseWithParam<int> Flags;
+
+// 8 Mpixel photo: color conversion vs direct YCbCr planes
+PERF_TEST_P(Flags, imdecode_jpeg, testing::Values((int)IMREAD_COLOR, (int)IMREAD_GRAYSCALE,
+                                                  (int)IMREAD_YUV_I420, (int)IMREAD_YUV_NV12))
+{
+    const int flags = GetParam();
+
+    Mat small(24, 32, CV_8UC3), image;
+    RNG rng(0xC0DEC);
+    rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, image, Size(3264, 2448), 0, 0, INTER_LINEAR);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", image, buf));
+    Mat dst;
+
+    TEST_CYCLE() dst = imdecode(buf, flags);
+
+    SANITY_CHECK_NOTHING();
+}
+
+#endif
+
+} // namespace
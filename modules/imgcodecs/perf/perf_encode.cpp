@@ -0,0 +1,84 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+// 8 Mpixel 16-bit BGR image (48 MB), MB/s = 48 / mean time
+static Mat generateEncodeImage()
+{
+    Mat small(24, 32, CV_16UC3), image;
+    RNG rng(0xC0DEC);
+    rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(65536));
+    resize(small, image, Size(3264, 2448), 0, 0, INTER_LINEAR);
+    return image;
+}
+
+#define ENCODE_THREADS testing::Values(1, 4)
+
+#ifdef HAVE_PNG
+
+typedef tuple<int, int, int> Level_Filter_Threads_t;
+typedef perf::TestBaseWithParam<Level_Filter_Threads_t> Level_Filter_Threads;
+
+PERF_TEST_P(Level_Filter_Threads, imencode_png,
+            testing::Combine(testing::Values(1, 3, 6, 9),
+                             testing::Values((int)IMWRITE_PNG_FILTER_SUB, (int)IMWRITE_PNG_FILTER_ALL),
+                             ENCODE_THREADS))
+{
+    const int level = get<0>(GetParam());
+    const int filter = get<1>(GetParam());
+    const int threads = get<2>(GetParam());
+
+    Mat image = generateEncodeImage();
+    vector<int> params;
+    params.push_back(IMWRITE_PNG_COMPRESSION);
+    params.push_back(level);
+    params.push_back(IMWRITE_PNG_FILTER);
+    params.push_back(filter);
+    vector<uchar> buf;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() ASSERT_TRUE(imencode(".png", image, buf, params));
+    setNumThreads(prevThreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+#endif
+
+#ifdef HAVE_TIFF
+
+typedef tuple<int, int> Compression_Threads_t;
+typedef perf::TestBaseWithParam<Compression_Threads_t> Compression_Threads;
+
+// 1 - none, 5 - LZW, 8 - deflate
+PERF_TEST_P(Compression_Threads, imencode_tiff,
+            testing::Combine(testing::Values(1, 5, 8), ENCODE_THREADS))
+{
+    const int compression = get<0>(GetParam());
+    const int threads = get<1>(GetParam());
+
+    Mat image = generateEncodeImage();
+    vector<int> params;
+    params.push_back(259); // TIFFTAG_COMPRESSION
+    params.push_back(compression);
+    params.push_back(278); // TIFFTAG_ROWSPERSTRIP
+    params.push_back(16);
+    vector<uchar> buf;
+
+    int prevThreads = getNumThreads();
+    setNumThreads(threads);
+    TEST_CYCLE() ASSERT_TRUE(imencode(".tiff", image, buf, params));
+    setNumThreads(prevThreads);
+
+    SANITY_CHECK_NOTHING();
+}
+
+#endif
+
+} // namespace
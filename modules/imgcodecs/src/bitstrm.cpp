@@ -337,6 +337,100 @@ int  RMByteStream::getDWord()
     return val;
 }
 
+/////////////////////////  SourceReader ////////////////////////////
+
+SourceReader::SourceReader()
+{
+    m_current = 0;
+    m_left = m_pos = 0;
+}
+
+bool  SourceReader::open( const Ptr<ImageDecodeSource>& source )
+{
+    close();
+    if( !source || !source->seek(0) )
+        return false;
+    m_source = source;
+    return true;
+}
+
+void  SourceReader::close()
+{
+    m_source.release();
+    m_current = 0;
+    m_left = m_pos = 0;
+}
+
+bool  SourceReader::isOpened() const
+{
+    return !m_source.empty();
+}
+
+const uchar* SourceReader::next( size_t& count )
+{
+    count = 0;
+    if( !m_source )
+        return 0;
+
+    const uchar* data = m_current;
+    count = m_left;
+    if( count == 0 )
+    {
+        data = m_source->next( count );
+        if( !data )
+            count = 0;
+    }
+    m_pos += count;
+    m_current = 0;
+    m_left = 0;
+    return data;
+}
+
+size_t  SourceReader::read( uchar* buffer, size_t count )
+{
+    size_t total = 0;
+    while( total < count && m_source )
+    {
+        if( m_left == 0 )
+        {
+            m_current = m_source->next( m_left );
+            if( !m_current || m_left == 0 )
+            {
+                m_current = 0;
+                m_left = 0;
+                break;
+            }
+        }
+        size_t len = std::min( count - total, m_left );
+        memcpy( buffer + total, m_current, len );
+        m_current += len;
+        m_left -= len;
+        m_pos += len;
+        total += len;
+    }
+    return total;
+}
+
+bool  SourceReader::seek( size_t pos )
+{
+    if( !m_source || !m_source->seek(pos) )
+        return false;
+    m_current = 0;
+    m_left = 0;
+    m_pos = pos;
+    return true;
+}
+
+size_t  SourceReader::tell() const
+{
+    return m_pos;
+}
+
+size_t  SourceReader::size() const
+{
+    return m_source ? m_source->size() : 0;
+}
+
 /////////////////////////// WBaseStream /////////////////////////////////
 
 // WBaseStream - base class for output streams
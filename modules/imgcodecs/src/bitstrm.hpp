@@ -122,6 +122,30 @@ public:
     int     getDWord();
 };
 
+// class SourceReader - sequential reader of an ImageDecodeSource,
+// keeps the unread part of the last piece returned by the source.
+class SourceReader
+{
+public:
+    SourceReader();
+
+    bool    open( const Ptr<ImageDecodeSource>& source );
+    void    close();
+    bool    isOpened() const;
+    // returns the unread part of the current piece or the next piece, 0 at the end of data
+    const uchar* next( size_t& count );
+    size_t  read( uchar* buffer, size_t count );
+    bool    seek( size_t pos );
+    size_t  tell() const;
+    size_t  size() const;
+
+protected:
+    Ptr<ImageDecodeSource> m_source;
+    const uchar* m_current;
+    size_t  m_left;
+    size_t  m_pos;
+};
+
 // WBaseStream - base class for output streams
 class WBaseStream
 {
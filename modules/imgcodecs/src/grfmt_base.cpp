@@ -52,6 +52,7 @@ BaseImageDecoder::BaseImageDecoder()
     m_width = m_height = 0;
     m_type = -1;
     m_buf_supported = false;
+    m_source_supported = false;
     m_scale_denom = 1;
 }
 
@@ -59,6 +60,7 @@ bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
     m_buf.release();
+    m_source.release();
     return true;
 }
 
@@ -68,6 +70,17 @@ bool BaseImageDecoder::setSource( const Mat& buf )
         return false;
     m_filename = String();
     m_buf = buf;
+    m_source.release();
+    return true;
+}
+
+bool BaseImageDecoder::setSource( const Ptr<ImageDecodeSource>& source )
+{
+    if( !m_source_supported )
+        return false;
+    m_filename = String();
+    m_buf.release();
+    m_source = source;
     return true;
 }
 
@@ -82,6 +95,27 @@ bool BaseImageDecoder::checkSignature( const String& signature ) const
     return signature.size() >= len && memcmp( signature.c_str(), m_signature.c_str(), len ) == 0;
 }
 
+bool BaseImageDecoder::setYUVOutput( int )
+{
+    return false;
+}
+
+bool BaseImageDecoder::checkFirstByte( uchar first ) const
+{
+    return m_signature.empty() || (uchar)m_signature[0] == first;
+}
+
+bool BaseImageDecoder::recycle()
+{
+    m_width = m_height = 0;
+    m_type = -1;
+    m_scale_denom = 1;
+    m_filename = String();
+    m_buf.release();
+    m_source.release();
+    return false;
+}
+
 int BaseImageDecoder::setScale( const int& scale_denom )
 {
     int temp = m_scale_denom;
@@ -89,6 +123,11 @@ int BaseImageDecoder::setScale( const int& scale_denom )
     return temp;
 }
 
+bool BaseImageDecoder::setRegion( const Rect&, const Size& )
+{
+    return false;
+}
+
 ImageDecoder BaseImageDecoder::newDecoder() const
 {
     return ImageDecoder();
@@ -137,6 +176,14 @@ ImageEncoder BaseImageEncoder::newEncoder() const
     return ImageEncoder();
 }
 
+bool BaseImageEncoder::recycle()
+{
+    m_filename = String();
+    m_buf = 0;
+    m_last_error.clear();
+    return true;
+}
+
 void BaseImageEncoder::throwOnEror() const
 {
     if(!m_last_error.empty())
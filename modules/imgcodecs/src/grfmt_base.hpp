@@ -67,6 +67,9 @@ public:
 
     virtual bool setSource( const String& filename );
     virtual bool setSource( const Mat& buf );
+    virtual bool setSource( const Ptr<ImageDecodeSource>& source );
+    /// Returns true if the decoder reads memory buffers passed to setSource.
+    bool isBufSupported() const { return m_buf_supported; }
     virtual int setScale( const int& scale_denom );
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
@@ -74,10 +77,26 @@ public:
     /// Called after readData to advance to the next page, if any.
     virtual bool nextPage() { return false; }
 
+    /// Called after readHeader to decode only the roi part of the image, reduced if possible
+    /// while staying not smaller than minSize. On success width() and height() return the size
+    /// of the image readData() produces. Returns false if the decoder can't do it itself.
+    virtual bool setRegion( const Rect& roi, const Size& minSize );
+
+    /// Called after readHeader to get the 4:2:0 YCbCr planes (IMREAD_YUV_I420 or IMREAD_YUV_NV12
+    /// layout) from readData() into CV_8UC1 image of yuv420MatSize(). Returns false if the decoder
+    /// can't produce them without the color conversion.
+    virtual bool setYUVOutput( int layout );
+
     virtual size_t signatureLength() const;
     virtual bool checkSignature( const String& signature ) const;
+    /// Returns false if no signature of the format starts with the byte (used to dispatch by the first byte).
+    virtual bool checkFirstByte( uchar first ) const;
     virtual ImageDecoder newDecoder() const;
 
+    /// Releases the source and the per-image state after the image is read, keeping the codec
+    /// structures which can be reused for the next image. Returns false if the decoder can't be reused.
+    virtual bool recycle();
+
 protected:
     int  m_width;  // width  of the image ( filled by readHeader )
     int  m_height; // height of the image ( filled by readHeader )
@@ -87,6 +106,8 @@ protected:
     String m_signature;
     Mat m_buf;
     bool m_buf_supported;
+    Ptr<ImageDecodeSource> m_source;
+    bool m_source_supported;
 };
 
 
@@ -106,6 +127,9 @@ public:
     virtual String getDescription() const;
     virtual ImageEncoder newEncoder() const;
 
+    /// Releases the destination after the image is written, so the encoder can write another image.
+    virtual bool recycle();
+
     virtual void throwOnEror() const;
 
 protected:
@@ -567,6 +567,10 @@ bool GdalDecoder::checkSignature( const String& signature )const{
     return false;
 }
 
+bool GdalDecoder::checkFirstByte( uchar )const{
+    return true;
+}
+
 } /// End of cv Namespace
 
 #endif /**< End  of HAVE_GDAL Definition */
@@ -146,6 +146,11 @@ class GdalDecoder CV_FINAL : public BaseImageDecoder{
         */
         virtual bool checkSignature( const String& signature ) const CV_OVERRIDE;
 
+        /**
+         * The DTED signature is not at the beginning of the file
+        */
+        virtual bool checkFirstByte( uchar first ) const CV_OVERRIDE;
+
     protected:
 
         /// GDAL Dataset
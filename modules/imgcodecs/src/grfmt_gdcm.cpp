@@ -83,6 +83,11 @@ bool DICOMDecoder::checkSignature( const String& signature ) const
     return false;
 }
 
+bool DICOMDecoder::checkFirstByte( uchar ) const
+{
+    return true; // the magic follows the preamble
+}
+
 ImageDecoder DICOMDecoder::newDecoder() const
 {
     return makePtr<DICOMDecoder>();
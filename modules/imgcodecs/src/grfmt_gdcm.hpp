@@ -61,6 +61,7 @@ public:
     bool  readHeader() CV_OVERRIDE;
     ImageDecoder newDecoder() const CV_OVERRIDE;
     virtual bool checkSignature( const String& signature ) const CV_OVERRIDE;
+    virtual bool checkFirstByte( uchar first ) const CV_OVERRIDE;
 };
 
 }
@@ -41,6 +41,8 @@
 
 #include "precomp.hpp"
 #include "grfmt_jpeg.hpp"
+#include "utils.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #ifdef HAVE_JPEG
 
@@ -88,6 +90,7 @@ struct JpegSource
 {
     struct jpeg_source_mgr pub;
     int skip;
+    SourceReader* reader;
 };
 
 struct JpegState
@@ -95,6 +98,8 @@ struct JpegState
     jpeg_decompress_struct cinfo; // IJG JPEG codec structure
     JpegErrorMgr jerr; // error processing manager state
     JpegSource source; // memory buffer source
+    SourceReader reader; // custom data source
+    jpeg_source_mgr* stdio_src; // file source allocated by jpeg_stdio_src in the permanent pool
 };
 
 /////////////////////// Error processing /////////////////////
@@ -148,6 +153,53 @@ static void jpeg_buffer_src(j_decompress_ptr cinfo, JpegSource* source)
     source->pub.bytes_in_buffer = 0; // forces fill_input_buffer on first read
 
     source->skip = 0;
+    source->reader = 0;
+}
+
+
+// reading ImageDecodeSource pieces in place
+
+METHODDEF(boolean)
+fill_input_buffer_from_reader(j_decompress_ptr cinfo)
+{
+    static const JOCTET fake_eoi[2] = { (JOCTET)0xFF, (JOCTET)JPEG_EOI };
+    JpegSource* source = (JpegSource*) cinfo->src;
+
+    size_t size = 0;
+    const uchar* data = source->reader->next( size );
+    if( !data || size == 0 )
+    {
+        // premature end of data, insert a fake EOI marker as jdatasrc.c does
+        data = fake_eoi;
+        size = sizeof(fake_eoi);
+    }
+    source->pub.next_input_byte = data;
+    source->pub.bytes_in_buffer = size;
+    return TRUE;
+}
+
+METHODDEF(void)
+skip_input_data_from_reader(j_decompress_ptr cinfo, long num_bytes)
+{
+    JpegSource* source = (JpegSource*) cinfo->src;
+
+    if( num_bytes <= 0 )
+        return;
+    while( num_bytes > (long)source->pub.bytes_in_buffer )
+    {
+        num_bytes -= (long)source->pub.bytes_in_buffer;
+        fill_input_buffer_from_reader( cinfo );
+    }
+    source->pub.next_input_byte += num_bytes;
+    source->pub.bytes_in_buffer -= num_bytes;
+}
+
+static void jpeg_reader_src(j_decompress_ptr cinfo, JpegSource* source, SourceReader* reader)
+{
+    jpeg_buffer_src(cinfo, source);
+    source->pub.fill_input_buffer = fill_input_buffer_from_reader;
+    source->pub.skip_input_data = skip_input_data_from_reader;
+    source->reader = reader;
 }
 
 
@@ -169,24 +221,33 @@ JpegDecoder::JpegDecoder()
     m_signature = "\xFF\xD8\xFF";
     m_state = 0;
     m_f = 0;
+    m_yuv = 0;
     m_buf_supported = true;
+    m_source_supported = true;
 }
 
 
 JpegDecoder::~JpegDecoder()
 {
     close();
+    if( m_state )
+    {
+        JpegState* state = (JpegState*)m_state;
+        jpeg_destroy_decompress( &state->cinfo );
+        delete state;
+        m_state = 0;
+    }
 }
 
 
+// the decompressor object is kept between the images, only the image pools are released
 void  JpegDecoder::close()
 {
     if( m_state )
     {
         JpegState* state = (JpegState*)m_state;
-        jpeg_destroy_decompress( &state->cinfo );
-        delete state;
-        m_state = 0;
+        jpeg_abort_decompress( &state->cinfo );
+        state->reader.close();
     }
 
     if( m_f )
@@ -197,6 +258,8 @@ void  JpegDecoder::close()
 
     m_width = m_height = 0;
     m_type = -1;
+    m_roi = Rect();
+    m_yuv = 0;
 }
 
 ImageDecoder JpegDecoder::newDecoder() const
@@ -204,19 +267,40 @@ ImageDecoder JpegDecoder::newDecoder() const
     return makePtr<JpegDecoder>();
 }
 
+bool  JpegDecoder::recycle()
+{
+    close();
+    BaseImageDecoder::recycle();
+    return true;
+}
+
 bool  JpegDecoder::readHeader()
 {
     volatile bool result = false;
     close();
 
-    JpegState* state = new JpegState;
-    m_state = state;
-    state->cinfo.err = jpeg_std_error(&state->jerr.pub);
-    state->jerr.pub.error_exit = error_exit;
+    JpegState* state = (JpegState*)m_state;
+    if( !state )
+    {
+        state = new JpegState;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+        state->stdio_src = 0;
+
+        if( setjmp( state->jerr.setjmp_buffer ) != 0 )
+        {
+            jpeg_destroy_decompress( &state->cinfo );
+            delete state;
+            return false;
+        }
+        jpeg_create_decompress( &state->cinfo );
+        m_state = state;
+    }
 
     if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        jpeg_create_decompress( &state->cinfo );
+        // the source managers are switched per image, jpeg_stdio_src reuses its own one
+        state->cinfo.src = 0;
 
         if( !m_buf.empty() )
         {
@@ -224,11 +308,20 @@ bool  JpegDecoder::readHeader()
             state->source.pub.next_input_byte = m_buf.ptr();
             state->source.pub.bytes_in_buffer = m_buf.cols*m_buf.rows*m_buf.elemSize();
         }
+        else if( m_source )
+        {
+            if( state->reader.open( m_source ) )
+                jpeg_reader_src(&state->cinfo, &state->source, &state->reader);
+        }
         else
         {
             m_f = fopen( m_filename.c_str(), "rb" );
             if( m_f )
+            {
+                state->cinfo.src = state->stdio_src;
                 jpeg_stdio_src( &state->cinfo, m_f );
+                state->stdio_src = state->cinfo.src;
+            }
         }
 
         if (state->cinfo.src != 0)
@@ -252,6 +345,40 @@ bool  JpegDecoder::readHeader()
     return result;
 }
 
+bool  JpegDecoder::setRegion( const Rect& roi, const Size& minSize )
+{
+    Rect r = roi & Rect(0, 0, m_width, m_height);
+    if( !m_state || r.empty() )
+        return false;
+
+    jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
+
+    // pick the strongest additional DCT scaling that keeps the region not smaller than minSize
+    int scale = 1;
+    if( minSize.width > 0 || minSize.height > 0 )
+    {
+        for( scale = 8 / (int)cinfo->scale_denom; scale > 1; scale /= 2 )
+            if( r.width / scale >= minSize.width && r.height / scale >= minSize.height )
+                break;
+    }
+
+    if( scale > 1 )
+    {
+        cinfo->scale_num = 1;
+        cinfo->scale_denom *= scale;
+        jpeg_calc_output_dimensions( cinfo );
+    }
+
+    int x1 = std::min((r.x + r.width + scale - 1) / scale, (int)cinfo->output_width);
+    int y1 = std::min((r.y + r.height + scale - 1) / scale, (int)cinfo->output_height);
+    m_roi = Rect(r.x / scale, r.y / scale, 0, 0);
+    m_roi.width = x1 - m_roi.x;
+    m_roi.height = y1 - m_roi.y;
+    m_width = m_roi.width;
+    m_height = m_roi.height;
+    return true;
+}
+
 /***************************************************************************
  * following code is for supporting MJPEG image files
  * based on a message of Laurent Pinchart on the video4linux mailing list
@@ -386,17 +513,300 @@ int my_jpeg_load_dht (struct jpeg_decompress_struct *info, unsigned char *dht,
  * based on a message of Laurent Pinchart on the video4linux mailing list
  ***************************************************************************/
 
+bool  JpegDecoder::setYUVOutput( int layout )
+{
+    if( !m_state )
+        return false;
+
+    const jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
+    if( !(cinfo->jpeg_color_space == JCS_YCbCr && cinfo->num_components == 3) &&
+        !(cinfo->jpeg_color_space == JCS_GRAYSCALE && cinfo->num_components == 1) )
+        return false;
+
+    m_yuv = layout;
+    return true;
+}
+
+#if JPEG_LIB_VERSION >= 70
+#define JPEG_DCT_H_SIZE(comp) ((comp)->DCT_h_scaled_size)
+#define JPEG_DCT_V_SIZE(comp) ((comp)->DCT_v_scaled_size)
+#else
+#define JPEG_DCT_H_SIZE(comp) ((comp)->DCT_scaled_size)
+#define JPEG_DCT_V_SIZE(comp) ((comp)->DCT_scaled_size)
+#endif
+
+// YCbCr->RGB coefficients of libjpeg (jdcolor.c) in 16-bit fixed point, the results are bit-exact.
+// Cb->G is FIX(0.34414) in libjpeg up to version 8 and libjpeg-turbo, FIX(0.344136286) since version 9.
+enum { YCC_SHIFT = 16, YCC_R_CR = 91881, YCC_G_CR = -46802, YCC_B_CB = 116130,
+#if JPEG_LIB_VERSION >= 90
+       YCC_G_CB = -22553
+#else
+       YCC_G_CB = -22554
+#endif
+};
+
+static void convertYCbCrToBGRRow( const uchar* ycc, uchar* bgr, int width )
+{
+    int i = 0;
+#if CV_SIMD128
+    const v_int32x4 v_half = v_setall_s32(1 << (YCC_SHIFT - 1)), v_center = v_setall_s32(128);
+    const v_int32x4 v_r_cr = v_setall_s32(YCC_R_CR), v_g_cb = v_setall_s32(YCC_G_CB),
+                    v_g_cr = v_setall_s32(YCC_G_CR), v_b_cb = v_setall_s32(YCC_B_CB);
+    for( ; i <= width - 16; i += 16 )
+    {
+        v_uint8x16 y8, cb8, cr8;
+        v_load_deinterleave( ycc + i*3, y8, cb8, cr8 );
+
+        v_uint16x8 y16[2], cb16[2], cr16[2];
+        v_expand( y8, y16[0], y16[1] );
+        v_expand( cb8, cb16[0], cb16[1] );
+        v_expand( cr8, cr16[0], cr16[1] );
+
+        v_int16x8 b16[2], g16[2], r16[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            v_uint32x4 y32[2], cb32[2], cr32[2];
+            v_expand( y16[k], y32[0], y32[1] );
+            v_expand( cb16[k], cb32[0], cb32[1] );
+            v_expand( cr16[k], cr32[0], cr32[1] );
+
+            v_int32x4 b[2], g[2], r[2];
+            for( int j = 0; j < 2; j++ )
+            {
+                v_int32x4 y = v_reinterpret_as_s32(y32[j]);
+                v_int32x4 cb = v_reinterpret_as_s32(cb32[j]) - v_center;
+                v_int32x4 cr = v_reinterpret_as_s32(cr32[j]) - v_center;
+                r[j] = y + ((cr * v_r_cr + v_half) >> YCC_SHIFT);
+                g[j] = y + ((cb * v_g_cb + cr * v_g_cr + v_half) >> YCC_SHIFT);
+                b[j] = y + ((cb * v_b_cb + v_half) >> YCC_SHIFT);
+            }
+            b16[k] = v_pack( b[0], b[1] );
+            g16[k] = v_pack( g[0], g[1] );
+            r16[k] = v_pack( r[0], r[1] );
+        }
+        v_store_interleave( bgr + i*3, v_pack_u( b16[0], b16[1] ),
+                            v_pack_u( g16[0], g16[1] ), v_pack_u( r16[0], r16[1] ) );
+    }
+#endif
+    for( ; i < width; i++ )
+    {
+        int y = ycc[i*3], cb = ycc[i*3 + 1] - 128, cr = ycc[i*3 + 2] - 128;
+        const int half = 1 << (YCC_SHIFT - 1);
+        bgr[i*3] = saturate_cast<uchar>( y + ((cb * YCC_B_CB + half) >> YCC_SHIFT) );
+        bgr[i*3 + 1] = saturate_cast<uchar>( y + ((cb * YCC_G_CB + cr * YCC_G_CR + half) >> YCC_SHIFT) );
+        bgr[i*3 + 2] = saturate_cast<uchar>( y + ((cr * YCC_R_CR + half) >> YCC_SHIFT) );
+    }
+}
+
+// the rows above the region have to be decompressed, but not converted
+static void skipScanlines( j_decompress_ptr cinfo, int count, JSAMPARRAY buffer )
+{
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    if( count > 0 )
+        jpeg_skip_scanlines( cinfo, count );
+#endif
+    while( (int)cinfo->output_scanline < count )
+        jpeg_read_scanlines( cinfo, buffer, 1 );
+}
+
+// Raw downsampled planes can be used if the luma has the full resolution and the chroma has
+// the full or the half one in each direction. Without the fancy upsampling libjpeg v7+ doesn't
+// enlarge the chroma by the IDCT scaling.
+static bool setRawYuvOutput( j_decompress_ptr cinfo, const Rect& roi )
+{
+    if( cinfo->jpeg_color_space != JCS_YCbCr || cinfo->num_components != 3 ||
+        (roi.x & 1) != 0 || (roi.y & 1) != 0 )
+        return false;
+
+    cinfo->raw_data_out = TRUE;
+    cinfo->do_fancy_upsampling = FALSE;
+    cinfo->out_color_space = JCS_YCbCr;
+    jpeg_calc_output_dimensions( cinfo );
+
+    const jpeg_component_info* comp = cinfo->comp_info;
+    const int lw = comp[0].h_samp_factor * JPEG_DCT_H_SIZE(comp);
+    const int lh = comp[0].v_samp_factor * JPEG_DCT_V_SIZE(comp);
+    bool ok = comp[0].h_samp_factor == cinfo->max_h_samp_factor &&
+              comp[0].v_samp_factor == cinfo->max_v_samp_factor && lh % 2 == 0;
+    for( int c = 1; c < 3 && ok; c++ )
+    {
+        const int w = comp[c].h_samp_factor * JPEG_DCT_H_SIZE(comp + c);
+        const int h = comp[c].v_samp_factor * JPEG_DCT_V_SIZE(comp + c);
+        ok = (w == lw || w * 2 == lw) && (h == lh || h * 2 == lh);
+    }
+
+    if( !ok )
+    {
+        cinfo->raw_data_out = FALSE;
+        cinfo->do_fancy_upsampling = TRUE;
+        jpeg_calc_output_dimensions( cinfo );
+    }
+    return ok;
+}
+
+static void readRawYuv420( j_decompress_ptr cinfo, const Rect& roi, Mat& img, bool nv12 )
+{
+    jpeg_start_decompress( cinfo );
+
+    const jpeg_component_info* comp = cinfo->comp_info;
+    const int lines = comp[0].v_samp_factor * JPEG_DCT_V_SIZE(comp);
+    const int lw = comp[0].h_samp_factor * JPEG_DCT_H_SIZE(comp);
+    JSAMPARRAY planes[3];
+    int rx[3], ry[3]; // luma to component resolution ratios
+    for( int c = 0; c < 3; c++ )
+    {
+        const int rows = comp[c].v_samp_factor * JPEG_DCT_V_SIZE(comp + c);
+        const int width = (comp[c].width_in_blocks + comp[c].h_samp_factor) * JPEG_DCT_H_SIZE(comp + c);
+        planes[c] = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo, JPOOL_IMAGE, width, rows);
+        rx[c] = lw / (comp[c].h_samp_factor * JPEG_DCT_H_SIZE(comp + c));
+        ry[c] = lines / rows;
+    }
+
+    const int cwidth = img.cols / 2, right = roi.x + roi.width - 1, bottom = roi.y + roi.height;
+    JSAMPROW chroma = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo, JPOOL_IMAGE, cwidth * 2, 1)[0];
+
+    while( (int)cinfo->output_scanline < bottom )
+    {
+        const int y0 = cinfo->output_scanline;
+        jpeg_read_raw_data( cinfo, planes, lines );
+
+        for( int k = 0; k < lines && y0 + k < bottom; k += 2 )
+        {
+            if( y0 + k < roi.y )
+                continue;
+            const int row = y0 + k - roi.y, k1 = y0 + k + 1 < bottom ? k + 1 : k;
+
+            for( int j = 0; j < 2; j++ )
+            {
+                uchar* dst = img.ptr(row + j);
+                memcpy( dst, planes[0][j ? k1 : k] + roi.x, roi.width );
+                if( img.cols > roi.width )
+                    dst[roi.width] = dst[roi.width - 1];
+            }
+
+            for( int c = 1; c < 3; c++ )
+            {
+                const uchar* src0 = planes[c][k / ry[c]];
+                const uchar* src1 = planes[c][k1 / ry[c]];
+                uchar* dst = chroma + (c - 1) * cwidth;
+                if( rx[c] == 2 && ry[c] == 2 )
+                {
+                    memcpy( dst, src0 + roi.x / 2, cwidth );
+                    continue;
+                }
+                for( int i = 0; i < cwidth; i++ )
+                {
+                    const int x0 = (roi.x + i * 2) / rx[c], x1 = std::min( roi.x + i * 2 + 1, right ) / rx[c];
+                    dst[i] = (uchar)((src0[x0] + src0[x1] + src1[x0] + src1[x1] + 2) >> 2);
+                }
+            }
+            storeYuv420ChromaRow( img, nv12, row / 2, chroma, chroma + cwidth );
+        }
+    }
+}
+
+static void readYuv420( j_decompress_ptr cinfo, const Rect& roi, Mat& img, bool nv12 )
+{
+    if( setRawYuvOutput( cinfo, roi ) )
+    {
+        readRawYuv420( cinfo, roi, img, nv12 );
+        return;
+    }
+
+    // upsampled chroma (or gray), but still without the color conversion
+    cinfo->out_color_space = cinfo->num_components == 3 ? JCS_YCbCr : JCS_GRAYSCALE;
+    jpeg_start_decompress( cinfo );
+
+    const int cn = cinfo->out_color_components;
+    JSAMPARRAY buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+                                                    JPOOL_IMAGE, cinfo->output_width*cn, 2 );
+    skipScanlines( cinfo, roi.y, buffer );
+
+    for( int y = 0; y < roi.height; y += 2 )
+    {
+        jpeg_read_scanlines( cinfo, buffer, 1 );
+        if( y + 1 < roi.height )
+            jpeg_read_scanlines( cinfo, buffer + 1, 1 );
+        storeYuv420Rows( img, nv12, y, buffer[0] + roi.x*cn,
+                         buffer[y + 1 < roi.height ? 1 : 0] + roi.x*cn, roi.width, cn );
+    }
+}
+
+static void readRows( j_decompress_ptr cinfo, const Rect& roi, Mat& img )
+{
+    const bool color = img.channels() > 1;
+
+    // YCbCr is converted to BGR here, so the channels don't have to be swapped after libjpeg
+    if( color )
+    {
+        if( cinfo->num_components == 3 && cinfo->jpeg_color_space == JCS_YCbCr )
+        {
+            cinfo->out_color_space = JCS_YCbCr;
+            cinfo->out_color_components = 3;
+        }
+        else if( cinfo->num_components != 4 )
+        {
+            cinfo->out_color_space = JCS_RGB;
+            cinfo->out_color_components = 3;
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+        }
+    }
+    else
+    {
+        if( cinfo->num_components != 4 )
+        {
+            cinfo->out_color_space = JCS_GRAYSCALE;
+            cinfo->out_color_components = 1;
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+        }
+    }
+
+    jpeg_start_decompress( cinfo );
+
+    JSAMPARRAY buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+                                                    JPOOL_IMAGE, cinfo->output_width*4, 1 );
+    skipScanlines( cinfo, roi.y, buffer );
+
+    for( int y = 0; y < roi.height; y++ )
+    {
+        jpeg_read_scanlines( cinfo, buffer, 1 );
+        const uchar* src = buffer[0] + roi.x*cinfo->out_color_components;
+        uchar* data = img.ptr(y);
+        if( color )
+        {
+            if( cinfo->out_color_space == JCS_YCbCr )
+                convertYCbCrToBGRRow( src, data, roi.width );
+            else if( cinfo->out_color_components == 3 )
+                icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, cvSize(roi.width,1) );
+            else
+                icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, cvSize(roi.width,1) );
+        }
+        else
+        {
+            if( cinfo->out_color_components == 1 )
+                memcpy( data, src, roi.width );
+            else
+                icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, cvSize(roi.width,1) );
+        }
+    }
+}
+
 bool  JpegDecoder::readData( Mat& img )
 {
     volatile bool result = false;
-    size_t step = img.step;
-    bool color = img.channels() > 1;
 
     if( m_state && m_width && m_height )
     {
         jpeg_decompress_struct* cinfo = &((JpegState*)m_state)->cinfo;
         JpegErrorMgr* jerr = &((JpegState*)m_state)->jerr;
-        JSAMPARRAY buffer = 0;
 
         if( setjmp( jerr->setjmp_buffer ) == 0 )
         {
@@ -414,60 +824,19 @@ bool  JpegDecoder::readData( Mat& img )
                     cinfo->dc_huff_tbl_ptrs );
             }
 
-            if( color )
+            const Rect roi = m_roi.empty() ? Rect(0, 0, m_width, m_height) : m_roi;
+            if( m_yuv )
             {
-                if( cinfo->num_components != 4 )
-                {
-                    cinfo->out_color_space = JCS_RGB;
-                    cinfo->out_color_components = 3;
-                }
-                else
-                {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                }
+                CV_Assert( img.type() == CV_8UC1 && img.size() == yuv420MatSize( roi.size() ) );
+                readYuv420( cinfo, roi, img, m_yuv == IMREAD_YUV_NV12 );
             }
             else
-            {
-                if( cinfo->num_components != 4 )
-                {
-                    cinfo->out_color_space = JCS_GRAYSCALE;
-                    cinfo->out_color_components = 1;
-                }
-                else
-                {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                }
-            }
-
-            jpeg_start_decompress( cinfo );
-
-            buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
-                                              JPOOL_IMAGE, m_width*4, 1 );
-
-            uchar* data = img.ptr();
-            for( ; m_height--; data += step )
-            {
-                jpeg_read_scanlines( cinfo, buffer, 1 );
-                if( color )
-                {
-                    if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                    else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                }
-                else
-                {
-                    if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
-                    else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                }
-            }
+                readRows( cinfo, roi, img );
 
             result = true;
-            jpeg_finish_decompress( cinfo );
+            // the rows below the region are not decompressed at all
+            if( cinfo->output_scanline >= cinfo->output_height )
+                jpeg_finish_decompress( cinfo );
         }
     }
 
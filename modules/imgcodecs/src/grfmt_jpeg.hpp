@@ -62,14 +62,19 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  setRegion( const Rect& roi, const Size& minSize ) CV_OVERRIDE;
+    bool  setYUVOutput( int layout ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool  recycle() CV_OVERRIDE;
 
 protected:
 
     FILE* m_f;
     void* m_state;
+    Rect  m_roi;   // region to decode, in the scaled image coordinates
+    int   m_yuv;   // IMREAD_YUV_I420 or IMREAD_YUV_NV12 output, 0 for BGR or gray
 
 private:
     JpegDecoder(const JpegDecoder &); // copy disabled
@@ -349,6 +349,11 @@ bool PAMDecoder::checkSignature( const String& signature ) const
            isspace(signature[2]);
 }
 
+bool PAMDecoder::checkFirstByte( uchar first ) const
+{
+    return first == 'P';
+}
+
 ImageDecoder PAMDecoder::newDecoder() const
 {
     return makePtr<PAMDecoder>();
@@ -71,6 +71,7 @@ public:
 
     size_t signatureLength() const CV_OVERRIDE;
     bool checkSignature( const String& signature ) const CV_OVERRIDE;
+    bool checkFirstByte( uchar first ) const CV_OVERRIDE;
     ImageDecoder newDecoder() const CV_OVERRIDE;
 
 protected:
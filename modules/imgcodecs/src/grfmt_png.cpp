@@ -90,6 +90,7 @@ PngDecoder::PngDecoder()
     m_info_ptr = m_end_info = 0;
     m_f = 0;
     m_buf_supported = true;
+    m_source_supported = true;
     m_buf_pos = 0;
     m_bit_depth = 0;
 }
@@ -105,6 +106,13 @@ ImageDecoder PngDecoder::newDecoder() const
     return makePtr<PngDecoder>();
 }
 
+bool  PngDecoder::recycle()
+{
+    close();
+    BaseImageDecoder::recycle();
+    return true;
+}
+
 void  PngDecoder::close()
 {
     if( m_f )
@@ -121,6 +129,8 @@ void  PngDecoder::close()
         png_destroy_read_struct( &png_ptr, &info_ptr, &end_info );
         m_png_ptr = m_info_ptr = m_end_info = 0;
     }
+    m_reader.close();
+    m_roi = Rect();
 }
 
 
@@ -139,6 +149,15 @@ void  PngDecoder::readDataFromBuf( void* _png_ptr, uchar* dst, size_t size )
     decoder->m_buf_pos += size;
 }
 
+void  PngDecoder::readDataFromSource( void* _png_ptr, uchar* dst, size_t size )
+{
+    png_structp png_ptr = (png_structp)_png_ptr;
+    PngDecoder* decoder = (PngDecoder*)(png_get_io_ptr(png_ptr));
+    CV_Assert( decoder );
+    if( decoder->m_reader.read( dst, size ) != size )
+        png_error(png_ptr, "PNG input source is incomplete");
+}
+
 bool  PngDecoder::readHeader()
 {
     volatile bool result = false;
@@ -162,6 +181,11 @@ bool  PngDecoder::readHeader()
             {
                 if( !m_buf.empty() )
                     png_set_read_fn(png_ptr, this, (png_rw_ptr)readDataFromBuf );
+                else if( m_source )
+                {
+                    if( m_reader.open( m_source ) )
+                        png_set_read_fn(png_ptr, this, (png_rw_ptr)readDataFromSource );
+                }
                 else
                 {
                     m_f = fopen( m_filename.c_str(), "rb" );
@@ -169,7 +193,7 @@ bool  PngDecoder::readHeader()
                         png_init_io( png_ptr, m_f );
                 }
 
-                if( !m_buf.empty() || m_f )
+                if( !m_buf.empty() || m_f || m_reader.isOpened() )
                 {
                     png_uint_32 wdth, hght;
                     int bit_depth, color_type, num_trans=0;
@@ -221,6 +245,22 @@ bool  PngDecoder::readHeader()
 }
 
 
+bool  PngDecoder::setRegion( const Rect& roi, const Size& )
+{
+    Rect r = roi & Rect(0, 0, m_width, m_height);
+    if( !m_png_ptr || r.empty() )
+        return false;
+
+    // every pass of an interlaced image spans the whole height
+    if( png_get_interlace_type( (png_structp)m_png_ptr, (png_infop)m_info_ptr ) != PNG_INTERLACE_NONE )
+        return false;
+
+    m_roi = r;
+    m_width = r.width;
+    m_height = r.height;
+    return true;
+}
+
 bool  PngDecoder::readData( Mat& img )
 {
     volatile bool result = false;
@@ -278,11 +318,28 @@ bool  PngDecoder::readData( Mat& img )
             png_set_interlace_handling( png_ptr );
             png_read_update_info( png_ptr, info_ptr );
 
-            for( y = 0; y < m_height; y++ )
-                buffer[y] = img.data + y*img.step;
+            if( m_roi.empty() )
+            {
+                for( y = 0; y < m_height; y++ )
+                    buffer[y] = img.data + y*img.step;
 
-            png_read_image( png_ptr, buffer );
-            png_read_end( png_ptr, end_info );
+                png_read_image( png_ptr, buffer );
+                png_read_end( png_ptr, end_info );
+            }
+            else
+            {
+                // read the rows one by one and stop at the bottom of the region
+                AutoBuffer<uchar> _row( png_get_rowbytes( png_ptr, info_ptr ) );
+                uchar* row = _row;
+                const size_t esz = img.elemSize();
+
+                for( y = 0; y < m_roi.y + m_roi.height; y++ )
+                {
+                    png_read_row( png_ptr, row, NULL );
+                    if( y >= m_roi.y )
+                        memcpy( img.ptr(y - m_roi.y), row + m_roi.x*esz, m_roi.width*esz );
+                }
+            }
 
             result = true;
         }
@@ -336,6 +393,254 @@ void PngEncoder::flushBuf(void*)
 {
 }
 
+namespace {
+
+// Rows are filtered and deflated in independent blocks of about this size
+// (the same way pigz does), the blocks are joined into one zlib stream.
+const size_t PNG_BLOCK_SIZE = 1 << 18;
+
+// converts a row to the PNG sample order: RGB(A), 16-bit samples in big-endian order
+static void convertRowToPng( const Mat& img, int y, uchar* dst )
+{
+    int x, width = img.cols, cn = img.channels();
+    if( img.depth() == CV_8U )
+    {
+        const uchar* src = img.ptr(y);
+        if( cn == 1 )
+            memcpy( dst, src, width );
+        else
+            for( x = 0; x < width; x++, src += cn, dst += cn )
+            {
+                dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0];
+                if( cn == 4 )
+                    dst[3] = src[3];
+            }
+    }
+    else
+    {
+        const ushort* src = img.ptr<ushort>(y);
+        for( x = 0; x < width; x++, src += cn, dst += cn*2 )
+            for( int c = 0; c < cn; c++ )
+            {
+                ushort v = src[cn >= 3 && c < 3 ? 2 - c : c];
+                dst[c*2] = (uchar)(v >> 8);
+                dst[c*2 + 1] = (uchar)v;
+            }
+    }
+}
+
+static inline uchar paethPredictor( int a, int b, int c )
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return (uchar)(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+}
+
+// applies PNG filter type (0 - none, 1 - sub, 2 - up, 3 - average, 4 - paeth),
+// prev is 0 for the first row of the image
+static void filterRow( int type, const uchar* row, const uchar* prev, size_t len, int bpp, uchar* dst )
+{
+    size_t i;
+    dst[0] = (uchar)type;
+    dst++;
+    switch( type )
+    {
+    case 1:
+        for( i = 0; i < len; i++ )
+            dst[i] = (uchar)(row[i] - (i >= (size_t)bpp ? row[i - bpp] : 0));
+        break;
+    case 2:
+        for( i = 0; i < len; i++ )
+            dst[i] = (uchar)(row[i] - (prev ? prev[i] : 0));
+        break;
+    case 3:
+        for( i = 0; i < len; i++ )
+        {
+            int a = i >= (size_t)bpp ? row[i - bpp] : 0, b = prev ? prev[i] : 0;
+            dst[i] = (uchar)(row[i] - ((a + b) >> 1));
+        }
+        break;
+    case 4:
+        for( i = 0; i < len; i++ )
+        {
+            int a = i >= (size_t)bpp ? row[i - bpp] : 0, b = prev ? prev[i] : 0;
+            int c = i >= (size_t)bpp && prev ? prev[i - bpp] : 0;
+            dst[i] = (uchar)(row[i] - paethPredictor(a, b, c));
+        }
+        break;
+    default:
+        memcpy( dst, row, len );
+    }
+}
+
+// sum of absolute values of the filtered bytes taken as signed, the libpng heuristic
+static size_t filteredRowCost( const uchar* filtered, size_t len )
+{
+    size_t sum = 0;
+    for( size_t i = 1; i <= len; i++ )
+        sum += std::abs((int)(schar)filtered[i]);
+    return sum;
+}
+
+class PngDeflateInvoker : public ParallelLoopBody
+{
+public:
+    PngDeflateInvoker( const Mat& img, int rowsPerBlock, int filters, int level, int strategy,
+                       std::vector<std::vector<uchar> >& blocks, std::vector<uLong>& adlers,
+                       std::vector<size_t>& lengths, std::vector<uchar>& status ) :
+        img_(img), rowsPerBlock_(rowsPerBlock), filters_(filters), level_(level), strategy_(strategy),
+        blocks_(&blocks), adlers_(&adlers), lengths_(&lengths), status_(&status)
+    {
+    }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        const int bpp = (int)img_.elemSize();
+        const size_t rowbytes = (size_t)img_.cols * bpp;
+        const int nblocks = (int)blocks_->size();
+        AutoBuffer<uchar> rows( rowbytes*2 ), candidate( rowbytes + 1 );
+        std::vector<uchar> filtered( (rowbytes + 1)*rowsPerBlock_ );
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*rowsPerBlock_, y1 = std::min( y0 + rowsPerBlock_, img_.rows );
+            uchar* prev = rows;
+            uchar* cur = rows + rowbytes;
+            if( y0 > 0 )
+                convertRowToPng( img_, y0 - 1, prev );
+
+            for( int y = y0; y < y1; y++ )
+            {
+                convertRowToPng( img_, y, cur );
+                uchar* dst = &filtered[(y - y0)*(rowbytes + 1)];
+                const uchar* above = y > 0 ? prev : 0;
+                size_t bestCost = (size_t)-1;
+                for( int type = 0; type < 5; type++ )
+                {
+                    if( (filters_ & (PNG_FILTER_NONE << type)) == 0 )
+                        continue;
+                    if( bestCost == (size_t)-1 )
+                    {
+                        filterRow( type, cur, above, rowbytes, bpp, dst );
+                        bestCost = filteredRowCost( dst, rowbytes );
+                        continue;
+                    }
+                    filterRow( type, cur, above, rowbytes, bpp, candidate );
+                    size_t cost = filteredRowCost( candidate, rowbytes );
+                    if( cost < bestCost )
+                    {
+                        bestCost = cost;
+                        memcpy( dst, candidate, rowbytes + 1 );
+                    }
+                }
+                std::swap( prev, cur );
+            }
+
+            size_t len = (y1 - y0)*(rowbytes + 1);
+            (*lengths_)[b] = len;
+            (*adlers_)[b] = adler32( adler32(0L, Z_NULL, 0), &filtered[0], (uInt)len );
+            (*status_)[b] = deflateBlock( &filtered[0], len, b == nblocks - 1, (*blocks_)[b] );
+        }
+    }
+
+protected:
+    // raw deflate of one block, ended by a sync flush (or the final block)
+    // so that the blocks can be concatenated
+    bool deflateBlock( const uchar* data, size_t len, bool last, std::vector<uchar>& out ) const
+    {
+        z_stream strm;
+        memset( &strm, 0, sizeof(strm) );
+        if( deflateInit2( &strm, level_, Z_DEFLATED, -MAX_WBITS, 8, strategy_ ) != Z_OK )
+            return false;
+
+        out.resize( deflateBound( &strm, (uLong)len ) + 16 );
+        strm.next_in = (Bytef*)data;
+        strm.avail_in = (uInt)len;
+        strm.next_out = &out[0];
+        strm.avail_out = (uInt)out.size();
+
+        bool ok = false;
+        for(;;)
+        {
+            if( strm.avail_out == 0 )
+            {
+                size_t used = out.size();
+                out.resize( used*2 );
+                strm.next_out = &out[used];
+                strm.avail_out = (uInt)used;
+            }
+            int code = deflate( &strm, last ? Z_FINISH : Z_SYNC_FLUSH );
+            if( code == Z_STREAM_ERROR )
+                break;
+            if( last ? code == Z_STREAM_END : strm.avail_in == 0 && strm.avail_out > 0 )
+            {
+                ok = true;
+                break;
+            }
+        }
+        out.resize( strm.total_out );
+        deflateEnd( &strm );
+        return ok;
+    }
+
+    const Mat& img_;
+    int rowsPerBlock_;
+    int filters_;
+    int level_;
+    int strategy_;
+    std::vector<std::vector<uchar> >* blocks_;
+    std::vector<uLong>* adlers_;
+    std::vector<size_t>* lengths_;
+    std::vector<uchar>* status_;
+};
+
+}
+
+/**
+ * Filters and compresses the image rows in parallel, producing the complete
+ * zlib stream of the IDAT chunks as a list of pieces.
+ *
+ * Returns false if the image is too small to be split or compression fails.
+*/
+static bool deflateImageParallel( const Mat& img, int filters, int level, int strategy,
+                                  std::vector<std::vector<uchar> >& blocks )
+{
+    const size_t rowbytes = (size_t)img.cols * img.elemSize();
+    int rowsPerBlock = (int)std::max( PNG_BLOCK_SIZE / (rowbytes + 1), (size_t)1 );
+    int nblocks = (img.rows + rowsPerBlock - 1) / rowsPerBlock;
+    if( nblocks < 2 )
+        return false;
+
+    blocks.resize( nblocks );
+    std::vector<uLong> adlers( nblocks );
+    std::vector<size_t> lengths( nblocks );
+    std::vector<uchar> status( nblocks, 0 );
+    parallel_for_( Range(0, nblocks),
+                   PngDeflateInvoker(img, rowsPerBlock, filters, level, strategy, blocks, adlers, lengths, status),
+                   nblocks );
+
+    uLong adler = adler32( 0L, Z_NULL, 0 );
+    for( int b = 0; b < nblocks; b++ )
+    {
+        if( !status[b] )
+            return false;
+        adler = adler32_combine( adler, adlers[b], (z_off_t)lengths[b] );
+    }
+
+    // zlib header: deflate with 32K window, FLEVEL from the compression level
+    int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    int cmf = 0x78, flg = flevel << 6;
+    flg += 31 - (cmf*256 + flg) % 31;
+    std::vector<uchar>& first = blocks[0];
+    first.insert( first.begin(), (uchar)flg );
+    first.insert( first.begin(), (uchar)cmf );
+
+    std::vector<uchar>& last = blocks[nblocks - 1];
+    for( int shift = 24; shift >= 0; shift -= 8 )
+        last.push_back( (uchar)(adler >> shift) );
+    return true;
+}
+
 bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 {
     png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
@@ -345,6 +650,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
     int depth = img.depth(), channels = img.channels();
     volatile bool result = false;
     AutoBuffer<uchar*> buffer;
+    std::vector<std::vector<uchar> > blocks;
 
     if( depth != CV_8U && depth != CV_16U )
         return false;
@@ -371,6 +677,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
+                int filter = -1;
                 bool isBilevel = false;
 
                 for( size_t i = 0; i < params.size(); i += 2 )
@@ -390,6 +697,12 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         isBilevel = params[i+1] != 0;
                     }
+                    if( params[i] == IMWRITE_PNG_FILTER )
+                    {
+                        filter = params[i+1] & PNG_ALL_FILTERS;
+                        if( filter == 0 )
+                            filter = PNG_FILTER_NONE;
+                    }
                 }
 
                 if( m_buf || f )
@@ -402,9 +715,15 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         // tune parameters for speed
                         // (see http://wiki.linuxquestions.org/wiki/Libpng)
-                        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+                        if( filter < 0 )
+                            filter = PNG_FILTER_SUB;
+                        compression_level = Z_BEST_SPEED;
                         png_set_compression_level(png_ptr, Z_BEST_SPEED);
                     }
+                    if( filter >= 0 )
+                        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filter);
+                    else
+                        filter = PNG_ALL_FILTERS; // the libpng default for 8 and 16-bit images
                     png_set_compression_strategy(png_ptr, compression_strategy);
 
                     png_set_IHDR( png_ptr, info_ptr, width, height, depth == CV_8U ? isBilevel?1:8 : 16,
@@ -415,21 +734,33 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                     png_write_info( png_ptr, info_ptr );
 
-                    if (isBilevel)
-                        png_set_packing(png_ptr);
+                    // large images are compressed in parallel, IDAT and IEND chunks are written directly
+                    if( !isBilevel && getNumThreads() > 1 &&
+                        deflateImageParallel( img, filter, compression_level, compression_strategy, blocks ) )
+                    {
+                        for( size_t i = 0; i < blocks.size(); i++ )
+                            png_write_chunk( png_ptr, (png_const_bytep)"IDAT", &blocks[i][0], blocks[i].size() );
+                        png_write_chunk( png_ptr, (png_const_bytep)"IEND", NULL, 0 );
+                        result = true;
+                    }
+                    else
+                    {
+                        if (isBilevel)
+                            png_set_packing(png_ptr);
 
-                    png_set_bgr( png_ptr );
-                    if( !isBigEndian() )
-                        png_set_swap( png_ptr );
+                        png_set_bgr( png_ptr );
+                        if( !isBigEndian() )
+                            png_set_swap( png_ptr );
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
+                        buffer.allocate(height);
+                        for( y = 0; y < height; y++ )
+                            buffer[y] = img.data + y*img.step;
 
-                    png_write_image( png_ptr, buffer );
-                    png_write_end( png_ptr, info_ptr );
+                        png_write_image( png_ptr, buffer );
+                        png_write_end( png_ptr, info_ptr );
 
-                    result = true;
+                        result = true;
+                    }
                 }
             }
         }
@@ -60,13 +60,16 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  setRegion( const Rect& roi, const Size& minSize ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool  recycle() CV_OVERRIDE;
 
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    static void readDataFromSource(void* png_ptr, uchar* dst, size_t size);
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -75,6 +78,8 @@ protected:
     FILE* m_f;
     int   m_color_type;
     size_t m_buf_pos;
+    SourceReader m_reader;
+    Rect  m_roi;      // region to decode, empty for the whole image
 };
 
 
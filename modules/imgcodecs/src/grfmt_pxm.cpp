@@ -125,11 +125,23 @@ bool PxMDecoder::checkSignature( const String& signature ) const
            isspace(signature[2]);
 }
 
+bool PxMDecoder::checkFirstByte( uchar first ) const
+{
+    return first == 'P';
+}
+
 ImageDecoder PxMDecoder::newDecoder() const
 {
     return makePtr<PxMDecoder>();
 }
 
+bool PxMDecoder::recycle()
+{
+    close();
+    BaseImageDecoder::recycle();
+    return true;
+}
+
 void PxMDecoder::close()
 {
     m_strm.close();
@@ -80,6 +80,7 @@ TiffDecoder::TiffDecoder()
     }
     m_hdr = false;
     m_buf_supported = true;
+    m_source_supported = true;
     m_buf_pos = 0;
 }
 
@@ -111,6 +112,21 @@ bool TiffDecoder::checkSignature( const String& signature ) const
         memcmp(signature.c_str(), fmtSignTiffMM, 4) == 0);
 }
 
+bool TiffDecoder::checkFirstByte( uchar first ) const
+{
+    return first == 'I' || first == 'M';
+}
+
+bool TiffDecoder::recycle()
+{
+    close();
+    BaseImageDecoder::recycle();
+    m_hdr = false;
+    m_buf_pos = 0;
+    m_roi = Rect();
+    return true;
+}
+
 int TiffDecoder::normalizeChannelsNumber(int channels) const
 {
     return channels > 4 ? 4 : channels;
@@ -197,10 +213,75 @@ public:
     }
 };
 
+class TiffDecoderSourceHelper
+{
+    SourceReader m_reader;
+public:
+    bool open(const Ptr<ImageDecodeSource>& source)
+    {
+        return m_reader.open(source);
+    }
+
+    static tmsize_t read( thandle_t handle, void* buffer, tmsize_t n )
+    {
+        TiffDecoderSourceHelper *helper = reinterpret_cast<TiffDecoderSourceHelper*>(handle);
+        return (tmsize_t)helper->m_reader.read((uchar*)buffer, (size_t)n);
+    }
+
+    static tmsize_t write( thandle_t /*handle*/, void* /*buffer*/, tmsize_t /*n*/ )
+    {
+        // Not used for decoding.
+        return 0;
+    }
+
+    static toff_t seek( thandle_t handle, toff_t offset, int whence )
+    {
+        TiffDecoderSourceHelper *helper = reinterpret_cast<TiffDecoderSourceHelper*>(handle);
+        const toff_t size = helper->m_reader.size();
+        toff_t new_pos = helper->m_reader.tell();
+        switch (whence)
+        {
+            case SEEK_SET:
+                new_pos = offset;
+                break;
+            case SEEK_CUR:
+                new_pos += offset;
+                break;
+            case SEEK_END:
+                new_pos = size + offset;
+                break;
+        }
+        new_pos = std::min(new_pos, size);
+        if( new_pos != helper->m_reader.tell() && !helper->m_reader.seek((size_t)new_pos) )
+            return (toff_t)-1;
+        return new_pos;
+    }
+
+    static int map( thandle_t /*handle*/, void** /*base*/, toff_t* /*size*/ )
+    {
+        // The data is not contiguous.
+        return 0;
+    }
+
+    static toff_t size( thandle_t handle )
+    {
+        TiffDecoderSourceHelper *helper = reinterpret_cast<TiffDecoderSourceHelper*>(handle);
+        return helper->m_reader.size();
+    }
+
+    static int close( thandle_t handle )
+    {
+        TiffDecoderSourceHelper *helper = reinterpret_cast<TiffDecoderSourceHelper*>(handle);
+        delete helper;
+        return 0;
+    }
+};
+
 bool TiffDecoder::readHeader()
 {
     bool result = false;
 
+    m_roi = Rect();
     TIFF* tif = static_cast<TIFF*>(m_tif);
     if (!m_tif)
     {
@@ -215,6 +296,19 @@ bool TiffDecoder::readHeader()
                                   &TiffDecoderBufHelper::close, &TiffDecoderBufHelper::size,
                                   &TiffDecoderBufHelper::map, /*unmap=*/0 );
         }
+        else if ( m_source )
+        {
+            TiffDecoderSourceHelper* source_helper = new TiffDecoderSourceHelper();
+            if ( source_helper->open(m_source) )
+            {
+                tif = TIFFClientOpen( "", "rm", reinterpret_cast<thandle_t>(source_helper), &TiffDecoderSourceHelper::read,
+                                      &TiffDecoderSourceHelper::write, &TiffDecoderSourceHelper::seek,
+                                      &TiffDecoderSourceHelper::close, &TiffDecoderSourceHelper::size,
+                                      &TiffDecoderSourceHelper::map, /*unmap=*/0 );
+            }
+            else
+                delete source_helper;
+        }
         else
         {
             tif = TIFFOpen(m_filename.c_str(), "r");
@@ -280,6 +374,26 @@ bool TiffDecoder::readHeader()
     return result;
 }
 
+bool TiffDecoder::setRegion( const Rect& roi, const Size& )
+{
+    Rect r = roi & Rect(0, 0, m_width, m_height);
+    if( !m_tif || r.empty() || m_hdr ||
+        (CV_MAT_DEPTH(m_type) != CV_8U && CV_MAT_DEPTH(m_type) != CV_16U) )
+        return false;
+
+    // flipped images are written bottom-up, leave them to the caller
+    uint16 img_orientation = ORIENTATION_TOPLEFT;
+    TIFFGetField( static_cast<TIFF*>(m_tif), TIFFTAG_ORIENTATION, &img_orientation );
+    if( img_orientation == ORIENTATION_BOTRIGHT || img_orientation == ORIENTATION_RIGHTBOT ||
+        img_orientation == ORIENTATION_BOTLEFT || img_orientation == ORIENTATION_LEFTBOT )
+        return false;
+
+    m_roi = r;
+    m_width = r.width;
+    m_height = r.height;
+    return true;
+}
+
 bool TiffDecoder::nextPage()
 {
     // Prepare the next page, if any.
@@ -307,7 +421,16 @@ bool  TiffDecoder::readData( Mat& img )
     if( m_tif && m_width && m_height )
     {
         TIFF* tif = (TIFF*)m_tif;
-        uint32 tile_width0 = m_width, tile_height0 = 0;
+        Size full_size(m_width, m_height);
+        if( !m_roi.empty() )
+        {
+            uint32 wdth = 0, hght = 0;
+            TIFFGetField( tif, TIFFTAG_IMAGEWIDTH, &wdth );
+            TIFFGetField( tif, TIFFTAG_IMAGELENGTH, &hght );
+            full_size = Size((int)wdth, (int)hght);
+        }
+        const Rect roi = m_roi.empty() ? Rect(Point(), full_size) : m_roi;
+        uint32 tile_width0 = full_size.width, tile_height0 = 0;
         int x, y, i;
         int is_tiled = TIFFIsTiled(tif);
         uint16 photometric;
@@ -342,11 +465,11 @@ bool  TiffDecoder::readData( Mat& img )
                 TIFFGetField( tif, TIFFTAG_ROWSPERSTRIP, &tile_height0 );
 
             if( tile_width0 <= 0 )
-                tile_width0 = m_width;
+                tile_width0 = full_size.width;
 
             if( tile_height0 <= 0 ||
                (!is_tiled && tile_height0 == std::numeric_limits<uint32>::max()) )
-                tile_height0 = m_height;
+                tile_height0 = full_size.height;
 
             if(dst_bpp == 8) {
                 // we will use TIFFReadRGBA* functions, so allocate temporary buffer for 32bit RGBA
@@ -359,23 +482,44 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
+            const int tiles_across = (full_size.width + (int)tile_width0 - 1) / (int)tile_width0;
+
+            // when decoding a region, only the tiles (strips) intersecting it are read,
+            // each one is converted into tile_img and the intersection is copied to img
+            Mat tile_img;
+            if( !m_roi.empty() )
+                tile_img.create( tile_height0, tile_width0, img.type() );
 
-            for( y = 0; y < m_height; y += tile_height0 )
+            for( y = roi.y - roi.y % (int)tile_height0; y < roi.y + roi.height; y += tile_height0 )
             {
                 int tile_height = tile_height0;
 
-                if( y + tile_height > m_height )
-                    tile_height = m_height - y;
+                if( y + tile_height > full_size.height )
+                    tile_height = full_size.height - y;
 
-                uchar* data = img.ptr(vert_flip ? m_height - y - tile_height : y);
-
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                for( x = roi.x - roi.x % (int)tile_width0; x < roi.x + roi.width; x += tile_width0 )
                 {
                     int tile_width = tile_width0, ok;
+                    int tileidx = (y / (int)tile_height0) * tiles_across + x / (int)tile_width0;
+
+                    if( x + tile_width > full_size.width )
+                        tile_width = full_size.width - x;
 
-                    if( x + tile_width > m_width )
-                        tile_width = m_width - x;
+                    uchar* data;
+                    size_t data_step;
+                    int dx;
+                    if( tile_img.empty() )
+                    {
+                        data = img.ptr(vert_flip ? full_size.height - y - tile_height : y);
+                        data_step = img.step;
+                        dx = x;
+                    }
+                    else
+                    {
+                        data = tile_img.ptr();
+                        data_step = tile_img.step;
+                        dx = 0;
+                    }
 
                     switch(dst_bpp)
                     {
@@ -402,19 +546,19 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R( bstart + i*tile_width0*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
+                                                             data + dx*4 + data_step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1) );
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_8u_C4C3R( bstart + i*tile_width0*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
+                                                             data + dx*3 + data_step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1), 2 );
                                     }
                                 }
                                 else
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
+                                                              data + dx + data_step*(tile_height - i - 1), 0,
                                                               cvSize(tile_width,1), 2 );
                             break;
                         }
@@ -439,13 +583,13 @@ bool  TiffDecoder::readData( Mat& img )
                                     if( ncn == 1 )
                                     {
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
+                                                                  (ushort*)(data + data_step*i) + dx*3, 0,
                                                                   cvSize(tile_width,1) );
                                     }
                                     else if( ncn == 3 )
                                     {
                                         icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + data_step*i) + dx*3, 0,
                                                                cvSize(tile_width,1) );
                                     }
                                     else if (ncn == 4)
@@ -453,20 +597,20 @@ bool  TiffDecoder::readData( Mat& img )
                                         if (wanted_channels == 4)
                                         {
                                             icvCvt_BGRA2RGBA_16u_C4R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 4, 0,
+                                                (ushort*)(data + data_step*i) + dx * 4, 0,
                                                 cvSize(tile_width, 1));
                                         }
                                         else
                                         {
                                             icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 3, 0,
+                                                (ushort*)(data + data_step*i) + dx * 3, 0,
                                                 cvSize(tile_width, 1), 2);
                                         }
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + data_step*i) + dx*3, 0,
                                                                cvSize(tile_width,1), 2 );
                                     }
                                 }
@@ -474,14 +618,14 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
+                                        memcpy((ushort*)(data + data_step*i)+dx,
                                                buffer16 + i*tile_width0*ncn,
                                                tile_width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
+                                                               (ushort*)(data + data_step*i) + dx, 0,
                                                                cvSize(tile_width,1), ncn, 2 );
                                     }
                                 }
@@ -507,13 +651,13 @@ bool  TiffDecoder::readData( Mat& img )
                             {
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
+                                    memcpy((float*)(data + data_step*i)+dx,
                                            buffer32 + i*tile_width0*ncn,
                                            tile_width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
+                                    memcpy((double*)(data + data_step*i)+dx,
                                          buffer64 + i*tile_width0*ncn,
                                          tile_width*sizeof(buffer64[0]));
                                 }
@@ -527,6 +671,12 @@ bool  TiffDecoder::readData( Mat& img )
                             return false;
                         }
                     }
+
+                    if( !tile_img.empty() )
+                    {
+                        Rect tile_roi = Rect(x, y, tile_width, tile_height) & roi;
+                        tile_img(tile_roi - Point(x, y)).copyTo(img(tile_roi - roi.tl()));
+                    }
                 }
             }
 
@@ -724,6 +874,153 @@ static void readParam(const std::vector<int>& params, int key, int& value)
         }
 }
 
+// converts a row to the TIFF sample order (RGB), returns false for unsupported number of channels
+static bool convertRowToTiff(const Mat& img, int y, uchar* buffer, size_t scanlineSize)
+{
+    int width = img.cols, depth = img.depth();
+    switch (img.channels())
+    {
+        case 1:
+        {
+            memcpy(buffer, img.ptr(y), scanlineSize);
+            return true;
+        }
+
+        case 3:
+        {
+            if (depth == CV_8U)
+                icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
+            else
+                icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
+            return true;
+        }
+
+        case 4:
+        {
+            if (depth == CV_8U)
+                icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
+            else
+                icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+// Strips are compressed independently, so the codecs which don't share state between strips
+// can run in parallel: every thread encodes its strips into a separate in-memory TIFF and
+// the encoded strips are copied to the output file with TIFFWriteRawStrip.
+static bool isParallelStripCompression(int compression)
+{
+    return compression == COMPRESSION_NONE || compression == COMPRESSION_LZW ||
+           compression == COMPRESSION_ADOBE_DEFLATE || compression == COMPRESSION_DEFLATE ||
+           compression == COMPRESSION_PACKBITS;
+}
+
+class TiffStripEncoder : public ParallelLoopBody
+{
+public:
+    TiffStripEncoder(const Mat& img, int bitsPerChannel, int rowsPerStrip, int compression, int predictor,
+                     int firstStrip, std::vector<std::vector<uchar> >& strips, std::vector<uchar>& status)
+        : img_(img), bitsPerChannel_(bitsPerChannel), rowsPerStrip_(rowsPerStrip), compression_(compression),
+          predictor_(predictor), firstStrip_(firstStrip), strips_(&strips), status_(&status)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int y0 = (firstStrip_ + range.start) * rowsPerStrip_;
+        int y1 = std::min((firstStrip_ + range.end) * rowsPerStrip_, img_.rows);
+        int channels = img_.channels();
+
+        std::vector<uchar> data;
+        TiffEncoderBufHelper buf_helper(&data);
+        TIFF* tif = buf_helper.open();
+        if (!tif)
+            return;
+
+        if (!TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, img_.cols)
+            || !TIFFSetField(tif, TIFFTAG_IMAGELENGTH, y1 - y0)
+            || !TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel_)
+            || !TIFFSetField(tif, TIFFTAG_COMPRESSION, compression_)
+            || !TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK)
+            || !TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels)
+            || !TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+            || !TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip_)
+            || (compression_ != COMPRESSION_NONE && !TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor_)))
+        {
+            TIFFClose(tif);
+            return;
+        }
+
+        size_t scanlineSize = TIFFScanlineSize(tif);
+        AutoBuffer<uchar> _buffer(scanlineSize * rowsPerStrip_ + 32);
+        uchar* buffer = _buffer;
+        bool ok = true;
+        for (int i = range.start; ok && i < range.end; i++)
+        {
+            int strip = i - range.start;
+            int y = y0 + strip * rowsPerStrip_, rows = std::min(rowsPerStrip_, y1 - y);
+            for (int j = 0; ok && j < rows; j++)
+                ok = convertRowToTiff(img_, y + j, buffer + j * scanlineSize, scanlineSize);
+            // TIFFWriteEncodedStrip modifies the buffer (predictor), it is converted again for every strip
+            ok = ok && TIFFWriteEncodedStrip(tif, strip, buffer, (tmsize_t)(scanlineSize * rows)) >= 0;
+        }
+
+        uint64* offsets = 0;
+        uint64* counts = 0;
+        if (ok && TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &offsets) && TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &counts))
+        {
+            for (int i = range.start; i < range.end; i++)
+            {
+                int strip = i - range.start;
+                const uchar* begin = &data[0] + offsets[strip];
+                (*strips_)[i].assign(begin, begin + counts[strip]);
+                (*status_)[i] = 1;
+            }
+        }
+        TIFFClose(tif);
+    }
+
+protected:
+    const Mat& img_;
+    int bitsPerChannel_;
+    int rowsPerStrip_;
+    int compression_;
+    int predictor_;
+    int firstStrip_;
+    std::vector<std::vector<uchar> >* strips_;
+    std::vector<uchar>* status_;
+};
+
+static bool writeStripsParallel(TIFF* tif, const Mat& img, int bitsPerChannel, int rowsPerStrip,
+                                int compression, int predictor, size_t scanlineSize)
+{
+    const int nstrips = (img.rows + rowsPerStrip - 1) / rowsPerStrip;
+    // bound the memory held by the encoded strips
+    const int batchSize = std::max((int)((64 << 20) / (scanlineSize * rowsPerStrip)), getNumThreads());
+    std::vector<std::vector<uchar> > strips;
+    std::vector<uchar> status;
+    for (int first = 0; first < nstrips; first += batchSize)
+    {
+        int count = std::min(batchSize, nstrips - first);
+        strips.assign(count, std::vector<uchar>());
+        status.assign(count, (uchar)0);
+        parallel_for_(Range(0, count),
+                      TiffStripEncoder(img, bitsPerChannel, rowsPerStrip, compression, predictor, first, strips, status),
+                      getNumThreads());
+        for (int i = 0; i < count; i++)
+        {
+            if (!status[i] ||
+                TIFFWriteRawStrip(tif, first + i, strips[i].empty() ? NULL : &strips[i][0], (tmsize_t)strips[i].size()) < 0)
+                return false;
+        }
+    }
+    return true;
+}
+
 bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
 {
     // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
@@ -833,6 +1130,18 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
 
         // row buffer, because TIFFWriteScanline modifies the original data!
         size_t scanlineSize = TIFFScanlineSize(pTiffHandle);
+
+        if (getNumThreads() > 1 && height > rowsPerStrip && isParallelStripCompression(compression))
+        {
+            if (!writeStripsParallel(pTiffHandle, img, bitsPerChannel, rowsPerStrip, compression, predictor, scanlineSize))
+            {
+                TIFFClose(pTiffHandle);
+                return false;
+            }
+            TIFFWriteDirectory(pTiffHandle);
+            continue;
+        }
+
         AutoBuffer<uchar> _buffer(scanlineSize + 32);
         uchar* buffer = _buffer;
         if (!buffer)
@@ -843,37 +1152,10 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
 
         for (int y = 0; y < height; ++y)
         {
-            switch (channels)
+            if (!convertRowToTiff(img, y, buffer, scanlineSize))
             {
-                case 1:
-                {
-                    memcpy(buffer, img.ptr(y), scanlineSize);
-                    break;
-                }
-
-                case 3:
-                {
-                    if (depth == CV_8U)
-                        icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
-                    else
-                        icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
-                    break;
-                }
-
-                case 4:
-                {
-                    if (depth == CV_8U)
-                        icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
-                    else
-                        icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
-                    break;
-                }
-
-                default:
-                {
-                    TIFFClose(pTiffHandle);
-                    return false;
-                }
+                TIFFClose(pTiffHandle);
+                return false;
             }
 
             int writeResult = TIFFWriteScanline(pTiffHandle, buffer, y, 0);
@@ -100,10 +100,13 @@ public:
     bool  readData( Mat& img ) CV_OVERRIDE;
     void  close();
     bool  nextPage() CV_OVERRIDE;
+    bool  setRegion( const Rect& roi, const Size& minSize ) CV_OVERRIDE;
 
     size_t signatureLength() const CV_OVERRIDE;
     bool checkSignature( const String& signature ) const CV_OVERRIDE;
+    bool checkFirstByte( uchar first ) const CV_OVERRIDE;
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool recycle() CV_OVERRIDE;
 
 protected:
     void* m_tif;
@@ -112,6 +115,7 @@ protected:
     bool readData_32FC1(Mat& img);
     bool m_hdr;
     size_t m_buf_pos;
+    Rect m_roi;
 
 private:
     TiffDecoder(const TiffDecoder &); // copy disabled
@@ -51,6 +51,15 @@
 #undef max
 #include <iostream>
 #include <fstream>
+#include <opencv2/core/utils/configuration.private.hpp>
+
+#if defined __linux__ || defined __APPLE__ || defined __unix__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define IMGCODECS_HAVE_MMAP 1
+#endif
 
 /****************************************************************************************\
 *                                      Image Codecs                                      *
@@ -113,8 +122,193 @@ protected:
     }
 };
 
+// std::streambuf view of an ImageDecodeSource, used to parse EXIF data
+class SourceStreamBuffer: public std::streambuf
+{
+public:
+    explicit SourceStreamBuffer(const Ptr<ImageDecodeSource>& source) : m_base(0)
+    {
+        m_reader.open(source);
+    }
+
+protected:
+    virtual int_type underflow() CV_OVERRIDE
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+
+        size_t count = 0;
+        const uchar* data = m_reader.next(count);
+        if (!data || count == 0)
+            return traits_type::eof();
+
+        m_base = m_reader.tell() - count;
+        char* base = reinterpret_cast<char*>(const_cast<uchar*>(data));
+        setg(base, base, base + count);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    virtual pos_type seekoff( off_type offset,
+                              std::ios_base::seekdir dir,
+                              std::ios_base::openmode mode ) CV_OVERRIDE
+    {
+        off_type whence = 0;
+        if (dir == std::ios_base::cur)
+        {
+            whence = (off_type)(m_base + (gptr() - eback()));
+        }
+        else if (dir == std::ios_base::end)
+        {
+            whence = (off_type)m_reader.size();
+        }
+        return seekpos(whence + offset, mode);
+    }
+
+    virtual pos_type seekpos( pos_type pos, std::ios_base::openmode ) CV_OVERRIDE
+    {
+        off_type to = (off_type)pos;
+        if (to < 0 || (size_t)to > m_reader.size() || !m_reader.seek((size_t)to))
+            return -1;
+        m_base = (size_t)to;
+        setg(0, 0, 0);
+        return pos;
+    }
+
+    SourceReader m_reader;
+    size_t m_base;
+};
+
+// ImageDecodeSource over a list of continuous chunks (e.g. network packets)
+class ChunkSource: public ImageDecodeSource
+{
+public:
+    explicit ChunkSource(const std::vector<Mat>& chunks) : m_index(0), m_offset(0), m_size(0)
+    {
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            if (chunks[i].empty())
+                continue;
+            CV_Assert(chunks[i].isContinuous());
+            m_chunks.push_back(chunks[i]);
+            m_starts.push_back(m_size);
+            m_size += chunks[i].total() * chunks[i].elemSize();
+        }
+    }
+
+    virtual const uchar* next(size_t& size) CV_OVERRIDE
+    {
+        size = 0;
+        if (m_index >= m_chunks.size())
+            return 0;
+        const Mat& chunk = m_chunks[m_index];
+        const uchar* data = chunk.ptr() + m_offset;
+        size = chunk.total() * chunk.elemSize() - m_offset;
+        m_index++;
+        m_offset = 0;
+        return data;
+    }
+
+    virtual bool seek(size_t pos) CV_OVERRIDE
+    {
+        if (pos > m_size)
+            return false;
+        if (pos == m_size)
+        {
+            m_index = m_chunks.size();
+            m_offset = 0;
+            return true;
+        }
+        m_index = (std::upper_bound(m_starts.begin(), m_starts.end(), pos) - m_starts.begin()) - 1;
+        m_offset = pos - m_starts[m_index];
+        return true;
+    }
+
+    virtual size_t size() const CV_OVERRIDE
+    {
+        return m_size;
+    }
+
+protected:
+    std::vector<Mat> m_chunks;
+    std::vector<size_t> m_starts;
+    size_t m_index;
+    size_t m_offset;
+    size_t m_size;
+};
+
+#ifdef IMGCODECS_HAVE_MMAP
+// read-only memory mapping of a whole file, unmapped on destruction. The file must not be
+// truncated while it is mapped, reading the missing pages raises SIGBUS.
+class MappedFile
+{
+public:
+    MappedFile() : m_data(0), m_size(0) {}
+    ~MappedFile() { close(); }
+
+    bool open(const String& filename)
+    {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+            (uint64)st.st_size <= (uint64)INT_MAX)
+        {
+            void* data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = data;
+                m_size = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);
+        return m_data != 0;
+    }
+
+    void close()
+    {
+        if (m_data)
+            munmap(m_data, m_size);
+        m_data = 0;
+        m_size = 0;
+    }
+
+    Mat mat() const
+    {
+        return Mat(1, (int)m_size, CV_8U, m_data);
+    }
+
+protected:
+    void* m_data;
+    size_t m_size;
+
+private:
+    MappedFile(const MappedFile&); // disabled
+    MappedFile& operator=(const MappedFile&); // disabled
+};
+#endif
+
 }
 
+ImageDecodeSource::~ImageDecodeSource() {}
+
+/**
+ * Idle codec instances of one thread, indexed as the registered codecs.
+ * Creating a codec may be costly (e.g. JpegDecoder keeps the libjpeg decompressor),
+ * so a codec released by the caller is kept here for the next image of the same format.
+ * The caches are not freed when their threads exit, so the number of the idle codecs
+ * of all the threads is limited (see keepIdleCodec).
+*/
+struct CodecCache
+{
+    std::vector<ImageDecoder> decoders;
+    std::vector<ImageEncoder> encoders;
+
+    std::vector<ImageDecoder>& idle( const BaseImageDecoder* ) { return decoders; }
+    std::vector<ImageEncoder>& idle( const BaseImageEncoder* ) { return encoders; }
+};
+
 /**
  * @struct ImageCodecInitializer
  *
@@ -174,14 +368,141 @@ struct ImageCodecInitializer
     #endif/*HAVE_GDAL*/
         decoders.push_back( makePtr<PAMDecoder>() );
         encoders.push_back( makePtr<PAMEncoder>() );
+
+        buildSignatureIndex();
+    }
+
+    /**
+     * Collect the decoders which may accept a signature starting with each byte value,
+     * so a signature is checked against a few decoders only
+    */
+    void buildSignatureIndex()
+    {
+        maxSignatureLength = 0;
+        for( size_t i = 0; i < decoders.size(); i++ )
+            maxSignatureLength = std::max(maxSignatureLength, decoders[i]->signatureLength());
+
+        for( int c = 0; c < 256; c++ )
+            for( size_t i = 0; i < decoders.size(); i++ )
+                if( decoders[i]->checkFirstByte((uchar)c) )
+                    decodersByFirstByte[c].push_back(i);
     }
 
     std::vector<ImageDecoder> decoders;
     std::vector<ImageEncoder> encoders;
+
+    /// indices of the decoders to check for the first signature byte, in the registration order
+    std::vector<size_t> decodersByFirstByte[256];
+    size_t maxSignatureLength;
+
+    /// codecs released by the callers, per thread
+    TLSData<CodecCache> cache;
 };
 
 static ImageCodecInitializer codecs;
 
+static bool reuseCodecs()
+{
+    static bool reuse = utils::getConfigurationParameterBool("OPENCV_IMGCODECS_REUSE_CODECS", true);
+    return reuse;
+}
+
+/// number of the codecs in the caches of all the threads
+static int idleCodecCount = 0;
+
+/// Reserves a place for one more idle codec, false if the limit is reached.
+static bool keepIdleCodec()
+{
+    static const int maxIdleCodecs = (int)std::min(
+        utils::getConfigurationParameterSizeT("OPENCV_IMGCODECS_REUSE_CODECS_LIMIT", 64), (size_t)INT_MAX);
+    if( CV_XADD(&idleCodecCount, 1) < maxIdleCodecs )
+        return true;
+    CV_XADD(&idleCodecCount, -1);
+    return false;
+}
+
+static inline ImageDecoder newCodec( const ImageDecoder& decoder ) { return decoder->newDecoder(); }
+static inline ImageEncoder newCodec( const ImageEncoder& encoder ) { return encoder->newEncoder(); }
+
+/**
+ * Deleter of the codecs given out by findDecoder/findEncoder,
+ * puts the codec to the cache of the current thread instead of destroying it.
+*/
+template<typename Codec> struct CodecRecycler
+{
+    CodecRecycler( size_t index_, const Ptr<Codec>& codec_ ) : index(index_), codec(codec_) {}
+
+    void operator()( Codec* ) const
+    {
+        std::vector<Ptr<Codec> >& idle = codecs.cache.getRef().idle( (const Codec*)0 );
+        if( index < idle.size() && idle[index].empty() && codec->recycle() && keepIdleCodec() )
+            idle[index] = codec;
+        codec.release();
+    }
+
+    size_t index;
+    mutable Ptr<Codec> codec;
+};
+
+/**
+ * Take the idle instance of the registered codec or create a new one
+ *
+ * @param[in] registered The registered codecs
+ * @param[in] index Index of the codec
+*/
+template<typename Codec> static Ptr<Codec>
+acquireCodec( const std::vector<Ptr<Codec> >& registered, size_t index )
+{
+    if( !reuseCodecs() )
+        return newCodec( registered[index] );
+
+    std::vector<Ptr<Codec> >& idle = codecs.cache.getRef().idle( (const Codec*)0 );
+    if( idle.size() < registered.size() )
+        idle.resize( registered.size() );
+
+    Ptr<Codec> codec = idle[index];
+    if( !codec.empty() )
+    {
+        idle[index].release();
+        CV_XADD(&idleCodecCount, -1);
+    }
+    else
+    {
+        codec = newCodec( registered[index] );
+        if( codec.empty() )
+            return codec;
+    }
+    return Ptr<Codec>( codec.get(), CodecRecycler<Codec>( index, codec ) );
+}
+
+/**
+ * Find the decoder accepting the signature
+ *
+ * @param[in] signature First bytes of the image data, at most codecs.maxSignatureLength
+ *
+ * @return Image decoder to parse the image data.
+*/
+static ImageDecoder matchDecoder( const String& signature )
+{
+    if( signature.empty() )
+    {
+        for( size_t i = 0; i < codecs.decoders.size(); i++ )
+            if( codecs.decoders[i]->checkSignature(signature) )
+                return acquireCodec( codecs.decoders, i );
+        return ImageDecoder();
+    }
+
+    const std::vector<size_t>& candidates = codecs.decodersByFirstByte[(uchar)signature[0]];
+    for( size_t k = 0; k < candidates.size(); k++ )
+    {
+        size_t i = candidates[k];
+        if( codecs.decoders[i]->checkSignature(signature) )
+            return acquireCodec( codecs.decoders, i );
+    }
+
+    return ImageDecoder();
+}
+
 /**
  * Find the decoders
  *
@@ -191,14 +512,7 @@ static ImageCodecInitializer codecs;
 */
 static ImageDecoder findDecoder( const String& filename ) {
 
-    size_t i, maxlen = 0;
-
-    /// iterate through list of registered codecs
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        size_t len = codecs.decoders[i]->signatureLength();
-        maxlen = std::max(maxlen, len);
-    }
+    size_t maxlen = codecs.maxSignatureLength;
 
     /// Open the file
     FILE* f= fopen( filename.c_str(), "rb" );
@@ -213,42 +527,90 @@ static ImageDecoder findDecoder( const String& filename ) {
     fclose(f);
     signature = signature.substr(0, maxlen);
 
-    /// compare signature against all decoders
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
-    }
-
-    /// If no decoder was found, return base type
-    return ImageDecoder();
+    /// compare signature against the decoders
+    return matchDecoder( signature );
 }
 
 static ImageDecoder findDecoder( const Mat& buf )
 {
-    size_t i, maxlen = 0;
+    size_t maxlen = codecs.maxSignatureLength;
 
     if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
         return ImageDecoder();
 
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        size_t len = codecs.decoders[i]->signatureLength();
-        maxlen = std::max(maxlen, len);
-    }
-
     String signature(maxlen, ' ');
     size_t bufSize = buf.rows*buf.cols*buf.elemSize();
     maxlen = std::min(maxlen, bufSize);
     memcpy( (void*)signature.c_str(), buf.data, maxlen );
 
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
-    }
+    return matchDecoder( signature );
+}
 
-    return ImageDecoder();
+#ifdef IMGCODECS_HAVE_MMAP
+static bool& useMappedFilesFlag()
+{
+    static bool use_mmap = utils::getConfigurationParameterBool("OPENCV_IMGCODECS_USE_MMAP", false);
+    return use_mmap;
+}
+
+static bool useMappedFiles()
+{
+    return useMappedFilesFlag();
+}
+#endif
+
+bool details::setUseMappedFiles( bool flag )
+{
+#ifdef IMGCODECS_HAVE_MMAP
+    bool& use_mmap = useMappedFilesFlag();
+    bool prev = use_mmap;
+    use_mmap = flag;
+    return prev;
+#else
+    CV_UNUSED(flag);
+    return false;
+#endif
+}
+
+static ImageDecoder findDecoder( const Ptr<ImageDecodeSource>& source )
+{
+    size_t maxlen = codecs.maxSignatureLength;
+
+    SourceReader reader;
+    if( !reader.open(source) )
+        return ImageDecoder();
+
+    String signature(maxlen, ' ');
+    maxlen = reader.read( (uchar*)signature.c_str(), maxlen );
+    signature = signature.substr(0, maxlen);
+
+    return matchDecoder( signature );
+}
+
+/**
+ * Copy the whole source into a continuous buffer
+ * (for decoders which can't read ImageDecodeSource directly).
+*/
+static Mat readSource( const Ptr<ImageDecodeSource>& source )
+{
+    SourceReader reader;
+    Mat buf;
+    if( !reader.open(source) || reader.size() == 0 )
+        return buf;
+    CV_Assert( reader.size() <= (size_t)INT_MAX );
+    buf.create( 1, (int)reader.size(), CV_8U );
+    size_t len = reader.read( buf.ptr(), reader.size() );
+    return buf.colRange( 0, (int)len );
+}
+
+static Ptr<ImageDecodeSource> makeChunkSource( InputArray _buf )
+{
+    int kind = _buf.kind();
+    if( kind != _InputArray::STD_VECTOR_MAT && kind != _InputArray::STD_VECTOR_VECTOR )
+        return Ptr<ImageDecodeSource>();
+    std::vector<Mat> chunks;
+    _buf.getMatVector( chunks );
+    return makePtr<ChunkSource>( chunks );
 }
 
 static ImageEncoder findEncoder( const String& _ext )
@@ -282,7 +644,7 @@ static ImageEncoder findEncoder( const String& _ext )
                     break;
             }
             if( j == len && !isalnum(descr[j]))
-                return codecs.encoders[i]->newEncoder();
+                return acquireCodec( codecs.encoders, i );
             descr += j;
         }
     }
@@ -330,6 +692,13 @@ static void ExifTransform(int orientation, Mat& img)
     }
 }
 
+/// The unchanged images and the YCbCr planes are returned as stored
+static bool orientationRequested( int flags )
+{
+    return flags != IMREAD_UNCHANGED &&
+           (flags & (IMREAD_IGNORE_ORIENTATION | IMREAD_YUV_I420 | IMREAD_YUV_NV12)) == 0;
+}
+
 static void ApplyExifOrientation(const String& filename, Mat& img)
 {
     int orientation = IMAGE_ORIENTATION_TL;
@@ -374,6 +743,94 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
     ExifTransform(orientation, img);
 }
 
+static void ApplyExifOrientation(const Ptr<ImageDecodeSource>& source, Mat& img)
+{
+    int orientation = IMAGE_ORIENTATION_TL;
+
+    SourceStreamBuffer ssb( source );
+    std::istream stream( &ssb );
+    ExifReader reader( stream );
+    if( reader.parse() )
+    {
+        ExifEntry_t entry = reader.getTag( ORIENTATION );
+        if (entry.tag != INVALID_TAG)
+        {
+            orientation = entry.field_u16; //orientation is unsigned short, so check field_u16
+        }
+    }
+
+    ExifTransform(orientation, img);
+}
+
+/**
+ * Region of the image to decode, see cv::ImreadParams
+*/
+struct ImreadRegion
+{
+    Rect roi;     // zero width or height extends the region up to the image border
+    Size minSize;
+};
+
+static ImreadRegion parseImreadParams( const std::vector<int>& params )
+{
+    CV_Assert(params.size() % 2 == 0 && params.size() <= CV_IO_MAX_IMAGE_PARAMS*2);
+
+    ImreadRegion region;
+    for( size_t i = 0; i < params.size(); i += 2 )
+    {
+        int value = params[i+1];
+        CV_Assert(value >= 0);
+        switch( params[i] )
+        {
+        case IMREAD_PARAM_ROI_X: region.roi.x = value; break;
+        case IMREAD_PARAM_ROI_Y: region.roi.y = value; break;
+        case IMREAD_PARAM_ROI_WIDTH: region.roi.width = value; break;
+        case IMREAD_PARAM_ROI_HEIGHT: region.roi.height = value; break;
+        case IMREAD_PARAM_MIN_WIDTH: region.minSize.width = value; break;
+        case IMREAD_PARAM_MIN_HEIGHT: region.minSize.height = value; break;
+        default:
+            CV_Error(Error::StsBadArg, "Unknown imread parameter");
+        }
+    }
+    return region;
+}
+
+/**
+ * Passes the requested region to the decoder after the header has been read
+ *
+ * @param[in] decoder Decoder with the header read
+ * @param[in] region Requested region, in the coordinates of the image reduced by scale
+ * @param[in] scale Reduction applied by imread_ after decoding, 1 if the decoder scales itself
+ * @param[in,out] size Size of the decoded image
+ * @param[out] dstSize Size of the region after the reduction
+ *
+ * @return Region to crop from the decoded image, empty if the decoder handles it
+*/
+static Rect setDecoderRegion( ImageDecoder& decoder, const ImreadRegion& region, int scale,
+                              Size& size, Size& dstSize )
+{
+    Rect roi = region.roi;
+    Size imgSize(size.width / scale, size.height / scale);
+    if( roi.width == 0 )
+        roi.width = imgSize.width - roi.x;
+    if( roi.height == 0 )
+        roi.height = imgSize.height - roi.y;
+    roi &= Rect(Point(), imgSize);
+    if( roi.empty() )
+        CV_Error(Error::StsBadArg, "The requested region is outside of the image");
+    dstSize = roi.size();
+
+    Rect droi(roi.x*scale, roi.y*scale, roi.width*scale, roi.height*scale);
+    if( decoder->setRegion(droi, Size(region.minSize.width*scale, region.minSize.height*scale)) )
+    {
+        size = validateInputImageSize(Size(decoder->width(), decoder->height()));
+        if( scale == 1 )
+            dstSize = size;
+        return Rect();
+    }
+    return droi;
+}
+
 /**
  * Read an image into memory and return the information
  *
@@ -384,16 +841,21 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
  *                      LOAD_MAT=2
  *                    }
  * @param[in] mat Reference to C++ Mat object (If LOAD_MAT)
- * @param[in] scale_denom Scale value
+ * @param[in] region Region to decode (If LOAD_MAT)
  *
 */
 static void*
-imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
+imread_( const String& filename, int flags, int hdrtype, Mat* mat=0, const ImreadRegion* region=0 )
 {
     IplImage* image = 0;
     CvMat *matrix = 0;
     Mat temp, *data = &temp;
 
+#ifdef IMGCODECS_HAVE_MMAP
+    /// must outlive the decoder which may refer to the mapped data
+    MappedFile mapped;
+#endif
+
     /// Search for the relevant decoder to handle the imagery
     ImageDecoder decoder;
 
@@ -426,8 +888,16 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     /// set the scale_denom in the driver
     decoder->setScale( scale_denom );
 
-    /// set the filename in the driver
-    decoder->setSource( filename );
+    /// set the filename in the driver, decoders which can read memory buffers
+    /// get the memory-mapped file instead to avoid the intermediate stdio copies if requested
+    bool mapped_source = false;
+#ifdef IMGCODECS_HAVE_MMAP
+    if( (flags == IMREAD_UNCHANGED || (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL) &&
+        useMappedFiles() && decoder->isBufSupported() && mapped.open( filename ) )
+        mapped_source = decoder->setSource( mapped.mat() );
+#endif
+    if( !mapped_source )
+        decoder->setSource( filename );
 
     CV_TRY
     {
@@ -450,6 +920,16 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     // established the required input image size
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
+    // if decoder is JpegDecoder then decoder->setScale always returns 1
+    int resize_denom = decoder->setScale( scale_denom ) > 1 ? scale_denom : 1;
+    Size dstSize( size.width / resize_denom, size.height / resize_denom );
+    Rect crop;
+    if( region )
+    {
+        CV_Assert( hdrtype == LOAD_MAT );
+        crop = setDecoderRegion( decoder, *region, resize_denom, size, dstSize );
+    }
+
     // grab the decoded type
     int type = decoder->type();
     if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
@@ -464,6 +944,21 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
             type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
     }
 
+    // the decoder may produce the YCbCr planes itself, otherwise BGR is converted after the decoding
+    const int yuv = hdrtype == LOAD_MAT && flags != IMREAD_UNCHANGED ?
+                    flags & (IMREAD_YUV_I420 | IMREAD_YUV_NV12) : 0;
+    bool yuv_decoded = false;
+    if( yuv )
+    {
+        type = CV_8UC3;
+        if( crop.empty() && resize_denom == 1 && decoder->setYUVOutput( yuv & IMREAD_YUV_NV12 ? IMREAD_YUV_NV12 : IMREAD_YUV_I420 ) )
+        {
+            yuv_decoded = true;
+            type = CV_8UC1;
+            size = yuv420MatSize( size );
+        }
+    }
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -471,6 +966,11 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
             matrix = cvCreateMat( size.height, size.width, type );
             temp = cvarrToMat( matrix );
         }
+        else if( !crop.empty() )
+        {
+            // the decoder can't crop, decode the whole image
+            temp.create( size.height, size.width, type );
+        }
         else
         {
             mat->create( size.height, size.width, type );
@@ -507,11 +1007,19 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         return 0;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( !crop.empty() )
     {
-        resize( *mat, *mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
+        temp(crop).copyTo(*mat);
     }
 
+    if( resize_denom > 1 )
+    {
+        resize( *mat, *mat, dstSize, 0, 0, INTER_LINEAR_EXACT);
+    }
+
+    if( yuv && !yuv_decoded )
+        convertToYuv420( *mat, *mat, (yuv & IMREAD_YUV_NV12) != 0 );
+
     return hdrtype == LOAD_CVMAT ? (void*)matrix :
         hdrtype == LOAD_IMAGE ? (void*)image : (void*)mat;
 }
@@ -607,7 +1115,7 @@ imreadmulti_(const String& filename, int flags, std::vector<Mat>& mats)
             break;
 
         // optionally rotate the data if EXIF' orientation flag says so
-        if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+        if( orientationRequested(flags) )
         {
             ApplyExifOrientation(filename, mat);
         }
@@ -641,7 +1149,7 @@ Mat imread( const String& filename, int flags )
     imread_( filename, flags, LOAD_MAT, &img );
 
     /// optionally rotate the data if EXIF' orientation flag says so
-    if( !img.empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    if( !img.empty() && orientationRequested(flags) )
     {
         ApplyExifOrientation(filename, img);
     }
@@ -650,6 +1158,23 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imread( const String& filename, int flags, const std::vector<int>& params )
+{
+    CV_TRACE_FUNCTION();
+
+    ImreadRegion region = parseImreadParams( params );
+    Mat img;
+    imread_( filename, flags, LOAD_MAT, &img, &region );
+
+    /// optionally rotate the data if EXIF' orientation flag says so
+    if( !img.empty() && orientationRequested(flags) )
+    {
+        ApplyExifOrientation(filename, img);
+    }
+
+    return img;
+}
+
 /**
 * Read a multi-page image
 *
@@ -729,19 +1254,39 @@ bool imwrite( const String& filename, InputArray _img,
 }
 
 static void*
-imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
+imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0, const ImreadRegion* region=0,
+           const Ptr<ImageDecodeSource>& source=Ptr<ImageDecodeSource>() )
 {
-    CV_Assert(!buf.empty() && buf.isContinuous());
     IplImage* image = 0;
     CvMat *matrix = 0;
     Mat temp, *data = &temp;
     String filename;
+    ImageDecoder decoder;
 
-    ImageDecoder decoder = findDecoder(buf);
-    if( !decoder )
-        return 0;
+    if( source )
+    {
+        decoder = findDecoder(source);
+        if( !decoder )
+            return 0;
 
-    if( !decoder->setSource(buf) )
+        if( !decoder->setSource(source) )
+        {
+            // the decoder needs continuous data, gather the source
+            Mat contiguous = readSource(source);
+            if( contiguous.empty() )
+                return 0;
+            return imdecode_( contiguous, flags, hdrtype, mat, region );
+        }
+    }
+    else
+    {
+        CV_Assert(!buf.empty() && buf.isContinuous());
+        decoder = findDecoder(buf);
+        if( !decoder )
+            return 0;
+    }
+
+    if( !source && !decoder->setSource(buf) )
     {
         filename = tempfile();
         FILE* f = fopen( filename.c_str(), "wb" );
@@ -790,6 +1335,14 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     // established the required input image size
     Size size = validateInputImageSize(Size(decoder->width(), decoder->height()));
 
+    Rect crop;
+    if( region )
+    {
+        CV_Assert( hdrtype == LOAD_MAT );
+        Size dstSize;
+        crop = setDecoderRegion( decoder, *region, 1, size, dstSize );
+    }
+
     int type = decoder->type();
     if( (flags & IMREAD_LOAD_GDAL) != IMREAD_LOAD_GDAL && flags != IMREAD_UNCHANGED )
     {
@@ -803,6 +1356,21 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
             type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
     }
 
+    // the decoder may produce the YCbCr planes itself, otherwise BGR is converted after the decoding
+    const int yuv = hdrtype == LOAD_MAT && flags != IMREAD_UNCHANGED ?
+                    flags & (IMREAD_YUV_I420 | IMREAD_YUV_NV12) : 0;
+    bool yuv_decoded = false;
+    if( yuv )
+    {
+        type = CV_8UC3;
+        if( crop.empty() && decoder->setYUVOutput( yuv & IMREAD_YUV_NV12 ? IMREAD_YUV_NV12 : IMREAD_YUV_I420 ) )
+        {
+            yuv_decoded = true;
+            type = CV_8UC1;
+            size = yuv420MatSize( size );
+        }
+    }
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -810,6 +1378,11 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
             matrix = cvCreateMat( size.height, size.width, type );
             temp = cvarrToMat(matrix);
         }
+        else if( !crop.empty() )
+        {
+            // the decoder can't crop, decode the whole image
+            temp.create( size.height, size.width, type );
+        }
         else
         {
             mat->create( size.height, size.width, type );
@@ -854,6 +1427,14 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         return 0;
     }
 
+    if( !crop.empty() )
+    {
+        temp(crop).copyTo(*mat);
+    }
+
+    if( yuv && !yuv_decoded )
+        convertToYuv420( *mat, *mat, (yuv & IMREAD_YUV_NV12) != 0 );
+
     return hdrtype == LOAD_CVMAT ? (void*)matrix :
         hdrtype == LOAD_IMAGE ? (void*)image : (void*)mat;
 }
@@ -863,11 +1444,15 @@ Mat imdecode( InputArray _buf, int flags )
 {
     CV_TRACE_FUNCTION();
 
+    Ptr<ImageDecodeSource> source = makeChunkSource(_buf);
+    if( source )
+        return imdecode( source, flags );
+
     Mat buf = _buf.getMat(), img;
     imdecode_( buf, flags, LOAD_MAT, &img );
 
     /// optionally rotate the data if EXIF' orientation flag says so
-    if( !img.empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    if( !img.empty() && orientationRequested(flags) )
     {
         ApplyExifOrientation(buf, img);
     }
@@ -879,12 +1464,27 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
 {
     CV_TRACE_FUNCTION();
 
-    Mat buf = _buf.getMat(), img;
+    Mat img;
     dst = dst ? dst : &img;
-    imdecode_( buf, flags, LOAD_MAT, dst );
+
+    Ptr<ImageDecodeSource> source = makeChunkSource(_buf);
+    if( source )
+    {
+        if( !imdecode_( Mat(), flags, LOAD_MAT, dst, 0, source ) )
+            dst->release();
+        if( !dst->empty() && orientationRequested(flags) )
+        {
+            ApplyExifOrientation(source, *dst);
+        }
+        return *dst;
+    }
+
+    Mat buf = _buf.getMat();
+    if( !imdecode_( buf, flags, LOAD_MAT, dst ) )
+        dst->release();
 
     /// optionally rotate the data if EXIF' orientation flag says so
-    if( !dst->empty() && (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED )
+    if( !dst->empty() && orientationRequested(flags) )
     {
         ApplyExifOrientation(buf, *dst);
     }
@@ -892,6 +1492,149 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
+Mat imdecode( InputArray _buf, int flags, const std::vector<int>& params )
+{
+    CV_TRACE_FUNCTION();
+
+    ImreadRegion region = parseImreadParams( params );
+    Mat img;
+
+    Ptr<ImageDecodeSource> source = makeChunkSource(_buf);
+    if( source )
+    {
+        imdecode_( Mat(), flags, LOAD_MAT, &img, &region, source );
+        if( !img.empty() && orientationRequested(flags) )
+        {
+            ApplyExifOrientation(source, img);
+        }
+        return img;
+    }
+
+    Mat buf = _buf.getMat();
+    imdecode_( buf, flags, LOAD_MAT, &img, &region );
+
+    /// optionally rotate the data if EXIF' orientation flag says so
+    if( !img.empty() && orientationRequested(flags) )
+    {
+        ApplyExifOrientation(buf, img);
+    }
+
+    return img;
+}
+
+Mat imdecode( const Ptr<ImageDecodeSource>& source, int flags )
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert( source );
+
+    Mat img;
+    imdecode_( Mat(), flags, LOAD_MAT, &img, 0, source );
+
+    /// optionally rotate the data if EXIF' orientation flag says so
+    if( !img.empty() && orientationRequested(flags) )
+    {
+        ApplyExifOrientation(source, img);
+    }
+
+    return img;
+}
+
+namespace {
+
+/**
+ * Decodes a range of a batch of files or buffers, one image per stripe.
+ * Each output Mat is passed to the decoder as is, so the preallocated
+ * matrices of the right size and type are filled in place.
+ */
+class ImreadBatchInvoker : public ParallelLoopBody
+{
+public:
+    ImreadBatchInvoker( const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                        std::vector<Mat>& mats, int flags, std::vector<uchar>& status )
+        : filenames_(filenames), bufs_(bufs), mats_(mats), flags_(flags), status_(status)
+    {
+        CV_Assert( filenames_ || bufs_ );
+    }
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat& img = mats_[i];
+            Mat buf;
+            CV_TRY
+            {
+                if( filenames_ )
+                    imread_( (*filenames_)[i], flags_, LOAD_MAT, &img );
+                else if( !(*bufs_)[i].empty() )
+                {
+                    // the decoders read a continuous buffer, sub-matrices are copied
+                    buf = (*bufs_)[i].isContinuous() ? (*bufs_)[i] : (*bufs_)[i].clone();
+                    imdecode_( buf, flags_, LOAD_MAT, &img );
+                }
+                else
+                    img.release();
+            }
+            CV_CATCH (cv::Exception, e)
+            {
+                std::cerr << "imreadBatch(" << i << "): " << e.what() << std::endl << std::flush;
+                img.release();
+            }
+
+            /// optionally rotate the data if EXIF' orientation flag says so
+            if( !img.empty() && orientationRequested(flags_) )
+            {
+                if( filenames_ )
+                    ApplyExifOrientation( (*filenames_)[i], img );
+                else
+                    ApplyExifOrientation( buf, img );
+            }
+            status_[i] = !img.empty();
+        }
+    }
+
+private:
+    const std::vector<String>* filenames_;
+    const std::vector<Mat>* bufs_;
+    std::vector<Mat>& mats_;
+    int flags_;
+    std::vector<uchar>& status_;
+};
+
+static bool imreadBatch_( const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                          std::vector<Mat>& mats, int flags )
+{
+    size_t n = filenames ? filenames->size() : bufs->size();
+    mats.resize(n);
+    if( n == 0 )
+        return true;
+
+    std::vector<uchar> status(n, (uchar)0);
+    // images differ in size a lot, so let every image be a separate stripe
+    parallel_for_( Range(0, (int)n), ImreadBatchInvoker(filenames, bufs, mats, flags, status), (double)n );
+
+    return std::find(status.begin(), status.end(), (uchar)0) == status.end();
+}
+
+}
+
+bool imreadBatch( const std::vector<String>& filenames, std::vector<Mat>& mats, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    return imreadBatch_( &filenames, 0, mats, flags );
+}
+
+bool imdecodeBatch( InputArrayOfArrays _bufs, std::vector<Mat>& mats, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> bufs;
+    if( !_bufs.empty() )
+        _bufs.getMatVector( bufs );
+    return imreadBatch_( 0, &bufs, mats, flags );
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params )
 {
@@ -984,7 +1727,7 @@ cvSaveImage( const char* filename, const CvArr* arr, const int* _params )
         for( ; _params[i] > 0; i += 2 )
             CV_Assert(i < CV_IO_MAX_IMAGE_PARAMS*2); // Limit number of params for security reasons
     }
-    return cv::imwrite_(filename, cv::cvarrToMat(arr),
+    return cv::imwrite_(filename, std::vector<cv::Mat>(1, cv::cvarrToMat(arr)),
         i > 0 ? std::vector<int>(_params, _params+i) : std::vector<int>(),
         CV_IS_IMAGE(arr) && ((const IplImage*)arr)->origin == IPL_ORIGIN_BL );
 }
@@ -0,0 +1,584 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+
+#include <list>
+#include <map>
+
+#ifdef HAVE_TIFF
+namespace tiff_dummy_namespace {
+#include "tiff.h"
+#include "tiffio.h"
+}
+using namespace tiff_dummy_namespace;
+#endif
+
+namespace cv
+{
+
+TiledImageReader::~TiledImageReader() {}
+TiledImageWriter::~TiledImageWriter() {}
+
+#ifdef HAVE_TIFF
+
+namespace {
+
+struct TiledLevel
+{
+    bool subifd;        // the level is a SubIFD at offset, otherwise the directory dir
+    uint64 offset;
+    int dir;
+    Size size;
+    Size tile;
+    bool tiled;         // strips are used as tiles otherwise
+    bool native;        // samples are copied as is, decoded through TIFFReadRGBA* otherwise
+    int type;
+};
+
+struct TileKey
+{
+    int level, x, y;
+
+    bool operator<( const TileKey& k ) const
+    {
+        return level != k.level ? level < k.level : y != k.y ? y < k.y : x < k.x;
+    }
+};
+
+static bool readLevel( TIFF* tif, TiledLevel& level )
+{
+    uint32 width = 0, height = 0;
+    uint16 bpp = 8, spp = 1, photometric = 0, planar = PLANARCONFIG_CONTIG, format = SAMPLEFORMAT_UINT;
+    uint16 compression = COMPRESSION_NONE;
+    if( !TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width) || !TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height) ||
+        width == 0 || height == 0 || width > (uint32)INT_MAX || height > (uint32)INT_MAX )
+        return false;
+    bool hasPhotometric = TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric) != 0;
+    TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bpp);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &spp);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planar);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &format);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &compression);
+
+    level.size = Size((int)width, (int)height);
+    level.tiled = TIFFIsTiled(tif) != 0;
+    if( level.tiled )
+    {
+        uint32 tw = 0, th = 0;
+        if( !TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tw) || !TIFFGetField(tif, TIFFTAG_TILELENGTH, &th) ||
+            tw == 0 || th == 0 || tw > width*2 || th > height*2 )
+            return false;
+        level.tile = Size((int)tw, (int)th);
+    }
+    else
+    {
+        uint32 rowsPerStrip = height;
+        TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+        level.tile = Size((int)width, (int)std::min(std::max(rowsPerStrip, (uint32)1), height));
+    }
+
+    int depth = bpp == 8 && format == SAMPLEFORMAT_UINT ? CV_8U :
+                bpp == 16 && format == SAMPLEFORMAT_UINT ? CV_16U :
+                bpp == 32 && format == SAMPLEFORMAT_IEEEFP ? CV_32F : -1;
+    level.native = depth >= 0 && hasPhotometric && compression != COMPRESSION_OJPEG &&
+        ((photometric == PHOTOMETRIC_MINISBLACK && spp == 1) ||
+         (photometric == PHOTOMETRIC_RGB && (spp == 3 || spp == 4) && planar == PLANARCONFIG_CONTIG));
+    level.type = level.native ? CV_MAKETYPE(depth, spp) : spp == 2 || spp >= 4 ? CV_8UC4 : CV_8UC3;
+    return true;
+}
+
+class TiffTiledReader CV_FINAL : public TiledImageReader
+{
+public:
+    TiffTiledReader( const String& filename, size_t cacheSize ) :
+        filename_(filename), cacheSize_(cacheSize), cachedBytes_(0)
+    {
+        TIFF* tif = TIFFOpen(filename.c_str(), "r");
+        if( !tif )
+            CV_Error(Error::StsError, "TiledImageReader: can't open the file " + filename);
+
+        TiledLevel level = TiledLevel();
+        if( !readLevel(tif, level) )
+        {
+            TIFFClose(tif);
+            CV_Error(Error::StsError, "TiledImageReader: unsupported image in " + filename);
+        }
+        levels_.push_back(level);
+
+        uint16 nsubifd = 0;
+        uint64* subifd = 0;
+        std::vector<uint64> offsets;
+        if( TIFFGetField(tif, TIFFTAG_SUBIFD, &nsubifd, &subifd) && subifd )
+            offsets.assign(subifd, subifd + nsubifd);
+
+        if( !offsets.empty() )
+        {
+            for( size_t i = 0; i < offsets.size(); i++ )
+            {
+                level = TiledLevel();
+                level.subifd = true;
+                level.offset = offsets[i];
+                if( TIFFSetSubDirectory(tif, offsets[i]) && readLevel(tif, level) && level.type == levels_[0].type )
+                    levels_.push_back(level);
+            }
+        }
+        else
+        {
+            for( int dir = 1; TIFFSetDirectory(tif, (tdir_t)dir); dir++ )
+            {
+                uint32 subfiletype = 0;
+                level = TiledLevel();
+                level.dir = dir;
+                if( TIFFGetField(tif, TIFFTAG_SUBFILETYPE, &subfiletype) && (subfiletype & FILETYPE_REDUCEDIMAGE) &&
+                    readLevel(tif, level) && level.type == levels_[0].type )
+                    levels_.push_back(level);
+            }
+        }
+
+        if( !TIFFSetDirectory(tif, 0) )
+        {
+            TIFFClose(tif);
+            CV_Error(Error::StsError, "TiledImageReader: can't read " + filename);
+        }
+        handles_.push_back(Handle(tif, 0));
+    }
+
+    ~TiffTiledReader()
+    {
+        for( size_t i = 0; i < handles_.size(); i++ )
+            TIFFClose(handles_[i].tif);
+    }
+
+    int levels() const CV_OVERRIDE { return (int)levels_.size(); }
+    Size size( int level ) const CV_OVERRIDE { return getLevel(level).size; }
+    Size tileSize( int level ) const CV_OVERRIDE { return getLevel(level).tile; }
+    int type() const CV_OVERRIDE { return levels_[0].type; }
+
+    Mat getTile( int x, int y, int level ) CV_OVERRIDE
+    {
+        TileKey key = { level, x, y };
+        {
+            AutoLock lock(mutex_);
+            std::map<TileKey, CacheList::iterator>::iterator it = index_.find(key);
+            if( it != index_.end() )
+            {
+                cache_.splice(cache_.begin(), cache_, it->second);
+                return it->second->second;
+            }
+        }
+
+        Mat tile = decodeTile(x, y, level);
+
+        AutoLock lock(mutex_);
+        std::map<TileKey, CacheList::iterator>::iterator it = index_.find(key);
+        if( it != index_.end() ) // decoded by another thread meanwhile
+            return it->second->second;
+        cache_.push_front(std::make_pair(key, tile));
+        index_[key] = cache_.begin();
+        cachedBytes_ += tile.total()*tile.elemSize();
+        shrinkCache();
+        return tile;
+    }
+
+    Mat readRegion( const Rect& roi, int level ) CV_OVERRIDE
+    {
+        const TiledLevel& l = getLevel(level);
+        CV_Assert( 0 <= roi.x && 0 < roi.width && roi.x + roi.width <= l.size.width &&
+                   0 <= roi.y && 0 < roi.height && roi.y + roi.height <= l.size.height );
+        Mat dst(roi.size(), type());
+        processRegion(roi, level, true, [&](const Mat& tile, const Rect& rect)
+        {
+            Rect r = rect & roi;
+            tile(r - rect.tl()).copyTo(dst(r - roi.tl()));
+        });
+        return dst;
+    }
+
+    void processTiles( const Rect& roi, int level,
+                       const std::function<void(const Mat& tile, const Rect& rect)>& callback ) CV_OVERRIDE
+    {
+        const TiledLevel& l = getLevel(level);
+        Rect r = roi & Rect(Point(), l.size);
+        if( !r.empty() )
+            processRegion(r, level, false, callback);
+    }
+
+    void setCacheSize( size_t cacheSize ) CV_OVERRIDE
+    {
+        AutoLock lock(mutex_);
+        cacheSize_ = cacheSize;
+        shrinkCache();
+    }
+
+protected:
+    typedef std::list<std::pair<TileKey, Mat> > CacheList;
+
+    struct Handle
+    {
+        Handle( TIFF* _tif = 0, int _level = 0 ) : tif(_tif), level(_level) {}
+        TIFF* tif;
+        int level;
+    };
+
+    // takes a free handle of the file (opens one if there is none) switched to the level
+    class HandleGuard
+    {
+    public:
+        HandleGuard( TiffTiledReader& reader, int level ) : reader_(reader)
+        {
+            {
+                AutoLock lock(reader_.mutex_);
+                if( !reader_.handles_.empty() )
+                {
+                    handle_ = reader_.handles_.back();
+                    reader_.handles_.pop_back();
+                }
+            }
+            if( !handle_.tif )
+            {
+                handle_.tif = TIFFOpen(reader_.filename_.c_str(), "r");
+                if( !handle_.tif )
+                    CV_Error(Error::StsError, "TiledImageReader: can't open the file " + reader_.filename_);
+            }
+            if( handle_.level != level )
+            {
+                const TiledLevel& l = reader_.levels_[level];
+                if( !(l.subifd ? TIFFSetSubDirectory(handle_.tif, l.offset) : TIFFSetDirectory(handle_.tif, (tdir_t)l.dir)) )
+                {
+                    TIFFClose(handle_.tif);
+                    CV_Error(Error::StsError, "TiledImageReader: can't read " + reader_.filename_);
+                }
+                handle_.level = level;
+            }
+        }
+
+        ~HandleGuard()
+        {
+            AutoLock lock(reader_.mutex_);
+            reader_.handles_.push_back(handle_);
+        }
+
+        TIFF* tif() const { return handle_.tif; }
+
+    protected:
+        TiffTiledReader& reader_;
+        Handle handle_;
+    };
+
+    class TileInvoker : public ParallelLoopBody
+    {
+    public:
+        TileInvoker( TiffTiledReader& reader, int level, const Rect& tiles, bool cached,
+                     const std::function<void(const Mat& tile, const Rect& rect)>& callback ) :
+            reader_(reader), level_(level), tiles_(tiles), cached_(cached), callback_(callback)
+        {
+        }
+
+        void operator()( const Range& range ) const CV_OVERRIDE
+        {
+            const Size tile = reader_.levels_[level_].tile;
+            for( int i = range.start; i < range.end; i++ )
+            {
+                int x = tiles_.x + i % tiles_.width, y = tiles_.y + i / tiles_.width;
+                Mat m = cached_ ? reader_.getTile(x, y, level_) : reader_.decodeTile(x, y, level_);
+                callback_(m, Rect(x*tile.width, y*tile.height, m.cols, m.rows));
+            }
+        }
+
+    protected:
+        TiffTiledReader& reader_;
+        int level_;
+        Rect tiles_;
+        bool cached_;
+        const std::function<void(const Mat& tile, const Rect& rect)>& callback_;
+    };
+
+    const TiledLevel& getLevel( int level ) const
+    {
+        if( level < 0 || level >= (int)levels_.size() )
+            CV_Error(Error::StsOutOfRange, "TiledImageReader: invalid level");
+        return levels_[level];
+    }
+
+    void processRegion( const Rect& roi, int level, bool cached,
+                        const std::function<void(const Mat& tile, const Rect& rect)>& callback )
+    {
+        const Size tile = levels_[level].tile;
+        Point first(roi.x / tile.width, roi.y / tile.height);
+        Point last((roi.x + roi.width - 1) / tile.width, (roi.y + roi.height - 1) / tile.height);
+        Rect tiles(first, last + Point(1, 1));
+        parallel_for_(Range(0, tiles.area()), TileInvoker(*this, level, tiles, cached, callback), tiles.area());
+    }
+
+    Mat decodeTile( int x, int y, int level )
+    {
+        const TiledLevel& l = getLevel(level);
+        Rect r(x*l.tile.width, y*l.tile.height, l.tile.width, l.tile.height);
+        if( x < 0 || y < 0 || r.x >= l.size.width || r.y >= l.size.height )
+            CV_Error(Error::StsOutOfRange, "TiledImageReader: invalid tile index");
+        r &= Rect(Point(), l.size);
+
+        HandleGuard handle(*this, level);
+        TIFF* tif = handle.tif();
+        Mat tile(r.size(), l.type);
+        if( l.native )
+        {
+            tmsize_t bufsize = l.tiled ? TIFFTileSize(tif) : TIFFStripSize(tif);
+            AutoBuffer<uchar> buffer(bufsize);
+            tmsize_t len = l.tiled ? TIFFReadEncodedTile(tif, TIFFComputeTile(tif, r.x, r.y, 0, 0), buffer, bufsize) :
+                                     TIFFReadEncodedStrip(tif, TIFFComputeStrip(tif, r.y, 0), buffer, bufsize);
+            size_t step = (l.tiled ? l.tile.width : l.size.width)*CV_ELEM_SIZE(l.type);
+            if( len < 0 || (size_t)len < step*(r.height - 1) + r.width*CV_ELEM_SIZE(l.type) )
+                CV_Error(Error::StsError, "TiledImageReader: can't read the tile");
+            Mat src(r.size(), l.type, (uchar*)buffer, step);
+            if( tile.channels() == 3 )
+                cvtColor(src, tile, COLOR_RGB2BGR);
+            else if( tile.channels() == 4 )
+                cvtColor(src, tile, COLOR_RGBA2BGRA);
+            else
+                src.copyTo(tile);
+        }
+        else
+        {
+            AutoBuffer<uint32> raster(l.tile.area());
+            if( !(l.tiled ? TIFFReadRGBATile(tif, r.x, r.y, raster) : TIFFReadRGBAStrip(tif, r.y, raster)) )
+                CV_Error(Error::StsError, "TiledImageReader: can't read the tile");
+            // the raster is bottom-up
+            const int rows = l.tiled ? l.tile.height : r.height, cn = tile.channels();
+            for( int i = 0; i < r.height; i++ )
+            {
+                const uint32* src = raster + (size_t)(rows - 1 - i)*l.tile.width;
+                uchar* dst = tile.ptr(i);
+                for( int j = 0; j < r.width; j++, dst += cn )
+                {
+                    uint32 v = src[j];
+                    dst[0] = (uchar)TIFFGetB(v);
+                    dst[1] = (uchar)TIFFGetG(v);
+                    dst[2] = (uchar)TIFFGetR(v);
+                    if( cn == 4 )
+                        dst[3] = (uchar)TIFFGetA(v);
+                }
+            }
+        }
+        return tile;
+    }
+
+    // drops the least recently used tiles, the caller holds the mutex
+    void shrinkCache()
+    {
+        while( cachedBytes_ > cacheSize_ && !cache_.empty() )
+        {
+            const Mat& tile = cache_.back().second;
+            cachedBytes_ -= tile.total()*tile.elemSize();
+            index_.erase(cache_.back().first);
+            cache_.pop_back();
+        }
+    }
+
+    String filename_;
+    std::vector<TiledLevel> levels_;
+    std::vector<Handle> handles_;
+    CacheList cache_;
+    std::map<TileKey, CacheList::iterator> index_;
+    size_t cacheSize_;
+    size_t cachedBytes_;
+    Mutex mutex_;
+};
+
+class TiffTiledWriter CV_FINAL : public TiledImageWriter
+{
+public:
+    TiffTiledWriter( const String& filename, Size size, int type, Size tileSize, int levels,
+                     const std::vector<int>& params ) :
+        tif_(0), size_(size), type_(type), tileSize_(tileSize), levels_(levels), level_(-1),
+        compression_(COMPRESSION_LZW), predictor_(CV_MAT_DEPTH(type) == CV_32F ? PREDICTOR_NONE : PREDICTOR_HORIZONTAL)
+    {
+        int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+        CV_Assert( (depth == CV_8U || depth == CV_16U || depth == CV_32F) && (cn == 1 || cn == 3 || cn == 4) );
+        CV_Assert( size.width > 0 && size.height > 0 && levels >= 1 && levels < 32 );
+        CV_Assert( tileSize.width > 0 && tileSize.height > 0 && tileSize.width % 16 == 0 && tileSize.height % 16 == 0 );
+        for( size_t i = 0; i + 1 < params.size(); i += 2 )
+        {
+            if( params[i] == TIFFTAG_COMPRESSION )
+                compression_ = params[i+1];
+            else if( params[i] == TIFFTAG_PREDICTOR )
+                predictor_ = params[i+1];
+        }
+
+        // the classic TIFF can't address more than 4GB, leave a margin for a poor compression
+        uint64 bytes = 0;
+        for( int l = 0; l < levels; l++ )
+            bytes += (uint64)this->size(l).area()*CV_ELEM_SIZE(type);
+        tif_ = TIFFOpen(filename.c_str(), bytes >= ((uint64)1 << 31) ? "w8" : "w");
+        if( !tif_ )
+            CV_Error(Error::StsError, "TiledImageWriter: can't create the file " + filename);
+        startLevel(0);
+    }
+
+    ~TiffTiledWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch( ... )
+        {
+        }
+    }
+
+    Size size( int level ) const CV_OVERRIDE
+    {
+        CV_Assert( 0 <= level && level < levels_ );
+        return Size(((size_.width - 1) >> level) + 1, ((size_.height - 1) >> level) + 1);
+    }
+
+    void writeTile( int x, int y, InputArray _tile, int level ) CV_OVERRIDE
+    {
+        AutoLock lock(mutex_);
+        if( !tif_ )
+            CV_Error(Error::StsError, "TiledImageWriter: the file is closed");
+        if( level < level_ || level >= levels_ )
+            CV_Error(Error::StsBadArg, "TiledImageWriter: the levels must be written in increasing order");
+        while( level_ < level )
+        {
+            finishLevel();
+            startLevel(level_ + 1);
+        }
+
+        Size sz = size(level);
+        Rect r(x*tileSize_.width, y*tileSize_.height, tileSize_.width, tileSize_.height);
+        if( x < 0 || y < 0 || r.x >= sz.width || r.y >= sz.height )
+            CV_Error(Error::StsOutOfRange, "TiledImageWriter: invalid tile index");
+        r &= Rect(Point(), sz);
+
+        Mat tile = _tile.getMat();
+        CV_Assert( tile.type() == type_ && (tile.size() == r.size() || tile.size() == tileSize_) );
+        tile = tile(Rect(Point(), r.size()));
+
+        buffer_.setTo(Scalar::all(0));
+        Mat dst = buffer_(Rect(Point(), r.size()));
+        if( tile.channels() == 3 )
+            cvtColor(tile, dst, COLOR_BGR2RGB);
+        else if( tile.channels() == 4 )
+            cvtColor(tile, dst, COLOR_BGRA2RGBA);
+        else
+            tile.copyTo(dst);
+
+        int index = y*tilesX_ + x;
+        if( TIFFWriteEncodedTile(tif_, (uint32)index, buffer_.ptr(), (tmsize_t)(buffer_.total()*buffer_.elemSize())) < 0 )
+            CV_Error(Error::StsError, "TiledImageWriter: can't write the tile");
+        written_[index] = 1;
+    }
+
+    void close() CV_OVERRIDE
+    {
+        AutoLock lock(mutex_);
+        if( !tif_ )
+            return;
+        while( level_ < levels_ - 1 )
+        {
+            finishLevel();
+            startLevel(level_ + 1);
+        }
+        finishLevel();
+        TIFFClose(tif_);
+        tif_ = 0;
+    }
+
+protected:
+    void startLevel( int level )
+    {
+        Size sz = size(level);
+        int depth = CV_MAT_DEPTH(type_), cn = CV_MAT_CN(type_);
+        bool ok = TIFFSetField(tif_, TIFFTAG_IMAGEWIDTH, sz.width)
+            && TIFFSetField(tif_, TIFFTAG_IMAGELENGTH, sz.height)
+            && TIFFSetField(tif_, TIFFTAG_TILEWIDTH, tileSize_.width)
+            && TIFFSetField(tif_, TIFFTAG_TILELENGTH, tileSize_.height)
+            && TIFFSetField(tif_, TIFFTAG_BITSPERSAMPLE, (int)CV_ELEM_SIZE1(depth)*8)
+            && TIFFSetField(tif_, TIFFTAG_SAMPLEFORMAT, depth == CV_32F ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT)
+            && TIFFSetField(tif_, TIFFTAG_SAMPLESPERPIXEL, cn)
+            && TIFFSetField(tif_, TIFFTAG_PHOTOMETRIC, cn > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK)
+            && TIFFSetField(tif_, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+            && TIFFSetField(tif_, TIFFTAG_COMPRESSION, compression_)
+            && (compression_ == COMPRESSION_NONE || TIFFSetField(tif_, TIFFTAG_PREDICTOR, predictor_));
+        if( ok && cn == 4 )
+        {
+            uint16 extra = EXTRASAMPLE_UNASSALPHA;
+            ok = TIFFSetField(tif_, TIFFTAG_EXTRASAMPLES, 1, &extra) != 0;
+        }
+        if( ok && level == 0 && levels_ > 1 )
+        {
+            // offsets are filled by libtiff when the next directories are written
+            std::vector<uint64> subifd(levels_ - 1, 0);
+            ok = TIFFSetField(tif_, TIFFTAG_SUBIFD, (uint16)subifd.size(), &subifd[0]) != 0;
+        }
+        if( ok && level > 0 )
+            ok = TIFFSetField(tif_, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE) != 0;
+        if( !ok )
+            CV_Error(Error::StsError, "TiledImageWriter: can't set the image parameters");
+
+        level_ = level;
+        tilesX_ = (sz.width + tileSize_.width - 1) / tileSize_.width;
+        int tilesY = (sz.height + tileSize_.height - 1) / tileSize_.height;
+        written_.assign((size_t)tilesX_*tilesY, (uchar)0);
+        buffer_.create(tileSize_, type_);
+    }
+
+    // fills the missing tiles with zeros and writes the directory
+    void finishLevel()
+    {
+        buffer_.setTo(Scalar::all(0));
+        for( size_t i = 0; i < written_.size(); i++ )
+        {
+            if( !written_[i] &&
+                TIFFWriteEncodedTile(tif_, (uint32)i, buffer_.ptr(), (tmsize_t)(buffer_.total()*buffer_.elemSize())) < 0 )
+                CV_Error(Error::StsError, "TiledImageWriter: can't write the tile");
+        }
+        if( !TIFFWriteDirectory(tif_) )
+            CV_Error(Error::StsError, "TiledImageWriter: can't write the directory");
+    }
+
+    TIFF* tif_;
+    Size size_;
+    int type_;
+    Size tileSize_;
+    int levels_;
+    int level_;
+    int tilesX_;
+    int compression_;
+    int predictor_;
+    std::vector<uchar> written_;
+    Mat buffer_;
+    Mutex mutex_;
+};
+
+}
+
+Ptr<TiledImageReader> TiledImageReader::create( const String& filename, size_t cacheSize )
+{
+    return makePtr<TiffTiledReader>(filename, cacheSize);
+}
+
+Ptr<TiledImageWriter> TiledImageWriter::create( const String& filename, Size size, int type, Size tileSize,
+                                                int levels, const std::vector<int>& params )
+{
+    return makePtr<TiffTiledWriter>(filename, size, type, tileSize, levels, params);
+}
+
+#else
+
+Ptr<TiledImageReader> TiledImageReader::create( const String&, size_t )
+{
+    CV_Error(Error::StsNotImplemented, "TiledImageReader: OpenCV is built without TIFF support");
+}
+
+Ptr<TiledImageWriter> TiledImageWriter::create( const String&, Size, int, Size, int, const std::vector<int>& )
+{
+    CV_Error(Error::StsNotImplemented, "TiledImageWriter: OpenCV is built without TIFF support");
+}
+
+#endif
+
+}
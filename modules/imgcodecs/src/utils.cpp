@@ -366,6 +366,112 @@ void icvCvt_CMYK2Gray_8u_C4C1R( const uchar* cmyk, int cmyk_step,
 }
 
 
+cv::Size yuv420MatSize( cv::Size size )
+{
+    int width = (size.width + 1) & -2, height = (size.height + 1) & -2;
+    return cv::Size( width, height / 2 * 3 );
+}
+
+
+void storeYuv420ChromaRow( cv::Mat& yuv, bool nv12, int row, const uchar* cb, const uchar* cr )
+{
+    CV_Assert( yuv.isContinuous() );
+    int width = yuv.cols / 2, height = yuv.rows / 3; // of the chroma planes
+    uchar* chroma = yuv.ptr(height * 2);
+
+    if( nv12 )
+    {
+        uchar* uv = chroma + (size_t)row * yuv.cols;
+        for( int i = 0; i < width; i++ )
+        {
+            uv[i*2] = cb[i];
+            uv[i*2 + 1] = cr[i];
+        }
+    }
+    else
+    {
+        memcpy( chroma + (size_t)row * width, cb, width );
+        memcpy( chroma + ((size_t)height + row) * width, cr, width );
+    }
+}
+
+
+void storeYuv420Rows( cv::Mat& yuv, bool nv12, int row, const uchar* ycc0, const uchar* ycc1,
+                      int width, int cn )
+{
+    const int cwidth = yuv.cols / 2;
+    uchar* y0 = yuv.ptr(row);
+    uchar* y1 = yuv.ptr(row + 1);
+    cv::AutoBuffer<uchar> _chroma(cwidth * 2);
+    uchar* cb = _chroma;
+    uchar* cr = cb + cwidth;
+
+    for( int i = 0; i < cwidth; i++ )
+    {
+        int x0 = i * 2, x1 = std::min( x0 + 1, width - 1 );
+        y0[x0] = ycc0[x0*cn];
+        y0[x0 + 1] = ycc0[x1*cn];
+        y1[x0] = ycc1[x0*cn];
+        y1[x0 + 1] = ycc1[x1*cn];
+        if( cn == 1 )
+        {
+            cb[i] = cr[i] = 128;
+            continue;
+        }
+        cb[i] = (uchar)((ycc0[x0*3 + 1] + ycc0[x1*3 + 1] + ycc1[x0*3 + 1] + ycc1[x1*3 + 1] + 2) >> 2);
+        cr[i] = (uchar)((ycc0[x0*3 + 2] + ycc0[x1*3 + 2] + ycc1[x0*3 + 2] + ycc1[x1*3 + 2] + 2) >> 2);
+    }
+    storeYuv420ChromaRow( yuv, nv12, row / 2, cb, cr );
+}
+
+
+// fixed point RGB->YCbCr coefficients of the IJG JPEG encoder (jccolor.c)
+#define  YCC_SHIFT  16
+#define  YCC_FIX(x) ((int)((x) * (1 << YCC_SHIFT) + 0.5))
+#define  YCC_HALF   (1 << (YCC_SHIFT - 1))
+#define  YCC_CBCR_OFFSET (128 << YCC_SHIFT)
+
+static void convertRowToYCbCr( const uchar* bgr, uchar* ycc, int width )
+{
+    for( int i = 0; i < width; i++, bgr += 3, ycc += 3 )
+    {
+        int b = bgr[0], g = bgr[1], r = bgr[2];
+        ycc[0] = (uchar)((YCC_FIX(0.299)*r + YCC_FIX(0.587)*g + YCC_FIX(0.114)*b + YCC_HALF) >> YCC_SHIFT);
+        ycc[1] = (uchar)((-YCC_FIX(0.168735892)*r - YCC_FIX(0.331264108)*g + YCC_FIX(0.5)*b +
+                          YCC_CBCR_OFFSET + YCC_HALF - 1) >> YCC_SHIFT);
+        ycc[2] = (uchar)((YCC_FIX(0.5)*r - YCC_FIX(0.418687589)*g - YCC_FIX(0.081312411)*b +
+                          YCC_CBCR_OFFSET + YCC_HALF - 1) >> YCC_SHIFT);
+    }
+}
+
+
+void convertToYuv420( const cv::Mat& src, cv::Mat& dst, bool nv12 )
+{
+    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_8UC3 );
+    const int width = src.cols, height = src.rows, cn = src.channels();
+    cv::Mat yuv( yuv420MatSize( src.size() ), CV_8UC1 );
+
+    cv::AutoBuffer<uchar> _ycc(cn == 3 ? width * 6 : 1);
+    uchar* ycc0 = _ycc;
+    uchar* ycc1 = ycc0 + width * 3;
+
+    for( int y = 0; y < height; y += 2 )
+    {
+        const uchar* row0 = src.ptr(y);
+        const uchar* row1 = src.ptr(std::min( y + 1, height - 1 ));
+        if( cn == 3 )
+        {
+            convertRowToYCbCr( row0, ycc0, width );
+            convertRowToYCbCr( row1, ycc1, width );
+            row0 = ycc0;
+            row1 = ycc1;
+        }
+        storeYuv420Rows( yuv, nv12, y, row0, row1, width, cn );
+    }
+    dst = yuv;
+}
+
+
 void CvtPaletteToGray( const PaletteEntry* palette, uchar* grayPalette, int entries )
 {
     int i;
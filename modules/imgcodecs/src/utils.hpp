@@ -107,6 +107,18 @@ void icvCvt_CMYK2BGR_8u_C4C3R( const uchar* cmyk, int cmyk_step,
 void icvCvt_CMYK2Gray_8u_C4C1R( const uchar* ycck, int ycck_step,
                                 uchar* gray, int gray_step, CvSize size );
 
+// 4:2:0 YCbCr images stored in the single channel matrix of COLOR_YUV2BGR_I420 (or NV12) layout,
+// see IMREAD_YUV_I420. The image size is rounded up to even numbers.
+cv::Size yuv420MatSize( cv::Size size );
+// stores the subsampled chroma row (yuv.cols/2 samples of each plane)
+void storeYuv420ChromaRow( cv::Mat& yuv, bool nv12, int row, const uchar* cb, const uchar* cr );
+// stores two full resolution rows of interleaved Y,Cb,Cr (cn == 3) or Y (cn == 1) samples
+// starting from the even row, the chroma is averaged over 2x2 pixels
+void storeYuv420Rows( cv::Mat& yuv, bool nv12, int row, const uchar* ycc0, const uchar* ycc1,
+                      int width, int cn );
+// converts BGR or grayscale 8-bit image with the JPEG (JFIF) YCbCr coefficients
+void convertToYuv420( const cv::Mat& src, cv::Mat& dst, bool nv12 );
+
 void  FillGrayPalette( PaletteEntry* palette, int bpp, bool negative = false );
 bool  IsColorPalette( PaletteEntry* palette, int bpp );
 void  CvtPaletteToGray( const PaletteEntry* palette, uchar* grayPalette, int entries );
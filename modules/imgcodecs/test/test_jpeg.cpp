@@ -3,6 +3,13 @@
 // of this distribution and at http://opencv.org/license.html
 #include "test_precomp.hpp"
 
+#ifdef HAVE_JPEG
+#include <stdio.h>
+extern "C" {
+#include "jpeglib.h"
+}
+#endif
+
 namespace opencv_test { namespace {
 
 #ifdef HAVE_JPEG
@@ -178,6 +185,139 @@ TEST(Imgcodecs_Jpeg, encode_decode_rst_jpeg)
     EXPECT_EQ(0, remove(output_normal.c_str()));
 }
 
+// decodes with the color conversion of libjpeg itself
+static Mat decodeRGBWithLibjpeg(const std::vector<uchar>& buf)
+{
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)&buf[0], (unsigned long)buf.size());
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&cinfo);
+
+    Mat rgb((int)cinfo.output_height, (int)cinfo.output_width, CV_8UC3);
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        JSAMPROW row = rgb.ptr((int)cinfo.output_scanline);
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return rgb;
+}
+
+TEST(Imgcodecs_Jpeg, decode_bitexact_with_libjpeg)
+{
+    // noise reaches most of the (Cb, Cr) pairs
+    Mat img(512, 512, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    std::vector<int> params;
+    params.push_back(IMWRITE_JPEG_QUALITY); params.push_back(100);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", img, buf, params));
+
+    Mat bgr = imdecode(buf, IMREAD_COLOR), ref;
+    ASSERT_FALSE(bgr.empty());
+    cvtColor(decodeRGBWithLibjpeg(buf), ref, COLOR_RGB2BGR);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), ref, bgr);
+}
+
+TEST(Imgcodecs_Jpeg, decode_region)
+{
+    Mat small(12, 16, CV_8UC3), img;
+    theRNG().fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, img, Size(403, 301), 0, 0, INTER_LINEAR);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", img, buf));
+
+    Mat full = imdecode(buf, IMREAD_COLOR);
+    ASSERT_FALSE(full.empty());
+
+    const Rect roi(37, 101, 150, 93);
+    std::vector<int> params;
+    params.push_back(IMREAD_PARAM_ROI_X); params.push_back(roi.x);
+    params.push_back(IMREAD_PARAM_ROI_Y); params.push_back(roi.y);
+    params.push_back(IMREAD_PARAM_ROI_WIDTH); params.push_back(roi.width);
+    params.push_back(IMREAD_PARAM_ROI_HEIGHT); params.push_back(roi.height);
+    Mat region = imdecode(buf, IMREAD_COLOR, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full(roi), region);
+
+    // the smallest DCT scale which keeps the region not less than requested
+    params.push_back(IMREAD_PARAM_MIN_WIDTH); params.push_back(30);
+    params.push_back(IMREAD_PARAM_MIN_HEIGHT); params.push_back(20);
+    Mat reduced = imdecode(buf, IMREAD_GRAYSCALE, params);
+    EXPECT_EQ(CV_8UC1, reduced.type());
+    EXPECT_EQ(Size(38, 24), reduced.size());
+
+    // region up to the image border
+    params.resize(4);
+    params[1] = 400;
+    params[3] = 0;
+    Mat border = imdecode(buf, IMREAD_COLOR, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full(Rect(400, 0, 3, full.rows)), border);
+}
+
+TEST(Imgcodecs_Jpeg, decode_yuv)
+{
+    Mat small(12, 16, CV_8UC3), img;
+    theRNG().fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, img, Size(99, 67), 0, 0, INTER_LINEAR);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".jpg", img, buf));
+
+    Mat i420 = imdecode(buf, IMREAD_YUV_I420);
+    ASSERT_EQ(CV_8UC1, i420.type());
+    ASSERT_EQ(Size(100, 102), i420.size());
+
+    // luma is decoded as is, the odd size is padded by the last column and row
+    Mat gray = imdecode(buf, IMREAD_GRAYSCALE), luma;
+    cv::copyMakeBorder(gray, luma, 0, 1, 0, 1, BORDER_REPLICATE);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), luma, i420.rowRange(0, 68));
+
+    // NV12 holds the same samples with interleaved chroma
+    Mat nv12 = imdecode(buf, IMREAD_YUV_NV12);
+    ASSERT_EQ(i420.size(), nv12.size());
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), i420.rowRange(0, 68), nv12.rowRange(0, 68));
+    Mat cb(34, 50, CV_8UC1, i420.ptr(68)), cr(34, 50, CV_8UC1, i420.ptr(68) + 34 * 50);
+    Mat planes[] = { cb, cr }, cbcr;
+    merge(planes, 2, cbcr);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), cbcr, Mat(34, 50, CV_8UC2, nv12.ptr(68)));
+
+    // chroma agrees with the color conversion of the decoded image
+    Mat ycrcb, expected[3];
+    cvtColor(imdecode(buf, IMREAD_COLOR), ycrcb, COLOR_BGR2YCrCb);
+    cv::copyMakeBorder(ycrcb, ycrcb, 0, 1, 0, 1, BORDER_REPLICATE);
+    resize(ycrcb, ycrcb, Size(50, 34), 0, 0, INTER_AREA);
+    split(ycrcb, expected);
+    EXPECT_LE(cvtest::norm(cr, expected[1], NORM_INF), 4);
+    EXPECT_LE(cvtest::norm(cb, expected[2], NORM_INF), 4);
+
+    // region with even offsets is cut from the full planes
+    const Rect roi(10, 20, 40, 30);
+    std::vector<int> params;
+    params.push_back(IMREAD_PARAM_ROI_X); params.push_back(roi.x);
+    params.push_back(IMREAD_PARAM_ROI_Y); params.push_back(roi.y);
+    params.push_back(IMREAD_PARAM_ROI_WIDTH); params.push_back(roi.width);
+    params.push_back(IMREAD_PARAM_ROI_HEIGHT); params.push_back(roi.height);
+    Mat region = imdecode(buf, IMREAD_YUV_I420, params);
+    ASSERT_EQ(Size(40, 45), region.size());
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), i420(roi), region.rowRange(0, 30));
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), cb(Rect(5, 10, 20, 15)),
+                        Mat(15, 20, CV_8UC1, region.ptr(30)));
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), cr(Rect(5, 10, 20, 15)),
+                        Mat(15, 20, CV_8UC1, region.ptr(30) + 15 * 20));
+
+    // grayscale JPEG has neutral chroma
+    ASSERT_TRUE(imencode(".jpg", gray, buf));
+    Mat gray_i420 = imdecode(buf, IMREAD_YUV_I420);
+    ASSERT_EQ(Size(100, 102), gray_i420.size());
+    cv::copyMakeBorder(imdecode(buf, IMREAD_GRAYSCALE), luma, 0, 1, 0, 1, BORDER_REPLICATE);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), luma, gray_i420.rowRange(0, 68));
+    EXPECT_EQ(0, cvtest::norm(gray_i420.rowRange(68, 102), Mat(34, 100, CV_8UC1, Scalar(128)), NORM_INF));
+}
+
 #endif // HAVE_JPEG
 
 }} // namespace
@@ -93,6 +93,64 @@ TEST(Imgcodecs_Png, read_color_palette_with_alpha)
     EXPECT_EQ(img.at<Vec3b>(0, 1), Vec3b(0, 0, 255));
 }
 
+TEST(Imgcodecs_Png, decode_region)
+{
+    Mat img(120, 97, CV_16UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(65536));
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", img, buf));
+
+    const Rect roi(10, 33, 51, 40);
+    std::vector<int> params;
+    params.push_back(IMREAD_PARAM_ROI_X); params.push_back(roi.x);
+    params.push_back(IMREAD_PARAM_ROI_Y); params.push_back(roi.y);
+    params.push_back(IMREAD_PARAM_ROI_WIDTH); params.push_back(roi.width);
+    params.push_back(IMREAD_PARAM_ROI_HEIGHT); params.push_back(roi.height);
+    Mat region = imdecode(buf, IMREAD_UNCHANGED, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(roi), region);
+
+    Mat full8 = imdecode(buf, IMREAD_GRAYSCALE);
+    region = imdecode(buf, IMREAD_GRAYSCALE, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full8(roi), region);
+}
+
+TEST(Imgcodecs_Png, encode_parallel)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC4 };
+    const int filters[] = { IMWRITE_PNG_FILTER_SUB, IMWRITE_PNG_FILTER_PAETH, IMWRITE_PNG_FILTER_ALL };
+    const int prevThreads = getNumThreads();
+    for (size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+    {
+        // large enough to be split into several blocks
+        Mat small(16, 16, types[t]), img;
+        theRNG().fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(types[t]) == CV_8U ? 256 : 65536));
+        resize(small, img, Size(509, 700), 0, 0, INTER_LINEAR);
+        img.row(300).setTo(Scalar::all(7));
+        for (size_t f = 0; f < sizeof(filters)/sizeof(filters[0]); f++)
+        {
+            SCOPED_TRACE(cv::format("type=%d filter=%d", types[t], filters[f]));
+            std::vector<int> params;
+            params.push_back(IMWRITE_PNG_FILTER);
+            params.push_back(filters[f]);
+            params.push_back(IMWRITE_PNG_COMPRESSION);
+            params.push_back((int)f * 3);
+
+            std::vector<uchar> buf;
+            setNumThreads(4);
+            bool encoded = imencode(".png", img, buf, params);
+            setNumThreads(prevThreads);
+            ASSERT_TRUE(encoded);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, imdecode(buf, IMREAD_UNCHANGED));
+
+            setNumThreads(1);
+            encoded = imencode(".png", img, buf, params);
+            setNumThreads(prevThreads);
+            ASSERT_TRUE(encoded);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, imdecode(buf, IMREAD_UNCHANGED));
+        }
+    }
+}
+
 #endif // HAVE_PNG
 
 }} // namespace
@@ -148,4 +148,295 @@ TEST(Imgcodecs_Image, write_umat)
     EXPECT_EQ(0, remove(dst_name.c_str()));
 }
 
+//==================================================================================================
+
+TEST(Imgcodecs_Image, read_decode_batch)
+{
+    const int N = 7;
+    const string batch_exts[] = { ".bmp", ".ppm", ".ras" };
+    RNG& rng = theRNG();
+
+    vector<Mat> images;
+    vector<String> filenames;
+    vector<vector<uchar> > bufs;
+    for (int i = 0; i < N; i++)
+    {
+        Mat image(32 + i * 7, 48 - i * 3, CV_8UC3);
+        rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        const string& ext = batch_exts[i % 3];
+        const string dst_name = cv::tempfile(ext.c_str());
+        ASSERT_TRUE(imwrite(dst_name, image));
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(ext, image, buf));
+        images.push_back(image);
+        filenames.push_back(dst_name);
+        bufs.push_back(buf);
+    }
+    filenames.push_back(cv::tempfile(".bmp")); // does not exist
+    bufs.push_back(vector<uchar>(10, (uchar)0)); // garbage
+
+    vector<Mat> loaded;
+    EXPECT_FALSE(imreadBatch(filenames, loaded));
+    ASSERT_EQ((size_t)N + 1, loaded.size());
+    for (int i = 0; i < N; i++)
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), images[i], loaded[i]);
+    EXPECT_TRUE(loaded[N].empty());
+
+    // preallocated outputs are filled in place
+    vector<uchar*> ptrs;
+    for (int i = 0; i < N; i++)
+        ptrs.push_back(loaded[i].data);
+    vector<Mat> decoded(loaded.begin(), loaded.begin() + N);
+    EXPECT_TRUE(imdecodeBatch(vector<vector<uchar> >(bufs.begin(), bufs.begin() + N), decoded));
+    for (int i = 0; i < N; i++)
+    {
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), images[i], decoded[i]);
+        EXPECT_EQ(ptrs[i], decoded[i].data);
+    }
+
+    EXPECT_FALSE(imdecodeBatch(bufs, decoded, IMREAD_GRAYSCALE));
+    ASSERT_EQ((size_t)N + 1, decoded.size());
+    EXPECT_EQ(CV_8UC1, decoded[0].type());
+    EXPECT_TRUE(decoded[N].empty());
+
+    // non-continuous buffers are decoded as well
+    vector<Mat> columns;
+    for (int i = 0; i < N; i++)
+    {
+        Mat wide((int)bufs[i].size(), 2, CV_8U, Scalar::all(0));
+        Mat(bufs[i]).copyTo(wide.col(1));
+        columns.push_back(wide.col(1));
+        ASSERT_FALSE(columns.back().isContinuous());
+    }
+    EXPECT_TRUE(imdecodeBatch(columns, decoded));
+    ASSERT_EQ((size_t)N, decoded.size());
+    for (int i = 0; i < N; i++)
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), images[i], decoded[i]);
+
+    for (int i = 0; i < N; i++)
+        EXPECT_EQ(0, remove(filenames[i].c_str()));
+}
+
+//==================================================================================================
+
+TEST(Imgcodecs_Image, read_region)
+{
+    Mat img(64, 80, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    const string dst_name = cv::tempfile(".bmp");
+    ASSERT_TRUE(imwrite(dst_name, img));
+
+    const Rect roi(20, 8, 33, 40);
+    std::vector<int> params;
+    params.push_back(IMREAD_PARAM_ROI_X); params.push_back(roi.x);
+    params.push_back(IMREAD_PARAM_ROI_Y); params.push_back(roi.y);
+    params.push_back(IMREAD_PARAM_ROI_WIDTH); params.push_back(roi.width);
+    params.push_back(IMREAD_PARAM_ROI_HEIGHT); params.push_back(roi.height);
+    Mat region = imread(dst_name, IMREAD_COLOR, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(roi), region);
+
+    // the region is given in the coordinates of the reduced image
+    Mat reduced = imread(dst_name, IMREAD_REDUCED_COLOR_2);
+    region = imread(dst_name, IMREAD_REDUCED_COLOR_2, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), reduced(Rect(20, 8, 20, 24)), region);
+
+    params[1] = 100;
+    EXPECT_THROW(imread(dst_name, IMREAD_COLOR, params), cv::Exception);
+
+    EXPECT_EQ(0, remove(dst_name.c_str()));
+}
+
+TEST(Imgcodecs_Image, decode_chunks)
+{
+    vector<string> chunk_exts;
+    chunk_exts.push_back(".bmp");
+#ifdef HAVE_JPEG
+    chunk_exts.push_back(".jpg");
+#endif
+#ifdef HAVE_PNG
+    chunk_exts.push_back(".png");
+#endif
+#ifdef HAVE_TIFF
+    chunk_exts.push_back(".tiff");
+#endif
+
+    Mat img(61, 77, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    for (size_t k = 0; k < chunk_exts.size(); k++)
+    {
+        SCOPED_TRACE(chunk_exts[k]);
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(chunk_exts[k], img, buf));
+        const Mat expected = imdecode(buf, IMREAD_COLOR);
+        ASSERT_FALSE(expected.empty());
+
+        // split into uneven pieces, including an empty one and single bytes
+        vector<vector<uchar> > chunks;
+        size_t pos = 0;
+        for (size_t i = 0; pos < buf.size(); i++)
+        {
+            size_t len = std::min(buf.size() - pos, (size_t)(i % 5 == 0 ? 1 : (i % 5) * 97));
+            if (i == 3)
+                len = 0;
+            chunks.push_back(vector<uchar>(buf.begin() + pos, buf.begin() + pos + len));
+            pos += len;
+        }
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, imdecode(chunks, IMREAD_COLOR));
+
+        vector<Mat> mats;
+        for (size_t i = 0; i < chunks.size(); i++)
+            mats.push_back(Mat(chunks[i], true));
+        Mat dst;
+        imdecode(mats, IMREAD_COLOR, &dst);
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, dst);
+
+        // the placeholder is released if the image can't be decoded
+        vector<uchar> garbage(buf.size(), 0);
+        imdecode(garbage, IMREAD_COLOR, &dst);
+        EXPECT_TRUE(dst.empty());
+
+        // truncated data
+        chunks.resize(chunks.size() / 2);
+        EXPECT_NO_THROW(imdecode(chunks, IMREAD_COLOR));
+    }
+}
+
+TEST(Imgcodecs_Image, read_mapped_file)
+{
+    vector<string> exts;
+    exts.push_back(".bmp");
+#ifdef HAVE_JPEG
+    exts.push_back(".jpg");
+#endif
+#ifdef HAVE_PNG
+    exts.push_back(".png");
+#endif
+
+    Mat img(40, 50, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    for (size_t k = 0; k < exts.size(); k++)
+    {
+        SCOPED_TRACE(exts[k]);
+        const string dst_name = cv::tempfile(exts[k].c_str());
+        ASSERT_TRUE(imwrite(dst_name, img));
+        const Mat expected = imread(dst_name, IMREAD_UNCHANGED);
+        const Mat expected_gray = imread(dst_name, IMREAD_REDUCED_GRAYSCALE_2);
+        ASSERT_FALSE(expected.empty());
+
+        const bool prev = details::setUseMappedFiles(true);
+        const Mat mapped = imread(dst_name, IMREAD_UNCHANGED);
+        const Mat mapped_gray = imread(dst_name, IMREAD_REDUCED_GRAYSCALE_2);
+        details::setUseMappedFiles(prev);
+
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, mapped);
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected_gray, mapped_gray);
+        if (exts[k] == ".bmp")
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, mapped);
+        EXPECT_EQ(0, remove(dst_name.c_str()));
+    }
+
+    // empty file
+    const string dst_name = cv::tempfile(".bmp");
+    FILE* f = fopen(dst_name.c_str(), "wb");
+    ASSERT_TRUE(f != NULL);
+    fclose(f);
+    const bool prev = details::setUseMappedFiles(true);
+    EXPECT_TRUE(imread(dst_name).empty());
+    details::setUseMappedFiles(prev);
+    EXPECT_TRUE(imread(dst_name).empty());
+    EXPECT_EQ(0, remove(dst_name.c_str()));
+}
+
+TEST(Imgcodecs_Image, reuse_codecs)
+{
+    vector<string> reuse_exts;
+    reuse_exts.push_back(".pnm");
+#ifdef HAVE_JPEG
+    reuse_exts.push_back(".jpg");
+#endif
+#ifdef HAVE_PNG
+    reuse_exts.push_back(".png");
+#endif
+#ifdef HAVE_TIFF
+    reuse_exts.push_back(".tiff");
+#endif
+
+    Mat img(48, 64, CV_8UC3), small(16, 24, CV_8UC1);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    theRNG().fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    for (size_t k = 0; k < reuse_exts.size(); k++)
+    {
+        SCOPED_TRACE(reuse_exts[k]);
+        vector<uchar> buf, buf_small;
+        ASSERT_TRUE(imencode(reuse_exts[k], img, buf));
+        ASSERT_TRUE(imencode(reuse_exts[k], small, buf_small));
+        const string dst_name = cv::tempfile(reuse_exts[k].c_str());
+        ASSERT_TRUE(imwrite(dst_name, img));
+
+        const Mat expected = imdecode(buf, IMREAD_UNCHANGED);
+        const Mat expected_small = imdecode(buf_small, IMREAD_UNCHANGED);
+        const Mat expected_reduced = imdecode(buf, IMREAD_REDUCED_COLOR_2);
+        ASSERT_FALSE(expected.empty());
+        ASSERT_FALSE(expected_small.empty());
+
+        // a released codec is reused for the next image, nothing should leak between the images
+        for (int iter = 0; iter < 3; iter++)
+        {
+            vector<uchar> truncated(buf.begin(), buf.begin() + buf.size() / 3);
+            EXPECT_NO_THROW(imdecode(truncated, IMREAD_UNCHANGED));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected_reduced, imdecode(buf, IMREAD_REDUCED_COLOR_2));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected_small, imdecode(buf_small, IMREAD_UNCHANGED));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, imdecode(buf, IMREAD_UNCHANGED));
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, imread(dst_name, IMREAD_UNCHANGED));
+            vector<uchar> buf2;
+            ASSERT_TRUE(imencode(reuse_exts[k], img, buf2));
+            EXPECT_EQ(buf, buf2);
+        }
+        EXPECT_EQ(0, remove(dst_name.c_str()));
+
+        // every thread keeps own codecs
+        vector<Mat> decoded(32);
+        parallel_for_(Range(0, (int)decoded.size()), [&](const Range& r) {
+            for (int i = r.start; i < r.end; i++)
+                decoded[i] = imdecode(i % 2 ? buf : buf_small, IMREAD_UNCHANGED);
+        });
+        for (size_t i = 0; i < decoded.size(); i++)
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), i % 2 ? expected : expected_small, decoded[i]);
+    }
+}
+
+#ifdef HAVE_PNG
+TEST(Imgcodecs_Image, read_yuv_converted)
+{
+    Mat small(12, 16, CV_8UC3), img;
+    theRNG().fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, img, Size(99, 67), 0, 0, INTER_LINEAR);
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".png", img, buf));
+
+    // the codecs without native YCbCr output go through BGR with the JFIF coefficients
+    Mat ycrcb, half, planes[3];
+    cvtColor(img, ycrcb, COLOR_BGR2YCrCb);
+    cv::copyMakeBorder(ycrcb, ycrcb, 0, 1, 0, 1, BORDER_REPLICATE);
+    resize(ycrcb, half, Size(50, 34), 0, 0, INTER_AREA);
+    split(ycrcb, planes);
+    Mat luma = planes[0];
+    split(half, planes);
+
+    Mat i420 = imdecode(buf, IMREAD_YUV_I420);
+    ASSERT_EQ(CV_8UC1, i420.type());
+    ASSERT_EQ(Size(100, 102), i420.size());
+    EXPECT_LE(cvtest::norm(luma, i420.rowRange(0, 68), NORM_INF), 1);
+    EXPECT_LE(cvtest::norm(planes[2], Mat(34, 50, CV_8UC1, i420.ptr(68)), NORM_INF), 2);
+    EXPECT_LE(cvtest::norm(planes[1], Mat(34, 50, CV_8UC1, i420.ptr(68) + 34 * 50), NORM_INF), 2);
+
+    Mat nv12 = imdecode(buf, IMREAD_YUV_NV12), cbcr;
+    ASSERT_EQ(i420.size(), nv12.size());
+    std::swap(planes[1], planes[2]);
+    merge(planes + 1, 2, cbcr);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), i420.rowRange(0, 68), nv12.rowRange(0, 68));
+    EXPECT_LE(cvtest::norm(cbcr, Mat(34, 50, CV_8UC2, nv12.ptr(68)), NORM_INF), 2);
+}
+#endif
+
 }} // namespace
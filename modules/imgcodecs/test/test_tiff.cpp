@@ -147,6 +147,130 @@ TEST(Imgcodecs_Tiff, decode_infinite_rowsperstrip)
     EXPECT_EQ(0, remove(filename.c_str()));
 }
 
+TEST(Imgcodecs_Tiff, decode_region)
+{
+    Mat img(150, 70, CV_16UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(65536));
+    std::vector<int> wparams;
+    wparams.push_back(TIFFTAG_ROWSPERSTRIP);
+    wparams.push_back(16);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(imencode(".tiff", img, buf, wparams));
+
+    const Rect roi(5, 40, 60, 37);
+    std::vector<int> params;
+    params.push_back(IMREAD_PARAM_ROI_X); params.push_back(roi.x);
+    params.push_back(IMREAD_PARAM_ROI_Y); params.push_back(roi.y);
+    params.push_back(IMREAD_PARAM_ROI_WIDTH); params.push_back(roi.width);
+    params.push_back(IMREAD_PARAM_ROI_HEIGHT); params.push_back(roi.height);
+    Mat region = imdecode(buf, IMREAD_UNCHANGED, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(roi), region);
+
+    Mat full8 = imdecode(buf, IMREAD_COLOR);
+    region = imdecode(buf, IMREAD_COLOR, params);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), full8(roi), region);
+}
+
+TEST(Imgcodecs_Tiff, encode_parallel)
+{
+    const int compressions[] = { COMPRESSION_NONE, COMPRESSION_LZW, COMPRESSION_ADOBE_DEFLATE };
+    const int prevThreads = getNumThreads();
+    Mat img(333, 127, CV_16UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(1024));
+    for (size_t c = 0; c < sizeof(compressions)/sizeof(compressions[0]); c++)
+    {
+        SCOPED_TRACE(cv::format("compression=%d", compressions[c]));
+        std::vector<int> params;
+        params.push_back(TIFFTAG_COMPRESSION);
+        params.push_back(compressions[c]);
+        params.push_back(TIFFTAG_ROWSPERSTRIP);
+        params.push_back(10);
+
+        std::vector<uchar> buf, single_buf;
+        setNumThreads(4);
+        bool encoded = imencode(".tiff", img, buf, params);
+        setNumThreads(1);
+        encoded = imencode(".tiff", img, single_buf, params) && encoded;
+        setNumThreads(prevThreads);
+        ASSERT_TRUE(encoded);
+
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, imdecode(buf, IMREAD_UNCHANGED));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, imdecode(single_buf, IMREAD_UNCHANGED));
+    }
+}
+
+TEST(Imgcodecs_Tiff, tiled_read_write)
+{
+    const Size size(600, 500), tile(128, 96);
+    Mat img(size, CV_16UC3);
+    theRNG().fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(65536));
+    vector<Mat> levels(3);
+    levels[0] = img;
+    resize(img, levels[1], Size(300, 250), 0, 0, INTER_AREA);
+    resize(img, levels[2], Size(150, 125), 0, 0, INTER_AREA);
+
+    const string filename = cv::tempfile(".tiff");
+    {
+        Ptr<TiledImageWriter> writer = TiledImageWriter::create(filename, size, img.type(), tile, 3);
+        for (int l = 0; l < 3; l++)
+        {
+            ASSERT_EQ(levels[l].size(), writer->size(l));
+            for (int y = 0; y * tile.height < levels[l].rows; y++)
+                for (int x = 0; x * tile.width < levels[l].cols; x++)
+                {
+                    if (l == 2 && x == 1 && y == 0)
+                        continue; // filled with zeros
+                    Rect r = Rect(x * tile.width, y * tile.height, tile.width, tile.height) & Rect(Point(), levels[l].size());
+                    writer->writeTile(x, y, levels[l](r), l);
+                }
+        }
+        EXPECT_THROW(writer->writeTile(0, 0, levels[1](Rect(Point(), tile)), 1), cv::Exception);
+    }
+    levels[2](Rect(tile.width, 0, levels[2].cols - tile.width, tile.height)).setTo(Scalar::all(0));
+
+    Ptr<TiledImageReader> reader = TiledImageReader::create(filename, 200000);
+    ASSERT_EQ(3, reader->levels());
+    EXPECT_EQ(img.type(), reader->type());
+    EXPECT_EQ(tile, reader->tileSize(1));
+    for (int l = 0; l < 3; l++)
+    {
+        ASSERT_EQ(levels[l].size(), reader->size(l));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), levels[l], reader->readRegion(Rect(Point(), levels[l].size()), l));
+    }
+    Rect roi(100, 90, 333, 250);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(roi), reader->readRegion(roi));
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img(Rect(512, 480, 88, 20)), reader->getTile(4, 5));
+    EXPECT_THROW(reader->getTile(5, 0), cv::Exception);
+
+    Mat streamed(size, img.type(), Scalar::all(0));
+    Mutex mutex;
+    int count = 0;
+    reader->processTiles(Rect(Point(), size), 0, [&](const Mat& t, const Rect& r)
+    {
+        AutoLock lock(mutex);
+        t.copyTo(streamed(r));
+        count++;
+    });
+    EXPECT_EQ(5 * 6, count);
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, streamed);
+
+    // strips of an ordinary TIFF are read as tiles
+    Mat gray(123, 77, CV_8UC1);
+    theRNG().fill(gray, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    std::vector<int> params;
+    params.push_back(TIFFTAG_ROWSPERSTRIP);
+    params.push_back(10);
+    ASSERT_TRUE(imwrite(filename, gray, params));
+    reader = TiledImageReader::create(filename);
+    EXPECT_EQ(1, reader->levels());
+    EXPECT_EQ(Size(77, 10), reader->tileSize());
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), gray(Rect(0, 120, 77, 3)), reader->getTile(0, 12));
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), gray(Rect(5, 7, 50, 101)), reader->readRegion(Rect(5, 7, 50, 101)));
+    reader.release();
+
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 TEST(Imgcodecs_Tiff, readWrite_32FC1)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
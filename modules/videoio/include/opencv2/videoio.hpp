@@ -168,6 +168,11 @@ enum VideoCaptureProperties {
        CAP_PROP_AUTOFOCUS     =39,
        CAP_PROP_SAR_NUM       =40, //!< Sample aspect ratio: num/den (num)
        CAP_PROP_SAR_DEN       =41, //!< Sample aspect ratio: num/den (den)
+       CAP_PROP_ASYNC_BUFFERS =42, //!< Number of frames decoded ahead on a background thread, 0 (default) decodes in VideoCapture::grab().
+       CAP_PROP_ASYNC_POLICY  =43, //!< What the background thread does when all the buffers are filled, see cv::VideoCaptureAsyncPolicies.
+       CAP_PROP_ASYNC_QUEUE_DEPTH    =44, //!< (read-only) Number of decoded frames waiting to be grabbed.
+       CAP_PROP_ASYNC_DROPPED_FRAMES =45, //!< (read-only) Number of decoded frames discarded because of cv::CAP_ASYNC_DROP_OLDEST policy.
+       CAP_PROP_ASYNC_WAITS   =46, //!< (read-only) Number of VideoCapture::grab() calls which had to wait for the background thread.
 #ifndef CV_DOXYGEN
        CV__CAP_PROP_LATEST
 #endif
@@ -184,13 +189,43 @@ enum VideoCaptureModes {
        CAP_MODE_YUYV = 3  //!< YUYV
      };
 
+/** @brief Policies of the asynchronous capturing, see cv::CAP_PROP_ASYNC_POLICY.
+*/
+enum VideoCaptureAsyncPolicies {
+       CAP_ASYNC_BLOCK       = 0, //!< Stop decoding until a frame is grabbed (default). No frames are lost, suits video files.
+       CAP_ASYNC_DROP_OLDEST = 1  //!< Replace the oldest decoded frame. Keeps the latency low, suits live sources.
+     };
+
 /** @brief %VideoWriter generic properties identifier.
  @sa VideoWriter::get(), VideoWriter::set()
 */
 enum VideoWriterProperties {
   VIDEOWRITER_PROP_QUALITY = 1,    //!< Current quality (0..100%) of the encoded videostream. Can be adjusted dynamically in some codecs.
   VIDEOWRITER_PROP_FRAMEBYTES = 2, //!< (Read-only): Size of just encoded video frame. Note that the encoding order may be different from representation order.
-  VIDEOWRITER_PROP_NSTRIPES = 3    //!< Number of stripes for parallel encoding. -1 for auto detection.
+  VIDEOWRITER_PROP_NSTRIPES = 3,   //!< Number of stripes for parallel encoding. -1 for auto detection.
+  VIDEOWRITER_PROP_ASYNC_BUFFERS = 4, //!< Number of frames queued for a background encoding thread, 0 (default) encodes in VideoWriter::write().
+  VIDEOWRITER_PROP_ASYNC_POLICY = 5,  //!< What VideoWriter::write() does when the queue is full, see cv::VideoWriterAsyncPolicies.
+  VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH = 6,    //!< (read-only) Number of frames waiting to be encoded.
+  VIDEOWRITER_PROP_ASYNC_DROPPED_FRAMES = 7, //!< (read-only) Number of frames not encoded because of the drop policies.
+  VIDEOWRITER_PROP_ASYNC_WAITS = 8,          //!< (read-only) Number of VideoWriter::write() calls which had to wait for the queue.
+  VIDEOWRITER_PROP_ASYNC_ENCODE_MSEC = 9,    //!< (read-only) Average time of encoding a frame on the background thread, in milliseconds.
+  VIDEOWRITER_PROP_CHROMA_SUBSAMPLING = 10   //!< Chroma subsampling of the built-in MJPEG encoder, see cv::VideoWriterChromaSubsampling.
+};
+
+/** @brief Chroma subsampling modes, see cv::VIDEOWRITER_PROP_CHROMA_SUBSAMPLING.
+*/
+enum VideoWriterChromaSubsampling {
+       VIDEOWRITER_CHROMA_420 = 420, //!< Half the resolution in both directions (default).
+       VIDEOWRITER_CHROMA_422 = 422, //!< Half the horizontal resolution.
+       VIDEOWRITER_CHROMA_444 = 444  //!< Full resolution.
+     };
+
+/** @brief Policies of the asynchronous writing, see cv::VIDEOWRITER_PROP_ASYNC_POLICY.
+*/
+enum VideoWriterAsyncPolicies {
+  VIDEOWRITER_ASYNC_BLOCK       = 0, //!< Wait for the encoder (default). No frames are lost.
+  VIDEOWRITER_ASYNC_DROP_OLDEST = 1, //!< Drop the oldest queued frame to make room for the new one.
+  VIDEOWRITER_ASYNC_DROP_NEWEST = 2  //!< Drop the frame being written. The caller never waits.
 };
 
 //! @} videoio_flags_base
@@ -282,7 +317,11 @@ enum { CAP_OPENNI_VGA_30HZ  = 0,
     @{
 */
 
-enum { CAP_PROP_GSTREAMER_QUEUE_LENGTH = 200 //!< Default is 1
+enum { CAP_PROP_GSTREAMER_QUEUE_LENGTH = 200, //!< Maximum number of samples queued in appsink (max-buffers). Default is 1, unless set in the pipeline description, 0 means unlimited
+       CAP_PROP_GSTREAMER_DROP         = 201, //!< Drop the oldest samples when the appsink queue is full instead of blocking the pipeline. Default is on for network and camera sources
+       CAP_PROP_GSTREAMER_SYNC         = 202, //!< Synchronize the appsink on the pipeline clock, i.e. deliver the samples at their presentation time
+       CAP_PROP_GSTREAMER_ZERO_COPY    = 203, //!< Return frames which refer to the mapped GStreamer buffers instead of copies. Default is 0
+       CAP_PROP_GSTREAMER_LATENCY_MSEC = 204  //!< (read-only) Time between the running time of the last grabbed sample and the moment it was grabbed. Negative if the pipeline runs ahead of its clock
      };
 
 //! @} GStreamer
@@ -574,13 +613,92 @@ enum { CAP_PROP_GPHOTO2_PREVIEW           = 17001, //!< Capture only preview fro
 
 /** @brief Images backend properties
 
+The image files of a sequence are listed once, when it is opened; seeking by CAP_PROP_POS_FRAMES
+takes constant time. The frames following the grabbed one are read and decoded in parallel, once per batch.
 */
 enum { CAP_PROP_IMAGES_BASE = 18000,
+       CAP_PROP_IMAGES_READ_AHEAD = CAP_PROP_IMAGES_BASE + 1, //!< Number of image files read at once, cv::getNumThreads() by default. 0 or 1 reads them one by one.
        CAP_PROP_IMAGES_LAST = 19000 // excluding
      };
 
 //! @} Images
 
+
+/** @name FFmpeg backend
+    @{
+*/
+
+/** @brief FFmpeg backend properties
+
+With CAP_PROP_CONVERT_RGB set to 0 the frames are returned as decoded, without the conversion to BGR:
+a single channel 8-bit matrix with the I420 (YUV 4:2:0) planes one after another, of the frame height * 3 / 2
+rows (the odd row and column are dropped). Use cvtColor with COLOR_YUV2BGR_I420 to convert them later.
+*/
+enum { CAP_PROP_FFMPEG_THREADS     = 19001, //!< Number of the decoding threads, 0 - one per CPU core (default).
+       CAP_PROP_FFMPEG_THREAD_TYPE = 19002  //!< Allowed threading, see VideoCaptureFFmpegThreadTypes. Returns the threading in use.
+     };
+
+/** @brief Threading of the FFmpeg decoder
+
+Frame threading decodes several frames at once and suits most codecs, but it delays the output by a frame
+per thread. Slice threading decodes parts of one frame in parallel, it is only possible for the streams
+encoded with several slices.
+*/
+enum VideoCaptureFFmpegThreadTypes {
+       CAP_FFMPEG_THREAD_FRAME = 1, //!< Decode several frames in parallel.
+       CAP_FFMPEG_THREAD_SLICE = 2  //!< Decode the slices of a frame in parallel.
+     };
+
+//! @} FFmpeg
+
+
+/** @name OpenCV MotionJPEG backend
+    @{
+*/
+
+/** @brief Built-in MotionJPEG backend properties
+
+With CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD set, the frames following the retrieved one are decoded in parallel,
+once per batch, and delivered in order.
+Seeking by CAP_PROP_POS_FRAMES, CAP_PROP_POS_MSEC or CAP_PROP_POS_AVI_RATIO uses the AVI index.
+The writer stores recordings over 1 GB as OpenDML AVI files, which are read and indexed the same way.
+It encodes the horizontal stripes of a frame in parallel (see VIDEOWRITER_PROP_NSTRIPES) as JPEG restart
+intervals, and subsamples the chroma as set by VIDEOWRITER_PROP_CHROMA_SUBSAMPLING.
+*/
+enum { CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD = 20001 //!< Number of frames decoded at once, e.g. cv::getNumThreads(). 0 (default) or 1 decodes the frames one by one on retrieval.
+     };
+
+//! @} OpenCV MotionJPEG
+
+
+/** @name Video4Linux2 backend
+    @{
+*/
+
+/** @brief V4L2 backend properties
+
+The frames are converted to BGR with cvtColor, right into the output Mat. With CAP_PROP_CONVERT_RGB set to 0
+they are returned in the native pixel format of CAP_PROP_FOURCC: YUYV and UYVY as CV_8UC2, NV12, NV21, I420
+and YV12 as CV_8UC1 of height * 3 / 2 rows, grayscale and Bayer as CV_8UC1, Y16 as CV_16UC1, MJPEG as
+a single row of compressed data.
+
+These frames are returned without copying: the Mat refers to the buffer
+the driver has captured the frame to, and the buffer is given back to the driver once the Mat and all its
+copies are released. Keep fewer such frames than CAP_PROP_BUFFERSIZE (up to 32 buffers), otherwise
+the capture stops. Clone the frames kept for longer.
+*/
+enum { CAP_PROP_V4L_MEMORY     = 21001, //!< Buffer memory, see VideoCaptureV4LMemory. Restarts the stream.
+       CAP_PROP_V4L_DMABUF_FD  = 21002  //!< Readonly, DMABUF file descriptor of the buffer holding the last grabbed frame (memory mapped buffers only), -1 if the driver cannot export it. It is owned by the capture and valid until it is closed.
+     };
+
+//! Memory of the V4L2 buffers
+enum VideoCaptureV4LMemory {
+       CAP_V4L_MEMORY_MMAP    = 1, //!< Buffers allocated by the driver and mapped (default).
+       CAP_V4L_MEMORY_USERPTR = 2  //!< The driver captures into the buffers allocated by OpenCV. Falls back to CAP_V4L_MEMORY_MMAP if the driver does not support it.
+     };
+
+//! @} Video4Linux2
+
 //! @} videoio_flags_others
 
 
@@ -603,6 +721,13 @@ Here is how the class can be used:
     `OPENCV_SOURCE_CODE/samples/python/video_threaded.py`
 -   (Python) %VideoCapture sample showcasing some features of the Video4Linux2 backend
     `OPENCV_SOURCE_CODE/samples/python/video_v4l2.py`
+
+@note Setting cv::CAP_PROP_ASYNC_BUFFERS to a positive value after the stream is opened moves decoding
+to a background thread, so it overlaps with the processing of the previous frames. The decoded frames
+are kept in a ring of reused buffers: VideoCapture::retrieve() passes the buffer to the output %Mat instead
+of copying it, and the buffer previously held by that %Mat is reused once no other %Mat refers to it.
+Only the default channel can be retrieved in this mode. Seeking or setting any other property discards
+the frames decoded ahead.
  */
 class CV_EXPORTS_W VideoCapture
 {
@@ -807,11 +932,98 @@ public:
     */
     CV_WRAP virtual bool open(const String& filename, int apiPreference);
 
+    /** @brief Waits for ready frames from several VideoCapture streams.
+
+    @param streams input video streams
+    @param readyIndex stream indexes with grabbed frames (ready to use VideoCapture::retrieve() to fetch the frames)
+    @param timeoutNs number of nanoseconds to wait (0 - infinite)
+    @return `true` if readyIndex is not empty
+
+    @throws Exception if the backend of a stream is not supported, if the buffers of a stream can't be
+    queued or the streaming can't be started, and if waiting or grabbing fails. Only V4L2 cameras
+    are supported: the device file descriptors of all the streams are waited for with a single poll() call.
+
+    The method grabs the frame of every stream which is ready, so the next call to VideoCapture::retrieve()
+    returns it. Use VideoCaptureGroup to grab the streams of other backends at the same time.
+    */
+    static bool waitAny(const std::vector<VideoCapture>& streams, CV_OUT std::vector<int>& readyIndex, int64 timeoutNs = 0);
+
 protected:
     Ptr<CvCapture> cap;
     Ptr<IVideoCapture> icap;
 };
 
+/** @brief Grabs the frames of several video streams at the same time.
+
+Each stream is grabbed by its own thread, so the cameras are triggered together rather than one after
+another, and a slow stream does not delay the others. Every grabbed frame is stamped with the time its grab
+has completed, on the monotonic clock of cv::getTickCount() converted to nanoseconds, and with the sequence
+number of the frame in its stream. They let the frames of the different streams be matched.
+
+The streams are shared with the VideoCapture objects the group is created from; do not use them directly
+while the group is grabbing.
+@code
+    VideoCaptureGroup group(cameras);
+    std::vector<int> ready;
+    while (group.grab(ready, 100000000)) // 100 ms
+    {
+        for (size_t i = 0; i < ready.size(); i++)
+            group.retrieve(ready[i], frames[ready[i]]);
+    }
+@endcode
+ */
+class CV_EXPORTS VideoCaptureGroup
+{
+public:
+    VideoCaptureGroup();
+    /** @overload
+    @param streams opened video streams
+    */
+    explicit VideoCaptureGroup(const std::vector<VideoCapture>& streams);
+    ~VideoCaptureGroup();
+
+    /** @brief Starts the grabbing threads of the streams. The previous streams of the group are released. */
+    void open(const std::vector<VideoCapture>& streams);
+
+    /** @brief Stops the grabbing threads, waiting for the grabs in progress. */
+    void release();
+
+    //! Number of the streams
+    int size() const;
+
+    /** @brief Grabs the next frame of every stream in parallel.
+
+    @param readyIndex indexes of the streams which have grabbed a frame
+    @param timeoutNs number of nanoseconds to wait for the streams (0 - infinite)
+    @return `true` if every stream has grabbed a frame
+
+    The streams which have not completed their grab within the timeout keep grabbing; their frame is
+    reported by one of the next calls instead of grabbing another one. An exception thrown by a stream
+    is rethrown here.
+    */
+    bool grab(CV_OUT std::vector<int>& readyIndex, int64 timeoutNs = 0);
+
+    /** @brief Decodes and returns the frame grabbed by a stream. Returns `false` while the stream is grabbing. */
+    bool retrieve(int index, OutputArray image, int flag = 0);
+
+    /** @brief Grabs and retrieves the frames of all the streams.
+
+    The images of the streams which have not grabbed a frame are empty.
+    @return `true` if every stream has grabbed a frame
+    */
+    bool read(CV_OUT std::vector<Mat>& images, int64 timeoutNs = 0);
+
+    //! Capture time of the last frame grabbed by the stream, in nanoseconds of the cv::getTickCount() clock
+    int64 getTimestamp(int index) const;
+
+    //! Number of the frames the stream has grabbed before the last one, -1 before the first frame
+    int64 getSequenceNumber(int index) const;
+
+protected:
+    struct Impl;
+    Ptr<Impl> impl;
+};
+
 class IVideoWriter;
 
 /** @example videowriter_basic.cpp
@@ -820,6 +1032,12 @@ An example using VideoCapture and VideoWriter class
 /** @brief Video writer class.
 
 The class provides C++ API for writing video files or image sequences.
+
+@note Setting cv::VIDEOWRITER_PROP_ASYNC_BUFFERS to a positive value after the writer is opened moves
+encoding to a background thread. VideoWriter::write() copies the frame into a queue of reused buffers and
+returns, so a slow frame of the encoder (e.g. a keyframe) does not stall the caller. Releasing the writer or
+setting the property back to 0 encodes the queued frames first. An error of the encoder is thrown by the
+next VideoWriter::write().
  */
 class CV_EXPORTS_W VideoWriter
 {
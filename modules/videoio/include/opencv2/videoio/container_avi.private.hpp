@@ -54,6 +54,14 @@ RIFF ('AVI '
            )
       ['idx1' (<AVI Index>) ]
      )
+     [RIFF ('AVIX'
+            LIST ('movi'
+                  ...
+                  [ 'ix00'(<Odml standard index of the chunks of this list>) ]
+                 )
+           )
+     ]
+     ...
 
      {xxdb|xxdc|xxpc|xxwb}
      xx - stream number: 00, 01, 02, ...
@@ -63,6 +71,10 @@ RIFF ('AVI '
      wb - audio frame
 
      JUNK section may pad any data section and must be ignored
+
+     OpenDML: every RIFF list holds at most about 1 GB. The 'indx' super index of the stream points to
+     the 'ix00' standard indexes, one per RIFF list, which locate the frames by 64-bit offsets.
+     'idx1' only covers the frames of the first RIFF list, for the readers which do not support OpenDML.
 */
 
 typedef std::deque< std::pair<uint64_t, uint32_t> > frame_list;
@@ -74,7 +86,7 @@ enum Codecs { MJPEG };
 
 //Represents single MJPEG video stream within single AVI/AVIX entry
 //Multiple video streams within single AVI/AVIX entry are not supported
-//ODML index is not supported
+//The frames of all AVIX entries are found by the ODML index if it is present, by idx1 otherwise
 class CV_EXPORTS AVIReadContainer
 {
 public:
@@ -103,6 +115,8 @@ protected:
     void skipJunk(RiffList& list);
     bool parseHdrlList(Codecs codec_);
     bool parseIndex(unsigned int index_size, frame_list& in_frame_list);
+    void parseSuperIndex(uint64_t strl_start, uint64_t strl_end);
+    bool parseOdmlIndex(frame_list& in_frame_list);
     bool parseMovi(frame_list& in_frame_list)
     {
         //not implemented
@@ -130,6 +144,8 @@ protected:
     unsigned int   m_height;
     double     m_fps;
     bool       m_is_indx_present;
+    //offsets and sizes of the ODML standard index chunks
+    std::vector<std::pair<uint64_t, uint32_t> > m_odml_indexes;
 };
 
 enum { COLORSPACE_GRAY=0, COLORSPACE_RGBA=1, COLORSPACE_BGR=2, COLORSPACE_YUV444P=3 };
@@ -158,6 +174,10 @@ public:
 
     int getAVIIndex(int stream_number, StreamType strm_type);
     void writeIndex(int stream_number, StreamType strm_type);
+    void writeOdmlIndex(int stream_number, StreamType strm_type);
+    bool isRiffFull() const;
+    void startNextRiff(int stream_number, StreamType strm_type);
+    void setMaxRiffSize(uint64_t size) { maxRiffSize = size; }
     void finishWriteAVI();
 
     bool isOpenedStream() const;
@@ -165,8 +185,8 @@ public:
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getChannels() const { return channels; }
-    size_t getMoviPointer() const { return moviPointer; }
-    size_t getStreamPos() const;
+    uint64_t getMoviPointer() const { return moviPointer; }
+    uint64_t getStreamPos() const;
 
     void pushFrameOffset(size_t elem) { frameOffset.push_back(elem); }
     void pushFrameSize(size_t elem) { frameSize.push_back(elem); }
@@ -180,11 +200,26 @@ public:
     void jflushStream(unsigned currval, int bitIdx);
 
 private:
+    struct IndexEntry
+    {
+        uint64_t offset;
+        uint32_t size;
+        uint32_t duration;
+    };
+
     Ptr<BitStream> strm;
     int outfps;
     int width, height, channels;
-    size_t moviPointer;
-    std::vector<size_t> frameOffset, frameSize, AVIChunkSizeIndex, frameNumIndexes;
+    uint64_t moviPointer;
+    std::vector<size_t> frameOffset, frameSize;
+    std::vector<uint64_t> AVIChunkSizeIndex, frameNumIndexes;
+    uint64_t maxRiffSize;
+    uint64_t riffPointer;        // the current RIFF list
+    int riffCount;
+    size_t riffFirstFrame;       // the first frame of the current RIFF list
+    size_t firstRiffFrames;      // frames of the 'AVI ' RIFF list once it is finished
+    uint64_t superIndexPointer;  // nEntriesInUse field of the 'indx' chunk
+    std::vector<IndexEntry> superIndex;
 };
 
 }
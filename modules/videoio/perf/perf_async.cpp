@@ -0,0 +1,79 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef perf::TestBaseWithParam<int> AsyncBuffers;
+
+// decoding of the next frames overlaps with the processing of the current one
+PERF_TEST_P(AsyncBuffers, read_and_process, testing::Values(0, 1, 4))
+{
+    const int buffers = GetParam();
+    const int frame_count = 60; // frames/s = frame_count / mean time
+    const string filename = cv::tempfile(".avi");
+    {
+        Mat small(12, 16, CV_8UC3), frame;
+        RNG rng(0xC0DEC);
+        VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, Size(640, 480));
+        ASSERT_TRUE(writer.isOpened());
+        for (int i = 0; i < frame_count; i++)
+        {
+            rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+            resize(small, frame, Size(640, 480), 0, 0, INTER_LINEAR);
+            writer << frame;
+        }
+    }
+
+    Mat frame, processed;
+    TEST_CYCLE()
+    {
+        VideoCapture cap(filename, CAP_OPENCV_MJPEG);
+        ASSERT_TRUE(cap.isOpened());
+        if (buffers > 0)
+            ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFERS, buffers));
+        int count = 0;
+        for (; cap.read(frame); count++)
+            GaussianBlur(frame, processed, Size(15, 15), 0);
+        ASSERT_EQ(frame_count, count);
+    }
+
+    remove(filename.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<int> AsyncWriterBuffers;
+
+// encoding of the previous frames overlaps with the processing of the next one
+PERF_TEST_P(AsyncWriterBuffers, process_and_write, testing::Values(0, 1, 4))
+{
+    const int buffers = GetParam();
+    const int frame_count = 60;
+    const string filename = cv::tempfile(".avi");
+    Mat small(12, 16, CV_8UC3), frame, processed;
+    RNG rng(0xC0DEC);
+    rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, frame, Size(640, 480), 0, 0, INTER_LINEAR);
+
+    TEST_CYCLE()
+    {
+        VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, Size(640, 480));
+        ASSERT_TRUE(writer.isOpened());
+        if (buffers > 0)
+            ASSERT_TRUE(writer.set(VIDEOWRITER_PROP_ASYNC_BUFFERS, buffers));
+        for (int i = 0; i < frame_count; i++)
+        {
+            GaussianBlur(frame, processed, Size(15, 15), 0);
+            writer << processed;
+        }
+    }
+
+    remove(filename.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
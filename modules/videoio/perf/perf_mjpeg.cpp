@@ -0,0 +1,72 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef perf::TestBaseWithParam<int> MJPEG_DecodeAhead;
+
+PERF_TEST_P(MJPEG_DecodeAhead, read, testing::Values(1, 4, 8))
+{
+    const int decode_ahead = GetParam();
+    const int frame_count = 32;
+    const string filename = cv::tempfile(".avi");
+    {
+        Mat small(12, 16, CV_8UC3), frame;
+        RNG rng(0xC0DEC);
+        VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, Size(1280, 720));
+        ASSERT_TRUE(writer.isOpened());
+        for (int i = 0; i < frame_count; i++)
+        {
+            rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+            resize(small, frame, Size(1280, 720), 0, 0, INTER_LINEAR);
+            writer << frame;
+        }
+    }
+
+    Mat frame;
+    TEST_CYCLE()
+    {
+        VideoCapture cap(filename, CAP_OPENCV_MJPEG);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD, decode_ahead));
+        int count = 0;
+        for (; cap.read(frame); count++)
+            ;
+        ASSERT_EQ(frame_count, count);
+    }
+
+    remove(filename.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+typedef perf::TestBaseWithParam<int> MJPEG_Subsampling;
+
+PERF_TEST_P(MJPEG_Subsampling, write, testing::Values(420, 422, 444))
+{
+    const int subsampling = GetParam();
+    const int frame_count = 8;
+    const string filename = cv::tempfile(".avi");
+    Mat small(12, 16, CV_8UC3), frame;
+    RNG rng(0xC0DEC);
+    rng.fill(small, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    resize(small, frame, Size(1920, 1080), 0, 0, INTER_LINEAR);
+
+    TEST_CYCLE()
+    {
+        VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, frame.size());
+        ASSERT_TRUE(writer.isOpened());
+        ASSERT_TRUE(writer.set(VIDEOWRITER_PROP_CHROMA_SUBSAMPLING, subsampling));
+        for (int i = 0; i < frame_count; i++)
+            writer << frame;
+    }
+
+    remove(filename.c_str());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
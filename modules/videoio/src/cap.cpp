@@ -681,13 +681,10 @@ bool VideoCapture::grab()
     return cvGrabFrame(cap) != 0;
 }
 
-bool VideoCapture::retrieve(OutputArray image, int channel)
+static bool retrieveLegacyFrame(CvCapture* cap, int channel, OutputArray image)
 {
-    CV_INSTRUMENT_REGION()
-
-    if (!icap.empty())
-        return icap->retrieveFrame(channel, image);
-
+    if (cap && cap->retrieveFrameTo(channel, image))
+        return true;
     IplImage* _img = cvRetrieveFrame(cap, channel);
     if( !_img )
     {
@@ -704,6 +701,31 @@ bool VideoCapture::retrieve(OutputArray image, int channel)
     return true;
 }
 
+bool VideoCapture::retrieve(OutputArray image, int channel)
+{
+    CV_INSTRUMENT_REGION()
+
+    if (!icap.empty())
+        return icap->retrieveFrame(channel, image);
+    return retrieveLegacyFrame(cap, channel, image);
+}
+
+// lets the C API backends be wrapped like the C++ ones
+class LegacyCapture CV_FINAL : public IVideoCapture
+{
+public:
+    explicit LegacyCapture(const Ptr<CvCapture>& cap_) : cap(cap_) {}
+    virtual double getProperty(int propId) const CV_OVERRIDE { return icvGetCaptureProperty(cap, propId); }
+    virtual bool setProperty(int propId, double value) CV_OVERRIDE { return cvSetCaptureProperty(cap, propId, value) != 0; }
+    virtual bool grabFrame() CV_OVERRIDE { return cvGrabFrame(cap) != 0; }
+    virtual bool retrieveFrame(int channel, OutputArray image) CV_OVERRIDE { return retrieveLegacyFrame(cap, channel, image); }
+    virtual bool isOpened() const CV_OVERRIDE { return !cap.empty(); }
+    virtual int getCaptureDomain() CV_OVERRIDE { return cvGetCaptureDomain(cap); }
+
+protected:
+    Ptr<CvCapture> cap;
+};
+
 bool VideoCapture::read(OutputArray image)
 {
     CV_INSTRUMENT_REGION()
@@ -715,6 +737,29 @@ bool VideoCapture::read(OutputArray image)
     return !image.empty();
 }
 
+bool VideoCapture::waitAny(const std::vector<VideoCapture>& streams, std::vector<int>& readyIndex, int64 timeoutNs)
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert(!streams.empty());
+    std::vector<CvCapture*> captures(streams.size());
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        CV_Assert(streams[i].isOpened());
+        if (!streams[i].icap.empty())
+            CV_Error(Error::StsNotImplemented, "VideoCapture::waitAny() supports the V4L2 cameras only");
+        captures[i] = streams[i].cap;
+    }
+#if !defined HAVE_LIBV4L && (defined HAVE_CAMV4L2 || defined HAVE_VIDEOIO)
+    return cvWaitAnyCameraCapture_V4L(captures, readyIndex, timeoutNs);
+#else
+    CV_UNUSED(timeoutNs);
+    readyIndex.clear();
+    CV_Error(Error::StsNotImplemented, "VideoCapture::waitAny() requires the V4L2 backend");
+    return false;
+#endif
+}
+
 VideoCapture& VideoCapture::operator >> (Mat& image)
 {
 #ifdef WINRT_VIDEO
@@ -753,6 +798,16 @@ VideoCapture& VideoCapture::operator >> (UMat& image)
 
 bool VideoCapture::set(int propId, double value)
 {
+    if (((propId == CAP_PROP_ASYNC_BUFFERS && value > 0) || propId == CAP_PROP_ASYNC_POLICY) && isOpened())
+    {
+        // from now on the backend is read through the background thread only
+        if (icap.empty())
+        {
+            icap = makePtr<LegacyCapture>(cap);
+            cap.release();
+        }
+        icap = createAsyncCapture(icap);
+    }
     if (!icap.empty())
         return icap->setProperty(propId, value);
     return cvSetCaptureProperty(cap, propId, value) != 0;
@@ -814,8 +869,34 @@ bool VideoWriter::isOpened() const
 }
 
 
+// lets the C API writers be wrapped like the C++ ones
+class LegacyWriter CV_FINAL : public IVideoWriter
+{
+public:
+    explicit LegacyWriter(const Ptr<CvVideoWriter>& writer_) : writer(writer_) {}
+    virtual bool isOpened() const CV_OVERRIDE { return !writer.empty(); }
+    virtual void write(InputArray image) CV_OVERRIDE
+    {
+        IplImage _img = image.getMat();
+        cvWriteFrame(writer, &_img);
+    }
+
+protected:
+    Ptr<CvVideoWriter> writer;
+};
+
 bool VideoWriter::set(int propId, double value)
 {
+    if (((propId == VIDEOWRITER_PROP_ASYNC_BUFFERS && value > 0) || propId == VIDEOWRITER_PROP_ASYNC_POLICY) && isOpened())
+    {
+        // from now on the frames are written by the background thread only
+        if (iwriter.empty())
+        {
+            iwriter = makePtr<LegacyWriter>(writer);
+            writer.release();
+        }
+        iwriter = createAsyncWriter(iwriter);
+    }
     if (!iwriter.empty())
         return iwriter->setProperty(propId, value);
     return false;
@@ -0,0 +1,570 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace cv
+{
+
+/** Decodes the frames of the wrapped capture ahead on a background thread.
+
+The decoded frames wait in a bounded queue. The buffers handed to the user are taken back once
+nobody else refers to them, so in the steady state the frames are neither allocated nor copied.
+*/
+class AsyncCapture CV_FINAL : public IVideoCapture
+{
+public:
+    explicit AsyncCapture(const Ptr<IVideoCapture>& source_)
+        : source(source_), capacity(0), policy(CAP_ASYNC_BLOCK), running(false), stopping(false),
+          finished(false), buffered(false), dropped(0), waits(0)
+    {
+        CV_Assert(source);
+    }
+    virtual ~AsyncCapture() CV_OVERRIDE { stop(false); }
+
+    virtual double getProperty(int propId) const CV_OVERRIDE;
+    virtual bool setProperty(int propId, double value) CV_OVERRIDE;
+    virtual bool grabFrame() CV_OVERRIDE;
+    virtual bool retrieveFrame(int channel, OutputArray image) CV_OVERRIDE;
+    virtual bool isOpened() const CV_OVERRIDE { return source->isOpened(); }
+    virtual int getCaptureDomain() CV_OVERRIDE { return source->getCaptureDomain(); }
+
+protected:
+    struct Frame
+    {
+        Frame() : posFrames(0), posMsec(0) {}
+
+        Mat image;
+        double posFrames, posMsec; // the source position right after the frame
+    };
+
+    void start();
+    void stop(bool discard);
+    void run();
+
+    // the following methods are called with the mutex locked
+    void recycle(Mat& buf);
+    Mat takeBuffer();
+
+    Ptr<IVideoCapture> source;
+    int capacity, policy;
+
+    std::thread thread;
+    mutable std::mutex mutex;       // guards the queue, the buffers and the counters
+    mutable std::mutex sourceMutex; // held by the background thread while it reads the source
+    std::condition_variable frameReady, spaceReady;
+
+    std::deque<Frame> queue;
+    std::vector<Mat> released; // buffers which are reused once the user drops them
+    Frame current;             // the last grabbed frame
+    bool running, stopping, finished;
+    bool buffered;             // the current frame is decoded already, the source is ahead of it
+    std::exception_ptr error;
+    int64 dropped, waits;
+};
+
+void AsyncCapture::recycle(Mat& buf)
+{
+    bool known = !buf.u;
+    for (size_t i = 0; i < released.size() && !known; i++)
+        known = released[i].u == buf.u;
+    if (!known)
+        released.push_back(buf);
+    buf.release();
+}
+
+Mat AsyncCapture::takeBuffer()
+{
+    Mat buf;
+    for (size_t i = 0; i < released.size(); i++)
+    {
+        if (released[i].u->refcount == 1)
+        {
+            buf = released[i];
+            released.erase(released.begin() + i);
+            break;
+        }
+    }
+    // the buffers kept by the user for longer are not waited for
+    const size_t maxReleased = 2;
+    if (released.size() > maxReleased)
+        released.erase(released.begin(), released.begin() + (released.size() - maxReleased));
+    return buf;
+}
+
+void AsyncCapture::start()
+{
+    if (!buffered)
+    {
+        current.posFrames = source->getProperty(CAP_PROP_POS_FRAMES);
+        current.posMsec = source->getProperty(CAP_PROP_POS_MSEC);
+    }
+    stopping = finished = false;
+    error = std::exception_ptr();
+    running = true;
+    thread = std::thread(&AsyncCapture::run, this);
+}
+
+void AsyncCapture::stop(bool discard)
+{
+    if (running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        spaceReady.notify_all();
+        thread.join();
+        running = false;
+    }
+    if (discard)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (; !queue.empty(); queue.pop_front())
+            recycle(queue.front().image);
+        recycle(current.image);
+        buffered = finished = false;
+    }
+}
+
+void AsyncCapture::run()
+{
+    for (;;)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && policy == CAP_ASYNC_BLOCK && (int)queue.size() >= capacity)
+                spaceReady.wait(lock);
+            if (stopping)
+                break;
+            frame.image = takeBuffer();
+        }
+
+        bool ok = false;
+        CV_TRY
+        {
+            std::lock_guard<std::mutex> lock(sourceMutex);
+            ok = source->grabFrame() && source->retrieveFrame(0, frame.image) && !frame.image.empty();
+            if (ok)
+            {
+                frame.posFrames = source->getProperty(CAP_PROP_POS_FRAMES);
+                frame.posMsec = source->getProperty(CAP_PROP_POS_MSEC);
+            }
+        }
+        CV_CATCH_ALL
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ok)
+        {
+            finished = true;
+            frameReady.notify_all();
+            break;
+        }
+        if ((int)queue.size() >= capacity) // CAP_ASYNC_DROP_OLDEST
+        {
+            recycle(queue.front().image);
+            queue.pop_front();
+            dropped++;
+        }
+        queue.push_back(frame);
+        frameReady.notify_one();
+    }
+}
+
+bool AsyncCapture::grabFrame()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    recycle(current.image);
+    if (!running && queue.empty())
+    {
+        buffered = false;
+        lock.unlock();
+        return source->grabFrame();
+    }
+
+    if (queue.empty() && !finished)
+    {
+        waits++;
+        while (queue.empty() && !finished)
+            frameReady.wait(lock);
+    }
+    if (queue.empty())
+    {
+        if (error)
+        {
+            std::exception_ptr e = error;
+            error = std::exception_ptr();
+            std::rethrow_exception(e);
+        }
+        return false;
+    }
+    current = queue.front();
+    queue.pop_front();
+    buffered = true;
+    spaceReady.notify_one();
+    return true;
+}
+
+bool AsyncCapture::retrieveFrame(int channel, OutputArray image)
+{
+    if (!buffered && !running)
+        return source->retrieveFrame(channel, image);
+
+    if (channel != 0 || current.image.empty())
+    {
+        image.release();
+        return false;
+    }
+    if (image.kind() == _InputArray::MAT && !image.fixedSize() && !image.fixedType())
+    {
+        // hand over the buffer, the one previously held by the output is reused later
+        Mat& dst = image.getMatRef();
+        if (dst.data != current.image.data)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            recycle(dst);
+        }
+        dst = current.image;
+    }
+    else
+        current.image.copyTo(image);
+    return true;
+}
+
+double AsyncCapture::getProperty(int propId) const
+{
+    switch (propId)
+    {
+    case CAP_PROP_ASYNC_BUFFERS:
+        return capacity;
+    case CAP_PROP_ASYNC_POLICY:
+        return policy;
+    case CAP_PROP_ASYNC_QUEUE_DEPTH:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)queue.size();
+    }
+    case CAP_PROP_ASYNC_DROPPED_FRAMES:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)dropped;
+    }
+    case CAP_PROP_ASYNC_WAITS:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)waits;
+    }
+    case CAP_PROP_POS_FRAMES:
+        if (buffered || running)
+            return current.posFrames;
+        break;
+    case CAP_PROP_POS_MSEC:
+        if (buffered || running)
+            return current.posMsec;
+        break;
+    default:
+        break;
+    }
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    return source->getProperty(propId);
+}
+
+bool AsyncCapture::setProperty(int propId, double value)
+{
+    switch (propId)
+    {
+    case CAP_PROP_ASYNC_BUFFERS:
+        if (value < 0)
+            return false;
+        // the frames decoded already are grabbed first
+        stop(false);
+        capacity = cvRound(value);
+        if (capacity > 0)
+            start();
+        return true;
+    case CAP_PROP_ASYNC_POLICY:
+        if (value != CAP_ASYNC_BLOCK && value != CAP_ASYNC_DROP_OLDEST)
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            policy = (int)value;
+        }
+        spaceReady.notify_all();
+        return true;
+    case CAP_PROP_ASYNC_QUEUE_DEPTH:
+    case CAP_PROP_ASYNC_DROPPED_FRAMES:
+    case CAP_PROP_ASYNC_WAITS:
+        return false;
+    default:
+        break;
+    }
+
+    // the frames decoded ahead do not match the new position or settings
+    bool restart = running;
+    stop(true);
+    bool ok = source->setProperty(propId, value);
+    if (restart)
+        start();
+    return ok;
+}
+
+Ptr<IVideoCapture> createAsyncCapture(const Ptr<IVideoCapture>& source)
+{
+    if (dynamic_cast<AsyncCapture*>(source.get()))
+        return source;
+    return makePtr<AsyncCapture>(source);
+}
+
+/** Encodes the frames on a background thread.
+
+The written frames are copied into a bounded queue of reused buffers, so the caller only waits
+for the encoder when the queue is full and the policy says so.
+*/
+class AsyncWriter CV_FINAL : public IVideoWriter
+{
+public:
+    explicit AsyncWriter(const Ptr<IVideoWriter>& sink_)
+        : sink(sink_), capacity(0), policy(VIDEOWRITER_ASYNC_BLOCK), running(false), stopping(false),
+          dropped(0), waits(0), encoded(0), encodeTicks(0)
+    {
+        CV_Assert(sink);
+    }
+    virtual ~AsyncWriter() CV_OVERRIDE { stop(); }
+
+    virtual double getProperty(int propId) const CV_OVERRIDE;
+    virtual bool setProperty(int propId, double value) CV_OVERRIDE;
+    virtual bool isOpened() const CV_OVERRIDE { return sink->isOpened(); }
+    virtual void write(InputArray image) CV_OVERRIDE;
+
+protected:
+    void start();
+    void stop();
+    void run();
+    void rethrowError(); // called with the mutex locked
+
+    Ptr<IVideoWriter> sink;
+    int capacity, policy;
+
+    std::thread thread;
+    mutable std::mutex mutex;     // guards the queue, the buffers and the counters
+    mutable std::mutex sinkMutex; // held by the background thread while it encodes
+    std::condition_variable frameReady, spaceReady;
+
+    std::deque<Mat> queue;
+    std::vector<Mat> released; // buffers of the encoded frames
+    bool running, stopping;
+    std::exception_ptr error;
+    int64 dropped, waits, encoded, encodeTicks;
+};
+
+void AsyncWriter::start()
+{
+    stopping = false;
+    running = true;
+    thread = std::thread(&AsyncWriter::run, this);
+}
+
+void AsyncWriter::stop()
+{
+    if (!running)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    // the queued frames are encoded first
+    frameReady.notify_all();
+    thread.join();
+    running = false;
+}
+
+void AsyncWriter::rethrowError()
+{
+    if (error)
+    {
+        std::exception_ptr e = error;
+        error = std::exception_ptr();
+        std::rethrow_exception(e);
+    }
+}
+
+void AsyncWriter::run()
+{
+    for (;;)
+    {
+        Mat frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && queue.empty())
+                frameReady.wait(lock);
+            if (queue.empty())
+                break;
+            frame = queue.front();
+            queue.pop_front();
+        }
+
+        int64 t = getTickCount();
+        CV_TRY
+        {
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            sink->write(frame);
+        }
+        CV_CATCH_ALL
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+        t = getTickCount() - t;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        encodeTicks += t;
+        encoded++;
+        released.push_back(frame);
+        spaceReady.notify_one();
+    }
+}
+
+void AsyncWriter::write(InputArray image)
+{
+    if (!running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rethrowError();
+        }
+        sink->write(image);
+        return;
+    }
+
+    Mat buf;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        rethrowError();
+        // the policy may change while waiting, so it is applied again until there is room
+        bool waited = false;
+        while ((int)queue.size() >= capacity)
+        {
+            if (policy == VIDEOWRITER_ASYNC_DROP_NEWEST)
+            {
+                dropped++;
+                return;
+            }
+            if (policy == VIDEOWRITER_ASYNC_DROP_OLDEST)
+            {
+                released.push_back(queue.front());
+                queue.pop_front();
+                dropped++;
+            }
+            else
+            {
+                if (!waited)
+                    waits++;
+                waited = true;
+                spaceReady.wait(lock);
+            }
+        }
+        if (!released.empty())
+        {
+            buf = released.back();
+            released.pop_back();
+        }
+    }
+
+    // the only producer, the room in the queue is kept while copying
+    image.copyTo(buf);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(buf);
+    frameReady.notify_one();
+}
+
+double AsyncWriter::getProperty(int propId) const
+{
+    switch (propId)
+    {
+    case VIDEOWRITER_PROP_ASYNC_BUFFERS:
+        return capacity;
+    case VIDEOWRITER_PROP_ASYNC_POLICY:
+        return policy;
+    case VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)queue.size();
+    }
+    case VIDEOWRITER_PROP_ASYNC_DROPPED_FRAMES:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)dropped;
+    }
+    case VIDEOWRITER_PROP_ASYNC_WAITS:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (double)waits;
+    }
+    case VIDEOWRITER_PROP_ASYNC_ENCODE_MSEC:
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return encoded > 0 ? encodeTicks * 1000. / (encoded * getTickFrequency()) : 0.;
+    }
+    default:
+        break;
+    }
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    return sink->getProperty(propId);
+}
+
+bool AsyncWriter::setProperty(int propId, double value)
+{
+    switch (propId)
+    {
+    case VIDEOWRITER_PROP_ASYNC_BUFFERS:
+        if (value < 0)
+            return false;
+        stop();
+        capacity = cvRound(value);
+        if (capacity > 0)
+            start();
+        return true;
+    case VIDEOWRITER_PROP_ASYNC_POLICY:
+        if (value != VIDEOWRITER_ASYNC_BLOCK && value != VIDEOWRITER_ASYNC_DROP_OLDEST &&
+            value != VIDEOWRITER_ASYNC_DROP_NEWEST)
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            policy = (int)value;
+        }
+        spaceReady.notify_all();
+        return true;
+    case VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH:
+    case VIDEOWRITER_PROP_ASYNC_DROPPED_FRAMES:
+    case VIDEOWRITER_PROP_ASYNC_WAITS:
+    case VIDEOWRITER_PROP_ASYNC_ENCODE_MSEC:
+        return false;
+    default:
+        break;
+    }
+    // the frames still queued are encoded with the new settings too
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    return sink->setProperty(propId, value);
+}
+
+Ptr<IVideoWriter> createAsyncWriter(const Ptr<IVideoWriter>& sink)
+{
+    if (dynamic_cast<AsyncWriter*>(sink.get()))
+        return sink;
+    return makePtr<AsyncWriter>(sink);
+}
+
+}
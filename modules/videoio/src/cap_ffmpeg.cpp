@@ -53,6 +53,7 @@ static CvCreateFileCapture_Plugin icvCreateFileCapture_FFMPEG_p = 0;
 static CvReleaseCapture_Plugin icvReleaseCapture_FFMPEG_p = 0;
 static CvGrabFrame_Plugin icvGrabFrame_FFMPEG_p = 0;
 static CvRetrieveFrame_Plugin icvRetrieveFrame_FFMPEG_p = 0;
+static CvRetrieveFrameTo_Plugin icvRetrieveFrameTo_FFMPEG_p = 0;
 static CvSetCaptureProperty_Plugin icvSetCaptureProperty_FFMPEG_p = 0;
 static CvGetCaptureProperty_Plugin icvGetCaptureProperty_FFMPEG_p = 0;
 static CvCreateVideoWriter_Plugin icvCreateVideoWriter_FFMPEG_p = 0;
@@ -151,6 +152,9 @@ private:
                 (CvGrabFrame_Plugin)GetProcAddress(icvFFOpenCV, "cvGrabFrame_FFMPEG");
             icvRetrieveFrame_FFMPEG_p =
                 (CvRetrieveFrame_Plugin)GetProcAddress(icvFFOpenCV, "cvRetrieveFrame_FFMPEG");
+            // absent in the older plugins, the frames are copied then
+            icvRetrieveFrameTo_FFMPEG_p =
+                (CvRetrieveFrameTo_Plugin)GetProcAddress(icvFFOpenCV, "cvRetrieveFrameTo_FFMPEG");
             icvSetCaptureProperty_FFMPEG_p =
                 (CvSetCaptureProperty_Plugin)GetProcAddress(icvFFOpenCV, "cvSetCaptureProperty_FFMPEG");
             icvGetCaptureProperty_FFMPEG_p =
@@ -186,6 +190,7 @@ private:
         icvReleaseCapture_FFMPEG_p = (CvReleaseCapture_Plugin)cvReleaseCapture_FFMPEG;
         icvGrabFrame_FFMPEG_p = (CvGrabFrame_Plugin)cvGrabFrame_FFMPEG;
         icvRetrieveFrame_FFMPEG_p = (CvRetrieveFrame_Plugin)cvRetrieveFrame_FFMPEG;
+        icvRetrieveFrameTo_FFMPEG_p = (CvRetrieveFrameTo_Plugin)cvRetrieveFrameTo_FFMPEG;
         icvSetCaptureProperty_FFMPEG_p = (CvSetCaptureProperty_Plugin)cvSetCaptureProperty_FFMPEG;
         icvGetCaptureProperty_FFMPEG_p = (CvGetCaptureProperty_Plugin)cvGetCaptureProperty_FFMPEG;
         icvCreateVideoWriter_FFMPEG_p = (CvCreateVideoWriter_Plugin)cvCreateVideoWriter_FFMPEG;
@@ -227,6 +232,13 @@ public:
         cvSetData(&frame, data, step);
         return &frame;
     }
+    virtual bool retrieveFrameTo(int, cv::OutputArray image) CV_OVERRIDE
+    {
+        if (!ffmpegCapture || !icvRetrieveFrameTo_FFMPEG_p ||
+            image.kind() != cv::_InputArray::MAT || image.fixedSize() || image.fixedType())
+            return false;
+        return icvRetrieveFrameTo_FFMPEG_p(ffmpegCapture, allocateFrame, (void*)&image) != 0;
+    }
     virtual bool open( const char* filename )
     {
         icvInitFFMPEG::Init();
@@ -246,6 +258,16 @@ public:
     }
 
 protected:
+    // the frame is converted right into the user's Mat, it is reallocated only when the format changes
+    static unsigned char* allocateFrame(void* userdata, int width, int height, int cn, int* step)
+    {
+        const cv::_OutputArray& image = *(const cv::_OutputArray*)userdata;
+        image.create(height, width, CV_8UC(cn));
+        cv::Mat& m = image.getMatRef();
+        *step = (int)m.step;
+        return m.data;
+    }
+
     void* ffmpegCapture;
     IplImage frame;
 };
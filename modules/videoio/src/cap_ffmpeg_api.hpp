@@ -24,10 +24,16 @@ enum
     CV_FFMPEG_CAP_PROP_FPS=5,
     CV_FFMPEG_CAP_PROP_FOURCC=6,
     CV_FFMPEG_CAP_PROP_FRAME_COUNT=7,
+    CV_FFMPEG_CAP_PROP_CONVERT_RGB=16,
     CV_FFMPEG_CAP_PROP_SAR_NUM=40,
-    CV_FFMPEG_CAP_PROP_SAR_DEN=41
+    CV_FFMPEG_CAP_PROP_SAR_DEN=41,
+    CV_FFMPEG_CAP_PROP_THREADS=19001,
+    CV_FFMPEG_CAP_PROP_THREAD_TYPE=19002
 };
 
+/* returns the buffer of height rows by width*cn bytes for the decoded frame and its row step */
+typedef unsigned char* (*CvAllocateFrame_Plugin)( void* userdata, int width, int height, int cn, int* step );
+
 
 OPENCV_FFMPEG_API struct CvCapture_FFMPEG* cvCreateFileCapture_FFMPEG(const char* filename);
 OPENCV_FFMPEG_API struct CvCapture_FFMPEG_2* cvCreateFileCapture_FFMPEG_2(const char* filename);
@@ -43,6 +49,8 @@ OPENCV_FFMPEG_API int cvRetrieveFrame_FFMPEG(struct CvCapture_FFMPEG* capture, u
                                              int* step, int* width, int* height, int* cn);
 OPENCV_FFMPEG_API int cvRetrieveFrame_FFMPEG_2(struct CvCapture_FFMPEG_2* capture, unsigned char** data,
                                              int* step, int* width, int* height, int* cn);
+OPENCV_FFMPEG_API int cvRetrieveFrameTo_FFMPEG(struct CvCapture_FFMPEG* capture,
+                                               CvAllocateFrame_Plugin allocate, void* userdata);
 OPENCV_FFMPEG_API void cvReleaseCapture_FFMPEG(struct CvCapture_FFMPEG** cap);
 OPENCV_FFMPEG_API void cvReleaseCapture_FFMPEG_2(struct CvCapture_FFMPEG_2** cap);
 OPENCV_FFMPEG_API struct CvVideoWriter_FFMPEG* cvCreateVideoWriter_FFMPEG(const char* filename,
@@ -60,6 +68,7 @@ typedef void* (*CvCreateCameraCapture_Plugin)( int index );
 typedef int (*CvGrabFrame_Plugin)( void* capture_handle );
 typedef int (*CvRetrieveFrame_Plugin)( void* capture_handle, unsigned char** data, int* step,
                                        int* width, int* height, int* cn );
+typedef int (*CvRetrieveFrameTo_Plugin)( void* capture_handle, CvAllocateFrame_Plugin allocate, void* userdata );
 typedef int (*CvSetCaptureProperty_Plugin)( void* capture_handle, int prop_id, double value );
 typedef double (*CvGetCaptureProperty_Plugin)( void* capture_handle, int prop_id );
 typedef void (*CvReleaseCapture_Plugin)( void** capture_handle );
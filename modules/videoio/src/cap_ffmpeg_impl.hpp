@@ -439,9 +439,14 @@ struct CvCapture_FFMPEG
     bool setProperty(int, double);
     bool grabFrame();
     bool retrieveFrame(int, unsigned char** data, int* step, int* width, int* height, int* cn);
+    bool retrieveFrameTo(CvAllocateFrame_Plugin allocate, void* userdata);
 
     void init();
 
+    void    getOutputFormat(int* width, int* height, int* cn) const;
+    bool    convertFrame(unsigned char* data, int step);
+    bool    reopenCodec();
+
     void    seek(int64_t frame_number);
     void    seek(double sec);
     bool    slowSeek( int framenumber );
@@ -466,6 +471,11 @@ struct CvCapture_FFMPEG
     AVPacket          packet;
     Image_FFMPEG      frame;
     struct SwsContext *img_convert_ctx;
+    struct SwsContext *out_convert_ctx; // converts right into the output buffer
+    unsigned char     *raw_buffer;
+
+    bool convert_rgb;
+    int thread_count, thread_type;
 
     int64_t frame_number, first_frame_number;
 
@@ -501,6 +511,16 @@ void CvCapture_FFMPEG::init()
     memset(&packet, 0, sizeof(packet));
     av_init_packet(&packet);
     img_convert_ctx = 0;
+    out_convert_ctx = 0;
+    raw_buffer = 0;
+
+    convert_rgb = true;
+    thread_count = 0;
+#ifdef FF_THREAD_FRAME
+    thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#else
+    thread_type = 0;
+#endif
 
     avcodec = 0;
     frame_number = 0;
@@ -520,6 +540,15 @@ void CvCapture_FFMPEG::close()
         img_convert_ctx = 0;
     }
 
+    if( out_convert_ctx )
+    {
+        sws_freeContext(out_convert_ctx);
+        out_convert_ctx = 0;
+    }
+
+    free(raw_buffer);
+    raw_buffer = 0;
+
     if( picture )
     {
 #if LIBAVCODEC_BUILD >= (LIBAVCODEC_VERSION_MICRO >= 100 \
@@ -884,6 +913,7 @@ bool CvCapture_FFMPEG::open( const char* _filename )
             if (enc_width && (enc->width != enc_width)) { enc->width = enc_width; }
             if (enc_height && (enc->height != enc_height)) { enc->height = enc_height; }
 
+            avcodec = codec;
             video_stream = i;
             video_st = ic->streams[i];
 #if LIBAVCODEC_BUILD >= (LIBAVCODEC_VERSION_MICRO >= 100 \
@@ -1017,6 +1047,18 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
     if( !video_st || !picture->data[0] )
         return false;
 
+    if( !convert_rgb )
+    {
+        getOutputFormat(width, height, cn);
+        unsigned char* buffer = (unsigned char*)realloc(raw_buffer, (size_t)*width * *height);
+        if( !buffer )
+            return false;
+        raw_buffer = buffer;
+        *data = raw_buffer;
+        *step = *width;
+        return convertFrame(raw_buffer, *step);
+    }
+
     if( img_convert_ctx == NULL ||
         frame.width != video_st->codec->width ||
         frame.height != video_st->codec->height ||
@@ -1083,6 +1125,100 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
     return true;
 }
 
+bool CvCapture_FFMPEG::retrieveFrameTo(CvAllocateFrame_Plugin allocate, void* userdata)
+{
+    if( !video_st || !picture->data[0] )
+        return false;
+
+    int width = 0, height = 0, cn = 0, step = 0;
+    getOutputFormat(&width, &height, &cn);
+    unsigned char* data = allocate(userdata, width, height, cn, &step);
+    return data != 0 && convertFrame(data, step);
+}
+
+void CvCapture_FFMPEG::getOutputFormat(int* width, int* height, int* cn) const
+{
+    *width = video_st->codec->width;
+    *height = video_st->codec->height;
+    *cn = 3;
+    if( !convert_rgb )
+    {
+        // I420: Y plane followed by U and V planes of a quarter size, the odd row/column is cut
+        *width &= ~1;
+        *height = (*height & ~1) / 2 * 3;
+        *cn = 1;
+    }
+}
+
+bool CvCapture_FFMPEG::convertFrame(unsigned char* data, int step)
+{
+    int width = video_st->codec->width, height = video_st->codec->height;
+    AVPixelFormat src_format = video_st->codec->pix_fmt;
+    AVPixelFormat dst_format = AV_PIX_FMT_BGR24;
+    uint8_t* dst[4] = { data, 0, 0, 0 };
+    int dst_step[4] = { step, 0, 0, 0 };
+
+    if( !convert_rgb )
+    {
+        width &= ~1;
+        height &= ~1;
+        // the planes follow each other without gaps
+        if( step != width )
+            return false;
+        dst[1] = dst[0] + width*height;
+        dst[2] = dst[1] + width*height/4;
+        dst_step[1] = dst_step[2] = width/2;
+
+        if( src_format == AV_PIX_FMT_YUV420P || src_format == AV_PIX_FMT_YUVJ420P )
+        {
+            // the decoded planes are copied as is
+            for( int i = 0; i < 3; i++ )
+            {
+                int rows = i == 0 ? height : height/2, cols = i == 0 ? width : width/2;
+                for( int y = 0; y < rows; y++ )
+                    memcpy(dst[i] + y*dst_step[i], picture->data[i] + y*picture->linesize[i], cols);
+            }
+            return true;
+        }
+        dst_format = AV_PIX_FMT_YUV420P;
+    }
+
+    out_convert_ctx = sws_getCachedContext(
+            out_convert_ctx,
+            width, height, src_format,
+            width, height, dst_format,
+            SWS_BICUBIC,
+            NULL, NULL, NULL
+            );
+    if( out_convert_ctx == NULL )
+        return false;
+
+    sws_scale(out_convert_ctx, picture->data, picture->linesize, 0, height, dst, dst_step);
+    return true;
+}
+
+bool CvCapture_FFMPEG::reopenCodec()
+{
+#if LIBAVCODEC_VERSION_INT >= ((53<<16)+(8<<8)+0) && defined FF_THREAD_FRAME
+    AVCodecContext* enc = video_st->codec;
+    avcodec_close(enc);
+    enc->thread_count = thread_count > 0 ? thread_count : get_number_of_cpus();
+    enc->thread_type = thread_type;
+    if( !avcodec || avcodec_open2(enc, avcodec, NULL) < 0 )
+    {
+        CV_WARN("Could not reopen the decoder");
+        return false;
+    }
+
+    // the decoder has lost the reference frames, decode them again
+    if( frame_number > 0 )
+        seek(frame_number);
+    return true;
+#else
+    return false;
+#endif
+}
+
 
 double CvCapture_FFMPEG::getProperty( int property_id ) const
 {
@@ -1114,6 +1250,15 @@ double CvCapture_FFMPEG::getProperty( int property_id ) const
         return _opencv_ffmpeg_get_sample_aspect_ratio(ic->streams[video_stream]).num;
     case CV_FFMPEG_CAP_PROP_SAR_DEN:
         return _opencv_ffmpeg_get_sample_aspect_ratio(ic->streams[video_stream]).den;
+    case CV_FFMPEG_CAP_PROP_CONVERT_RGB:
+        return convert_rgb ? 1 : 0;
+    case CV_FFMPEG_CAP_PROP_THREADS:
+        return (double)video_st->codec->thread_count;
+#ifdef FF_THREAD_FRAME
+    case CV_FFMPEG_CAP_PROP_THREAD_TYPE:
+        // the threading chosen by the decoder, it depends on the codec and the stream
+        return (double)video_st->codec->active_thread_type;
+#endif
     default:
         break;
     }
@@ -1283,6 +1428,17 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
             picture_pts=(int64_t)value;
         }
         break;
+    case CV_FFMPEG_CAP_PROP_CONVERT_RGB:
+        convert_rgb = value != 0;
+        break;
+    case CV_FFMPEG_CAP_PROP_THREADS:
+        if( value < 0 )
+            return false;
+        thread_count = (int)value;
+        return reopenCodec();
+    case CV_FFMPEG_CAP_PROP_THREAD_TYPE:
+        thread_type = (int)value;
+        return reopenCodec();
     default:
         return false;
     }
@@ -2201,6 +2357,11 @@ int cvRetrieveFrame_FFMPEG(CvCapture_FFMPEG* capture, unsigned char** data, int*
     return capture->retrieveFrame(0, data, step, width, height, cn);
 }
 
+int cvRetrieveFrameTo_FFMPEG(CvCapture_FFMPEG* capture, CvAllocateFrame_Plugin allocate, void* userdata)
+{
+    return capture->retrieveFrameTo(allocate, userdata);
+}
+
 CvVideoWriter_FFMPEG* cvCreateVideoWriter_FFMPEG( const char* filename, int fourcc, double fps,
                                                   int width, int height, int isColor )
 {
@@ -0,0 +1,258 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace cv
+{
+
+static int64 tickCountNs()
+{
+    static const double ns_per_tick = 1e9 / getTickFrequency();
+    return (int64)(getTickCount() * ns_per_tick);
+}
+
+/** One grabbing thread per stream. A grab request is handed to all the threads at once, and the
+group waits until every stream has completed it or the timeout expires.
+*/
+struct VideoCaptureGroup::Impl
+{
+    enum State { IDLE, REQUESTED, GRABBING, DONE };
+
+    struct Stream
+    {
+        Stream() : state(IDLE), grabbed(false), timestamp(0), sequence(-1), count(0), doneTimestamp(0) {}
+
+        VideoCapture cap;
+        std::thread thread;
+        State state;
+        bool grabbed;     // result of the last grab
+        int64 timestamp;  // of the last frame reported by VideoCaptureGroup::grab()
+        int64 sequence;
+        int64 count;      // frames grabbed so far
+        int64 doneTimestamp;
+        std::exception_ptr error;
+    };
+
+    Impl() : stopping(false) {}
+    ~Impl() { stop(); }
+
+    void start(const std::vector<VideoCapture>& caps);
+    void stop();
+    void run(Stream* s);
+    Stream& at(int index) const
+    {
+        CV_Assert(0 <= index && index < (int)streams.size());
+        return *streams[index];
+    }
+
+    std::vector<Ptr<Stream> > streams;
+    mutable std::mutex mutex;
+    std::condition_variable requested, done;
+    bool stopping;
+};
+
+void VideoCaptureGroup::Impl::start(const std::vector<VideoCapture>& caps)
+{
+    stop();
+    stopping = false;
+    for (size_t i = 0; i < caps.size(); i++)
+    {
+        CV_Assert(caps[i].isOpened());
+        Ptr<Stream> s = makePtr<Stream>();
+        s->cap = caps[i];
+        streams.push_back(s);
+    }
+    for (size_t i = 0; i < streams.size(); i++)
+        streams[i]->thread = std::thread(&Impl::run, this, streams[i].get());
+}
+
+void VideoCaptureGroup::Impl::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        requested.notify_all();
+    }
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        if (streams[i]->thread.joinable())
+            streams[i]->thread.join();
+    }
+    streams.clear();
+}
+
+void VideoCaptureGroup::Impl::run(Stream* s)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        while (!stopping && s->state != REQUESTED)
+            requested.wait(lock);
+        if (stopping)
+            break;
+        s->state = GRABBING;
+        lock.unlock();
+
+        bool grabbed = false;
+        std::exception_ptr error;
+        CV_TRY
+        {
+            grabbed = s->cap.grab();
+        }
+        CV_CATCH_ALL
+        {
+            error = std::current_exception();
+        }
+        const int64 timestamp = tickCountNs();
+
+        lock.lock();
+        s->grabbed = grabbed;
+        s->error = error;
+        s->doneTimestamp = timestamp;
+        s->state = DONE;
+        done.notify_all();
+    }
+}
+
+VideoCaptureGroup::VideoCaptureGroup() : impl(makePtr<Impl>())
+{
+}
+
+VideoCaptureGroup::VideoCaptureGroup(const std::vector<VideoCapture>& streams) : impl(makePtr<Impl>())
+{
+    open(streams);
+}
+
+VideoCaptureGroup::~VideoCaptureGroup()
+{
+    release();
+}
+
+void VideoCaptureGroup::open(const std::vector<VideoCapture>& streams)
+{
+    CV_INSTRUMENT_REGION()
+
+    impl->start(streams);
+}
+
+void VideoCaptureGroup::release()
+{
+    impl->stop();
+}
+
+int VideoCaptureGroup::size() const
+{
+    return (int)impl->streams.size();
+}
+
+bool VideoCaptureGroup::grab(std::vector<int>& readyIndex, int64 timeoutNs)
+{
+    CV_INSTRUMENT_REGION()
+
+    readyIndex.clear();
+    std::vector<Ptr<Impl::Stream> >& streams = impl->streams;
+    std::unique_lock<std::mutex> lock(impl->mutex);
+
+    // the streams still grabbing since a previous timeout are not requested again
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        if (streams[i]->state == Impl::IDLE)
+            streams[i]->state = Impl::REQUESTED;
+    }
+    impl->requested.notify_all();
+
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeoutNs);
+    for (;;)
+    {
+        bool pending = false;
+        for (size_t i = 0; i < streams.size() && !pending; i++)
+            pending = streams[i]->state != Impl::DONE;
+        if (!pending)
+            break;
+        if (timeoutNs <= 0)
+            impl->done.wait(lock);
+        else if (impl->done.wait_until(lock, deadline) == std::cv_status::timeout)
+            break;
+    }
+
+    std::exception_ptr error;
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        Impl::Stream& s = *streams[i];
+        if (s.state != Impl::DONE)
+            continue;
+        s.state = Impl::IDLE;
+        if (s.error)
+        {
+            error = s.error;
+            s.error = std::exception_ptr();
+        }
+        else if (s.grabbed)
+        {
+            s.timestamp = s.doneTimestamp;
+            s.sequence = s.count++;
+            readyIndex.push_back((int)i);
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+    return !streams.empty() && readyIndex.size() == streams.size();
+}
+
+bool VideoCaptureGroup::retrieve(int index, OutputArray image, int flag)
+{
+    CV_INSTRUMENT_REGION()
+
+    Impl::Stream& s = impl->at(index);
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        if (s.state != Impl::IDLE)
+            return false;
+    }
+    // the thread of an idle stream does not touch the capture until the next grab
+    return s.cap.retrieve(image, flag);
+}
+
+bool VideoCaptureGroup::read(std::vector<Mat>& images, int64 timeoutNs)
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<int> ready;
+    bool all = grab(ready, timeoutNs);
+    images.resize(impl->streams.size());
+    std::vector<bool> retrieved(images.size(), false);
+    for (size_t i = 0; i < ready.size(); i++)
+        retrieved[ready[i]] = retrieve(ready[i], images[ready[i]]);
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        if (!retrieved[i])
+        {
+            images[i].release();
+            all = false;
+        }
+    }
+    return all;
+}
+
+int64 VideoCaptureGroup::getTimestamp(int index) const
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->at(index).timestamp;
+}
+
+int64 VideoCaptureGroup::getSequenceNumber(int index) const
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->at(index).sequence;
+}
+
+} // namespace cv
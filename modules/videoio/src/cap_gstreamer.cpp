@@ -156,6 +156,35 @@ inline static bool is_gst_element_exists(const std::string & name)
     return true;
 }
 
+#if GST_VERSION_MAJOR > 0
+/*!
+ * \brief The GStreamerBufferAllocator class
+ * Keeps a GstBuffer referenced and mapped while a Mat refers to its memory
+ */
+class GStreamerBufferAllocator CV_FINAL : public MatAllocator
+{
+public:
+    struct Mapping
+    {
+        GstBuffer* buffer;
+        GstMapInfo info;
+    };
+    UMatData* allocate(int, const int*, int, void*, size_t*, int, UMatUsageFlags) const CV_OVERRIDE { return NULL; }
+    bool allocate(UMatData*, int, UMatUsageFlags) const CV_OVERRIDE { return false; }
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+        CV_Assert(u->urefcount == 0 && u->refcount == 0);
+        Mapping* mapping = (Mapping*)u->userdata;
+        gst_buffer_unmap(mapping->buffer, &mapping->info);
+        gst_buffer_unref(mapping->buffer);
+        delete mapping;
+        delete u;
+    }
+};
+#endif
+
 //==================================================================================================
 
 class GStreamerCapture CV_FINAL : public IVideoCapture
@@ -180,6 +209,8 @@ private:
     bool          isPosFramesEmulated;
     gint64        emulatedFrameNumber;
     bool          isOutputByteBuffer;
+    bool          zeroCopy;
+    double        latency;
 
 public:
     GStreamerCapture();
@@ -196,6 +227,8 @@ public:
 
 protected:
     bool determineFrameDims(Size & sz);
+    Mat frameHeader(const Size & sz, uchar* data, size_t size) const;
+    void updateLatency();
     bool isPipelinePlaying();
     void startPipeline();
     void stopPipeline();
@@ -218,7 +251,9 @@ GStreamerCapture::GStreamerCapture() :
     isPosFramesSupported(false),
     isPosFramesEmulated(false),
     emulatedFrameNumber(-1),
-    isOutputByteBuffer(false)
+    isOutputByteBuffer(false),
+    zeroCopy(false),
+    latency(0)
 {
 }
 
@@ -269,6 +304,7 @@ bool GStreamerCapture::grabFrame()
     if(!sample)
         return false;
     gst_sample_ref(sample);
+    updateLatency();
 #endif
 
     if (isPosFramesEmulated)
@@ -277,10 +313,53 @@ bool GStreamerCapture::grabFrame()
     return true;
 }
 
+#if GST_VERSION_MAJOR > 0
+/*!
+ * \brief GStreamerCapture::updateLatency
+ * Measures how late the grabbed sample is with respect to the pipeline clock
+ */
+void GStreamerCapture::updateLatency()
+{
+    latency = 0;
+    GstBuffer * buf = gst_sample_get_buffer(sample);
+    GstSegment * segment = gst_sample_get_segment(sample);
+    if (!buf || !segment || !GST_BUFFER_PTS_IS_VALID(buf))
+        return;
+    GstClock * clock = gst_element_get_clock(pipeline);
+    if (!clock)
+        return;
+    GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+    GstClockTime base_time = gst_element_get_base_time(pipeline);
+    guint64 running_time = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+    if (running_time == GST_CLOCK_TIME_NONE || now < base_time)
+        return;
+    latency = ((double)(gint64)(now - base_time) - (double)running_time) * 1e-6; // nano seconds to milli seconds
+}
+#endif
+
+/*!
+ * \brief GStreamerCapture::frameHeader
+ * \return Mat header over the mapped sample memory.
+ *  Packed formats may have rows padded to 4 bytes, the stride is derived from the buffer size.
+ */
+Mat GStreamerCapture::frameHeader(const Size & sz, uchar* data, size_t size) const
+{
+    if (isOutputByteBuffer)
+        return Mat(Size((int)size, 1), CV_8UC1, data);
+    size_t step = (size_t)sz.width * channels;
+    if (sz.height > 0 && size % sz.height == 0 && size / sz.height > step)
+        step = size / sz.height;
+    CV_Assert(size >= step * sz.height);
+    return Mat(sz, CV_MAKETYPE(CV_8U, channels), data, step);
+}
+
 /*!
  * \brief CvCapture_GStreamer::retrieveFrame
  * \return IplImage pointer. [Transfer Full]
- *  Retrieve the previously grabbed buffer, and wrap it in an IPLImage structure
+ *  Retrieve the previously grabbed buffer, and wrap it in an IPLImage structure.
+ *  In the zero-copy mode the output refers to the mapped buffer, which is kept
+ *  referenced until the last Mat using it is released.
  */
 bool GStreamerCapture::retrieveFrame(int, OutputArray dst)
 {
@@ -304,6 +383,28 @@ bool GStreamerCapture::retrieveFrame(int, OutputArray dst)
     GstBuffer * buf = gst_sample_get_buffer(sample);
     if (!buf)
         return false;
+    if (zeroCopy && dst.kind() == _InputArray::MAT && !dst.fixedSize() && !dst.fixedType())
+    {
+        static GStreamerBufferAllocator allocator;
+        GStreamerBufferAllocator::Mapping* mapping = new GStreamerBufferAllocator::Mapping;
+        mapping->buffer = gst_buffer_ref(buf);
+        if (!gst_buffer_map(buf, &mapping->info, GST_MAP_READ))
+        {
+            gst_buffer_unref(buf);
+            delete mapping;
+            CV_WARN("Failed to map GStreamerbuffer to system memory");
+            return false;
+        }
+        Mat src = frameHeader(sz, mapping->info.data, mapping->info.size);
+        src.u = new UMatData(&allocator);
+        src.u->data = src.u->origdata = mapping->info.data;
+        src.u->size = mapping->info.size;
+        src.u->userdata = mapping;
+        src.u->refcount = 1;
+        dst.getMatRef() = src;
+        return true;
+    }
+
     GstMapInfo info;
     if (!gst_buffer_map(buf, &info, GST_MAP_READ))
     {
@@ -312,15 +413,7 @@ bool GStreamerCapture::retrieveFrame(int, OutputArray dst)
         return false;
     }
 
-    {
-        Mat src;
-        if (isOutputByteBuffer)
-            src = Mat(Size(info.size, 1), CV_8UC1, info.data);
-        else
-            src = Mat(sz, CV_MAKETYPE(CV_8U, channels), info.data);
-        CV_Assert(src.isContinuous());
-        src.copyTo(dst);
-    }
+    frameHeader(sz, info.data, info.size).copyTo(dst);
     gst_buffer_unmap(buf, &info);
 #endif
 
@@ -821,12 +914,14 @@ bool GStreamerCapture::open(const String &filename_)
         }
     }
 
-    //TODO: is 1 single buffer really high enough?
-    gst_app_sink_set_max_buffers (GST_APP_SINK(sink), 1);
-//    gst_app_sink_set_drop (GST_APP_SINK(sink), stream);
+    // keep the latency bounded: a single queued sample, unless the pipeline description asks for more.
+    // Live sources built from an uri drop the stale samples instead of stalling the producer.
+    if (!manualpipeline || gst_app_sink_get_max_buffers(GST_APP_SINK(sink)) == 0)
+        gst_app_sink_set_max_buffers (GST_APP_SINK(sink), 1);
+    if (!manualpipeline && !file)
+        gst_app_sink_set_drop (GST_APP_SINK(sink), TRUE);
     //do not emit signals: all calls will be synchronous and blocking
     gst_app_sink_set_emit_signals (GST_APP_SINK(sink), FALSE);
-//    gst_base_sink_set_sync(GST_BASE_SINK(sink), FALSE);
 
 #if GST_VERSION_MAJOR == 0
     caps = gst_caps_new_simple("video/x-raw-rgb",
@@ -1037,6 +1132,28 @@ double GStreamerCapture::getProperty(int propId) const
             return 0;
         }
         return gst_app_sink_get_max_buffers(GST_APP_SINK(sink));
+    case CAP_PROP_GSTREAMER_DROP:
+        if(!sink)
+        {
+            CV_WARN("there is no sink yet");
+            return 0;
+        }
+        return gst_app_sink_get_drop(GST_APP_SINK(sink)) ? 1 : 0;
+    case CAP_PROP_GSTREAMER_SYNC:
+    {
+        if(!sink)
+        {
+            CV_WARN("there is no sink yet");
+            return 0;
+        }
+        gboolean sync = FALSE;
+        g_object_get(G_OBJECT(sink), "sync", &sync, NULL);
+        return sync ? 1 : 0;
+    }
+    case CAP_PROP_GSTREAMER_ZERO_COPY:
+        return zeroCopy ? 1 : 0;
+    case CAP_PROP_GSTREAMER_LATENCY_MSEC:
+        return latency;
     default:
         CV_WARN("GStreamer: unhandled property");
         break;
@@ -1065,6 +1182,42 @@ bool GStreamerCapture::setProperty(int propId, double value)
         return false;
     }
 
+    // the appsink and output properties take effect on the fly, the pipeline is not restarted
+    switch(propId)
+    {
+    case CV_CAP_GSTREAMER_QUEUE_LENGTH:
+    case CAP_PROP_GSTREAMER_DROP:
+    case CAP_PROP_GSTREAMER_SYNC:
+        if(!sink)
+        {
+            CV_WARN("there is no sink yet");
+            return false;
+        }
+        if (propId == CV_CAP_GSTREAMER_QUEUE_LENGTH)
+        {
+            if (value < 0)
+                return false;
+            // 0 lets the queue grow without limit
+            gst_app_sink_set_max_buffers(GST_APP_SINK(sink), (guint) value);
+        }
+        else if (propId == CAP_PROP_GSTREAMER_DROP)
+            gst_app_sink_set_drop(GST_APP_SINK(sink), value != 0);
+        else
+            g_object_set(G_OBJECT(sink), "sync", (gboolean)(value != 0), NULL);
+        return true;
+    case CAP_PROP_GSTREAMER_ZERO_COPY:
+#if GST_VERSION_MAJOR > 0
+        zeroCopy = value != 0;
+        return true;
+#else
+        return false;
+#endif
+    case CAP_PROP_GSTREAMER_LATENCY_MSEC:
+        return false;
+    default:
+        break;
+    }
+
     bool wasPlaying = this->isPipelinePlaying();
     if (wasPlaying)
         this->stopPipeline();
@@ -1179,16 +1332,6 @@ bool GStreamerCapture::setProperty(int propId, double value)
     case CV_CAP_PROP_GAIN:
     case CV_CAP_PROP_CONVERT_RGB:
         break;
-    case CV_CAP_GSTREAMER_QUEUE_LENGTH:
-    {
-        if(!sink)
-        {
-            CV_WARN("there is no sink yet");
-            return false;
-        }
-        gst_app_sink_set_max_buffers(GST_APP_SINK(sink), (guint) value);
-        return true;
-    }
     default:
         CV_WARN("GStreamer: unhandled property");
     }
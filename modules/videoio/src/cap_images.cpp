@@ -50,7 +50,9 @@
 //
 
 #include "precomp.hpp"
+#include "opencv2/core/utils/filesystem.hpp"
 #include <sys/stat.h>
+#include <set>
 
 #ifdef NDEBUG
 #define CV_WARN(message)
@@ -70,8 +72,9 @@ public:
         filename = NULL;
         currentframe = firstframe = 0;
         length = 0;
-        frame = NULL;
         grabbedInOpen = false;
+        readAhead = cv::getNumThreads();
+        decodedBegin = 0;
     }
 
     virtual ~CvCapture_Images() CV_OVERRIDE
@@ -87,13 +90,22 @@ public:
     virtual IplImage* retrieveFrame(int) CV_OVERRIDE;
 
 protected:
+    void listFrames(unsigned offset);
+    void decodeAhead(unsigned index);
+
     char*  filename; // actually a printf-pattern
     unsigned currentframe;
     unsigned firstframe; // number of first frame
     unsigned length; // length of sequence
+    std::vector<cv::String> files; // the frame files, listed once on open
 
-    IplImage* frame;
+    cv::Mat frame;
+    IplImage frameHeader;
     bool grabbedInOpen;
+
+    int readAhead;
+    unsigned decodedBegin;
+    std::vector<cv::Mat> decoded;
 };
 
 
@@ -106,34 +118,70 @@ void CvCapture_Images::close()
     }
     currentframe = firstframe = 0;
     length = 0;
-    cvReleaseImage( &frame );
+    files.clear();
+    frame.release();
+    decoded.clear();
+    decodedBegin = 0;
 }
 
+class ImageSequenceReadBody : public cv::ParallelLoopBody
+{
+public:
+    ImageSequenceReadBody(const std::vector<cv::String>& files_, unsigned first_, std::vector<cv::Mat>& frames_)
+        : files(files_), first(first_), frames(frames_) {}
+
+    void operator()(const cv::Range& range) const CV_OVERRIDE
+    {
+        for(int i = range.start; i < range.end; i++)
+            frames[i] = cv::imread(files[first + i], cv::IMREAD_UNCHANGED);
+    }
 
-bool CvCapture_Images::grabFrame()
+protected:
+    const std::vector<cv::String>& files;
+    unsigned first;
+    std::vector<cv::Mat>& frames;
+};
+
+// reads and decodes the next frames in parallel, the file I/O overlaps as well
+void CvCapture_Images::decodeAhead(unsigned index)
 {
-    char str[_MAX_PATH];
-    sprintf(str, filename, firstframe + currentframe);
+    const unsigned count = std::min((unsigned)std::max(readAhead, 1), length - index);
+    decoded.assign(count, cv::Mat());
+    decodedBegin = index;
+    cv::parallel_for_(cv::Range(0, (int)count), ImageSequenceReadBody(files, index, decoded), (double)count);
+}
 
+bool CvCapture_Images::grabFrame()
+{
     if (grabbedInOpen)
     {
         grabbedInOpen = false;
         ++currentframe;
 
-        return frame != NULL;
+        return !frame.empty();
     }
 
-    cvReleaseImage(&frame);
-    frame = cvLoadImage(str, CV_LOAD_IMAGE_UNCHANGED);
-    if( frame )
+    frame.release();
+    if (currentframe >= length)
+        return false;
+
+    // the frames already handed over are read again when seeking back
+    if (currentframe < decodedBegin || currentframe >= decodedBegin + decoded.size() ||
+        decoded[currentframe - decodedBegin].empty())
+        decodeAhead(currentframe);
+    std::swap(frame, decoded[currentframe - decodedBegin]);
+    if( !frame.empty() )
         currentframe++;
 
-    return frame != NULL;
+    return !frame.empty();
 }
 
 IplImage* CvCapture_Images::retrieveFrame(int)
 {
-    return grabbedInOpen ? NULL : frame;
+    if (grabbedInOpen || frame.empty())
+        return NULL;
+    frameHeader = IplImage(frame);
+    return &frameHeader;
 }
 
 double CvCapture_Images::getProperty(int id) const
@@ -150,15 +198,17 @@ double CvCapture_Images::getProperty(int id) const
     case CV_CAP_PROP_POS_AVI_RATIO:
         return (double)currentframe / (double)(length - 1);
     case CV_CAP_PROP_FRAME_WIDTH:
-        return frame ? frame->width : 0;
+        return frame.cols;
     case CV_CAP_PROP_FRAME_HEIGHT:
-        return frame ? frame->height : 0;
+        return frame.rows;
     case CV_CAP_PROP_FPS:
         CV_WARN("collections of images don't have framerates\n");
         return 1;
     case CV_CAP_PROP_FOURCC:
         CV_WARN("collections of images don't have 4-character codes\n");
         return 0;
+    case cv::CAP_PROP_IMAGES_READ_AHEAD:
+        return readAhead;
     }
     return 0;
 }
@@ -193,6 +243,11 @@ bool CvCapture_Images::setProperty(int id, double value)
         if (currentframe != 0)
             grabbedInOpen = false; // grabbed frame is not valid anymore
         return true;
+    case cv::CAP_PROP_IMAGES_READ_AHEAD:
+        if(value < 0)
+            return false;
+        readAhead = cvRound(value);
+        return true;
     }
     CV_WARN("unknown/unhandled property\n");
     return false;
@@ -257,45 +312,85 @@ static char* icvExtractPattern(const char *filename, unsigned *offset)
 }
 
 
-bool CvCapture_Images::open(const char * _filename)
+// lists the directory once and looks the frame names up, instead of probing the files one by one
+void CvCapture_Images::listFrames(unsigned offset)
 {
-    unsigned offset = 0;
-    close();
+    cv::String pattern = filename, dir;
+    size_t slash = pattern.find_last_of("/\\");
+    if (slash != cv::String::npos)
+    {
+        dir = pattern.substr(0, slash + 1);
+        pattern = pattern.substr(slash + 1);
+    }
 
-    filename = icvExtractPattern(_filename, &offset);
-    if(!filename)
-        return false;
+    // a pattern in the directory part is resolved by probing the files
+    bool listed = dir.find('%') == cv::String::npos;
+    std::set<cv::String> names;
+    if (listed)
+    {
+        std::vector<cv::String> entries;
+        CV_TRY
+        {
+            cv::utils::fs::glob_relative(dir.empty() ? cv::String(".") : dir, cv::String(), entries);
+            names.insert(entries.begin(), entries.end());
+        }
+        CV_CATCH_ALL
+        {
+            // no such directory, or no filesystem support in this build: probe the files
+            listed = false;
+        }
+    }
 
-    // determine the length of the sequence
-    length = 0;
-    char str[_MAX_PATH];
+    char str[_MAX_PATH], name[_MAX_PATH];
     for(;;)
     {
         sprintf(str, filename, offset + length);
-        struct stat s;
-        if(stat(str, &s))
+        bool found;
+        if (listed)
+        {
+            sprintf(name, pattern.c_str(), offset + length);
+            found = names.count(name) > 0;
+        }
+        else
+        {
+            struct stat s;
+            found = stat(str, &s) == 0;
+        }
+        if(!found)
         {
             if(length == 0 && offset == 0) // allow starting with 0 or 1
             {
                 offset++;
                 continue;
             }
-        }
-
-        if(!cvHaveImageReader(str))
             break;
+        }
 
+        files.push_back(str);
         length++;
     }
+    firstframe = offset;
+}
 
-    if(length == 0)
+bool CvCapture_Images::open(const char * _filename)
+{
+    unsigned offset = 0;
+    close();
+
+    filename = icvExtractPattern(_filename, &offset);
+    if(!filename)
+        return false;
+
+    // determine the length of the sequence
+    length = 0;
+    listFrames(offset);
+
+    if(length == 0 || !cvHaveImageReader(files[0].c_str()))
     {
         close();
         return false;
     }
 
-    firstframe = offset;
-
     // grab frame to enable properties retrieval
     bool grabRes = grabFrame();
     grabbedInOpen = true;
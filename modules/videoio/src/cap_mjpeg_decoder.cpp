@@ -62,13 +62,20 @@ public:
 protected:
 
     inline uint64_t getFramePos() const;
+    bool seek(size_t frame);
+    void decodeAhead(size_t frame);
 
     Ptr<AVIReadContainer> m_avi_container;
     bool             m_is_first_frame;
     frame_list       m_mjpeg_frames;
 
     frame_iterator   m_frame_iterator;
-    Mat              m_current_frame;
+
+    // the frames following the retrieved one are decoded in parallel and kept
+    // here until they are retrieved, each one is handed out to the user only once
+    int              m_decode_ahead;
+    size_t           m_decoded_begin;
+    std::vector<Mat> m_decoded_frames;
 
     //frame width/height and fps could be different for
     //each frame/stream. At the moment we suppose that they
@@ -89,25 +96,44 @@ uint64_t MotionJpegCapture::getFramePos() const
     return m_frame_iterator - m_mjpeg_frames.begin() + 1;
 }
 
+// the frames are looked up in the AVI index, no scanning is needed
+bool MotionJpegCapture::seek(size_t frame)
+{
+    m_decoded_frames.clear();
+    if(frame == 0)
+    {
+        m_is_first_frame = true;
+        m_frame_iterator = m_mjpeg_frames.end();
+        return true;
+    }
+    if(frame <= m_mjpeg_frames.size())
+    {
+        m_frame_iterator = m_mjpeg_frames.begin() + (frame - 1);
+        m_is_first_frame = false;
+        return true;
+    }
+    return false;
+}
+
 bool MotionJpegCapture::setProperty(int property, double value)
 {
-    if(property == CAP_PROP_POS_FRAMES)
+    switch(property)
     {
-        if(int(value) == 0)
-        {
-            m_is_first_frame = true;
-            m_frame_iterator = m_mjpeg_frames.end();
-            return true;
-        }
-        else if(m_mjpeg_frames.size() > value)
-        {
-            m_frame_iterator = m_mjpeg_frames.begin() + int(value - 1);
-            m_is_first_frame = false;
+        case CAP_PROP_POS_FRAMES:
+            return value >= 0 && seek((size_t)value);
+        case CAP_PROP_POS_MSEC:
+            return value >= 0 && m_fps > 0 && seek((size_t)cvRound(value * m_fps / 1000));
+        case CAP_PROP_POS_AVI_RATIO:
+            return value >= 0 && seek((size_t)cvRound(value * m_mjpeg_frames.size()));
+        case CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD:
+            if(value < 0)
+                return false;
+            m_decode_ahead = cvRound(value);
+            m_decoded_frames.clear();
             return true;
-        }
+        default:
+            return false;
     }
-
-    return false;
 }
 
 double MotionJpegCapture::getProperty(int property) const
@@ -116,6 +142,8 @@ double MotionJpegCapture::getProperty(int property) const
     {
         case CAP_PROP_POS_FRAMES:
             return (double)getFramePos();
+        case CAP_PROP_POS_MSEC:
+            return getFramePos() > 0 && m_fps > 0 ? (getFramePos() - 1) * 1000 / m_fps : 0;
         case CAP_PROP_POS_AVI_RATIO:
             return double(getFramePos())/m_mjpeg_frames.size();
         case CAP_PROP_FRAME_WIDTH:
@@ -130,6 +158,8 @@ double MotionJpegCapture::getProperty(int property) const
             return (double)m_mjpeg_frames.size();
         case CAP_PROP_FORMAT:
             return 0;
+        case CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD:
+            return m_decode_ahead;
         default:
             return 0;
     }
@@ -153,19 +183,85 @@ bool MotionJpegCapture::grabFrame()
     return m_frame_iterator != m_mjpeg_frames.end();
 }
 
+class MotionJpegDecodeBody : public ParallelLoopBody
+{
+public:
+    MotionJpegDecodeBody(const std::vector<std::vector<char> >& data_, std::vector<Mat>& frames_, int flags_)
+        : data(data_), frames(frames_), flags(flags_) {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for(int i = range.start; i < range.end; i++)
+        {
+            if(data[i].empty() || !imdecode(data[i], flags, &frames[i]).data)
+                frames[i].release();
+        }
+    }
+
+protected:
+    const std::vector<std::vector<char> >& data;
+    std::vector<Mat>& frames;
+    int flags;
+};
+
+// reads the compressed frames one after another and decodes them in parallel
+void MotionJpegCapture::decodeAhead(size_t frame)
+{
+    const size_t count = std::min((size_t)m_decode_ahead, m_mjpeg_frames.size() - frame);
+    std::vector<std::vector<char> > data(count);
+    for(size_t i = 0; i < count; i++)
+        data[i] = m_avi_container->readFrame(m_mjpeg_frames.begin() + (frame + i));
+
+    m_decoded_frames.resize(count);
+    m_decoded_begin = frame;
+
+    const int flags = CV_LOAD_IMAGE_ANYDEPTH | CV_LOAD_IMAGE_COLOR | IMREAD_IGNORE_ORIENTATION;
+    parallel_for_(Range(0, (int)count), MotionJpegDecodeBody(data, m_decoded_frames, flags), (double)count);
+}
+
 bool MotionJpegCapture::retrieveFrame(int, OutputArray output_frame)
 {
+    if(m_frame_iterator != m_mjpeg_frames.end() && m_decode_ahead > 1)
+    {
+        const size_t frame = m_frame_iterator - m_mjpeg_frames.begin();
+        if(frame < m_decoded_begin || frame >= m_decoded_begin + m_decoded_frames.size())
+            decodeAhead(frame);
+
+        // the buffer is passed to the user and dropped from the batch, the frames retrieved
+        // once again or failed to decode are decoded one by one below
+        Mat& decoded = m_decoded_frames[frame - m_decoded_begin];
+        if(!decoded.empty())
+        {
+            if(output_frame.kind() == _InputArray::MAT && !output_frame.fixedSize() && !output_frame.fixedType())
+                output_frame.getMatRef() = decoded;
+            else
+                decoded.copyTo(output_frame);
+            decoded.release();
+            return true;
+        }
+    }
+
     if(m_frame_iterator != m_mjpeg_frames.end())
     {
         std::vector<char> data = m_avi_container->readFrame(m_frame_iterator);
 
-        if(data.size())
+        if(data.empty())
+            return false;
+
+        const int flags = CV_LOAD_IMAGE_ANYDEPTH | CV_LOAD_IMAGE_COLOR | IMREAD_IGNORE_ORIENTATION;
+        if(output_frame.kind() == _InputArray::MAT && !output_frame.fixedSize() && !output_frame.fixedType())
         {
-            m_current_frame = imdecode(data, CV_LOAD_IMAGE_ANYDEPTH | CV_LOAD_IMAGE_COLOR | IMREAD_IGNORE_ORIENTATION);
+            // decode right into the output buffer, it is not reallocated for the same frame size
+            // and it is released if the frame can't be decoded
+            Mat& dst = output_frame.getMatRef();
+            imdecode(data, flags, &dst);
+            return !dst.empty();
         }
 
-        m_current_frame.copyTo(output_frame);
-
+        Mat decoded = imdecode(data, flags);
+        if(decoded.empty())
+            return false;
+        decoded.copyTo(output_frame);
         return true;
     }
 
@@ -204,6 +300,9 @@ bool MotionJpegCapture::open(const String& filename)
 
     m_frame_iterator = m_mjpeg_frames.end();
     m_is_first_frame = true;
+    m_decode_ahead = 0;
+    m_decoded_begin = 0;
+    m_decoded_frames.clear();
 
     if(!m_avi_container->parseRiff(m_mjpeg_frames))
     {
@@ -41,6 +41,7 @@
 
 #include "precomp.hpp"
 #include "opencv2/videoio/container_avi.private.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <vector>
 #include <deque>
@@ -231,14 +232,11 @@ private:
 };
 
 
+// every stripe is encoded into its own buffer as a separate restart interval,
+// the buffers are written one after another without merging the bits
 class mjpeg_buffer_keeper
 {
 public:
-    mjpeg_buffer_keeper()
-    {
-        reset();
-    }
-
     mjpeg_buffer& operator[](int i)
     {
         return m_buffer_list[i];
@@ -253,129 +251,16 @@ public:
         }
     }
 
-    unsigned* get_data()
-    {
-        //if there is only one buffer (single thread) there is no need to stack buffers
-        if(m_buffer_list.size() == 1)
-        {
-            m_buffer_list[0].finish();
-
-            m_data_len = m_buffer_list[0].get_len();
-            m_last_bit_len = m_buffer_list[0].get_bits_free() ? 32 - m_buffer_list[0].get_bits_free() : 0;
-
-            return m_buffer_list[0].get_data();
-        }
-
-        allocate_output_buffer();
-
-        int bits = 0;
-        unsigned currval = 0;
-        m_data_len = 0;
-
-        for(unsigned j = 0; j < m_buffer_list.size(); ++j)
-        {
-            mjpeg_buffer& buffer = m_buffer_list[j];
-
-            //if no bit shift required we could use memcpy
-            if(bits == 0)
-            {
-                size_t current_pos = m_data_len;
-
-                if(buffer.get_bits_free() == 0)
-                {
-                    memcpy(&m_output_buffer[current_pos], buffer.get_data(), sizeof(buffer.get_data()[0])*buffer.get_len());
-                    m_data_len += buffer.get_len();
-                    currval = 0;
-                }
-                else
-                {
-                    memcpy(&m_output_buffer[current_pos], buffer.get_data(), sizeof(buffer.get_data()[0])*(buffer.get_len() - 1 ));
-                    m_data_len += buffer.get_len() - 1;
-                    currval = buffer.get_data()[buffer.get_len() - 1];
-                }
-            }
-            else
-            {
-                for(unsigned i = 0; i < buffer.get_len() - 1; ++i)
-                {
-                    currval |= ( (unsigned)buffer.get_data()[i] >> (31 & (-bits)) );
-
-                    m_output_buffer[m_data_len++] = currval;
-
-                    currval = buffer.get_data()[i] << (bits + 32);
-                }
-
-                currval |= ( (unsigned)buffer.get_data()[buffer.get_len() - 1] >> (31 & (-bits)) );
-
-                if( buffer.get_bits_free() <= -bits)
-                {
-                    m_output_buffer[m_data_len++] = currval;
-
-                    currval = buffer.get_data()[buffer.get_len() - 1] << (bits + 32);
-                }
-            }
-
-            bits += buffer.get_bits_free();
-
-            if(bits > 0)
-            {
-                bits -= 32;
-            }
-        }
-
-        //bits == 0 means that last element shouldn't be used.
-        m_output_buffer[m_data_len++] = currval;
-
-        m_last_bit_len = -bits;
-
-        return &m_output_buffer[0];
-    }
-
-    int get_last_bit_len()
-    {
-        return m_last_bit_len;
-    }
-
-    int get_data_size()
-    {
-        return m_data_len;
-    }
-
     void reset()
     {
-        m_last_bit_len = 0;
         for(unsigned i = 0; i < m_buffer_list.size(); ++i)
         {
             m_buffer_list[i].reset();
         }
-
-        //there is no need to erase output buffer since it would be overwritten
-        m_data_len = 0;
     }
 
 private:
-
-    void allocate_output_buffer()
-    {
-        unsigned total_size = 0;
-
-        for(unsigned i = 0; i < m_buffer_list.size(); ++i)
-        {
-            m_buffer_list[i].finish();
-            total_size += m_buffer_list[i].get_len();
-        }
-
-        if(total_size > m_output_buffer.size())
-        {
-            m_output_buffer.clear();
-            m_output_buffer.resize(total_size);
-        }
-    }
-
     std::deque<mjpeg_buffer> m_buffer_list;
-    std::vector<unsigned> m_output_buffer;
-    int m_data_len;
-    int m_last_bit_len;
 };
 
 class MotionJpegWriter : public IVideoWriter
@@ -386,6 +271,7 @@ public:
         rawstream = false;
         nstripes = -1;
         quality = 0;
+        subsampling = VIDEOWRITER_CHROMA_420;
     }
 
     MotionJpegWriter(const String& filename, double fps, Size size, bool iscolor)
@@ -393,6 +279,7 @@ public:
         rawstream = false;
         open(filename, fps, size, iscolor);
         nstripes = -1;
+        subsampling = VIDEOWRITER_CHROMA_420;
     }
     ~MotionJpegWriter() { close(); }
 
@@ -403,6 +290,7 @@ public:
 
         if( !container.isEmptyFrameOffset() && !rawstream )
         {
+            container.writeOdmlIndex(0, dc);
             container.endWriteChunk(); // end LIST 'movi'
             container.writeIndex(0, dc);
             container.finishWriteAVI();
@@ -442,7 +330,10 @@ public:
     void write(InputArray _img) CV_OVERRIDE
     {
         Mat img = _img.getMat();
-        size_t chunkPointer = container.getStreamPos();
+        // the long recordings continue in OpenDML RIFF 'AVIX' lists
+        if( !rawstream && container.isRiffFull() )
+            container.startNextRiff(0, dc);
+        uint64_t chunkPointer = container.getStreamPos();
         int input_channels = img.channels();
         int colorspace = -1;
         int imgWidth = img.cols;
@@ -484,10 +375,10 @@ public:
 
         if( !rawstream )
         {
-            size_t tempChunkPointer = container.getStreamPos();
-            size_t moviPointer = container.getMoviPointer();
-            container.pushFrameOffset(chunkPointer - moviPointer);
-            container.pushFrameSize(tempChunkPointer - chunkPointer - 8);       // Size excludes '00dc' and size field
+            uint64_t tempChunkPointer = container.getStreamPos();
+            uint64_t moviPointer = container.getMoviPointer();
+            container.pushFrameOffset((size_t)(chunkPointer - moviPointer));
+            container.pushFrameSize((size_t)(tempChunkPointer - chunkPointer - 8));       // Size excludes '00dc' and size field
             container.endWriteChunk(); // end '00dc'
         }
     }
@@ -503,6 +394,8 @@ public:
         }
         if( propId == VIDEOWRITER_PROP_NSTRIPES )
             return nstripes;
+        if( propId == VIDEOWRITER_PROP_CHROMA_SUBSAMPLING )
+            return subsampling;
         return 0.;
     }
 
@@ -520,6 +413,15 @@ public:
             return true;
         }
 
+        if( propId == VIDEOWRITER_PROP_CHROMA_SUBSAMPLING )
+        {
+            int mode = cvRound(value);
+            if( mode != VIDEOWRITER_CHROMA_420 && mode != VIDEOWRITER_CHROMA_422 && mode != VIDEOWRITER_CHROMA_444 )
+                return false;
+            subsampling = mode;
+            return true;
+        }
+
         return false;
     }
 
@@ -530,6 +432,7 @@ protected:
     bool rawstream;
     mjpeg_buffer_keeper buffers_list;
     double nstripes;
+    int subsampling;
 
     AVIWriteContainer container;
 };
@@ -891,6 +794,100 @@ vst1q_s16((addr), reg);
     STORE_DESCALED(dst + 3*8, x3,postscale + 3*8);
 }
 
+#elif CV_SIMD128
+// transposes the 8x8 matrix stored as a[half of the columns][row]
+static inline void v_transpose8x8( const v_int32x4 (&a)[2][8], v_int32x4 (&b)[2][8] )
+{
+    for( int h = 0; h < 2; h++ )
+        for( int v = 0; v < 2; v++ )
+            v_transpose4x4( a[h][v*4], a[h][v*4+1], a[h][v*4+2], a[h][v*4+3],
+                            b[v][h*4], b[v][h*4+1], b[v][h*4+2], b[v][h*4+3] );
+}
+
+static inline v_int32x4 v_dct_descale( const v_int32x4& x )
+{
+    return v_shr<fixb>(x + v_setall_s32(1 << (fixb - 1)));
+}
+
+// one pass of the scalar FDCT below, on 4 rows or columns at once
+static inline void v_fdct8( const v_int32x4 (&s)[8], v_int32x4 (&d)[8] )
+{
+    const v_int32x4 c0_707 = v_setall_s32(C0_707), c0_541 = v_setall_s32(C0_541),
+                    c0_382 = v_setall_s32(C0_382), c1_306 = v_setall_s32(C1_306);
+
+    v_int32x4 x0 = s[0], x1 = s[7];
+    v_int32x4 x2 = s[3], x3 = s[4];
+
+    v_int32x4 x4 = x0 + x1; x0 -= x1;
+    x1 = x2 + x3; x2 -= x3;
+
+    v_int32x4 w7 = x0, w1 = x2;
+    x2 = x4 + x1; x4 -= x1;
+
+    x0 = s[1]; x3 = s[6];
+    x1 = x0 + x3; x0 -= x3;
+    v_int32x4 w5 = x0;
+
+    x0 = s[2]; x3 = s[5];
+    v_int32x4 w3 = x0 - x3; x0 += x3;
+
+    x3 = x0 + x1; x0 -= x1;
+    x1 = x2 + x3; x2 -= x3;
+
+    d[0] = x1; d[4] = x2;
+
+    x0 = v_dct_descale((x0 - x4)*c0_707);
+    x1 = x4 + x0; x4 -= x0;
+    d[2] = x4; d[6] = x1;
+
+    x0 = w1; x1 = w3;
+    x2 = w5; x3 = w7;
+
+    x0 += x1; x1 += x2; x2 += x3;
+    x1 = v_dct_descale(x1*c0_707);
+
+    x4 = x1 + x3; x3 -= x1;
+    x1 = (x0 - x2)*c0_382;
+    x0 = v_dct_descale(x0*c0_541 + x1);
+    x2 = v_dct_descale(x2*c1_306 + x1);
+
+    x1 = x0 + x3; x3 -= x0;
+    x0 = x4 + x2; x4 -= x2;
+
+    d[5] = x1; d[1] = x0;
+    d[7] = x4; d[3] = x3;
+}
+
+// FDCT with postscaling (quantization), gives exactly the same result as the scalar code
+static void aan_fdct8x8( const short *src, short *dst,
+                        int step, const short *postscale )
+{
+    v_int32x4 a[2][8], b[2][8];
+    int i, h;
+
+    for( i = 0; i < 8; i++, src += step )
+        v_expand(v_load(src), a[0][i], a[1][i]);
+
+    // pass 1: process rows
+    v_transpose8x8(a, b);
+    for( h = 0; h < 2; h++ )
+        v_fdct8(b[h], a[h]);
+
+    // pass 2: process columns
+    v_transpose8x8(a, b);
+    for( h = 0; h < 2; h++ )
+        v_fdct8(b[h], a[h]);
+
+    v_transpose8x8(a, b);
+    const v_int32x4 delta = v_setall_s32(1 << (postshift - 1));
+    for( i = 0; i < 8; i++, postscale += 8, dst += 8 )
+    {
+        v_int32x4 lo = v_shr<postshift>(b[0][i]*v_load_expand(postscale) + delta);
+        v_int32x4 hi = v_shr<postshift>(b[1][i]*v_load_expand(postscale + 4) + delta);
+        v_store(dst, v_pack(lo, hi));
+    }
+}
+
 #else
 // FDCT with postscaling
 static void aan_fdct8x8( const short *src, short *dst,
@@ -1000,16 +997,15 @@ static void aan_fdct8x8( const short *src, short *dst,
 #endif
 
 
-inline void convertToYUV(int colorspace, int channels, int input_channels, short* UV_data, short* Y_data, const uchar* pix_data, int y_limit, int x_limit, int step, int u_plane_ofs, int v_plane_ofs)
+inline void convertToYUV(int colorspace, int channels, int input_channels, int x_scale, int y_scale, short* UV_data, short* Y_data, const uchar* pix_data, int y_limit, int x_limit, int step, int u_plane_ofs, int v_plane_ofs)
 {
     int i, j;
     const int UV_step = 16;
-    int  x_scale = channels > 1 ? 2 : 1, y_scale = x_scale;
     int  Y_step = x_scale*8;
 
     if( channels > 1 )
     {
-        if( colorspace == COLORSPACE_YUV444P && y_limit == 16 && x_limit == 16 )
+        if( colorspace == COLORSPACE_YUV444P && x_scale == 2 && y_scale == 2 && y_limit == 16 && x_limit == 16 )
         {
             for( i = 0; i < y_limit; i += 2, pix_data += step*2, Y_data += Y_step*2, UV_data += UV_step )
             {
@@ -1138,6 +1134,8 @@ public:
         int _input_channels,
         int _channels,
         int _colorspace,
+        int _x_scale,
+        int _y_scale,
         unsigned (&_huff_dc_tab)[2][16],
         unsigned (&_huff_ac_tab)[2][256],
         short (&_fdct_qtab)[2][64],
@@ -1153,6 +1151,8 @@ public:
         input_channels(_input_channels),
         channels(_channels),
         colorspace(_colorspace),
+        x_scale(_x_scale),
+        y_scale(_y_scale),
         huff_dc_tab(_huff_dc_tab),
         huff_ac_tab(_huff_ac_tab),
         fdct_qtab(_fdct_qtab),
@@ -1167,20 +1167,23 @@ public:
         {
             if(height*width > min_pixels_count)
             {
-                stripes_count = default_stripes_count;
+                stripes_count = std::max(default_stripes_count, getNumThreads());
             }
         }
         else
         {
-            stripes_count = cvCeil(nstripes);
+            stripes_count = std::max(cvCeil(nstripes), 1);
         }
 
-        int y_scale = channels > 1 ? 2 : 1;
-        int y_step = y_scale * 8;
-
-        int max_stripes = (height - 1)/y_step + 1;
+        // the stripes are restart intervals of the same number of MCU rows,
+        // the interval length in MCUs is a 16-bit value
+        int num_steps = (height - 1)/(y_scale*8) + 1;
+        int mcu_per_row = (width - 1)/(x_scale*8) + 1;
 
-        stripes_count = std::min(stripes_count, max_stripes);
+        rows_per_stripe = (num_steps + stripes_count - 1)/stripes_count;
+        rows_per_stripe = std::max(std::min(rows_per_stripe, 65535/mcu_per_row), 1);
+        stripes_count = (num_steps + rows_per_stripe - 1)/rows_per_stripe;
+        restart_interval = stripes_count > 1 ? rows_per_stripe*mcu_per_row : 0;
 
         m_buffer_list.allocate_buffers(stripes_count, (height*width*2)/stripes_count);
     }
@@ -1200,8 +1203,6 @@ public:
         int i, j;
 
         short  buffer[4096];
-        int  x_scale = channels > 1 ? 2 : 1, y_scale = x_scale;
-        int  dc_pred[] = { 0, 0, 0 };
         int  x_step = x_scale * 8;
         int  y_step = y_scale * 8;
         short  block[6][64];
@@ -1210,60 +1211,19 @@ public:
         int u_plane_ofs = step*height;
         int v_plane_ofs = u_plane_ofs + step*height;
         const uchar* data = in_data;
-        const uchar* init_data = data;
-
-        int num_steps = (height - 1)/y_step + 1;
-
-        //if this is not first stripe we need to calculate dc_pred from previous step
-        if(range.start > 0)
-        {
-            y = y_step*int(num_steps*range.start/stripes_count - 1);
-            data = init_data + y*step;
-
-            for( x = 0; x < width; x += x_step )
-            {
-                int x_limit = x_step;
-                int y_limit = y_step;
-                const uchar* pix_data = data + x*input_channels;
-                short* Y_data = block[0];
-                short* UV_data = block[luma_count];
-
-                if( x + x_limit > width ) x_limit = width - x;
-                if( y + y_limit > height ) y_limit = height - y;
-
-                memset( block, 0, block_count*64*sizeof(block[0][0]));
-
-                convertToYUV(colorspace, channels, input_channels, UV_data, Y_data, pix_data, y_limit, x_limit, step, u_plane_ofs, v_plane_ofs);
-
-                for( i = 0; i < block_count; i++ )
-                {
-                    int is_chroma = i >= luma_count;
-                    int src_step = x_scale * 8;
-                    const short* src_ptr = block[i & -2] + (i & 1)*8;
-
-                    aan_fdct8x8( src_ptr, buffer, src_step, fdct_qtab[is_chroma] );
-
-                    j = is_chroma + (i > luma_count);
-                    dc_pred[j] = buffer[0];
-                }
-            }
-        }
 
         for(int k = range.start; k < range.end; ++k)
         {
             mjpeg_buffer& output_buffer = m_buffer_list[k];
             output_buffer.clear();
 
-            int y_min = y_step*int(num_steps*k/stripes_count);
-            int y_max = y_step*int(num_steps*(k+1)/stripes_count);
-
-            if(k == stripes_count - 1)
-            {
-                y_max = height;
-            }
+            // the DC prediction starts over in every restart interval
+            int  dc_pred[] = { 0, 0, 0 };
 
+            int y_min = y_step*rows_per_stripe*k;
+            int y_max = std::min(y_min + y_step*rows_per_stripe, height);
 
-            data = init_data + y_min*step;
+            data = in_data + y_min*step;
 
             for( y = y_min; y < y_max; y += y_step, data += y_step*step )
             {
@@ -1280,14 +1240,16 @@ public:
 
                     memset( block, 0, block_count*64*sizeof(block[0][0]));
 
-                    convertToYUV(colorspace, channels, input_channels, UV_data, Y_data, pix_data, y_limit, x_limit, step, u_plane_ofs, v_plane_ofs);
+                    convertToYUV(colorspace, channels, input_channels, x_scale, y_scale, UV_data, Y_data, pix_data, y_limit, x_limit, step, u_plane_ofs, v_plane_ofs);
 
                     for( i = 0; i < block_count; i++ )
                     {
                         int is_chroma = i >= luma_count;
-                        int src_step = x_scale * 8;
                         int run = 0, val;
-                        const short* src_ptr = block[i & -2] + (i & 1)*8;
+                        // the luma blocks are parts of the x_step-wide MCU, Cb and Cr lie side by side
+                        int src_step = is_chroma ? 16 : x_step;
+                        const short* src_ptr = is_chroma ? UV_data + (i - luma_count)*8 :
+                            Y_data + (i / x_scale)*8*x_step + (i % x_scale)*8;
                         const unsigned* htable = huff_ac_tab[is_chroma];
 
                         aan_fdct8x8( src_ptr, buffer, src_step, fdct_qtab[is_chroma] );
@@ -1351,6 +1313,12 @@ public:
         return stripes_count;
     }
 
+    //! the length of the restart intervals in MCUs, 0 if the frame is a single stripe
+    int getRestartInterval()
+    {
+        return restart_interval;
+    }
+
     mjpeg_buffer_keeper& m_buffer_list;
 private:
 
@@ -1363,11 +1331,15 @@ private:
     const int input_channels;
     const int channels;
     const int colorspace;
+    const int x_scale;
+    const int y_scale;
     const unsigned (&huff_dc_tab)[2][16];
     const unsigned (&huff_ac_tab)[2][256];
     const short (&fdct_qtab)[2][64];
     const uchar* cat_table;
     int stripes_count;
+    int rows_per_stripe;
+    int restart_interval;
     static const int default_stripes_count;
 };
 
@@ -1409,7 +1381,8 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
     unsigned huff_dc_tab[2][16];
     unsigned huff_ac_tab[2][256];
 
-    int  x_scale = channels > 1 ? 2 : 1, y_scale = x_scale;
+    int  x_scale = channels > 1 && subsampling != VIDEOWRITER_CHROMA_444 ? 2 : 1;
+    int  y_scale = channels > 1 && subsampling == VIDEOWRITER_CHROMA_420 ? 2 : 1;
     short  buffer[4096];
     int*   hbuffer = (int*)buffer;
     int  luma_count = x_scale*y_scale;
@@ -1485,6 +1458,20 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
         container.putStreamByte( i > 0 ); // quantization table idx
     }
 
+    buffers_list.reset();
+
+    MjpegEncoder parallel_encoder(height, width, step, data, input_channels, channels, colorspace, x_scale, y_scale,
+                                  huff_dc_tab, huff_ac_tab, fdct_qtab, cat_table, buffers_list, nstripes);
+
+    // the stripes are encoded independently, as restart intervals
+    int restart_interval = parallel_encoder.getRestartInterval();
+    if( restart_interval > 0 )
+    {
+        container.jputStreamShort( 0xFFDD );      // DRI marker
+        container.jputStreamShort( 4 );           // length of restart interval definition
+        container.jputStreamShort( restart_interval );
+    }
+
     // put scan header
     container.jputStreamShort( 0xFFDA );          // SOS marker
     container.jputStreamShort( 6 + 2*channels );  // length of scan header
@@ -1502,28 +1489,37 @@ void MotionJpegWriter::writeFrameData( const uchar* data, int step, int colorspa
     container.putStreamByte( 0 );  // successive approximation bit position
     // high & low - (0,0) for sequential DCT
 
-    buffers_list.reset();
-
-    MjpegEncoder parallel_encoder(height, width, step, data, input_channels, channels, colorspace, huff_dc_tab, huff_ac_tab, fdct_qtab, cat_table, buffers_list, nstripes);
-
     cv::parallel_for_(parallel_encoder.getRange(), parallel_encoder, parallel_encoder.getNStripes());
 
-    //std::vector<unsigned>& v = parallel_encoder.m_buffer_list.get_data();
-    unsigned* v = buffers_list.get_data();
-    unsigned last_data_elem = buffers_list.get_data_size() - 1;
-
-    for(unsigned k = 0; k < last_data_elem; ++k)
+    const int stripes = parallel_encoder.getRange().end;
+    for(int k = 0; k < stripes; ++k)
     {
-        container.jputStream(v[k]);
+        if(k > 0)
+        {
+            container.jputStreamShort( 0xFFD0 + ((k - 1) & 7) ); // RSTn marker
+        }
+
+        mjpeg_buffer& stripe = buffers_list[k];
+        stripe.finish();
+        const unsigned* v = stripe.get_data();
+        unsigned len = stripe.get_len();
+        if(len == 0)
+            continue;
+
+        for(unsigned n = 0; n < len - 1; ++n)
+        {
+            container.jputStream(v[n]);
+        }
+        // the interval ends at a byte boundary, the rest is padded with 1 bits
+        container.jflushStream(v[len - 1], stripe.get_bits_free());
     }
-    container.jflushStream(v[last_data_elem], 32 - buffers_list.get_last_bit_len());
     container.jputStreamShort( 0xFFD9 ); // EOI marker
     /*printf("total dct = %.1fms, total cvt = %.1fms\n",
      total_dct*1000./cv::getTickFrequency(),
      total_cvt*1000./cv::getTickFrequency());*/
 
-    size_t pos = container.getStreamPos();
-    size_t pos1 = (pos + 3) & ~3;
+    uint64_t pos = container.getStreamPos();
+    uint64_t pos1 = (pos + 3) & ~(uint64_t)3;
     for( ; pos < pos1; pos++ )
         container.putStreamByte(0);
 }
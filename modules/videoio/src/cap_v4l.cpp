@@ -219,6 +219,7 @@ make & enjoy!
 #include <errno.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
+#include <poll.h>
 #include <sys/mman.h>
 
 #include <string.h>
@@ -247,7 +248,7 @@ make & enjoy!
 
 
 // default and maximum number of V4L buffers, not including last, 'special' buffer
-#define MAX_V4L_BUFFERS 10
+#define MAX_V4L_BUFFERS 32 // VIDEO_MAX_FRAME
 #define DEFAULT_V4L_BUFFERS 4
 
 // if enabled, then bad JPEG warnings become errors and cause NULL returned instead of image
@@ -263,8 +264,40 @@ struct buffer
 {
   void *  start;
   size_t  length;
+  Mat     memory;   // owns the mapping or the user pointer memory, shared with the frames handed out
+  bool    queued;   // owned by the driver
+  mutable int dmabuf; // exported on request, -1 if not exported yet
 };
 
+/* Removes the mapping of a V4L2 buffer once the last Mat referring to it is released,
+   so the frames handed out stay valid after the capture is closed */
+class V4L2MmapAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* allocate(int, const int*, int, void*, size_t*, int, UMatUsageFlags) const CV_OVERRIDE { return NULL; }
+    bool allocate(UMatData*, int, UMatUsageFlags) const CV_OVERRIDE { return false; }
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if(!u)
+            return;
+        CV_Assert(u->urefcount == 0 && u->refcount == 0);
+        if (-1 == munmap(u->origdata, u->size))
+            perror ("munmap");
+        delete u;
+    }
+};
+
+static Mat v4l2_wrap_mapping(void* start, size_t length)
+{
+    static V4L2MmapAllocator allocator;
+    Mat m(1, (int)length, CV_8UC1, start);
+    m.u = new UMatData(&allocator);
+    m.u->data = m.u->origdata = (uchar*)start;
+    m.u->size = length;
+    m.u->refcount = 1;
+    return m;
+}
+
 static unsigned int n_buffers = 0;
 
 struct CvCaptureCAM_V4L CV_FINAL : public CvCapture
@@ -284,6 +317,8 @@ struct CvCaptureCAM_V4L CV_FINAL : public CvCapture
    bool convert_rgb;
    bool frame_allocated;
    bool returnFrame;
+   v4l2_memory memoryType;
+   __u32 bytesused;
 
    /* V4L2 variables */
    buffer buffers[MAX_V4L_BUFFERS + 1];
@@ -308,6 +343,7 @@ struct CvCaptureCAM_V4L CV_FINAL : public CvCapture
    virtual bool setProperty(int, double) CV_OVERRIDE;
    virtual bool grabFrame() CV_OVERRIDE;
    virtual IplImage* retrieveFrame(int) CV_OVERRIDE;
+   virtual bool retrieveFrameTo(int, OutputArray) CV_OVERRIDE;
 
    Range getRange(int property_id) const {
        switch (property_id) {
@@ -475,6 +511,10 @@ static int autosetup_capture_mode_v4l2(CvCaptureCAM_V4L* capture) {
             V4L2_PIX_FMT_MJPEG,
             V4L2_PIX_FMT_JPEG,
 #endif
+            V4L2_PIX_FMT_NV12,
+            V4L2_PIX_FMT_NV21,
+            V4L2_PIX_FMT_YUV420,
+            V4L2_PIX_FMT_GREY,
             V4L2_PIX_FMT_Y16
     };
 
@@ -565,9 +605,15 @@ static int v4l2_set_fps(CvCaptureCAM_V4L* capture) {
 static int v4l2_num_channels(__u32 palette) {
     switch(palette) {
     case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
     case V4L2_PIX_FMT_MJPEG:
     case V4L2_PIX_FMT_JPEG:
     case V4L2_PIX_FMT_Y16:
+    case V4L2_PIX_FMT_GREY:
+    case V4L2_PIX_FMT_SBGGR8:
+    case V4L2_PIX_FMT_SGBRG8:
         return 1;
     case V4L2_PIX_FMT_YUYV:
     case V4L2_PIX_FMT_UYVY:
@@ -594,6 +640,9 @@ static void v4l2_create_frame(CvCaptureCAM_V4L *capture) {
             size = CvSize(capture->buffers[capture->bufferIndex].length, 1);
             break;
         case V4L2_PIX_FMT_YVU420:
+        case V4L2_PIX_FMT_YUV420:
+        case V4L2_PIX_FMT_NV12:
+        case V4L2_PIX_FMT_NV21:
             size.height = size.height * 3 / 2; // "1.5" channels
             break;
         case V4L2_PIX_FMT_Y16:
@@ -694,10 +743,16 @@ static int _capture_V4L2 (CvCaptureCAM_V4L *capture)
 
    capture->req.count = buffer_number;
    capture->req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-   capture->req.memory = V4L2_MEMORY_MMAP;
+   capture->req.memory = capture->memoryType;
 
    if (-1 == ioctl (capture->deviceHandle, VIDIOC_REQBUFS, &capture->req))
    {
+       if (EINVAL == errno && capture->memoryType == V4L2_MEMORY_USERPTR)
+       {
+         fprintf (stderr, "%s does not support user pointers, using memory mapping\n", deviceName);
+         capture->memoryType = V4L2_MEMORY_MMAP;
+         goto try_again;
+       }
        if (EINVAL == errno)
        {
          fprintf (stderr, "%s does not support memory mapping\n", deviceName);
@@ -728,6 +783,22 @@ static int _capture_V4L2 (CvCaptureCAM_V4L *capture)
 
    for (n_buffers = 0; n_buffers < capture->req.count; ++n_buffers)
    {
+       capture->buffers[n_buffers].queued = false;
+       capture->buffers[n_buffers].dmabuf = -1;
+
+       if (capture->memoryType == V4L2_MEMORY_USERPTR)
+       {
+           // the driver writes right into the Mats, the frames handed out share them
+           capture->buffers[n_buffers].memory.create(1, (int)capture->form.fmt.pix.sizeimage, CV_8UC1);
+           capture->buffers[n_buffers].start = capture->buffers[n_buffers].memory.data;
+           capture->buffers[n_buffers].length = capture->form.fmt.pix.sizeimage;
+           if (n_buffers == 0) {
+               capture->buffers[MAX_V4L_BUFFERS].start = malloc( capture->form.fmt.pix.sizeimage );
+               capture->buffers[MAX_V4L_BUFFERS].length = capture->form.fmt.pix.sizeimage;
+           }
+           continue;
+       }
+
        v4l2_buffer buf = v4l2_buffer();
        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
        buf.memory = V4L2_MEMORY_MMAP;
@@ -751,11 +822,13 @@ static int _capture_V4L2 (CvCaptureCAM_V4L *capture)
 
        if (MAP_FAILED == capture->buffers[n_buffers].start) {
            perror ("mmap");
+           capture->buffers[n_buffers].start = 0;
 
            /* free capture, and returns an error code */
            icvCloseCAM_V4L (capture);
            return -1;
        }
+       capture->buffers[n_buffers].memory = v4l2_wrap_mapping(capture->buffers[n_buffers].start, buf.length);
 
        if (n_buffers == 0) {
      capture->buffers[MAX_V4L_BUFFERS].start = malloc( buf.length );
@@ -763,6 +836,7 @@ static int _capture_V4L2 (CvCaptureCAM_V4L *capture)
        }
    }
 
+   capture->bufferIndex = 0;
    v4l2_create_frame(capture);
 
    // reinitialize buffers
@@ -826,15 +900,44 @@ bool CvCaptureCAM_V4L::open(const char* _deviceName)
     convert_rgb = true;
     deviceName = _deviceName;
     returnFrame = true;
+    memoryType = V4L2_MEMORY_MMAP;
 
     return _capture_V4L2(this) == 1;
 }
 
+/* Gives the buffers back to the driver, except the ones still referred to by the frames handed out */
+static bool v4l2_queue_buffers(CvCaptureCAM_V4L* capture) {
+    bool any_queued = false;
+    for (unsigned int i = 0; i < capture->req.count; ++i)
+    {
+        buffer& b = capture->buffers[i];
+        if (!b.queued && (b.memory.empty() || b.memory.u->refcount == 1))
+        {
+            v4l2_buffer buf = v4l2_buffer();
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = capture->memoryType;
+            buf.index = i;
+            if (capture->memoryType == V4L2_MEMORY_USERPTR) {
+                buf.m.userptr = (unsigned long)b.start;
+                buf.length = (__u32)b.length;
+            }
+
+            if (-1 == ioctl (capture->deviceHandle, VIDIOC_QBUF, &buf)) {
+                perror ("VIDIOC_QBUF");
+                continue;
+            }
+            b.queued = true;
+        }
+        any_queued |= b.queued;
+    }
+    return any_queued;
+}
+
 static int read_frame_v4l2(CvCaptureCAM_V4L* capture) {
     v4l2_buffer buf = v4l2_buffer();
 
     buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
+    buf.memory = capture->memoryType;
 
     if (-1 == ioctl (capture->deviceHandle, VIDIOC_DQBUF, &buf)) {
         switch (errno) {
@@ -861,19 +964,16 @@ static int read_frame_v4l2(CvCaptureCAM_V4L* capture) {
 
    assert(buf.index < capture->req.count);
 
-   memcpy(capture->buffers[MAX_V4L_BUFFERS].start,
-      capture->buffers[buf.index].start,
-      capture->buffers[MAX_V4L_BUFFERS].length );
-   capture->bufferIndex = MAX_V4L_BUFFERS;
+   // the frame is read right from the buffer, it is given back to the driver on the next grab
+   capture->buffers[buf.index].queued = false;
+   capture->bufferIndex = buf.index;
+   capture->bytesused = buf.bytesused;
    //printf("got data in buff %d, len=%d, flags=0x%X, seq=%d, used=%d)\n",
    //	  buf.index, buf.length, buf.flags, buf.sequence, buf.bytesused);
 
    //set timestamp in capture struct to be timestamp of most recent frame
    capture->timestamp = buf.timestamp;
 
-   if (-1 == ioctl (capture->deviceHandle, VIDIOC_QBUF, &buf))
-       perror ("VIDIOC_QBUF");
-
    return 1;
 }
 
@@ -884,28 +984,32 @@ static int mainloop_v4l2(CvCaptureCAM_V4L* capture) {
 
     while (count-- > 0) {
         for (;;) {
-            fd_set fds;
-            struct timeval tv;
+            if (!v4l2_queue_buffers(capture)) {
+                fprintf (stderr, "VIDEOIO ERROR: V4L2: all the buffers are held by the frames handed out, "
+                         "release them or increase CAP_PROP_BUFFERSIZE\n");
+                return -1;
+            }
+
+            // poll() instead of select(), the descriptor may be above FD_SETSIZE
+            pollfd fds;
             int r;
 
-            FD_ZERO (&fds);
-            FD_SET (capture->deviceHandle, &fds);
+            fds.fd = capture->deviceHandle;
+            fds.events = POLLIN;
+            fds.revents = 0;
 
             /* Timeout. */
-            tv.tv_sec = 10;
-            tv.tv_usec = 0;
-
-            r = select (capture->deviceHandle+1, &fds, NULL, NULL, &tv);
+            r = poll (&fds, 1, 10000);
 
             if (-1 == r) {
                 if (EINTR == errno)
                     continue;
 
-                perror ("select");
+                perror ("poll");
             }
 
             if (0 == r) {
-                fprintf (stderr, "select timeout\n");
+                fprintf (stderr, "poll timeout\n");
 
                 /* end the infinite loop */
                 break;
@@ -921,41 +1025,32 @@ static int mainloop_v4l2(CvCaptureCAM_V4L* capture) {
     return 0;
 }
 
-static bool icvGrabFrameCAM_V4L(CvCaptureCAM_V4L* capture) {
-   if (capture->FirstCapture) {
-      /* Some general initialization must take place the first time through */
-
-      /* This is just a technicality, but all buffers must be filled up before any
-         staggered SYNC is applied.  SO, filler up. (see V4L HowTo) */
-
-      {
-
-        for (capture->bufferIndex = 0;
-             capture->bufferIndex < ((int)capture->req.count);
-             ++capture->bufferIndex)
-        {
-
-          v4l2_buffer buf = v4l2_buffer();
+/* Queues all the buffers and starts the streaming, done the first time through */
+static bool v4l2_stream_on(CvCaptureCAM_V4L* capture) {
+    /* This is just a technicality, but all buffers must be filled up before any
+       staggered SYNC is applied.  SO, filler up. (see V4L HowTo) */
+    if (!v4l2_queue_buffers(capture))
+        return false;
 
-          buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-          buf.memory      = V4L2_MEMORY_MMAP;
-          buf.index       = (unsigned long)capture->bufferIndex;
+    /* enable the streaming */
+    capture->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (-1 == ioctl (capture->deviceHandle, VIDIOC_STREAMON,
+                      &capture->type)) {
+        /* error enabling the stream */
+        perror ("VIDIOC_STREAMON");
+        return false;
+    }
 
-          if (-1 == ioctl (capture->deviceHandle, VIDIOC_QBUF, &buf)) {
-              perror ("VIDIOC_QBUF");
-              return false;
-          }
-        }
+    /* preparation is ok */
+    capture->FirstCapture = 0;
+    return true;
+}
 
-        /* enable the streaming */
-        capture->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        if (-1 == ioctl (capture->deviceHandle, VIDIOC_STREAMON,
-                          &capture->type)) {
-            /* error enabling the stream */
-            perror ("VIDIOC_STREAMON");
-            return false;
-        }
-      }
+static bool icvGrabFrameCAM_V4L(CvCaptureCAM_V4L* capture) {
+   if (capture->FirstCapture) {
+      /* Some general initialization must take place the first time through */
+      if (!v4l2_stream_on(capture))
+          return false;
 
 #if defined(V4L_ABORT_BADJPEG)
         // skip first frame. it is often bad -- this is unnotied in traditional apps,
@@ -963,9 +1058,6 @@ static bool icvGrabFrameCAM_V4L(CvCaptureCAM_V4L* capture) {
         if(mainloop_v4l2(capture) != 1)
                 return false;
 #endif
-
-      /* preparation is ok */
-      capture->FirstCapture = 0;
    }
 
    if(mainloop_v4l2(capture) != 1) return false;
@@ -1041,14 +1133,6 @@ move_411_block(int yTL, int yTR, int yBL, int yBR, int u, int v,
     rgb[5] = LIMIT(r+yBR);
 }
 
-/* Converts from planar YUV420P to RGB24. */
-static inline void
-yuv420p_to_rgb24(int width, int height, uchar* src, uchar* dst)
-{
-    cvtColor(Mat(height * 3 / 2, width, CV_8U, src), Mat(height, width, CV_8UC3, dst),
-             COLOR_YUV2BGR_YV12);
-}
-
 // Consider a YUV411P image of 8x2 pixels.
 //
 // A plane of Y values as before.
@@ -1095,214 +1179,6 @@ yuv411p_to_rgb24(int width, int height,
     }
 }
 
-/* convert from 4:2:2 YUYV interlaced to RGB24 */
-static void
-yuyv_to_rgb24(int width, int height, unsigned char* src, unsigned char* dst) {
-    cvtColor(Mat(height, width, CV_8UC2, src), Mat(height, width, CV_8UC3, dst),
-             COLOR_YUV2BGR_YUYV);
-}
-
-static inline void
-uyvy_to_rgb24 (int width, int height, unsigned char *src, unsigned char *dst)
-{
-    cvtColor(Mat(height, width, CV_8UC2, src), Mat(height, width, CV_8UC3, dst),
-             COLOR_YUV2BGR_UYVY);
-}
-
-static inline void
-y16_to_rgb24 (int width, int height, unsigned char* src, unsigned char* dst)
-{
-    Mat gray8;
-    Mat(height, width, CV_16UC1, src).convertTo(gray8, CV_8U, 0.00390625);
-    cvtColor(gray8,Mat(height, width, CV_8UC3, dst),COLOR_GRAY2BGR);
-}
-
-#ifdef HAVE_JPEG
-
-/* convert from mjpeg to rgb24 */
-static bool
-mjpeg_to_rgb24(int width, int height, unsigned char* src, int length, IplImage* dst) {
-    Mat temp = cvarrToMat(dst);
-    imdecode(Mat(1, length, CV_8U, src), IMREAD_COLOR, &temp);
-    return temp.data && temp.cols == width && temp.rows == height;
-}
-
-#endif
-
-/*
- * BAYER2RGB24 ROUTINE TAKEN FROM:
- *
- * Sonix SN9C10x based webcam basic I/F routines
- * Takafumi Mizuno <taka-qce@ls-a.jp>
- *
- */
-static void bayer2rgb24(long int WIDTH, long int HEIGHT, unsigned char *src, unsigned char *dst)
-{
-    long int i;
-    unsigned char *rawpt, *scanpt;
-    long int size;
-
-    rawpt = src;
-    scanpt = dst;
-    size = WIDTH*HEIGHT;
-
-    for ( i = 0; i < size; i++ ) {
-  if ( (i/WIDTH) % 2 == 0 ) {
-      if ( (i % 2) == 0 ) {
-    /* B */
-    if ( (i > WIDTH) && ((i % WIDTH) > 0) ) {
-        *scanpt++ = (*(rawpt-WIDTH-1)+*(rawpt-WIDTH+1)+
-         *(rawpt+WIDTH-1)+*(rawpt+WIDTH+1))/4;  /* R */
-        *scanpt++ = (*(rawpt-1)+*(rawpt+1)+
-         *(rawpt+WIDTH)+*(rawpt-WIDTH))/4;      /* G */
-        *scanpt++ = *rawpt;                                     /* B */
-    } else {
-        /* first line or left column */
-        *scanpt++ = *(rawpt+WIDTH+1);           /* R */
-        *scanpt++ = (*(rawpt+1)+*(rawpt+WIDTH))/2;      /* G */
-        *scanpt++ = *rawpt;                             /* B */
-    }
-      } else {
-    /* (B)G */
-    if ( (i > WIDTH) && ((i % WIDTH) < (WIDTH-1)) ) {
-        *scanpt++ = (*(rawpt+WIDTH)+*(rawpt-WIDTH))/2;  /* R */
-        *scanpt++ = *rawpt;                                     /* G */
-        *scanpt++ = (*(rawpt-1)+*(rawpt+1))/2;          /* B */
-    } else {
-        /* first line or right column */
-        *scanpt++ = *(rawpt+WIDTH);     /* R */
-        *scanpt++ = *rawpt;             /* G */
-        *scanpt++ = *(rawpt-1); /* B */
-    }
-      }
-  } else {
-      if ( (i % 2) == 0 ) {
-    /* G(R) */
-    if ( (i < (WIDTH*(HEIGHT-1))) && ((i % WIDTH) > 0) ) {
-        *scanpt++ = (*(rawpt-1)+*(rawpt+1))/2;          /* R */
-        *scanpt++ = *rawpt;                                     /* G */
-        *scanpt++ = (*(rawpt+WIDTH)+*(rawpt-WIDTH))/2;  /* B */
-    } else {
-        /* bottom line or left column */
-        *scanpt++ = *(rawpt+1);         /* R */
-        *scanpt++ = *rawpt;                     /* G */
-        *scanpt++ = *(rawpt-WIDTH);             /* B */
-    }
-      } else {
-    /* R */
-    if ( i < (WIDTH*(HEIGHT-1)) && ((i % WIDTH) < (WIDTH-1)) ) {
-        *scanpt++ = *rawpt;                                     /* R */
-        *scanpt++ = (*(rawpt-1)+*(rawpt+1)+
-         *(rawpt-WIDTH)+*(rawpt+WIDTH))/4;      /* G */
-        *scanpt++ = (*(rawpt-WIDTH-1)+*(rawpt-WIDTH+1)+
-         *(rawpt+WIDTH-1)+*(rawpt+WIDTH+1))/4;  /* B */
-    } else {
-        /* bottom line or right column */
-        *scanpt++ = *rawpt;                             /* R */
-        *scanpt++ = (*(rawpt-1)+*(rawpt-WIDTH))/2;      /* G */
-        *scanpt++ = *(rawpt-WIDTH-1);           /* B */
-    }
-      }
-  }
-  rawpt++;
-    }
-
-}
-
-// SGBRG to RGB24
-// for some reason, red and blue needs to be swapped
-// at least for  046d:092f Logitech, Inc. QuickCam Express Plus to work
-//see: http://www.siliconimaging.com/RGB%20Bayer.htm
-//and 4.6 at http://tldp.org/HOWTO/html_single/libdc1394-HOWTO/
-static void sgbrg2rgb24(long int WIDTH, long int HEIGHT, unsigned char *src, unsigned char *dst)
-{
-    long int i;
-    unsigned char *rawpt, *scanpt;
-    long int size;
-
-    rawpt = src;
-    scanpt = dst;
-    size = WIDTH*HEIGHT;
-
-    for ( i = 0; i < size; i++ )
-    {
-        if ( (i/WIDTH) % 2 == 0 ) //even row
-        {
-            if ( (i % 2) == 0 ) //even pixel
-            {
-                if ( (i > WIDTH) && ((i % WIDTH) > 0) )
-                {
-                    *scanpt++ = (*(rawpt-1)+*(rawpt+1))/2;       /* R */
-                    *scanpt++ = *(rawpt);                        /* G */
-                    *scanpt++ = (*(rawpt-WIDTH) + *(rawpt+WIDTH))/2;      /* B */
-                } else
-                {
-                  /* first line or left column */
-
-                  *scanpt++ = *(rawpt+1);           /* R */
-                  *scanpt++ = *(rawpt);             /* G */
-                  *scanpt++ =  *(rawpt+WIDTH);      /* B */
-                }
-            } else //odd pixel
-            {
-                if ( (i > WIDTH) && ((i % WIDTH) < (WIDTH-1)) )
-                {
-                    *scanpt++ = *(rawpt);       /* R */
-                    *scanpt++ = (*(rawpt-1)+*(rawpt+1)+*(rawpt-WIDTH)+*(rawpt+WIDTH))/4; /* G */
-                    *scanpt++ = (*(rawpt-WIDTH-1) + *(rawpt-WIDTH+1) + *(rawpt+WIDTH-1) + *(rawpt+WIDTH+1))/4;      /* B */
-                } else
-                {
-                    /* first line or right column */
-
-                    *scanpt++ = *(rawpt);       /* R */
-                    *scanpt++ = (*(rawpt-1)+*(rawpt+WIDTH))/2; /* G */
-                    *scanpt++ = *(rawpt+WIDTH-1);      /* B */
-                }
-            }
-        } else
-        { //odd row
-            if ( (i % 2) == 0 ) //even pixel
-            {
-                if ( (i < (WIDTH*(HEIGHT-1))) && ((i % WIDTH) > 0) )
-                {
-                    *scanpt++ =  (*(rawpt-WIDTH-1)+*(rawpt-WIDTH+1)+*(rawpt+WIDTH-1)+*(rawpt+WIDTH+1))/4;          /* R */
-                    *scanpt++ =  (*(rawpt-1)+*(rawpt+1)+*(rawpt-WIDTH)+*(rawpt+WIDTH))/4;      /* G */
-                    *scanpt++ =  *(rawpt); /* B */
-                } else
-                {
-                    /* bottom line or left column */
-
-                    *scanpt++ =  *(rawpt-WIDTH+1);          /* R */
-                    *scanpt++ =  (*(rawpt+1)+*(rawpt-WIDTH))/2;      /* G */
-                    *scanpt++ =  *(rawpt); /* B */
-                }
-            } else
-            { //odd pixel
-                if ( i < (WIDTH*(HEIGHT-1)) && ((i % WIDTH) < (WIDTH-1)) )
-                {
-                    *scanpt++ = (*(rawpt-WIDTH)+*(rawpt+WIDTH))/2;  /* R */
-                    *scanpt++ = *(rawpt);      /* G */
-                    *scanpt++ = (*(rawpt-1)+*(rawpt+1))/2; /* B */
-                } else
-                {
-                    /* bottom line or right column */
-
-                    *scanpt++ = (*(rawpt-WIDTH));  /* R */
-                    *scanpt++ = *(rawpt);      /* G */
-                    *scanpt++ = (*(rawpt-1)); /* B */
-                }
-            }
-        }
-        rawpt++;
-    }
-}
-
-static inline void
-rgb24_to_rgb24 (int width, int height, unsigned char *src, unsigned char *dst)
-{
-    cvtColor(Mat(height, width, CV_8UC3, src), Mat(height, width, CV_8UC3, dst), COLOR_RGB2BGR);
-}
-
 #define CLAMP(x)        ((x)<0?0:((x)>255)?255:(x))
 
 typedef struct {
@@ -1474,6 +1350,87 @@ static int sonix_decompress(int width, int height, unsigned char *inp, unsigned
   return 0;
 }
 
+/* Converts the captured frame to BGR, right from the driver's buffer.
+   The conversions of imgproc are vectorized and run in parallel. */
+static bool v4l2_convert_frame(CvCaptureCAM_V4L* capture, Mat& dst) {
+    const int width = capture->form.fmt.pix.width, height = capture->form.fmt.pix.height;
+    const size_t step = capture->form.fmt.pix.bytesperline; // of the Y plane for the planar formats
+    uchar* src = (uchar*)capture->buffers[capture->bufferIndex].start;
+    CV_Assert(dst.rows == height && dst.cols == width && dst.type() == CV_8UC3);
+
+    switch (capture->palette)
+    {
+    case V4L2_PIX_FMT_BGR24:
+        Mat(height, width, CV_8UC3, src, step).copyTo(dst);
+        return true;
+    case V4L2_PIX_FMT_RGB24:
+        cvtColor(Mat(height, width, CV_8UC3, src, step), dst, COLOR_RGB2BGR);
+        return true;
+    case V4L2_PIX_FMT_YVU420:
+        cvtColor(Mat(height * 3 / 2, width, CV_8U, src, step), dst, COLOR_YUV2BGR_YV12);
+        return true;
+    case V4L2_PIX_FMT_YUV420:
+        cvtColor(Mat(height * 3 / 2, width, CV_8U, src, step), dst, COLOR_YUV2BGR_I420);
+        return true;
+    case V4L2_PIX_FMT_NV12:
+        cvtColor(Mat(height * 3 / 2, width, CV_8U, src, step), dst, COLOR_YUV2BGR_NV12);
+        return true;
+    case V4L2_PIX_FMT_NV21:
+        cvtColor(Mat(height * 3 / 2, width, CV_8U, src, step), dst, COLOR_YUV2BGR_NV21);
+        return true;
+    case V4L2_PIX_FMT_YUYV:
+        cvtColor(Mat(height, width, CV_8UC2, src, step), dst, COLOR_YUV2BGR_YUYV);
+        return true;
+    case V4L2_PIX_FMT_UYVY:
+        cvtColor(Mat(height, width, CV_8UC2, src, step), dst, COLOR_YUV2BGR_UYVY);
+        return true;
+    case V4L2_PIX_FMT_GREY:
+        cvtColor(Mat(height, width, CV_8UC1, src, step), dst, COLOR_GRAY2BGR);
+        return true;
+    case V4L2_PIX_FMT_Y16:
+    {
+        Mat gray8;
+        Mat(height, width, CV_16UC1, src, step).convertTo(gray8, CV_8U, 0.00390625);
+        cvtColor(gray8, dst, COLOR_GRAY2BGR);
+        return true;
+    }
+    // OpenCV names the Bayer patterns by the second row
+    case V4L2_PIX_FMT_SBGGR8:
+        cvtColor(Mat(height, width, CV_8UC1, src, step), dst, COLOR_BayerBG2BGR);
+        return true;
+    case V4L2_PIX_FMT_SGBRG8:
+        cvtColor(Mat(height, width, CV_8UC1, src, step), dst, COLOR_BayerGR2BGR);
+        return true;
+    case V4L2_PIX_FMT_SN9C10X:
+        sonix_decompress_init();
+        sonix_decompress(width, height, src, (uchar*)capture->buffers[MAX_V4L_BUFFERS].start);
+        cvtColor(Mat(height, width, CV_8UC1, capture->buffers[MAX_V4L_BUFFERS].start), dst, COLOR_BayerBG2BGR);
+        return true;
+    case V4L2_PIX_FMT_YUV411P:
+        if (dst.isContinuous()) {
+            yuv411p_to_rgb24(width, height, src, dst.data);
+        } else {
+            Mat temp(height, width, CV_8UC3);
+            yuv411p_to_rgb24(width, height, src, temp.data);
+            temp.copyTo(dst);
+        }
+        return true;
+#ifdef HAVE_JPEG
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG:
+    {
+        const size_t length = capture->bytesused ? capture->bytesused : capture->buffers[capture->bufferIndex].length;
+        uchar* data = dst.data;
+        imdecode(Mat(1, (int)length, CV_8U, src), IMREAD_COLOR, &dst);
+        // a frame of another size is not written to the output
+        return dst.data == data;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
 static IplImage* icvRetrieveFrameCAM_V4L( CvCaptureCAM_V4L* capture, int) {
     /* Now get what has already been captured as a IplImage return */
     // we need memory iff convert_rgb is true
@@ -1496,102 +1453,65 @@ static IplImage* icvRetrieveFrameCAM_V4L( CvCaptureCAM_V4L* capture, int) {
         return &capture->frame;
     }
 
-    switch (capture->palette)
-    {
-    case V4L2_PIX_FMT_BGR24:
-        memcpy((char *)capture->frame.imageData,
-               (char *)capture->buffers[capture->bufferIndex].start,
-               capture->frame.imageSize);
-        break;
+    Mat frame = cvarrToMat(&capture->frame);
+    if (!v4l2_convert_frame(capture, frame))
+        return 0;
 
-    case V4L2_PIX_FMT_YVU420:
-        yuv420p_to_rgb24(capture->form.fmt.pix.width,
-                 capture->form.fmt.pix.height,
-                 (unsigned char*)(capture->buffers[capture->bufferIndex].start),
-                 (unsigned char*)capture->frame.imageData);
-        break;
+    if (capture->returnFrame)
+        return(&capture->frame);
+    else
+        return 0;
+}
 
-    case V4L2_PIX_FMT_YUV411P:
-        yuv411p_to_rgb24(capture->form.fmt.pix.width,
-                 capture->form.fmt.pix.height,
-                 (unsigned char*)(capture->buffers[capture->bufferIndex].start),
-                 (unsigned char*)capture->frame.imageData);
-        break;
-#ifdef HAVE_JPEG
-    case V4L2_PIX_FMT_MJPEG:
-    case V4L2_PIX_FMT_JPEG:
-        if (!mjpeg_to_rgb24(capture->form.fmt.pix.width,
-                    capture->form.fmt.pix.height,
-                    (unsigned char*)(capture->buffers[capture->bufferIndex]
-                             .start),
-                    capture->buffers[capture->bufferIndex].length,
-                    &capture->frame))
-          return 0;
-        break;
-#endif
+/* Converts the frame right into the output. Without the conversion it hands out the buffer
+   the frame was captured to, the buffer goes back to the driver once the returned Mat and all
+   its copies are released */
+static bool icvRetrieveFrameToCAM_V4L( CvCaptureCAM_V4L* capture, OutputArray image ) {
+    if (capture->FirstCapture || !capture->returnFrame ||
+        image.kind() != _InputArray::MAT || image.fixedSize() || image.fixedType() ||
+        capture->bufferIndex < 0 || capture->bufferIndex >= (int)capture->req.count)
+        return false;
 
-    case V4L2_PIX_FMT_YUYV:
-        yuyv_to_rgb24(capture->form.fmt.pix.width,
-                  capture->form.fmt.pix.height,
-                  (unsigned char*)(capture->buffers[capture->bufferIndex].start),
-                  (unsigned char*)capture->frame.imageData);
-        break;
-    case V4L2_PIX_FMT_UYVY:
-        uyvy_to_rgb24(capture->form.fmt.pix.width,
-                  capture->form.fmt.pix.height,
-                  (unsigned char*)(capture->buffers[capture->bufferIndex].start),
-                  (unsigned char*)capture->frame.imageData);
-        break;
-    case V4L2_PIX_FMT_SBGGR8:
-        bayer2rgb24(capture->form.fmt.pix.width,
-                capture->form.fmt.pix.height,
-                (unsigned char*)capture->buffers[capture->bufferIndex].start,
-                (unsigned char*)capture->frame.imageData);
-        break;
+    if (capture->convert_rgb) {
+        image.create(capture->form.fmt.pix.height, capture->form.fmt.pix.width, CV_8UC3);
+        return v4l2_convert_frame(capture, image.getMatRef());
+    }
 
-    case V4L2_PIX_FMT_SN9C10X:
-        sonix_decompress_init();
-        sonix_decompress(capture->form.fmt.pix.width,
-                 capture->form.fmt.pix.height,
-                 (unsigned char*)capture->buffers[capture->bufferIndex].start,
-                 (unsigned char*)capture->buffers[(capture->bufferIndex+1) % capture->req.count].start);
-
-        bayer2rgb24(capture->form.fmt.pix.width,
-                capture->form.fmt.pix.height,
-                (unsigned char*)capture->buffers[(capture->bufferIndex+1) % capture->req.count].start,
-                (unsigned char*)capture->frame.imageData);
-        break;
+    const buffer& b = capture->buffers[capture->bufferIndex];
+    int channels = v4l2_num_channels(capture->palette);
+    if (b.memory.empty() || channels == 0)
+        return false;
 
-    case V4L2_PIX_FMT_SGBRG8:
-        sgbrg2rgb24(capture->form.fmt.pix.width,
-                capture->form.fmt.pix.height,
-                (unsigned char*)capture->buffers[(capture->bufferIndex+1) % capture->req.count].start,
-                (unsigned char*)capture->frame.imageData);
+    int rows = capture->form.fmt.pix.height, cols = capture->form.fmt.pix.width;
+    int type = CV_8UC(channels);
+    size_t step = capture->form.fmt.pix.bytesperline;
+    switch (capture->palette) {
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG:
+        rows = 1;
+        cols = (int)(capture->bytesused ? capture->bytesused : b.length);
+        step = cols;
         break;
-    case V4L2_PIX_FMT_RGB24:
-        rgb24_to_rgb24(capture->form.fmt.pix.width,
-                capture->form.fmt.pix.height,
-                (unsigned char*)capture->buffers[(capture->bufferIndex+1) % capture->req.count].start,
-                (unsigned char*)capture->frame.imageData);
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_YUV420:
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV21:
+        rows = rows * 3 / 2; // "1.5" channels
         break;
     case V4L2_PIX_FMT_Y16:
-        if(capture->convert_rgb){
-            y16_to_rgb24(capture->form.fmt.pix.width,
-                         capture->form.fmt.pix.height,
-                         (unsigned char*)capture->buffers[capture->bufferIndex].start,
-                         (unsigned char*)capture->frame.imageData);
-        }else{
-            memcpy((char *)capture->frame.imageData,
-                   (char *)capture->buffers[capture->bufferIndex].start,
-                   capture->frame.imageSize);
-        }
+        type = CV_16UC1;
         break;
     }
+    if (step < (size_t)cols * CV_ELEM_SIZE(type))
+        step = (size_t)cols * CV_ELEM_SIZE(type);
+    if (step * rows > b.length)
+        return false;
 
-    if (capture->returnFrame)
-        return(&capture->frame);
-    else
-        return 0;
+    Mat frame(rows, cols, type, b.memory.data, step);
+    frame.u = b.memory.u;
+    CV_XADD(&frame.u->refcount, 1);
+    image.getMatRef() = frame;
+    return true;
 }
 
 static inline __u32 capPropertyToV4L2(int prop) {
@@ -1645,6 +1565,27 @@ static double icvGetPropertyCAM_V4L (const CvCaptureCAM_V4L* capture,
           return capture->convert_rgb;
       case CV_CAP_PROP_BUFFERSIZE:
           return capture->bufferSize;
+      case CAP_PROP_V4L_MEMORY:
+          return capture->memoryType;
+      case CAP_PROP_V4L_DMABUF_FD:
+      {
+          if (capture->FirstCapture || capture->memoryType != V4L2_MEMORY_MMAP ||
+              capture->bufferIndex < 0 || capture->bufferIndex >= (int)capture->req.count)
+              return -1;
+          const buffer& b = capture->buffers[capture->bufferIndex];
+#ifdef VIDIOC_EXPBUF
+          if (b.dmabuf < 0) {
+              v4l2_exportbuffer expbuf = v4l2_exportbuffer();
+              expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+              expbuf.index = capture->bufferIndex;
+              expbuf.flags = O_CLOEXEC | O_RDONLY;
+              if (-1 == ioctl (capture->deviceHandle, VIDIOC_EXPBUF, &expbuf))
+                  return -1;
+              b.dmabuf = expbuf.fd;
+          }
+#endif
+          return b.dmabuf;
+      }
       }
 
       if(property_id == CV_CAP_PROP_FPS) {
@@ -1826,6 +1767,14 @@ static int icvSetPropertyCAM_V4L( CvCaptureCAM_V4L* capture,
             }
         }
         break;
+    case CAP_PROP_V4L_MEMORY:
+        if (value != CAP_V4L_MEMORY_MMAP && value != CAP_V4L_MEMORY_USERPTR) {
+            retval = false;
+        } else {
+            capture->memoryType = (v4l2_memory)(int)value;
+            retval = v4l2_reset(capture) && capture->memoryType == (v4l2_memory)(int)value;
+        }
+        break;
     case CV_CAP_PROP_BUFFERSIZE:
         if ((int)value > MAX_V4L_BUFFERS || (int)value < 1) {
             fprintf(stderr, "V4L: Bad buffer size %d, buffer size must be from 1 to %d\n", (int)value, MAX_V4L_BUFFERS);
@@ -1861,13 +1810,14 @@ static void icvCloseCAM_V4L( CvCaptureCAM_V4L* capture ){
 
        for (unsigned int n_buffers_ = 0; n_buffers_ < MAX_V4L_BUFFERS; ++n_buffers_)
        {
-           if (capture->buffers[n_buffers_].start) {
-               if (-1 == munmap (capture->buffers[n_buffers_].start, capture->buffers[n_buffers_].length)) {
-                   perror ("munmap");
-               } else {
-                   capture->buffers[n_buffers_].start = 0;
-               }
-           }
+           buffer& b = capture->buffers[n_buffers_];
+           if (b.dmabuf >= 0)
+               close(b.dmabuf);
+           b.dmabuf = -1;
+           // the mapping stays until the frames handed out are released
+           b.memory.release();
+           b.start = 0;
+           b.queued = false;
        }
 
        if (capture->buffers[MAX_V4L_BUFFERS].start)
@@ -1897,6 +1847,11 @@ IplImage* CvCaptureCAM_V4L::retrieveFrame(int)
     return icvRetrieveFrameCAM_V4L( this, 0 );
 }
 
+bool CvCaptureCAM_V4L::retrieveFrameTo(int, OutputArray image)
+{
+    return icvRetrieveFrameToCAM_V4L( this, image );
+}
+
 double CvCaptureCAM_V4L::getProperty( int propId ) const
 {
     return icvGetPropertyCAM_V4L( this, propId );
@@ -1907,6 +1862,58 @@ bool CvCaptureCAM_V4L::setProperty( int propId, double value )
     return icvSetPropertyCAM_V4L( this, propId, value );
 }
 
+/* Waits on all the devices at once with a single poll() and grabs from the ones which are ready */
+bool cvWaitAnyCameraCapture_V4L(const std::vector<CvCapture*>& captures, std::vector<int>& ready, int64 timeoutNs)
+{
+    ready.clear();
+    std::vector<CvCaptureCAM_V4L*> cams(captures.size());
+    for (size_t i = 0; i < captures.size(); i++)
+    {
+        cams[i] = dynamic_cast<CvCaptureCAM_V4L*>(captures[i]);
+        if (!cams[i])
+            CV_Error(Error::StsNotImplemented, "VideoCapture::waitAny() supports the V4L2 cameras only");
+    }
+    if (cams.empty())
+        return false;
+
+    // poll() instead of select(), the descriptors may be above FD_SETSIZE
+    std::vector<pollfd> fds(cams.size());
+    for (size_t i = 0; i < cams.size(); i++)
+    {
+        CvCaptureCAM_V4L* capture = cams[i];
+        if (capture->FirstCapture ? !v4l2_stream_on(capture) : !v4l2_queue_buffers(capture))
+            CV_Error(Error::StsError, cv::format("VideoCapture::waitAny(): can't queue the buffers of the stream %d, "
+                                                 "release the frames or increase CAP_PROP_BUFFERSIZE", (int)i));
+        fds[i].fd = capture->deviceHandle;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    const int timeoutMs = timeoutNs > 0 ? (int)std::min((timeoutNs + 999999) / 1000000, (int64)INT_MAX) : -1;
+    int r;
+    do
+    {
+        r = poll (&fds[0], (nfds_t)fds.size(), timeoutMs);
+    } while (-1 == r && EINTR == errno);
+
+    if (-1 == r)
+        CV_Error(Error::StsError, cv::format("VideoCapture::waitAny(): poll() failed, errno=%d", errno));
+
+    for (size_t i = 0; i < cams.size() && r > 0; i++)
+    {
+        if (fds[i].revents & (POLLERR | POLLNVAL))
+            CV_Error(Error::StsError, cv::format("VideoCapture::waitAny(): the stream %d failed", (int)i));
+        if ((fds[i].revents & POLLIN) == 0)
+            continue;
+        int code = mainloop_v4l2(cams[i]);
+        if (code < 0)
+            CV_Error(Error::StsError, cv::format("VideoCapture::waitAny(): can't grab a frame of the stream %d", (int)i));
+        if (code == 1)
+            ready.push_back((int)i);
+    }
+    return !ready.empty();
+}
+
 } // end namespace cv
 
 CvCapture* cvCreateCameraCapture_V4L( int index )
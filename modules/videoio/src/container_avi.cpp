@@ -24,6 +24,7 @@ const uint32_t JUNK_CC = CV_FOURCC('J','U','N','K');
 const uint32_t INFO_CC = CV_FOURCC('I','N','F','O');
 const uint32_t ODML_CC = CV_FOURCC('o','d','m','l');
 const uint32_t DMLH_CC = CV_FOURCC('d','m','l','h');
+const uint32_t INDX_CC = CV_FOURCC('i','n','d','x');
 
 String fourccToString(uint32_t fourcc);
 
@@ -90,6 +91,38 @@ struct BitmapInfoHeader
     uint32_t biClrImportant;        // Specifies that the first x colors of the color table. Are important to the DIB.
 };
 
+// 'indx' chunk after its RiffChunk header: the ODML super index, followed by nEntriesInUse entries
+// { uint64_t qwOffset; uint32_t dwSize; uint32_t dwDuration; }
+struct AviSuperIndexHeader
+{
+    uint16_t wLongsPerEntry;        // 4
+    uint8_t  bIndexSubType;         // 0
+    uint8_t  bIndexType;            // AVI_INDEX_OF_INDEXES
+    uint32_t nEntriesInUse;
+    uint32_t dwChunkId;             // '00dc'
+    uint32_t dwReserved[3];
+};
+
+struct AviSuperIndexEntry
+{
+    uint64_t qwOffset;              // absolute position of the standard index chunk
+    uint32_t dwSize;                // size of the standard index chunk
+    uint32_t dwDuration;            // number of frames it indexes
+};
+
+// 'ix00' chunk after its RiffChunk header: the ODML standard index, followed by nEntriesInUse entries
+// { uint32_t dwOffset; uint32_t dwSize; }
+struct AviStdIndexHeader
+{
+    uint16_t wLongsPerEntry;        // 2
+    uint8_t  bIndexSubType;         // 0
+    uint8_t  bIndexType;            // AVI_INDEX_OF_CHUNKS
+    uint32_t nEntriesInUse;
+    uint32_t dwChunkId;             // '00dc'
+    uint64_t qwBaseOffset;          // dwOffset of the entries is relative to it and points to the chunk data
+    uint32_t dwReserved;
+};
+
 struct RiffChunk
 {
     uint32_t m_four_cc;
@@ -147,6 +180,18 @@ inline VideoInputStream& operator >> (VideoInputStream& is, AviIndex& idx1)
     return is;
 }
 
+inline VideoInputStream& operator >> (VideoInputStream& is, AviSuperIndexHeader& indx)
+{
+    is.read((char*)(&indx), sizeof(indx));
+    return is;
+}
+
+inline VideoInputStream& operator >> (VideoInputStream& is, AviStdIndexHeader& ix)
+{
+    is.read((char*)(&ix), sizeof(ix));
+    return is;
+}
+
 inline VideoInputStream& operator >> (VideoInputStream& is, RiffChunk& riff_chunk)
 {
     is.read((char*)(&riff_chunk), sizeof(riff_chunk));
@@ -168,6 +213,39 @@ static const int JUNK_SEEK = 4096;
 static const int AVIIF_KEYFRAME = 0x10;
 static const int MAX_BYTES_PER_SEC = 99999999;
 static const int SUG_BUFFER_SIZE = 1048576;
+static const int AVI_INDEX_OF_INDEXES = 0x00;
+static const int AVI_INDEX_OF_CHUNKS = 0x01;
+static const int AVI_INDEX_DELTAFRAME = 0x80000000; // set in dwSize of the entries of the non-key frames
+static const int SUPER_INDEX_ENTRIES = 1024;        // standard indexes reserved in the header, one per RIFF list
+static const uint64_t MAX_RIFF_SIZE = 1 << 30;
+
+// 64-bit file positions, the recordings can be larger than 2 GB
+static int64_t fileTell(FILE* f)
+{
+#ifdef _WIN32
+    return _ftelli64(f);
+#else
+    return ftello(f);
+#endif
+}
+
+static bool fileSeek(FILE* f, int64_t pos)
+{
+#ifdef _WIN32
+    return _fseeki64(f, pos, SEEK_SET) == 0;
+#else
+    return fseeko(f, (off_t)pos, SEEK_SET) == 0;
+#endif
+}
+
+static inline uchar* putIntLE(uchar* ptr, uint32_t val)
+{
+    ptr[0] = (uchar)val;
+    ptr[1] = (uchar)(val >> 8);
+    ptr[2] = (uchar)(val >> 16);
+    ptr[3] = (uchar)(val >> 24);
+    return ptr + 4;
+}
 
 String fourccToString(uint32_t fourcc)
 {
@@ -224,14 +302,14 @@ VideoInputStream& VideoInputStream::read(char* buf, uint64_t count)
 
 VideoInputStream& VideoInputStream::seekg(uint64_t pos)
 {
-    m_is_valid = (fseek(m_f, (int32_t)pos, SEEK_SET) == 0);
+    m_is_valid = fileSeek(m_f, (int64_t)pos);
 
     return *this;
 }
 
 uint64_t VideoInputStream::tellg()
 {
-    return ftell(m_f);
+    return (uint64_t)fileTell(m_f);
 }
 
 VideoInputStream::operator bool()
@@ -306,6 +384,76 @@ bool AVIReadContainer::parseIndex(uint32_t index_size, frame_list& in_frame_list
     return result;
 }
 
+// finds the 'indx' chunk of the stream within its strl list
+void AVIReadContainer::parseSuperIndex(uint64_t strl_start, uint64_t strl_end)
+{
+    m_odml_indexes.clear();
+    m_file_stream->seekg(strl_start);
+    while(m_file_stream && m_file_stream->tellg() + sizeof(RiffChunk) <= strl_end)
+    {
+        RiffChunk chunk;
+        *m_file_stream >> chunk;
+        if(!m_file_stream)
+            break;
+        uint64_t next_chunk = m_file_stream->tellg();
+        next_chunk += chunk.m_size + (chunk.m_size & 1);
+
+        if(chunk.m_four_cc == INDX_CC)
+        {
+            AviSuperIndexHeader indx;
+            *m_file_stream >> indx;
+            if(m_file_stream && indx.wLongsPerEntry == 4 && indx.bIndexType == AVI_INDEX_OF_INDEXES &&
+               indx.dwChunkId == m_stream_id && sizeof(indx) + (uint64_t)indx.nEntriesInUse * sizeof(AviSuperIndexEntry) <= chunk.m_size)
+            {
+                std::vector<AviSuperIndexEntry> entries(indx.nEntriesInUse);
+                if(!entries.empty())
+                    m_file_stream->read((char*)&entries[0], entries.size() * sizeof(entries[0]));
+                for(size_t i = 0; m_file_stream && i < entries.size(); i++)
+                    m_odml_indexes.push_back(std::make_pair(entries[i].qwOffset, entries[i].dwSize));
+                if(!m_file_stream)
+                    m_odml_indexes.clear();
+            }
+            return;
+        }
+        m_file_stream->seekg(next_chunk);
+    }
+}
+
+// reads the standard indexes the super index points to, each at once
+bool AVIReadContainer::parseOdmlIndex(frame_list& in_frame_list)
+{
+    frame_list frames;
+    std::vector<uint32_t> entries;
+    for(size_t i = 0; i < m_odml_indexes.size(); i++)
+    {
+        m_file_stream->seekg(m_odml_indexes[i].first);
+        RiffChunk ix;
+        AviStdIndexHeader ix_hdr;
+        *m_file_stream >> ix >> ix_hdr;
+        if(!m_file_stream || ix_hdr.wLongsPerEntry != 2 || ix_hdr.bIndexType != AVI_INDEX_OF_CHUNKS ||
+           ix_hdr.dwChunkId != m_stream_id || sizeof(ix_hdr) + (uint64_t)ix_hdr.nEntriesInUse * 8 > ix.m_size)
+        {
+            fprintf(stderr, "Failed to parse ODML index %d\n", (int)i);
+            return false;
+        }
+
+        entries.resize(ix_hdr.nEntriesInUse * 2);
+        if(!entries.empty())
+            m_file_stream->read((char*)&entries[0], entries.size() * sizeof(entries[0]));
+        if(!m_file_stream)
+            return false;
+        for(size_t j = 0; j < entries.size(); j += 2)
+        {
+            // the offsets point to the chunk data, the frame list refers to the chunk headers
+            uint64_t chunk_pos = ix_hdr.qwBaseOffset + entries[j] - sizeof(RiffChunk);
+            frames.push_back(std::make_pair(chunk_pos, entries[j + 1] & ~(uint32_t)AVI_INDEX_DELTAFRAME));
+        }
+    }
+
+    in_frame_list.insert(in_frame_list.end(), frames.begin(), frames.end());
+    return !frames.empty();
+}
+
 bool AVIReadContainer::parseStrl(char stream_id, Codecs codec_)
 {
     RiffChunk strh;
@@ -396,11 +544,15 @@ bool AVIReadContainer::parseHdrlList(Codecs codec_)
 
                 if( m_file_stream && strl_list.m_riff_or_list_cc == LIST_CC && strl_list.m_list_type_cc == STRL_CC )
                 {
-                    next_strl_list = m_file_stream->tellg();
+                    uint64_t strl_start = m_file_stream->tellg();
+                    next_strl_list = strl_start;
                     //RiffList::m_size includes fourCC field which we have already read
                     next_strl_list += (strl_list.m_size - 4);
 
+                    const uint32_t stream_id = m_stream_id;
                     result = parseStrl((char)i, codec_);
+                    if(result && stream_id == 0 && m_stream_id != 0)
+                        parseSuperIndex(strl_start, next_strl_list);
                 }
                 else
                 {
@@ -459,8 +611,11 @@ bool AVIReadContainer::parseAviWithFrameList(frame_list& in_frame_list, Codecs c
                 m_movi_start -= 4;
 
                 m_movi_end = m_movi_start + some_list.m_size;
+                //the ODML index covers all the RIFF lists
+                if(!m_odml_indexes.empty())
+                    is_index_found = parseOdmlIndex(in_frame_list);
                 //if m_is_indx_present is set to true we should find index
-                if(m_is_indx_present)
+                if(!is_index_found && m_is_indx_present)
                 {
                     //we are expecting to find index section after movi list
                     uint32_t indx_pos = (uint32_t)m_movi_start + 4;
@@ -544,8 +699,12 @@ bool AVIReadContainer::parseRiff(frame_list &m_mjpeg_frames_)
             //RiffList::m_size includes fourCC field which we have already read
             next_riff += (riff_list.m_size - 4);
 
-            bool is_parsed = parseAvi(m_mjpeg_frames_, MJPEG);
-            result = result || is_parsed;
+            //AVIX lists only continue the movi data, their frames are found by the ODML index
+            if(riff_list.m_list_type_cc == AVI_CC)
+            {
+                bool is_parsed = parseAvi(m_mjpeg_frames_, MJPEG);
+                result = result || is_parsed;
+            }
             m_file_stream->seekg(next_riff);
         }
         else
@@ -595,14 +754,14 @@ public:
     void close();
 
     void writeBlock();
-    size_t getPos() const;
+    uint64_t getPos() const;
     void putByte(int val);
     void putBytes(const uchar* buf, int count);
 
     void putShort(int val);
     void putInt(int val);
     void jputShort(int val);
-    void patchInt(int val, size_t pos);
+    void patchInt(int val, uint64_t pos);
     void jput(unsigned currval);
     void jflush(unsigned currval, int bitIdx);
 
@@ -611,7 +770,7 @@ protected:
     uchar*  m_start;
     uchar*  m_end;
     uchar*  m_current;
-    size_t  m_pos;
+    uint64_t m_pos;
     bool    m_is_opened;
     FILE*   m_f;
 };
@@ -660,8 +819,8 @@ void BitStream::writeBlock()
     m_current = m_start;
 }
 
-size_t BitStream::getPos() const {
-    return (size_t)(m_current - m_start) + m_pos;
+uint64_t BitStream::getPos() const {
+    return (uint64_t)(m_current - m_start) + m_pos;
 }
 
 void BitStream::putByte(int val)
@@ -726,11 +885,11 @@ void BitStream::jputShort(int val)
         writeBlock();
 }
 
-void BitStream::patchInt(int val, size_t pos)
+void BitStream::patchInt(int val, uint64_t pos)
 {
     if( pos >= m_pos )
     {
-        ptrdiff_t delta = pos - m_pos;
+        ptrdiff_t delta = (ptrdiff_t)(pos - m_pos);
         CV_Assert( delta < m_current - m_start );
         m_start[delta] = (uchar)val;
         m_start[delta+1] = (uchar)(val >> 8);
@@ -739,12 +898,11 @@ void BitStream::patchInt(int val, size_t pos)
     }
     else
     {
-        CV_Assert(pos < (1u<<31));
-        long fpos = ftell(m_f);
-        fseek(m_f, (long)pos, SEEK_SET);
+        int64_t fpos = fileTell(m_f);
+        CV_Assert(fileSeek(m_f, (int64_t)pos));
         uchar buf[] = { (uchar)val, (uchar)(val >> 8), (uchar)(val >> 16), (uchar)(val >> 24) };
         fwrite(buf, 1, 4, m_f);
-        fseek(m_f, fpos, SEEK_SET);
+        CV_Assert(fileSeek(m_f, fpos));
     }
 }
 
@@ -799,6 +957,12 @@ AVIWriteContainer::AVIWriteContainer() : strm(makePtr<BitStream>())
     width = 0;
     channels = 0;
     moviPointer = 0;
+    maxRiffSize = MAX_RIFF_SIZE;
+    riffPointer = 0;
+    riffCount = 0;
+    riffFirstFrame = 0;
+    firstRiffFrames = 0;
+    superIndexPointer = 0;
     strm->close();
 }
 
@@ -808,6 +972,7 @@ AVIWriteContainer::~AVIWriteContainer() {
     frameSize.clear();
     AVIChunkSizeIndex.clear();
     frameNumIndexes.clear();
+    superIndex.clear();
 }
 
 bool AVIWriteContainer::initContainer(const String& filename, double fps, Size size, bool iscolor)
@@ -817,12 +982,23 @@ bool AVIWriteContainer::initContainer(const String& filename, double fps, Size s
     height = size.height;
     channels = iscolor ? 3 : 1;
     moviPointer = 0;
+    riffPointer = 0;
+    riffCount = 0;
+    riffFirstFrame = 0;
+    firstRiffFrames = 0;
+    superIndexPointer = 0;
+    frameOffset.clear();
+    frameSize.clear();
+    frameNumIndexes.clear();
+    superIndex.clear();
     bool result = strm->open(filename);
     return result;
 }
 
 void AVIWriteContainer::startWriteAVI(int stream_count)
 {
+    riffPointer = strm->getPos();
+    riffCount = 1;
     startWriteChunk(RIFF_CC);
 
     strm->putInt(AVI_CC);
@@ -902,9 +1078,23 @@ void AVIWriteContainer::writeStreamHeader(Codecs codec_)
     strm->putInt(0);
     strm->putInt(0);
     strm->putInt(0);
-    // Must be indx chunk
     endWriteChunk(); // end strf
 
+    // indx, the ODML super index, filled in by finishWriteAVI
+    startWriteChunk(INDX_CC);
+    strm->putShort(4); // wLongsPerEntry
+    strm->putByte(0);  // bIndexSubType
+    strm->putByte(AVI_INDEX_OF_INDEXES);
+    superIndexPointer = strm->getPos();
+    strm->putInt(0);   // nEntriesInUse
+    strm->putInt(getAVIIndex(0, dc));
+    strm->putInt(0);
+    strm->putInt(0);
+    strm->putInt(0);
+    for( int i = 0; i < SUPER_INDEX_ENTRIES * 4; i++ )
+        strm->putInt(0);
+    endWriteChunk(); // end indx
+
     endWriteChunk(); // end strl
 
     // odml
@@ -924,8 +1114,8 @@ void AVIWriteContainer::writeStreamHeader(Codecs codec_)
 
     // JUNK
     startWriteChunk(JUNK_CC);
-    size_t pos = strm->getPos();
-    for( ; pos < (size_t)JUNK_SEEK; pos += 4 )
+    uint64_t pos = strm->getPos();
+    for( ; pos < (uint64_t)JUNK_SEEK; pos += 4 )
         strm->putInt(0);
     endWriteChunk(); // end JUNK
 
@@ -948,8 +1138,8 @@ void AVIWriteContainer::endWriteChunk()
 {
     if( !AVIChunkSizeIndex.empty() )
     {
-        size_t currpos = strm->getPos();
-        size_t pospos = AVIChunkSizeIndex.back();
+        uint64_t currpos = strm->getPos();
+        uint64_t pospos = AVIChunkSizeIndex.back();
         AVIChunkSizeIndex.pop_back();
         int chunksz = (int)(currpos - (pospos + 4));
         strm->patchInt(chunksz, pospos);
@@ -972,35 +1162,121 @@ int AVIWriteContainer::getAVIIndex(int stream_number, StreamType strm_type) {
 
 void AVIWriteContainer::writeIndex(int stream_number, StreamType strm_type)
 {
-    // old style AVI index. Must be Open-DML index
+    // old style AVI index, written after the movi list of the first RIFF list only
+    if( riffCount > 1 )
+        return;
     startWriteChunk(IDX1_CC);
-    int nframes = (int)frameOffset.size();
-    for( int i = 0; i < nframes; i++ )
+    const uint32_t ckid = getAVIIndex(stream_number, strm_type);
+    const size_t nframes = frameOffset.size();
+    std::vector<uchar> buf(nframes * 16);
+    uchar* ptr = buf.empty() ? 0 : &buf[0];
+    for( size_t i = 0; i < nframes; i++ )
     {
-        strm->putInt(getAVIIndex(stream_number, strm_type));
-        strm->putInt(AVIIF_KEYFRAME);
-        strm->putInt((int)frameOffset[i]);
-        strm->putInt((int)frameSize[i]);
+        ptr = putIntLE(ptr, ckid);
+        ptr = putIntLE(ptr, AVIIF_KEYFRAME);
+        ptr = putIntLE(ptr, (uint32_t)frameOffset[i]);
+        ptr = putIntLE(ptr, (uint32_t)frameSize[i]);
     }
+    if( !buf.empty() )
+        strm->putBytes(&buf[0], (int)buf.size());
     endWriteChunk(); // End idx1
 }
 
+// the ix00 standard index of the frames of the current RIFF list, written at once at the end of its movi list
+void AVIWriteContainer::writeOdmlIndex(int stream_number, StreamType strm_type)
+{
+    const size_t nframes = frameOffset.size() - riffFirstFrame;
+    if( nframes == 0 )
+        return;
+    if( superIndex.size() >= (size_t)SUPER_INDEX_ENTRIES )
+        CV_Error(CV_StsOutOfRange, "The AVI super index is full");
+
+    const uint32_t ckid = getAVIIndex(stream_number, strm_type);
+    const uint32_t ixid = CV_FOURCC('i', 'x', (ckid & 255), ((ckid >> 8) & 255));
+    const size_t header_size = sizeof(RiffChunk) + sizeof(AviStdIndexHeader);
+    std::vector<uchar> buf(header_size + nframes * 8);
+    uchar* ptr = &buf[0];
+    ptr = putIntLE(ptr, ixid);
+    ptr = putIntLE(ptr, (uint32_t)(buf.size() - sizeof(RiffChunk)));
+    *ptr++ = 2; *ptr++ = 0; // wLongsPerEntry
+    *ptr++ = 0;             // bIndexSubType
+    *ptr++ = AVI_INDEX_OF_CHUNKS;
+    ptr = putIntLE(ptr, (uint32_t)nframes);
+    ptr = putIntLE(ptr, ckid);
+    ptr = putIntLE(ptr, (uint32_t)moviPointer);
+    ptr = putIntLE(ptr, (uint32_t)(moviPointer >> 32));
+    ptr = putIntLE(ptr, 0);
+    for( size_t i = riffFirstFrame; i < frameOffset.size(); i++ )
+    {
+        // relative to the 'movi' fourcc, pointing to the chunk data
+        ptr = putIntLE(ptr, (uint32_t)(frameOffset[i] + sizeof(RiffChunk)));
+        ptr = putIntLE(ptr, (uint32_t)frameSize[i]);
+    }
+
+    IndexEntry entry;
+    entry.offset = strm->getPos();
+    entry.size = (uint32_t)buf.size();
+    entry.duration = (uint32_t)nframes;
+    superIndex.push_back(entry);
+    strm->putBytes(&buf[0], (int)buf.size());
+    riffFirstFrame = frameOffset.size();
+}
+
+bool AVIWriteContainer::isRiffFull() const
+{
+    return riffCount > 0 && strm->getPos() - riffPointer >= maxRiffSize;
+}
+
+// closes the current RIFF list and continues the movi data in a new RIFF 'AVIX' list
+void AVIWriteContainer::startNextRiff(int stream_number, StreamType strm_type)
+{
+    writeOdmlIndex(stream_number, strm_type);
+    endWriteChunk(); // end LIST 'movi'
+    if( riffCount == 1 )
+    {
+        writeIndex(stream_number, strm_type);
+        firstRiffFrames = frameOffset.size();
+    }
+    endWriteChunk(); // end RIFF
+
+    riffPointer = strm->getPos();
+    riffCount++;
+    startWriteChunk(RIFF_CC);
+    strm->putInt(AVIX_CC);
+    startWriteChunk(LIST_CC);
+    moviPointer = strm->getPos();
+    strm->putInt(MOVI_CC);
+}
+
 void AVIWriteContainer::finishWriteAVI()
 {
     int nframes = (int)frameOffset.size();
-    // Record frames numbers to AVI Header
+    // Record frames numbers to AVI Header, the main header counts the frames of the first RIFF list only
     while (!frameNumIndexes.empty())
     {
-        size_t ppos = frameNumIndexes.back();
+        uint64_t ppos = frameNumIndexes.back();
         frameNumIndexes.pop_back();
-        strm->patchInt(nframes, ppos);
+        strm->patchInt(frameNumIndexes.empty() && riffCount > 1 ? (int)firstRiffFrames : nframes, ppos);
+    }
+    // Record the standard indexes to the super index
+    if( superIndexPointer != 0 )
+    {
+        strm->patchInt((int)superIndex.size(), superIndexPointer);
+        uint64_t pos = superIndexPointer + 4 * 5;
+        for( size_t i = 0; i < superIndex.size(); i++, pos += sizeof(AviSuperIndexEntry) )
+        {
+            strm->patchInt((int)superIndex[i].offset, pos);
+            strm->patchInt((int)(superIndex[i].offset >> 32), pos + 4);
+            strm->patchInt((int)superIndex[i].size, pos + 8);
+            strm->patchInt((int)superIndex[i].duration, pos + 12);
+        }
     }
     endWriteChunk(); // end RIFF
 }
 
 bool AVIWriteContainer::isOpenedStream() const { return strm->isOpened(); }
 
-size_t AVIWriteContainer::getStreamPos() const { return strm->getPos(); }
+uint64_t AVIWriteContainer::getStreamPos() const { return strm->getPos(); }
 
 void AVIWriteContainer::jputStreamShort(int val) { strm->jputShort(val); }
 
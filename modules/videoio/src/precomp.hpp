@@ -90,6 +90,8 @@ struct CvCapture
     virtual bool setProperty(int, double) { return 0; }
     virtual bool grabFrame() { return true; }
     virtual IplImage* retrieveFrame(int) { return 0; }
+    // writes the frame right into the output, false if the backend cannot do that
+    virtual bool retrieveFrameTo(int, cv::OutputArray) { return false; }
     virtual int getCaptureDomain() { return cv::CAP_ANY; } // Return the type of the capture object: CAP_VFW, etc...
 };
 
@@ -187,6 +189,13 @@ namespace cv
         virtual void write(InputArray) = 0;
     };
 
+    //! decodes the frames of the source on a background thread, see CAP_PROP_ASYNC_BUFFERS
+    Ptr<IVideoCapture> createAsyncCapture(const Ptr<IVideoCapture>& source);
+    //! encodes the frames on a background thread, see VIDEOWRITER_PROP_ASYNC_BUFFERS
+    Ptr<IVideoWriter> createAsyncWriter(const Ptr<IVideoWriter>& sink);
+    //! see VideoCapture::waitAny
+    bool cvWaitAnyCameraCapture_V4L(const std::vector<CvCapture*>& captures, std::vector<int>& ready, int64 timeoutNs);
+
     Ptr<IVideoCapture> createMotionJpegCapture(const String& filename);
     Ptr<IVideoWriter> createMotionJpegWriter( const String& filename, double fps, Size frameSize, bool iscolor );
 
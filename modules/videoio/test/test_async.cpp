@@ -0,0 +1,266 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "test_precomp.hpp"
+
+#include <set>
+#include <thread>
+#include <chrono>
+
+namespace opencv_test { namespace {
+
+static void readAll(VideoCapture& cap, std::vector<Mat>& frames, std::vector<double>& positions)
+{
+    const bool async = cap.get(CAP_PROP_ASYNC_BUFFERS) > 0;
+    frames.clear();
+    positions.clear();
+    Mat frame;
+    while (cap.read(frame))
+    {
+        // the asynchronous capture must not overwrite the frames which are still referred to
+        frames.push_back(async ? frame : frame.clone());
+        positions.push_back(cap.get(CAP_PROP_POS_FRAMES));
+    }
+}
+
+class Videoio_Async : public testing::TestWithParam<VideoCaptureAPIs>
+{
+protected:
+    void SetUp()
+    {
+        apiPref = GetParam();
+        frame_count = 30;
+        Mat img(120, 160, CV_8UC3);
+        if (apiPref == CAP_IMAGES)
+        {
+            video_file = cv::tempfile(".png");
+            video_file = video_file.substr(0, video_file.size() - 4) + "_%02d.png";
+            for (int i = 0; i < frame_count; i++)
+            {
+                generateFrame(i, frame_count, img);
+                ASSERT_TRUE(imwrite(cv::format(video_file.c_str(), i), img));
+            }
+        }
+        else
+        {
+            video_file = cv::tempfile(".avi");
+            VideoWriter writer(video_file, apiPref, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, img.size());
+            ASSERT_TRUE(writer.isOpened());
+            for (int i = 0; i < frame_count; i++)
+            {
+                generateFrame(i, frame_count, img);
+                writer << img;
+            }
+        }
+    }
+    void TearDown()
+    {
+        if (apiPref == CAP_IMAGES)
+        {
+            for (int i = 0; i < frame_count; i++)
+                remove(cv::format(video_file.c_str(), i).c_str());
+        }
+        else
+            remove(video_file.c_str());
+    }
+
+    int apiPref;
+    int frame_count;
+    std::string video_file;
+};
+
+TEST_P(Videoio_Async, read)
+{
+    std::vector<Mat> expected, frames;
+    std::vector<double> expected_pos, pos;
+    {
+        VideoCapture cap(video_file, apiPref);
+        ASSERT_TRUE(cap.isOpened());
+        readAll(cap, expected, expected_pos);
+        ASSERT_EQ((size_t)frame_count, expected.size());
+    }
+
+    VideoCapture cap(video_file, apiPref);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFERS, 4));
+    EXPECT_EQ(4, cap.get(CAP_PROP_ASYNC_BUFFERS));
+    EXPECT_EQ(CAP_ASYNC_BLOCK, cap.get(CAP_PROP_ASYNC_POLICY));
+    EXPECT_EQ(160, cap.get(CAP_PROP_FRAME_WIDTH));
+    readAll(cap, frames, pos);
+    ASSERT_EQ(expected.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", (int)i));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected[i], frames[i]);
+        EXPECT_EQ(expected_pos[i], pos[i]);
+    }
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH));
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES));
+
+    // seeking restarts the background thread
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 10));
+    Mat frame;
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected[10], frame);
+    EXPECT_EQ(expected_pos[10], cap.get(CAP_PROP_POS_FRAMES));
+
+    // the frames decoded ahead are not lost when the thread stops
+    for (int i = 0; i < 10000 && cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH) < 4; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_GE(cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH), 4);
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFERS, 0));
+    for (int i = 11; i < frame_count; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected[i], frame);
+    }
+    EXPECT_FALSE(cap.read(frame));
+}
+
+TEST_P(Videoio_Async, reuse_buffers)
+{
+    VideoCapture cap(video_file, apiPref);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFERS, 2));
+    std::set<uchar*> buffers;
+    Mat frame;
+    for (int i = 0; cap.read(frame); i++)
+        buffers.insert(frame.data);
+    // the queue, the frame being decoded, the grabbed one and the ones returned by the output
+    EXPECT_LE(buffers.size(), (size_t)6);
+}
+
+TEST_P(Videoio_Async, drop_oldest)
+{
+    VideoCapture cap(video_file, apiPref);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_POLICY, CAP_ASYNC_DROP_OLDEST));
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_BUFFERS, 2));
+    // a file is decoded faster than it is read here, only the last frames remain
+    for (int i = 0; i < 10000 && cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES) < frame_count - 2; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(frame_count - 2, cap.get(CAP_PROP_ASYNC_DROPPED_FRAMES));
+    EXPECT_EQ(2, cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH));
+
+    Mat frame, expected(120, 160, CV_8UC3);
+    for (int i = frame_count - 2; i < frame_count; i++)
+    {
+        ASSERT_TRUE(cap.read(frame));
+        generateFrame(i, frame_count, expected);
+        EXPECT_GT(cvtest::PSNR(expected, frame), 30);
+    }
+    EXPECT_FALSE(cap.read(frame));
+}
+
+INSTANTIATE_TEST_CASE_P(videoio, Videoio_Async, testing::Values(CAP_OPENCV_MJPEG, CAP_IMAGES));
+
+//==================================================================================================
+
+typedef testing::TestWithParam<VideoCaptureAPIs> Videoio_AsyncWriter;
+
+static std::string writerFilename(int apiPref)
+{
+    if (apiPref == CAP_IMAGES)
+    {
+        std::string filename = cv::tempfile(".png");
+        return filename.substr(0, filename.size() - 4) + "_%02d.png";
+    }
+    return cv::tempfile(".avi");
+}
+
+static void removeWritten(int apiPref, const std::string& filename, int frame_count)
+{
+    if (apiPref == CAP_IMAGES)
+    {
+        for (int i = 0; i < frame_count; i++)
+            remove(cv::format(filename.c_str(), i).c_str());
+    }
+    else
+        remove(filename.c_str());
+}
+
+static std::vector<Mat> writeAndRead(int apiPref, int buffers, int policy, int frame_count, double* dropped = 0)
+{
+    const std::string filename = writerFilename(apiPref);
+    {
+        VideoWriter writer(filename, apiPref, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, Size(160, 120));
+        EXPECT_TRUE(writer.isOpened());
+        if (buffers > 0)
+        {
+            EXPECT_TRUE(writer.set(VIDEOWRITER_PROP_ASYNC_POLICY, policy));
+            EXPECT_TRUE(writer.set(VIDEOWRITER_PROP_ASYNC_BUFFERS, buffers));
+            EXPECT_EQ(buffers, writer.get(VIDEOWRITER_PROP_ASYNC_BUFFERS));
+        }
+        Mat img(120, 160, CV_8UC3);
+        for (int i = 0; i < frame_count; i++)
+        {
+            generateFrame(i, frame_count, img);
+            writer << img; // the frame is copied, it can be overwritten right away
+        }
+        if (dropped)
+            *dropped = writer.get(VIDEOWRITER_PROP_ASYNC_DROPPED_FRAMES);
+    }
+
+    std::vector<Mat> frames;
+    VideoCapture cap(filename, apiPref);
+    Mat frame;
+    while (cap.isOpened() && cap.read(frame))
+        frames.push_back(frame.clone());
+    removeWritten(apiPref, filename, frame_count);
+    return frames;
+}
+
+TEST_P(Videoio_AsyncWriter, write)
+{
+    const int frame_count = 30;
+    std::vector<Mat> expected = writeAndRead(GetParam(), 0, VIDEOWRITER_ASYNC_BLOCK, frame_count);
+    ASSERT_EQ((size_t)frame_count, expected.size());
+    std::vector<Mat> frames = writeAndRead(GetParam(), 3, VIDEOWRITER_ASYNC_BLOCK, frame_count);
+    ASSERT_EQ(expected.size(), frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+        EXPECT_EQ(0, cvtest::norm(expected[i], frames[i], NORM_INF)) << "frame " << i;
+}
+
+TEST_P(Videoio_AsyncWriter, drop_newest)
+{
+    const int frame_count = 30;
+    double dropped = -1;
+    std::vector<Mat> frames = writeAndRead(GetParam(), 1, VIDEOWRITER_ASYNC_DROP_NEWEST, frame_count, &dropped);
+    // the frames not dropped are written in order
+    EXPECT_EQ(frame_count, (int)frames.size() + (int)dropped);
+    EXPECT_GE(frames.size(), (size_t)1);
+}
+
+TEST(Videoio_AsyncWriter, metrics)
+{
+    const std::string filename = cv::tempfile(".avi");
+    VideoWriter writer(filename, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, Size(640, 480));
+    ASSERT_TRUE(writer.isOpened());
+    ASSERT_TRUE(writer.set(VIDEOWRITER_PROP_ASYNC_BUFFERS, 2));
+    EXPECT_EQ(VIDEOWRITER_ASYNC_BLOCK, writer.get(VIDEOWRITER_PROP_ASYNC_POLICY));
+    EXPECT_FALSE(writer.set(VIDEOWRITER_PROP_ASYNC_POLICY, 3));
+    EXPECT_FALSE(writer.set(VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH, 1));
+    Mat img(480, 640, CV_8UC3);
+    randu(img, 0, 256);
+    for (int i = 0; i < 10; i++)
+    {
+        writer << img;
+        EXPECT_LE(writer.get(VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH), 2);
+    }
+    // the queue is drained before the thread stops
+    ASSERT_TRUE(writer.set(VIDEOWRITER_PROP_ASYNC_BUFFERS, 0));
+    EXPECT_EQ(0, writer.get(VIDEOWRITER_PROP_ASYNC_QUEUE_DEPTH));
+    EXPECT_EQ(0, writer.get(VIDEOWRITER_PROP_ASYNC_DROPPED_FRAMES));
+    EXPECT_GT(writer.get(VIDEOWRITER_PROP_ASYNC_ENCODE_MSEC), 0);
+    writer << img; // synchronously
+    writer.release();
+
+    VideoCapture cap(filename, CAP_OPENCV_MJPEG);
+    EXPECT_EQ(11, cap.get(CAP_PROP_FRAME_COUNT));
+    remove(filename.c_str());
+}
+
+INSTANTIATE_TEST_CASE_P(videoio, Videoio_AsyncWriter, testing::Values(CAP_OPENCV_MJPEG, CAP_IMAGES));
+
+}} // namespace
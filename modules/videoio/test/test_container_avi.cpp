@@ -84,4 +84,69 @@ TEST(videoio_avi, basic)
     remove(filename.c_str());
 }
 
+TEST(videoio_avi, odml)
+{
+    const String filename = cv::tempfile("test.avi");
+    const int frame_count = 60;
+    std::vector<std::vector<uchar> > data(frame_count);
+    RNG rng(0xA1);
+    for (int i = 0; i < frame_count; i++)
+    {
+        data[i].resize(rng.uniform(1000, 5000));
+        rng.fill(data[i], RNG::UNIFORM, 0, 256);
+    }
+    {
+        AVIWriteContainer out;
+        ASSERT_TRUE(out.initContainer(filename, 25, Size(64, 48), true));
+        out.setMaxRiffSize(64 * 1024); // several RIFF lists
+        out.startWriteAVI(1);
+        out.writeStreamHeader(MJPEG);
+        for (int i = 0; i < frame_count; i++)
+        {
+            if (out.isRiffFull())
+                out.startNextRiff(0, dc);
+            uint64_t chunkPointer = out.getStreamPos();
+            out.startWriteChunk(out.getAVIIndex(0, dc));
+            out.putStreamBytes(&data[i][0], (int)data[i].size());
+            out.pushFrameOffset((size_t)(chunkPointer - out.getMoviPointer()));
+            out.pushFrameSize((size_t)(out.getStreamPos() - chunkPointer - 8));
+            out.endWriteChunk();
+        }
+        out.writeOdmlIndex(0, dc);
+        out.endWriteChunk(); // ends LIST chunk
+        out.writeIndex(0, dc);
+        out.finishWriteAVI();
+    }
+
+    int riff_count = 0;
+    {
+        FILE* f = fopen(filename.c_str(), "rb");
+        ASSERT_TRUE(f != NULL);
+        char header[12];
+        long pos = 0;
+        while (fseek(f, pos, SEEK_SET) == 0 && fread(header, 1, 12, f) == 12 && memcmp(header, "RIFF", 4) == 0)
+        {
+            EXPECT_EQ(0, memcmp(header + 8, riff_count == 0 ? "AVI " : "AVIX", 4));
+            riff_count++;
+            pos += 8 + (header[4] & 255) + ((header[5] & 255) << 8) + ((header[6] & 255) << 16);
+        }
+        fclose(f);
+    }
+    EXPECT_GT(riff_count, 2);
+
+    AVIReadContainer in;
+    in.initStream(filename);
+    frame_list frames;
+    ASSERT_TRUE(in.parseRiff(frames));
+    ASSERT_EQ((size_t)frame_count, frames.size());
+    for (int i = 0; i < frame_count; i++)
+    {
+        std::vector<char> actual = in.readFrame(frames.begin() + i);
+        ASSERT_EQ(data[i].size(), actual.size()) << "frame " << i;
+        EXPECT_EQ(0, memcmp(&data[i][0], &actual[0], actual.size())) << "frame " << i;
+    }
+    in.close();
+    remove(filename.c_str());
+}
+
 }
@@ -439,5 +439,60 @@ TEST(Videoio_Video_parallel_writers_and_readers, accuracy)
         delete *i;
 }
 
+TEST(Videoio_Video, ffmpeg_threads_and_raw_output)
+{
+    const string filename = cv::tempfile(".avi");
+    const int frame_count = 10;
+    const Size size(161, 121); // odd, the raw frames are cut to even sizes
+    {
+        VideoWriter writer(filename, CAP_FFMPEG, VideoWriter::fourcc('m', 'p', '4', 'v'), 25, size);
+        ASSERT_TRUE(writer.isOpened());
+        Mat img(size, CV_8UC3);
+        for (int i = 0; i < frame_count; i++)
+        {
+            generateFrame(i, frame_count, img);
+            writer << img;
+        }
+    }
+
+    std::vector<Mat> expected;
+    {
+        VideoCapture cap(filename, CAP_FFMPEG);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_THREADS, 1));
+        EXPECT_EQ(1, cap.get(CAP_PROP_FFMPEG_THREADS));
+        Mat frame;
+        uchar* data = 0;
+        for (int i = 0; cap.read(frame); i++)
+        {
+            // the frames are converted right into the output
+            if (i > 0)
+                EXPECT_EQ(data, frame.data);
+            data = frame.data;
+            expected.push_back(frame.clone());
+        }
+        ASSERT_EQ((size_t)frame_count, expected.size());
+    }
+
+    VideoCapture cap(filename, CAP_FFMPEG);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_THREAD_TYPE, CAP_FFMPEG_THREAD_FRAME | CAP_FFMPEG_THREAD_SLICE));
+    ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_THREADS, 4));
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 0));
+    EXPECT_EQ(0, cap.get(CAP_PROP_CONVERT_RGB));
+    Mat frame, bgr;
+    for (int i = 0; i < frame_count; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        ASSERT_TRUE(cap.read(frame));
+        ASSERT_EQ(CV_8UC1, frame.type());
+        ASSERT_EQ(Size(160, 180), frame.size());
+        cvtColor(frame, bgr, COLOR_YUV2BGR_I420);
+        EXPECT_GT(cvtest::PSNR(expected[i](Rect(0, 0, 160, 120)), bgr), 30);
+    }
+    EXPECT_FALSE(cap.read(frame));
+    remove(filename.c_str());
+}
+
 #endif
 }} // namespace
@@ -0,0 +1,89 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+class Videoio_Group : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        Mat img(60, 80, CV_8UC3);
+        for (int s = 0; s < 3; s++)
+        {
+            std::string pattern = cv::tempfile(".png");
+            pattern = pattern.substr(0, pattern.size() - 4) + "_%02d.png";
+            patterns.push_back(pattern);
+            frame_counts.push_back(5 + s);
+            for (int i = 0; i < frame_counts[s]; i++)
+            {
+                generateFrame(i + 10 * s, 30, img);
+                ASSERT_TRUE(imwrite(cv::format(pattern.c_str(), i), img));
+            }
+        }
+    }
+    void TearDown()
+    {
+        for (size_t s = 0; s < patterns.size(); s++)
+            for (int i = 0; i < frame_counts[s]; i++)
+                remove(cv::format(patterns[s].c_str(), i).c_str());
+    }
+    std::vector<VideoCapture> openAll()
+    {
+        std::vector<VideoCapture> streams(patterns.size());
+        for (size_t s = 0; s < patterns.size(); s++)
+            EXPECT_TRUE(streams[s].open(patterns[s], CAP_IMAGES));
+        return streams;
+    }
+
+    std::vector<std::string> patterns;
+    std::vector<int> frame_counts;
+};
+
+TEST_F(Videoio_Group, read)
+{
+    VideoCaptureGroup group(openAll());
+    ASSERT_EQ(3, group.size());
+    for (int s = 0; s < group.size(); s++)
+        EXPECT_EQ(-1, group.getSequenceNumber(s));
+
+    std::vector<Mat> frames;
+    std::vector<int64> timestamps(3, 0);
+    for (int i = 0; i < frame_counts[0]; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        ASSERT_TRUE(group.read(frames));
+        ASSERT_EQ(3u, frames.size());
+        for (int s = 0; s < 3; s++)
+        {
+            Mat expected = imread(cv::format(patterns[s].c_str(), i), IMREAD_UNCHANGED);
+            EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), expected, frames[s]);
+            EXPECT_EQ(i, group.getSequenceNumber(s));
+            EXPECT_GE(group.getTimestamp(s), timestamps[s]);
+            timestamps[s] = group.getTimestamp(s);
+        }
+    }
+
+    // the first stream has ended, the others go on
+    std::vector<int> ready;
+    EXPECT_FALSE(group.grab(ready));
+    ASSERT_EQ(2u, ready.size());
+    EXPECT_EQ(1, ready[0]);
+    EXPECT_EQ(2, ready[1]);
+    EXPECT_EQ(frame_counts[0] - 1, group.getSequenceNumber(0));
+    EXPECT_EQ(frame_counts[0], group.getSequenceNumber(1));
+
+    group.release();
+    EXPECT_EQ(0, group.size());
+}
+
+TEST_F(Videoio_Group, waitAny_requires_v4l)
+{
+    std::vector<VideoCapture> streams = openAll();
+    std::vector<int> ready;
+    EXPECT_THROW(VideoCapture::waitAny(streams, ready), cv::Exception);
+}
+
+}} // namespace
@@ -71,6 +71,79 @@ Param test_data[] = {
 
 INSTANTIATE_TEST_CASE_P(videoio, Videoio_Gstreamer_Test, testing::ValuesIn(test_data));
 
+TEST(Videoio_GStreamer, sink_properties)
+{
+    VideoCapture cap("videotestsrc is-live=true ! video/x-raw, format=BGR, width=320, height=240 ! appsink max-buffers=3", CAP_GSTREAMER);
+    ASSERT_TRUE(cap.isOpened());
+    // the settings of the pipeline description are kept
+    EXPECT_EQ(3, cap.get(CAP_PROP_GSTREAMER_QUEUE_LENGTH));
+    EXPECT_EQ(0, cap.get(CAP_PROP_GSTREAMER_DROP));
+    EXPECT_EQ(1, cap.get(CAP_PROP_GSTREAMER_SYNC));
+
+    ASSERT_TRUE(cap.set(CAP_PROP_GSTREAMER_QUEUE_LENGTH, 1));
+    ASSERT_TRUE(cap.set(CAP_PROP_GSTREAMER_DROP, 1));
+    EXPECT_EQ(1, cap.get(CAP_PROP_GSTREAMER_QUEUE_LENGTH));
+    EXPECT_EQ(1, cap.get(CAP_PROP_GSTREAMER_DROP));
+    ASSERT_TRUE(cap.set(CAP_PROP_GSTREAMER_QUEUE_LENGTH, 0)); // unlimited
+    EXPECT_EQ(0, cap.get(CAP_PROP_GSTREAMER_QUEUE_LENGTH));
+    ASSERT_TRUE(cap.set(CAP_PROP_GSTREAMER_QUEUE_LENGTH, 1));
+    EXPECT_FALSE(cap.set(CAP_PROP_GSTREAMER_LATENCY_MSEC, 0));
+
+    Mat frame;
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(cap.read(frame));
+        // a live source with a single dropping buffer delivers fresh frames
+        double latency = cap.get(CAP_PROP_GSTREAMER_LATENCY_MSEC);
+        EXPECT_GE(latency, 0);
+        EXPECT_LT(latency, 1000);
+    }
+    EXPECT_EQ(Size(320, 240), frame.size());
+}
+
+TEST(Videoio_GStreamer, default_queue_length)
+{
+    VideoCapture cap("videotestsrc num-buffers=1 ! video/x-raw, format=BGR ! appsink", CAP_GSTREAMER);
+    ASSERT_TRUE(cap.isOpened());
+    EXPECT_EQ(1, cap.get(CAP_PROP_GSTREAMER_QUEUE_LENGTH));
+}
+
+TEST(Videoio_GStreamer, zero_copy)
+{
+    const int count_frames = 10;
+    // odd width: the BGR rows are padded to 4 bytes by GStreamer
+    const string pipeline = "videotestsrc pattern=ball num-buffers=10 ! video/x-raw, format=BGR, width=161, height=120 ! appsink sync=false";
+    std::vector<Mat> expected;
+    {
+        VideoCapture cap(pipeline, CAP_GSTREAMER);
+        ASSERT_TRUE(cap.isOpened());
+        Mat frame;
+        while (cap.read(frame))
+            expected.push_back(frame.clone());
+        ASSERT_EQ((size_t)count_frames, expected.size());
+    }
+
+    VideoCapture cap(pipeline, CAP_GSTREAMER);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_GSTREAMER_ZERO_COPY, 1));
+    EXPECT_EQ(1, cap.get(CAP_PROP_GSTREAMER_ZERO_COPY));
+    std::vector<Mat> frames;
+    for (int i = 0; i < count_frames; i++)
+    {
+        Mat frame; // the frames stay valid while the buffers are referenced
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(Size(161, 120), frame.size());
+        frames.push_back(frame);
+    }
+    cap.release();
+    for (int i = 0; i < count_frames; i++)
+    {
+        if (i > 0)
+            EXPECT_NE(frames[i - 1].data, frames[i].data);
+        EXPECT_EQ(0, cvtest::norm(expected[i], frames[i], NORM_INF)) << "frame " << i;
+    }
+}
+
 } // namespace
 
 #endif
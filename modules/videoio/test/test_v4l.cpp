@@ -0,0 +1,157 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "test_precomp.hpp"
+
+#include <set>
+
+#ifdef HAVE_CAMV4L2
+
+// The tests run on a device given by OPENCV_TEST_V4L_DEVICE,
+// e.g. the virtual one created by "modprobe vivid": OPENCV_TEST_V4L_DEVICE=/dev/video0
+
+namespace opencv_test { namespace {
+
+static void openTestDevice(VideoCapture& cap, int fourcc = VideoWriter::fourcc('Y', 'U', 'Y', 'V'))
+{
+    const char* device = getenv("OPENCV_TEST_V4L_DEVICE");
+    if (!device)
+        throw SkipTestException("OPENCV_TEST_V4L_DEVICE is not set");
+    ASSERT_TRUE(cap.open(device, CAP_V4L));
+    if (!cap.set(CAP_PROP_FOURCC, fourcc))
+        throw SkipTestException("the device does not support " + fourccToString(fourcc));
+}
+
+TEST(Videoio_V4L, raw_frames_without_copying)
+{
+    VideoCapture cap;
+    openTestDevice(cap);
+    ASSERT_TRUE(cap.set(CAP_PROP_BUFFERSIZE, 4));
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 0));
+    const int width = (int)cap.get(CAP_PROP_FRAME_WIDTH), height = (int)cap.get(CAP_PROP_FRAME_HEIGHT);
+
+    std::vector<Mat> frames;
+    std::set<uchar*> buffers;
+    Mat frame;
+    for (int i = 0; i < 20; i++)
+    {
+        ASSERT_TRUE(cap.read(frame));
+        ASSERT_EQ(CV_8UC2, frame.type());
+        ASSERT_EQ(Size(width, height), frame.size());
+        buffers.insert(frame.data);
+        if (i < 2)
+            frames.push_back(frame); // held, these buffers are not given back
+    }
+    EXPECT_LE(buffers.size(), (size_t)4);
+    for (size_t i = 0; i < frames.size(); i++)
+        EXPECT_NE(frames[i].data, frame.data);
+
+    // the held frames stay valid after the capture is closed
+    cap.release();
+    Mat copy = frames[0].clone();
+    EXPECT_EQ(0, cvtest::norm(copy, frames[0], NORM_INF));
+}
+
+TEST(Videoio_V4L, all_buffers_held)
+{
+    VideoCapture cap;
+    openTestDevice(cap);
+    ASSERT_TRUE(cap.set(CAP_PROP_BUFFERSIZE, 2));
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 0));
+    Mat frame1, frame2, frame3;
+    ASSERT_TRUE(cap.read(frame1));
+    ASSERT_TRUE(cap.read(frame2));
+    EXPECT_FALSE(cap.read(frame3));
+    frame1.release();
+    EXPECT_TRUE(cap.read(frame3));
+}
+
+TEST(Videoio_V4L, userptr)
+{
+    VideoCapture cap;
+    openTestDevice(cap);
+    ASSERT_TRUE(cap.set(CAP_PROP_V4L_MEMORY, CAP_V4L_MEMORY_USERPTR));
+    EXPECT_EQ(CAP_V4L_MEMORY_USERPTR, cap.get(CAP_PROP_V4L_MEMORY));
+    EXPECT_EQ(-1, cap.get(CAP_PROP_V4L_DMABUF_FD));
+    Mat raw, bgr;
+    ASSERT_TRUE(cap.read(bgr));
+    EXPECT_EQ(CV_8UC3, bgr.type());
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 0));
+    ASSERT_TRUE(cap.read(raw));
+    EXPECT_EQ(CV_8UC2, raw.type());
+}
+
+TEST(Videoio_V4L, dmabuf_export)
+{
+    VideoCapture cap;
+    openTestDevice(cap);
+    Mat frame;
+    ASSERT_TRUE(cap.read(frame));
+    const int fd = (int)cap.get(CAP_PROP_V4L_DMABUF_FD);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(fd, (int)cap.get(CAP_PROP_V4L_DMABUF_FD));
+}
+
+TEST(Videoio_V4L, waitAny)
+{
+    std::vector<VideoCapture> streams(1);
+    openTestDevice(streams[0]);
+    std::vector<int> ready;
+    Mat frame;
+    for (int i = 0; i < 10; i++)
+    {
+        // a device delivers a frame well within a second
+        ASSERT_TRUE(VideoCapture::waitAny(streams, ready, 1000000000));
+        ASSERT_EQ(1u, ready.size());
+        EXPECT_EQ(0, ready[0]);
+        ASSERT_TRUE(streams[0].retrieve(frame));
+        EXPECT_FALSE(frame.empty());
+    }
+}
+
+typedef testing::TestWithParam<std::string> Videoio_V4L_Formats;
+
+TEST_P(Videoio_V4L_Formats, convert)
+{
+    VideoCapture cap;
+    openTestDevice(cap, fourccFromString(GetParam()));
+    const int width = (int)cap.get(CAP_PROP_FRAME_WIDTH), height = (int)cap.get(CAP_PROP_FRAME_HEIGHT);
+
+    // the same frame with and without the conversion
+    Mat raw, bgr, expected;
+    ASSERT_TRUE(cap.grab());
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 0));
+    ASSERT_TRUE(cap.retrieve(raw));
+    ASSERT_TRUE(cap.set(CAP_PROP_CONVERT_RGB, 1));
+    ASSERT_TRUE(cap.retrieve(bgr));
+    ASSERT_EQ(CV_8UC3, bgr.type());
+    ASSERT_EQ(Size(width, height), bgr.size());
+
+    const std::string format = GetParam();
+    if (format == "YUYV")
+        cvtColor(raw, expected, COLOR_YUV2BGR_YUYV);
+    else if (format == "UYVY")
+        cvtColor(raw, expected, COLOR_YUV2BGR_UYVY);
+    else if (format == "NV12")
+        cvtColor(raw, expected, COLOR_YUV2BGR_NV12);
+    else if (format == "NV21")
+        cvtColor(raw, expected, COLOR_YUV2BGR_NV21);
+    else if (format == "YU12")
+        cvtColor(raw, expected, COLOR_YUV2BGR_I420);
+    else if (format == "YV12")
+        cvtColor(raw, expected, COLOR_YUV2BGR_YV12);
+    else if (format == "GREY")
+        cvtColor(raw, expected, COLOR_GRAY2BGR);
+    else if (format == "RGB3")
+        cvtColor(raw, expected, COLOR_RGB2BGR);
+    else
+        expected = raw;
+    EXPECT_EQ(0, cvtest::norm(expected, bgr, NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(videoio, Videoio_V4L_Formats,
+                        testing::Values("YUYV", "UYVY", "NV12", "NV21", "YU12", "YV12", "GREY", "RGB3", "BGR3"));
+
+}} // namespace
+
+#endif // HAVE_CAMV4L2
@@ -509,4 +509,219 @@ INSTANTIATE_TEST_CASE_P(videoio, Videoio_Synthetic,
                             testing::ValuesIn(all_sizes),
                             testing::ValuesIn(synthetic_params)));
 
+//==================================================================================================
+
+TEST(Videoio_MJPEG, decode_ahead_and_seek)
+{
+    const string video_file = cv::tempfile(".avi");
+    const int frame_count = 20;
+    const double fps = 25;
+    {
+        VideoWriter writer(video_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, Size(160, 120));
+        ASSERT_TRUE(writer.isOpened());
+        Mat img(120, 160, CV_8UC3);
+        for (int i = 0; i < frame_count; i++)
+        {
+            generateFrame(i, frame_count, img);
+            writer << img;
+        }
+    }
+
+    std::vector<Mat> expected;
+    {
+        VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD, 0));
+        Mat frame;
+        while (cap.read(frame))
+            expected.push_back(frame.clone());
+        ASSERT_EQ((size_t)frame_count, expected.size());
+    }
+
+    VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+    ASSERT_TRUE(cap.isOpened());
+    EXPECT_EQ(0, cap.get(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD));
+    ASSERT_TRUE(cap.set(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD, 6));
+    EXPECT_EQ(6, cap.get(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD));
+    std::vector<Mat> frames;
+    Mat frame;
+    for (int i = 0; i < frame_count; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        if (i == 7)
+            ASSERT_TRUE(cap.grab()); // skipped without retrieving
+        else
+            ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(i + 1, cap.get(CAP_PROP_POS_FRAMES));
+        if (i != 7)
+        {
+            // the frames kept by the user are not overwritten by the later batches
+            frames.push_back(frame);
+            EXPECT_EQ(0, cvtest::norm(expected[i], frame, NORM_INF));
+        }
+    }
+    EXPECT_FALSE(cap.read(frame));
+    for (int i = 0, j = 0; i < frame_count; i++)
+    {
+        if (i != 7)
+            EXPECT_EQ(0, cvtest::norm(expected[i], frames[j++], NORM_INF)) << "frame " << i;
+    }
+
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 13));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(0, cvtest::norm(expected[13], frame, NORM_INF));
+
+    // the frames modified by the user are not returned again, neither retrieved twice nor after seeking back
+    frame.setTo(Scalar::all(0));
+    ASSERT_TRUE(cap.retrieve(frame));
+    EXPECT_EQ(0, cvtest::norm(expected[13], frame, NORM_INF));
+    frame.setTo(Scalar::all(0));
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 13));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(0, cvtest::norm(expected[13], frame, NORM_INF));
+
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_MSEC, 5 * 1000 / fps));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(0, cvtest::norm(expected[5], frame, NORM_INF));
+    EXPECT_DOUBLE_EQ(5 * 1000 / fps, cap.get(CAP_PROP_POS_MSEC));
+
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_AVI_RATIO, 0.5));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(0, cvtest::norm(expected[frame_count / 2], frame, NORM_INF));
+
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, frame_count));
+    EXPECT_FALSE(cap.read(frame));
+    EXPECT_FALSE(cap.set(CAP_PROP_POS_FRAMES, frame_count + 1));
+
+    // the outputs of a fixed type are converted from both paths
+    for (int decode_ahead = 0; decode_ahead <= 6; decode_ahead += 6)
+    {
+        SCOPED_TRACE(cv::format("decode ahead %d", decode_ahead));
+        ASSERT_TRUE(cap.set(CAP_PROP_OPENCV_MJPEG_DECODE_AHEAD, decode_ahead));
+        ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 3));
+        Mat_<Vec3b> typed;
+        ASSERT_TRUE(cap.read(typed));
+        EXPECT_EQ(0, cvtest::norm(expected[3], typed, NORM_INF));
+    }
+
+    remove(video_file.c_str());
+}
+
+static std::vector<Mat> writeReadMJPEG(const std::vector<Mat>& frames, double nstripes, int subsampling)
+{
+    const string video_file = cv::tempfile(".avi");
+    {
+        VideoWriter writer(video_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, frames[0].size());
+        EXPECT_TRUE(writer.isOpened());
+        EXPECT_TRUE(writer.set(VIDEOWRITER_PROP_NSTRIPES, nstripes));
+        EXPECT_TRUE(writer.set(VIDEOWRITER_PROP_CHROMA_SUBSAMPLING, subsampling));
+        EXPECT_EQ(subsampling, writer.get(VIDEOWRITER_PROP_CHROMA_SUBSAMPLING));
+        for (size_t i = 0; i < frames.size(); i++)
+            writer << frames[i];
+    }
+    std::vector<Mat> result;
+    VideoCapture cap(video_file, CAP_OPENCV_MJPEG);
+    Mat frame;
+    while (cap.read(frame))
+        result.push_back(frame.clone());
+    remove(video_file.c_str());
+    return result;
+}
+
+TEST(Videoio_MJPEG, stripes_and_subsampling)
+{
+    // the size is not a multiple of the MCU size
+    std::vector<Mat> frames(3);
+    for (int i = 0; i < (int)frames.size(); i++)
+    {
+        frames[i].create(100, 150, CV_8UC3);
+        generateFrame(i, (int)frames.size(), frames[i]);
+    }
+
+    const int modes[] = { VIDEOWRITER_CHROMA_420, VIDEOWRITER_CHROMA_422, VIDEOWRITER_CHROMA_444 };
+    double psnr[3];
+    for (int m = 0; m < 3; m++)
+    {
+        SCOPED_TRACE(cv::format("subsampling %d", modes[m]));
+        std::vector<Mat> single = writeReadMJPEG(frames, 1, modes[m]);
+        // the restart intervals are decoded to exactly the same frames
+        std::vector<Mat> striped = writeReadMJPEG(frames, 5, modes[m]);
+        ASSERT_EQ(frames.size(), single.size());
+        ASSERT_EQ(frames.size(), striped.size());
+        psnr[m] = 100;
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            EXPECT_EQ(0, cvtest::norm(single[i], striped[i], NORM_INF)) << "frame " << i;
+            psnr[m] = std::min(psnr[m], cvtest::PSNR(frames[i], single[i]));
+        }
+        EXPECT_GT(psnr[m], 28);
+    }
+    // the sharp color edges of the test frames suffer from the subsampling
+    EXPECT_GT(psnr[1], psnr[0]);
+    EXPECT_GT(psnr[2], psnr[1]);
+
+    const string video_file = cv::tempfile(".avi");
+    {
+        VideoWriter writer(video_file, CAP_OPENCV_MJPEG, VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, Size(160, 120));
+        ASSERT_TRUE(writer.isOpened());
+        EXPECT_EQ(VIDEOWRITER_CHROMA_420, writer.get(VIDEOWRITER_PROP_CHROMA_SUBSAMPLING));
+        EXPECT_FALSE(writer.set(VIDEOWRITER_PROP_CHROMA_SUBSAMPLING, 411));
+    }
+    remove(video_file.c_str());
+}
+
+TEST(Videoio_Images, read_ahead_and_seek)
+{
+    const int frame_count = 20;
+    string pattern = cv::tempfile(".png");
+    pattern = pattern.substr(0, pattern.size() - 4) + "_%03d.png";
+    std::vector<Mat> expected(frame_count);
+    for (int i = 0; i < frame_count; i++)
+    {
+        expected[i].create(120, 160, CV_8UC3);
+        generateFrame(i, frame_count, expected[i]);
+        // the sequence starts at 1
+        ASSERT_TRUE(imwrite(cv::format(pattern.c_str(), i + 1), expected[i]));
+    }
+
+    VideoCapture cap(pattern, CAP_IMAGES);
+    ASSERT_TRUE(cap.isOpened());
+    EXPECT_EQ(frame_count, cap.get(CAP_PROP_FRAME_COUNT));
+    EXPECT_EQ(160, cap.get(CAP_PROP_FRAME_WIDTH));
+    ASSERT_TRUE(cap.set(CAP_PROP_IMAGES_READ_AHEAD, 6));
+    EXPECT_EQ(6, cap.get(CAP_PROP_IMAGES_READ_AHEAD));
+    EXPECT_FALSE(cap.set(CAP_PROP_IMAGES_READ_AHEAD, -1));
+    std::vector<Mat> frames;
+    Mat frame;
+    for (int i = 0; i < frame_count; i++)
+    {
+        SCOPED_TRACE(cv::format("frame %d", i));
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(i + 1, cap.get(CAP_PROP_POS_FRAMES));
+        frames.push_back(frame.clone());
+    }
+    EXPECT_FALSE(cap.read(frame));
+    for (int i = 0; i < frame_count; i++)
+        EXPECT_EQ(0, cvtest::norm(expected[i], frames[i], NORM_INF)) << "frame " << i;
+
+    // seeking back into the batch which has been read already, and forward
+    const int positions[] = { 19, 13, 12, 2, 3, 0 };
+    for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+        const int pos = positions[i];
+        SCOPED_TRACE(cv::format("position %d", pos));
+        ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, pos));
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(0, cvtest::norm(expected[pos], frame, NORM_INF));
+        EXPECT_EQ(pos + 1, cap.get(CAP_PROP_POS_FRAMES));
+    }
+
+    for (int i = 0; i < frame_count; i++)
+        remove(cv::format(pattern.c_str(), i + 1).c_str());
+
+    // a missing directory does not throw
+    VideoCapture missing("/nonexistent_directory/frame_%03d.png", CAP_IMAGES);
+    EXPECT_FALSE(missing.isOpened());
+}
+
 } // namespace